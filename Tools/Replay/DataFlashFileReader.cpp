@@ -24,6 +24,13 @@ AP_LoggerFileReader::~AP_LoggerFileReader()
 
 bool AP_LoggerFileReader::open_log(const char *logfile)
 {
+#if AP_LOGREADER_MMAP_ENABLED
+    // mapped copy on write so handlers are given messages in place
+    if (mapped_log.open(logfile, true)) {
+        file_size = mapped_log.size();
+        return true;
+    }
+#endif
     fd = AP::FS().open(logfile, O_RDONLY);
     if (fd == -1) {
         return false;
@@ -57,8 +64,53 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
     memcpy(dest, packet_counts, sizeof(packet_counts));
 }
 
+#if AP_LOGREADER_MMAP_ENABLED
+/*
+  messages in the mapped log are found without system calls. As with
+  the read() path replay stops at bytes which are not a message with a
+  known format
+ */
+bool AP_LoggerFileReader::update_mapped(void)
+{
+    uint32_t offset = bytes_read;
+    AP_Logger_IndexedReader::Message msg;
+    const bool ret = mapped_log.next(offset, msg);
+    bytes_read = offset;
+    if (!ret) {
+        switch (mapped_log.stopped()) {
+        case AP_Logger_IndexedReader::Stop::END_OF_LOG:
+            break;
+        case AP_Logger_IndexedReader::Stop::BAD_HEADER:
+            printf("bad log header\n");
+            break;
+        case AP_Logger_IndexedReader::Stop::NO_FORMAT:
+            ::printf("No format defined for type (%d)\n", msg.type);
+            exit(1);
+        }
+        return false;
+    }
+    packet_counts[msg.type]++;
+    message_count++;
+
+    uint8_t *data = mapped_log.writable(msg);
+    if (msg.type == LOG_FORMAT_MSG) {
+        struct log_Format f;
+        memcpy(&f, data, sizeof(f));
+        memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+        return handle_log_format_msg(f);
+    }
+    return handle_msg(formats[msg.type], data);
+}
+#endif  // AP_LOGREADER_MMAP_ENABLED
+
 bool AP_LoggerFileReader::update()
 {
+#if AP_LOGREADER_MMAP_ENABLED
+    if (mapped_log.is_open()) {
+        return update_mapped();
+    }
+#endif
+
     uint8_t hdr[3];
     if (read_input(hdr, 3) != 3) {
         return false;
@@ -1,9 +1,19 @@
 #pragma once
 
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/AP_Logger_IndexedReader.h>
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
 
+// read the log through a memory mapping rather than with read() calls
+#ifndef AP_LOGREADER_MMAP_ENABLED
+#define AP_LOGREADER_MMAP_ENABLED AP_LOGGER_INDEXED_READER_ENABLED
+#endif
+
+#if AP_LOGREADER_MMAP_ENABLED && !AP_LOGGER_INDEXED_READER_ENABLED
+#error AP_LOGREADER_MMAP_ENABLED requires AP_LOGGER_INDEXED_READER_ENABLED
+#endif
+
 class AP_LoggerFileReader
 {
 public:
@@ -29,6 +39,13 @@ protected:
 private:
     ssize_t read_input(void *buf, size_t count);
 
+#if AP_LOGREADER_MMAP_ENABLED
+    // handle the next message of the mapped log
+    bool update_mapped(void);
+
+    AP_Logger_IndexedReader mapped_log;
+#endif
+
     uint64_t bytes_read = 0;
     uint64_t file_size = 0; // Total size of the log file
     uint32_t message_count = 0;
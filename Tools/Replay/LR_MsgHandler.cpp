@@ -38,6 +38,21 @@ void LR_MsgHandler_RFRF::process_message(uint8_t *msgbytes)
         MAP_FLAG(AP_DAL::FrameType::LogWriteEKF2, AP_DAL::FrameType::LogWriteEKF3);
     }
 #undef MAP_FLAG
+    /*
+      when we replay a single EKF lane the other EKF is never initialised
+     */
+#define CLEAR_FLAG(flag) msg.frame_types &= ~uint8_t(flag)
+    if (replay_only_ekf2) {
+        CLEAR_FLAG(AP_DAL::FrameType::InitialiseFilterEKF3);
+        CLEAR_FLAG(AP_DAL::FrameType::UpdateFilterEKF3);
+        CLEAR_FLAG(AP_DAL::FrameType::LogWriteEKF3);
+    }
+    if (replay_only_ekf3) {
+        CLEAR_FLAG(AP_DAL::FrameType::InitialiseFilterEKF2);
+        CLEAR_FLAG(AP_DAL::FrameType::UpdateFilterEKF2);
+        CLEAR_FLAG(AP_DAL::FrameType::LogWriteEKF2);
+    }
+#undef CLEAR_FLAG
     AP::dal().handle_message(msg, ekf2, ekf3);
 }
 
@@ -39,6 +39,8 @@ static ReplayVehicle replayvehicle;
 user_parameter *user_parameters;
 bool replay_force_ekf2;
 bool replay_force_ekf3;
+bool replay_only_ekf2;
+bool replay_only_ekf3;
 bool show_progress;
 
 const AP_Param::Info ReplayVehicle::var_info[] = {
@@ -125,12 +127,16 @@ void Replay::usage(void)
     ::printf("\t--param-file FILENAME  load parameters from a file\n");
     ::printf("\t--force-ekf2 force enable EKF2\n");
     ::printf("\t--force-ekf3 force enable EKF3\n");
+    ::printf("\t--only-ekf2 only replay EKF2\n");
+    ::printf("\t--only-ekf3 only replay EKF3\n");
     ::printf("\t--progress  show a progress bar during replay\n");
 }
 
 enum param_key : uint8_t {
     FORCE_EKF2 = 1,
     FORCE_EKF3,
+    ONLY_EKF2,
+    ONLY_EKF3,
 };
 
 void Replay::_parse_command_line(uint8_t argc, char * const argv[])
@@ -142,6 +148,8 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"param-file",      true,   0, 'F'},
         {"force-ekf2",      false,  0, param_key::FORCE_EKF2},
         {"force-ekf3",      false,  0, param_key::FORCE_EKF3},
+        {"only-ekf2",       false,  0, param_key::ONLY_EKF2},
+        {"only-ekf3",       false,  0, param_key::ONLY_EKF3},
         {"progress",        false,  0, 'P'},
         {"help",            false,  0, 'h'},
         {0, false, 0, 0}
@@ -177,6 +185,14 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         case param_key::FORCE_EKF3:
             replay_force_ekf3 = true;
             break;
+
+        case param_key::ONLY_EKF2:
+            replay_only_ekf2 = true;
+            break;
+
+        case param_key::ONLY_EKF3:
+            replay_only_ekf3 = true;
+            break;
             
         case 'P':
             show_progress = true;
@@ -274,6 +290,11 @@ void Replay::setup()
         exit(1);
     }
 
+    if (replay_only_ekf2 && replay_only_ekf3) {
+        ::printf("Cannot use both --only-ekf2 and --only-ekf3\n");
+        exit(1);
+    }
+
     if (filename == nullptr) {
 #if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
         // allow replay on stm32
@@ -6,6 +6,9 @@
 Create a replay log using master branch.
 Check out a specified branch, compile and run Replay against replay log
 Run check_replay.py over the produced log
+
+With --time, also time EKF3-only Replay of each log with the Replay
+built from master and from the branch, to measure EKF speedups
 '''
 
 import git
@@ -14,14 +17,20 @@ import os
 import subprocess
 import sys
 import re
+import shutil
+import tempfile
+import time
 
 from pymavlink import DFReader
 
 import check_replay
 
 class CheckReplayBranch(object):
-    def __init__(self, master='remotes/origin/master'):
+    def __init__(self, master='remotes/origin/master', accuracy=0.0, time_runs=0):
         self.master = master
+        self.accuracy = accuracy
+        self.time_runs = time_runs
+        self.master_replay = None
 
     def find_topdir(self):
         here = os.getcwd()
@@ -113,6 +122,11 @@ class CheckReplayBranch(object):
         # generate logs:
         subprocess.check_call(["Tools/autotest/autotest.py", "--debug", "build.Copter", "test.Copter.Replay"])
 
+        if self.time_runs > 0:
+            # keep the Replay the autotest built for timing
+            self.master_replay = os.path.join(tempfile.mkdtemp(), "Replay-master")
+            shutil.copy("build/sitl/tool/Replay", self.master_replay)
+
         # check out the original branch:
         self.repo.head.reference = old_branch
         self.repo.head.reset(index=True, working_tree=True)
@@ -133,6 +147,49 @@ class CheckReplayBranch(object):
                 replayed_logs.add(match.group(1))
         return sorted(list(replayed_logs))
 
+    def replay_supports(self, replay, option):
+        '''true if a Replay binary lists option in its usage'''
+        workdir = tempfile.mkdtemp()
+        usage = subprocess.run([replay, "--help"],
+                               cwd=workdir,
+                               stdout=subprocess.PIPE,
+                               stderr=subprocess.DEVNULL,
+                               universal_newlines=True).stdout
+        shutil.rmtree(workdir)
+        return option in usage
+
+    def time_replay(self, replay, ekf_option, logfile_path):
+        '''best time of EKF3 Replay of a log, run away from logs/'''
+        best = None
+        for i in range(self.time_runs):
+            workdir = tempfile.mkdtemp()
+            start = time.time()
+            subprocess.check_call([replay, ekf_option, logfile_path],
+                                  cwd=workdir,
+                                  stdout=subprocess.DEVNULL)
+            elapsed = time.time() - start
+            shutil.rmtree(workdir)
+            if best is None or elapsed < best:
+                best = elapsed
+        return best
+
+    def time_replays(self, replay_logs):
+        branch_replay = os.path.abspath("build/sitl/tool/Replay")
+        # older Replay treats unknown options as --help and exits
+        # successfully without replaying, so only use --only-ekf3 if
+        # both binaries have it; --force-ekf3 is in both
+        ekf_option = "--force-ekf3"
+        if (self.replay_supports(self.master_replay, "--only-ekf3") and
+                self.replay_supports(branch_replay, "--only-ekf3")):
+            ekf_option = "--only-ekf3"
+        self.progress("Timing Replay with %s" % ekf_option)
+        for log in replay_logs:
+            log = os.path.abspath(log)
+            master_time = self.time_replay(self.master_replay, ekf_option, log)
+            branch_time = self.time_replay(branch_replay, ekf_option, log)
+            self.progress("EKF3 Replay of (%s): master %.2fs branch %.2fs speedup %.2fx" %
+                          (log, master_time, branch_time, master_time / max(branch_time, 0.001)))
+
     def run(self):
         self.topdir = self.find_topdir()
         self.repo = self.find_repo()
@@ -166,11 +223,14 @@ class CheckReplayBranch(object):
             self.progress("Running check_replay.py on Replay output log: %s" % new_log)
 
             # run check_replay across Replay log
-            if check_replay.check_log(new_log, verbose=True):
+            if check_replay.check_log(new_log, verbose=True, accuracy=self.accuracy):
                 self.progress("check_replay.py of (%s): OK" % new_log)
             else:
                 self.progress("check_replay.py of (%s): FAILED" % new_log)
                 success = False
+        if self.time_runs > 0:
+            self.time_replays(replay_logs)
+
         if success:
             self.progress("All OK")
         else:
@@ -183,10 +243,13 @@ if __name__ == '__main__':
     from argparse import ArgumentParser
     parser = ArgumentParser(description=__doc__)
     parser.add_argument("--master", default='remotes/origin/master', help="branch to consider master branch")
+    parser.add_argument("--accuracy", type=float, default=0.0, help="accuracy percentage for match")
+    parser.add_argument("--time", type=int, default=0, metavar="RUNS",
+                        help="time EKF3 Replay of each log on master and branch, best of RUNS")
 
     args = parser.parse_args()
 
-    s = CheckReplayBranch(master=args.master)
+    s = CheckReplayBranch(master=args.master, accuracy=args.accuracy, time_runs=args.time)
     if not s.run():
         sys.exit(1)
 
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+
+'''
+Replay many logs in parallel and check the replayed EKF output matches
+the original, printing a summary of timing and divergences.
+
+With --split-ekf each log is replayed twice at the same time, once with
+only EKF2 and once with only EKF3, so the two EKFs run on separate cores.
+
+e.g. ./Tools/Replay/replay_batch.py -j 16 --split-ekf logs/*.BIN
+
+AP_FLAKE8_CLEAN
+'''
+
+import glob
+import os
+import re
+import subprocess
+import sys
+import time
+
+from argparse import ArgumentParser
+from concurrent.futures import ProcessPoolExecutor
+
+import check_replay
+
+
+class ReplayJob(object):
+    def __init__(self, logfile, lane, workdir):
+        self.logfile = logfile
+        self.lane = lane
+        self.workdir = workdir
+        self.passed = False
+        self.message = ""
+        self.replay_time = 0
+        self.check_time = 0
+        self.checked = 0
+        self.errors = 0
+
+
+def run_job(job, replay, replay_args, accuracy, ignores):
+    '''replay one log on one lane and check the result, run in a worker process'''
+    os.makedirs(job.workdir, exist_ok=True)
+    for old_log in glob.glob(os.path.join(job.workdir, "logs", "*.BIN")):
+        os.unlink(old_log)
+
+    cmd = [replay]
+    if job.lane == "ekf2":
+        cmd.append("--only-ekf2")
+    elif job.lane == "ekf3":
+        cmd.append("--only-ekf3")
+    cmd.extend(replay_args)
+    cmd.append(job.logfile)
+
+    start = time.time()
+    with open(os.path.join(job.workdir, "replay.txt"), "w") as f:
+        ret = subprocess.call(cmd, cwd=job.workdir, stdin=subprocess.DEVNULL, stdout=f, stderr=subprocess.STDOUT)
+    job.replay_time = time.time() - start
+    if ret != 0:
+        job.message = "Replay exit code %d" % ret
+        return job
+
+    output_logs = glob.glob(os.path.join(job.workdir, "logs", "*.BIN"))
+    if len(output_logs) == 0:
+        job.message = "no output log"
+        return job
+    output_log = max(output_logs, key=os.path.getmtime)
+
+    lines = []
+    start = time.time()
+    job.passed = check_replay.check_log(output_log,
+                                        progress=lines.append,
+                                        ekf2_only=(job.lane == "ekf2"),
+                                        ekf3_only=(job.lane == "ekf3"),
+                                        accuracy=accuracy,
+                                        ignores=ignores)
+    job.check_time = time.time() - start
+    logged = 0
+    for line in lines:
+        match = re.match(r"Processed (\d+)/(\d+) messages, (\d+) errors", str(line))
+        if match is not None:
+            job.checked = int(match.group(1))
+            logged = int(match.group(2))
+            job.errors = int(match.group(3))
+    if job.lane != "both" and logged == 0 and job.checked == 0:
+        # this EKF did not run when the log was recorded
+        job.passed = True
+    with open(os.path.join(job.workdir, "check.txt"), "w") as f:
+        for line in lines:
+            print(line, file=f)
+    if not job.passed:
+        reason = "%u mismatches" % job.errors if job.errors else "message count mismatch"
+        job.message = "%s (%s)" % (reason, os.path.join(job.workdir, "check.txt"))
+    return job
+
+
+def print_summary(jobs, wall_time):
+    print("")
+    print("%-40s %-5s %9s %9s %9s %7s %s" %
+          ("Log", "Lane", "Replay(s)", "Check(s)", "Messages", "Errors", "Result"))
+    for job in jobs:
+        print("%-40s %-5s %9.1f %9.1f %9u %7u %s" %
+              (os.path.basename(job.logfile), job.lane, job.replay_time, job.check_time,
+               job.checked, job.errors, "PASSED" if job.passed else "FAILED " + job.message))
+    failed = [j for j in jobs if not j.passed]
+    replay_time = sum([j.replay_time for j in jobs])
+    print("")
+    print("%u replays: %u passed, %u failed, %u mismatches" %
+          (len(jobs), len(jobs) - len(failed), len(failed), sum([j.errors for j in jobs])))
+    print("Wall time %.1fs, total replay time %.1fs, parallel speedup %.1fx" %
+          (wall_time, replay_time, replay_time / max(wall_time, 0.001)))
+
+
+def find_topdir():
+    return os.path.realpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description=__doc__)
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="number of replays to run at once")
+    parser.add_argument("--replay", default=os.path.join(find_topdir(), "build", "sitl", "tool", "Replay"),
+                        help="Replay binary")
+    parser.add_argument("--split-ekf", action='store_true', help="replay EKF2 and EKF3 as separate concurrent lanes")
+    parser.add_argument("--out-dir", default="replay_batch", help="directory to hold Replay output")
+    parser.add_argument("--parm", action='append', default=[], help="parameter NAME=VALUE passed to Replay")
+    parser.add_argument("--accuracy", type=float, default=0.0, help="accuracy percentage for match")
+    parser.add_argument("--ignore-field", action='append', default=[], help="ignore message field when comparing")
+    parser.add_argument("logs", metavar="LOG", nargs="+")
+    args = parser.parse_args()
+
+    replay_args = []
+    for p in args.parm:
+        replay_args.extend(["--parm", p])
+
+    lanes = ["ekf2", "ekf3"] if args.split_ekf else ["both"]
+    out_dir = os.path.abspath(args.out_dir)
+    jobs = []
+    for i, logfile in enumerate(args.logs):
+        for lane in lanes:
+            workdir = os.path.join(out_dir, "%03u-%s-%s" % (i, os.path.basename(logfile), lane))
+            jobs.append(ReplayJob(os.path.abspath(logfile), lane, workdir))
+
+    start = time.time()
+    with ProcessPoolExecutor(max_workers=args.jobs) as executor:
+        futures = [executor.submit(run_job, job, os.path.abspath(args.replay), replay_args,
+                                   args.accuracy, set(args.ignore_field)) for job in jobs]
+        jobs = []
+        for future in futures:
+            job = future.result()
+            print("%s %s %s (%.1fs)" % ("PASSED" if job.passed else "FAILED",
+                                        os.path.basename(job.logfile), job.lane, job.replay_time))
+            sys.stdout.flush()
+            jobs.append(job)
+    print_summary(jobs, time.time() - start)
+
+    if any([not j.passed for j in jobs]):
+        sys.exit(1)
+    sys.exit(0)
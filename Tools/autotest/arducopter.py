@@ -762,7 +762,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.set_heartbeat_rate(0)
         self.wait_mode("SMART_RTL")
         self.wait_disarmed()
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
 
         self.takeoffAndMoveAway()
@@ -778,7 +778,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
                 raise NotAchievedException("Not in SMART_RTL")
         self.install_message_hook_context(ensure_smartrtl)
 
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.set_heartbeat_rate(0)
         self.wait_statustext("GCS Failsafe")
@@ -786,7 +786,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.wait_disarmed()
 
         self.end_subtest("GCS failsafe SmartRTL twice")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.context_pop()
 
@@ -797,7 +797,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.set_heartbeat_rate(0)
         self.delay_sim_time(5)
         self.wait_mode("ALT_HOLD")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.delay_sim_time(5)
         self.wait_mode("ALT_HOLD")
         self.end_subtest("Completed GCS failsafe disabled test")
@@ -810,7 +810,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.set_parameter('FS_OPTIONS', 0)
         self.set_heartbeat_rate(0)
         self.wait_mode("RTL")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.change_mode("LOITER")
         self.end_subtest("Completed GCS failsafe recovery test")
@@ -828,7 +828,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.delay_sim_time(old_gcs_timeout + (new_gcs_timeout - old_gcs_timeout) / 2)
         self.assert_mode("LOITER")
         self.wait_mode("RTL")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.change_mode("LOITER")
         self.set_parameter('FS_GCS_TIMEOUT', old_gcs_timeout)
@@ -841,7 +841,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.set_heartbeat_rate(0)
         self.wait_mode("RTL")
         self.wait_rtl_complete()
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.end_subtest("Completed GCS failsafe RTL with no options test")
 
@@ -852,7 +852,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.set_heartbeat_rate(0)
         self.wait_mode("LAND")
         self.wait_landed_and_disarmed()
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.end_subtest("Completed GCS failsafe land with no options test")
 
@@ -863,7 +863,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.set_heartbeat_rate(0)
         self.wait_mode("SMART_RTL")
         self.wait_disarmed()
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.end_subtest("Completed GCS failsafe SmartRTL->RTL with no options test")
 
@@ -874,7 +874,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.set_heartbeat_rate(0)
         self.wait_mode("SMART_RTL")
         self.wait_disarmed()
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.end_subtest("Completed GCS failsafe SmartRTL->Land with no options test")
 
@@ -885,7 +885,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.set_heartbeat_rate(0)
         self.wait_mode("RTL")
         self.wait_rtl_complete()
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.end_subtest("Completed GCS failsafe invalid value with no options test")
 
@@ -902,7 +902,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.wait_statustext("GCS Failsafe - Continuing Pilot Control", timeout=60)
         self.delay_sim_time(5)
         self.wait_mode("ALT_HOLD")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
 
         self.progress("Testing continue in auto mission")
@@ -913,7 +913,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.wait_statustext("GCS Failsafe - Continuing Auto Mode", timeout=60)
         self.delay_sim_time(5)
         self.wait_mode("AUTO")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
 
         self.progress("Testing continue landing in land mode")
@@ -925,7 +925,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         self.delay_sim_time(5)
         self.wait_mode("LAND")
         self.wait_landed_and_disarmed()
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.end_subtest("Completed GCS failsafe with option bits")
 
@@ -3041,6 +3041,50 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
         if max_SH_core0 < 0.9:
             raise NotAchievedException("BARO glitch did not raise SH in core 0")
 
+    def EK3ParallelCores(self):
+        '''Fly with the EKF3 cores updated in parallel on worker threads'''
+        self.set_parameters({
+            "EK3_ENABLE": 1,
+            "AHRS_EKF_TYPE": 3,
+            "EK3_IMU_MASK": 3,      # two cores
+            "EK3_OPTIONS": 4,       # ParallelCores
+        })
+        self.reboot_sitl()
+        self.context_collect("STATUSTEXT")
+
+        self.wait_ready_to_arm()
+        self.takeoff(10, mode='LOITER')
+        self.progress("Flying forward")
+        self.set_rc(2, 1300)
+        self.delay_sim_time(10)
+        self.set_rc(2, 1500)
+        self.delay_sim_time(5)
+        self.do_RTL()
+
+        if self.statustext_in_collections("EKF3 parallel cores unavailable"):
+            raise NotAchievedException("Cores were not run in parallel")
+
+        # both lanes must have tracked the flight
+        dfreader = self.dfreader_for_current_onboard_log()
+        last_pos = {}
+        max_diff = 0
+        count = 0
+        while True:
+            m = dfreader.recv_match(type="XKF1")
+            if m is None:
+                break
+            last_pos[m.C] = (m.TimeUS, m.PN, m.PE, m.PD)
+            if m.C != 1 or 0 not in last_pos or m.TimeUS - last_pos[0][0] > 50000:
+                continue
+            diff = math.sqrt(sum([(p0-p1)**2 for (p0, p1) in zip(last_pos[0][1:], last_pos[1][1:])]))
+            max_diff = max(max_diff, diff)
+            count += 1
+        self.progress("Lanes compared %u times, max position difference %.2fm" % (count, max_diff))
+        if count == 0:
+            raise NotAchievedException("No XKF1 messages for the second core")
+        if max_diff > 2:
+            raise NotAchievedException("Lanes differ by %.2fm" % max_diff)
+
     def AutoTuneSwitch(self):
         """Test autotune on a switch with gains being saved"""
 
@@ -10949,11 +10993,59 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
             ('GPS', self.test_replay_gps_bit),
             ('Beacon', self.test_replay_beacon_bit),
             ('OpticalFlow', self.test_replay_optical_flow_bit),
+            ('IMUFailover', self.test_replay_imu_failover_bit),
         ]
         for (name, func) in bits:
             self.start_subtest("%s" % name)
             self.test_replay_bit(func)
 
+    def test_replay_imu_failover_bit(self):
+        '''fail the second IMU in flight so two EKF3 cores share the
+        first IMU's data, then reset the EKFs on the ground'''
+        self.set_parameters({
+            "LOG_REPLAY": 1,
+            "LOG_DISARMED": 1,
+            "EK3_ENABLE": 1,
+            "EK2_ENABLE": 1,
+            "EK3_IMU_MASK": 3,
+        })
+        self.reboot_sitl()
+
+        self.wait_sensor_state(mavutil.mavlink.MAV_SYS_STATUS_LOGGING, True, True, True)
+
+        current_log_filepath = self.current_onboard_log_filepath()
+        self.progress("Current log path: %s" % str(current_log_filepath))
+
+        self.change_mode("LOITER")
+        self.wait_ready_to_arm(require_absolute=True)
+        self.arm_vehicle()
+        self.takeoffAndMoveAway()
+
+        self.progress("Failing second IMU")
+        self.set_parameters({
+            "SIM_ACC_FAIL_MSK": 2,
+            "SIM_GYR_FAIL_MSK": 2,
+        })
+        self.delay_sim_time(10)
+        self.set_parameters({
+            "SIM_ACC_FAIL_MSK": 0,
+            "SIM_GYR_FAIL_MSK": 0,
+        })
+        self.do_RTL()
+
+        # a simple accel calibration resets the AHRS and so the EKFs
+        self.progress("Resetting EKFs")
+        self.run_cmd(
+            mavutil.mavlink.MAV_CMD_PREFLIGHT_CALIBRATION,
+            p5=4,
+            timeout=5,
+        )
+        self.delay_sim_time(10)
+
+        self.reboot_sitl()
+
+        return current_log_filepath
+
     def test_replay_bit(self, bit):
 
         self.context_push()
@@ -14560,6 +14652,7 @@ RTL_ALT 111
             self.PLDNoParameters,
             self.PeriphMultiUARTTunnel,
             self.EKF3SRCPerCore,
+            self.EK3ParallelCores,
         ])
         return ret
 
@@ -1357,7 +1357,7 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
         self.progress("Disconnecting GCS")
         self.set_heartbeat_rate(0)
         self.wait_mode("RTL", timeout=10)
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.end_subtest("Completed RTL Failsafe test")
 
         self.start_subtest("Test Failsafe: FBWA Glide")
@@ -1368,7 +1368,7 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
         self.progress("Disconnecting GCS")
         self.set_heartbeat_rate(0)
         self.wait_mode("FBWA", timeout=10)
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.end_subtest("Completed FBWA Failsafe test")
 
         self.start_subtest("Test Failsafe: Deploy Parachute")
@@ -1386,7 +1386,7 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
         self.progress("Disconnecting GCS")
         self.set_heartbeat_rate(0)
         self.wait_statustext("BANG", timeout=60)
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.disarm_vehicle(force=True)
         self.reboot_sitl()
         self.end_subtest("Completed Parachute Failsafe test")
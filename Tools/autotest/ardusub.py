@@ -247,7 +247,7 @@ class AutoTestSub(vehicle_test_suite.TestSuite):
         self.setGCSfailsafe(4)
         self.set_heartbeat_rate(0)
         self.wait_mode("SURFACE")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.progress("GSC Failsafe OK")
         self.disarm_vehicle()
@@ -1248,7 +1248,7 @@ class AutoTestSub(vehicle_test_suite.TestSuite):
         self.progress("Surface mode engaged")
         self.wait_altitude(altitude_min=-1, altitude_max=0, relative=False, timeout=60)
         self.progress("Vehicle resurfaced")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.progress("Baro-less Surface mode OK")
         self.disarm_vehicle()
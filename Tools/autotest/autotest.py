@@ -485,9 +485,8 @@ def run_step(step):
                 instance_num = int(a[2])
                 param_file = a[3].split(",")
                 bin_path = util.reltopdir(os.path.join('build', config_name, 'bin', binary_name))
-                customisation = '-I {}'.format(instance_num)
                 sup_binary = {"binary" : bin_path,
-                              "customisation" : customisation,
+                              "instance" : instance_num,
                               "param_file" : param_file}
                 supplementary_binaries.append(sup_binary)
             # we are running in conjunction with a supplementary app
@@ -516,6 +515,7 @@ def run_step(step):
         "build_opts": copy.copy(build_opts),
         "generate_junit": opts.junit,
         "enable_fgview": opts.enable_fgview,
+        "sitl_instance": opts.sitl_instance,
     }
     if opts.speedup is not None:
         fly_opts["speedup"] = opts.speedup
@@ -968,6 +968,10 @@ if __name__ == "__main__":
                          default=None,
                          type='int',
                          help='speedup to run the simulations at')
+    group_sim.add_option("--sitl-instance",
+                         default=0,
+                         type='int',
+                         help='SITL instance number; network ports are offset by 10 per instance')
     group_sim.add_option("--valgrind",
                          default=False,
                          action='store_true',
@@ -1763,7 +1763,7 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
         self.set_heartbeat_rate(0)
         self.delay_sim_time(5)
         self.wait_mode("MANUAL")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.delay_sim_time(5)
         self.wait_mode("MANUAL")
         self.end_subtest("Completed GCS failsafe disabled test")
@@ -1776,7 +1776,7 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
         # self.setGCSfailsafe(1)
         # self.set_heartbeat_rate(0)
         # self.wait_mode("RTL")
-        # self.set_heartbeat_rate(self.speedup)
+        # self.set_heartbeat_rate(self.nominal_speedup())
         # self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         # self.change_mode("MANUAL")
         # self.end_subtest("Completed GCS failsafe recovery test")
@@ -1787,7 +1787,7 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
         self.set_heartbeat_rate(0)
         self.wait_mode("RTL")
         self.wait_statustext("Reached destination", timeout=60)
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.end_subtest("Completed GCS failsafe RTL")
 
@@ -1798,7 +1798,7 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
         self.set_heartbeat_rate(0)
         self.wait_mode("RTL")
         self.wait_statustext("Reached destination", timeout=60)
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.end_subtest("Completed GCS failsafe invalid value")
 
@@ -1812,7 +1812,7 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
         self.wait_statustext("Failsafe - Continuing Auto Mode", timeout=60)
         self.delay_sim_time(5)
         self.wait_mode("AUTO")
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
 
         self.start_subtest("GCS failsafe RTL with no options test: FS_GCS_ENABLE=1 and FS_GCS_TIMEOUT=10")
@@ -1826,7 +1826,7 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
         self.assert_mode("MANUAL")
         self.wait_mode("RTL")
         self.wait_statustext("Reached destination", timeout=60)
-        self.set_heartbeat_rate(self.speedup)
+        self.set_heartbeat_rate(self.nominal_speedup())
         self.wait_statustext("GCS Failsafe Cleared", timeout=60)
         self.disarm_vehicle()
         self.end_subtest("Completed GCS failsafe RTL")
@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+
+'''
+Run many autotest subtests in parallel, one SITL instance per worker
+
+Each worker runs autotest.py for one subtest at a time with its own
+SITL instance number (so network ports do not clash), its own working
+directory (eeprom, logs and terrain) and its own BUILDLOGS directory.
+Binaries must already be built, e.g. with "autotest.py build.Copter".
+
+Some tests can't share the host with other SITL instances. SITL's CAN
+multicast groups (one per bus), the ports AP_Periph uses and the
+"mcast:" serial device are the same for every instance. Tests using
+them (see EXCLUSIVE_TESTS) run one at a time after the other tests.
+
+e.g. ./Tools/autotest/sitl_farm.py -j 32 --speedup 100 Copter Plane.AUTOTUNE
+
+AP_FLAKE8_CLEAN
+'''
+
+import optparse
+import os
+import queue
+import re
+import subprocess
+import sys
+import threading
+import time
+
+from concurrent.futures import ThreadPoolExecutor
+
+# tests which must not run alongside other SITL instances; the CAN and
+# BattCAN vehicles run AP_Periph supplementary binaries over CAN
+EXCLUSIVE_TESTS = [
+    re.compile(r"^(CAN|BattCAN)\."),
+    re.compile(r"^Copter\.PeriphMultiUARTTunnel$"),
+]
+
+
+class FarmResult(object):
+    def __init__(self, test, passed, duration, message, logfile, achieved_speedup):
+        self.test = test
+        self.passed = passed
+        self.duration = duration
+        self.message = message
+        self.logfile = logfile
+        self.achieved_speedup = achieved_speedup
+
+
+class SITLFarm(object):
+    def __init__(self,
+                 jobs=None,
+                 speedup=None,
+                 timeout=1800,
+                 farm_dir="sitl_farm",
+                 first_instance=0,
+                 extra_args=[]):
+        if jobs is None:
+            jobs = os.cpu_count()
+        self.jobs = jobs
+        self.speedup = speedup
+        self.timeout = timeout
+        self.farm_dir = os.path.abspath(farm_dir)
+        self.first_instance = first_instance
+        self.extra_args = extra_args
+        self.autotest = os.path.join(os.path.dirname(os.path.abspath(__file__)), "autotest.py")
+        self.print_lock = threading.Lock()
+
+    def progress(self, message):
+        with self.print_lock:
+            print("FARM: %s" % (message,))
+            sys.stdout.flush()
+
+    def subtests_for_vehicle(self, vehicle):
+        '''return names of all subtests for a vehicle, e.g. Copter'''
+        output = subprocess.check_output(
+            [self.autotest, "--list-subtests-for-vehicle", vehicle],
+            universal_newlines=True,
+        )
+        return output.split()
+
+    def expand_tests(self, names):
+        '''expand vehicle names into their subtests; Copter.Name is a single subtest'''
+        tests = []
+        for name in names:
+            if name.startswith("test."):
+                name = name[len("test."):]
+            if "." in name:
+                tests.append(name)
+                continue
+            for subtest in self.subtests_for_vehicle(name):
+                tests.append("%s.%s" % (name, subtest))
+        return tests
+
+    def is_exclusive(self, test):
+        '''true if test must not run alongside other SITL instances'''
+        return any([pattern.match(test) is not None for pattern in EXCLUSIVE_TESTS])
+
+    def run_test(self, test, instances):
+        '''run one subtest on a free SITL instance'''
+        instance = instances.get()
+        try:
+            return self.run_test_on_instance(test, instance)
+        finally:
+            instances.put(instance)
+
+    def run_test_on_instance(self, test, instance):
+        workdir = os.path.join(self.farm_dir, "instance%u" % instance)
+        buildlogs = os.path.join(workdir, "buildlogs")
+        os.makedirs(buildlogs, exist_ok=True)
+        logfile = os.path.join(self.farm_dir, "%s.txt" % test)
+
+        env = dict(os.environ)
+        env["BUILDLOGS"] = buildlogs
+        cmd = [
+            self.autotest,
+            "--sitl-instance", str(instance),
+            "--show-test-timings",
+        ]
+        if self.speedup is not None:
+            cmd.extend(["--speedup", str(self.speedup)])
+        cmd.extend(self.extra_args)
+        cmd.append("test.%s" % test)
+
+        start = time.time()
+        message = ""
+        with open(logfile, "w") as f:
+            try:
+                p = subprocess.run(cmd,
+                                   cwd=workdir,
+                                   env=env,
+                                   stdin=subprocess.DEVNULL,
+                                   stdout=f,
+                                   stderr=subprocess.STDOUT,
+                                   timeout=self.timeout)
+                passed = p.returncode == 0
+                if not passed:
+                    message = "exit code %d" % p.returncode
+            except subprocess.TimeoutExpired:
+                passed = False
+                message = "timed out after %us" % self.timeout
+        result = FarmResult(test, passed, time.time() - start, message, logfile,
+                            self.achieved_speedup(logfile))
+        self.progress("%s %s (%.1fs instance %u)" %
+                      ("PASSED" if passed else "FAILED", test, result.duration, instance))
+        return result
+
+    def achieved_speedup(self, logfile):
+        '''simulated time over wall time reported by autotest, None if not reported'''
+        with open(logfile) as f:
+            for line in f:
+                match = re.match(r".*tests_achieved_speedup--\*\*: ([0-9.]+)", line)
+                if match is not None:
+                    return float(match.group(1))
+        return None
+
+    def run(self, names):
+        tests = self.expand_tests(names)
+        if len(tests) == 0:
+            self.progress("No tests to run")
+            return False
+        shared = [test for test in tests if not self.is_exclusive(test)]
+        exclusive = [test for test in tests if self.is_exclusive(test)]
+        jobs = max(min(self.jobs, len(shared)), 1)
+        self.progress("Running %u tests on %u instances, then %u tests one at a time" %
+                      (len(shared), jobs, len(exclusive)))
+
+        os.makedirs(self.farm_dir, exist_ok=True)
+
+        instances = queue.Queue()
+        for i in range(jobs):
+            instances.put(self.first_instance + i)
+
+        start = time.time()
+        results = []
+        if len(shared) > 0:
+            with ThreadPoolExecutor(max_workers=jobs) as executor:
+                futures = [executor.submit(self.run_test, test, instances) for test in shared]
+                results = [future.result() for future in futures]
+        for test in exclusive:
+            results.append(self.run_test(test, instances))
+        wall_time = time.time() - start
+
+        self.print_summary(results, wall_time)
+        return all([r.passed for r in results])
+
+    def print_summary(self, results, wall_time):
+        test_time = sum([r.duration for r in results])
+        print("")
+        print("%-50s %8s %8s %s" % ("Test", "Time(s)", "Speedup", "Result"))
+        for r in sorted(results, key=lambda r: r.duration, reverse=True):
+            result = "PASSED" if r.passed else "FAILED %s (%s)" % (r.message, r.logfile)
+            speedup = "-" if r.achieved_speedup is None else "%.1f" % r.achieved_speedup
+            print("%-50s %8.1f %8s %s" % (r.test, r.duration, speedup, result))
+        failed = [r for r in results if not r.passed]
+        print("")
+        print("%u tests: %u passed, %u failed" % (len(results), len(results) - len(failed), len(failed)))
+        print("Wall time %.1fs, total test time %.1fs, parallel speedup %.1fx, %.1f tests/hour" %
+              (wall_time, test_time, test_time / max(wall_time, 0.001), len(results) * 3600.0 / max(wall_time, 0.001)))
+
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser(
+        "sitl_farm.py [options] VEHICLE|VEHICLE.SUBTEST...",
+        epilog=""
+        "e.g. ./Tools/autotest/sitl_farm.py -j 32 --speedup 100 Copter Plane.AUTOTUNE"
+    )
+    parser.add_option("-j", "--jobs",
+                      type=int,
+                      default=None,
+                      help='number of SITL instances to run at once (default: number of CPUs)')
+    parser.add_option("--speedup",
+                      type=int,
+                      default=None,
+                      help='speedup to run the simulations at, 0 to run as fast as possible '
+                      '(default: autotest default per vehicle)')
+    parser.add_option("--timeout",
+                      type=int,
+                      default=1800,
+                      help='seconds to allow each subtest before it is counted as failed')
+    parser.add_option("--farm-dir",
+                      type='string',
+                      default="sitl_farm",
+                      help='directory to hold per-instance working directories and test output')
+    parser.add_option("--first-instance",
+                      type=int,
+                      default=0,
+                      help='first SITL instance number to use')
+    parser.add_option("--debug",
+                      action='store_true',
+                      default=False,
+                      help='use debug binaries')
+
+    opts, args = parser.parse_args()
+    if len(args) == 0:
+        parser.error("no tests given")
+
+    extra_args = []
+    if opts.debug:
+        extra_args.append("--debug")
+
+    farm = SITLFarm(
+        jobs=opts.jobs,
+        speedup=opts.speedup,
+        timeout=opts.timeout,
+        farm_dir=opts.farm_dir,
+        first_instance=opts.first_instance,
+        extra_args=extra_args,
+    )
+    sys.exit(0 if farm.run(args) else 1)
@@ -1936,6 +1936,7 @@ class TestSuite(ABC):
                  dronecan_tests=False,
                  generate_junit=False,
                  enable_fgview=False,
+                 sitl_instance=0,
                  build_opts={}):
 
         self.start_time = time.time()
@@ -1963,6 +1964,7 @@ class TestSuite(ABC):
         self.ubsan = ubsan
         self.ubsan_abort = ubsan_abort
         self.build_opts = build_opts
+        self.sitl_instance = sitl_instance
         self.num_aux_imus = num_aux_imus
         self.generate_junit = generate_junit
         if generate_junit:
@@ -1989,6 +1991,7 @@ class TestSuite(ABC):
         self.run_tests_called = False
         self._show_test_timings = _show_test_timings
         self.test_timings = dict()
+        self.test_sim_timings = dict()
         self.total_waiting_to_arm_time = 0
         self.waiting_to_arm_count = 0
         self.force_ahrs_type = force_ahrs_type
@@ -2039,6 +2042,14 @@ class TestSuite(ABC):
     def default_speedup(self):
         return 8
 
+    def nominal_speedup(self):
+        '''speedup to scale wall clock rates and timeouts by.  A free
+        running simulation (speedup 0) has no fixed speedup, so is
+        treated as a large one'''
+        if self.speedup == 0:
+            return 100
+        return self.speedup
+
     def progress(self, text, send_statustext=True):
         """Display autotest progress text."""
         delta_time = time.time() - self.start_time
@@ -2100,13 +2111,14 @@ class TestSuite(ABC):
 
     def adjust_ardupilot_port(self, port):
         '''adjust port in case we do not wish to use the default range (5760 and 5501 etc)'''
-        return port
+        # SITL offsets its ports by 10 for each instance number
+        return port + 10 * self.sitl_instance
 
     def spare_network_port(self, offset=0):
         '''returns a network port which should be able to be bound'''
         if offset > 2:
             raise ValueError("offset too large")
-        return 8000 + offset
+        return self.adjust_ardupilot_port(8000 + offset)
 
     def autotest_connection_string_to_ardupilot(self):
         return "tcp:127.0.0.1:%u" % self.adjust_ardupilot_port(5760)
@@ -2114,7 +2126,7 @@ class TestSuite(ABC):
     def sitl_rcin_port(self, offset=0):
         if offset > 2:
             raise ValueError("offset too large")
-        return 5501 + offset
+        return self.adjust_ardupilot_port(5501 + offset)
 
     def mavproxy_options(self):
         """Returns options to be passed to MAVProxy."""
@@ -3534,6 +3546,24 @@ class TestSuite(ABC):
         def __init__(self, suite, **kwargs):
             super(TestSuite.ValidateAHRS3AgainstSimState, self).__init__(suite, 'AHRS3', **kwargs)
 
+    class SimTimeAccumulator(MessageHook):
+        '''adds up simulation time seen in SYSTEM_TIME messages, including
+        across reboots, so achieved speedup can be reported'''
+        def __init__(self, suite):
+            super(TestSuite.SimTimeAccumulator, self).__init__(suite)
+            self.sim_time = 0
+            self.last_time_boot_ms = None
+
+        def process(self, mav, m):
+            if m.get_type() != 'SYSTEM_TIME':
+                return
+            if self.last_time_boot_ms is not None and m.time_boot_ms > self.last_time_boot_ms:
+                self.sim_time += (m.time_boot_ms - self.last_time_boot_ms) * 0.001
+            self.last_time_boot_ms = m.time_boot_ms
+
+        def hook_removed(self):
+            pass
+
     def message_hook(self, mav, msg):
         """Called as each mavlink msg is received."""
 #        print("msg: %s" % str(msg))
@@ -4867,6 +4897,8 @@ class TestSuite(ABC):
 
     def TestLogDownloadMAVProxyNetwork(self, upload_logs=False):
         """Download latest log over network port"""
+        # ports 16001 to 16006, offset for our SITL instance
+        port = self.adjust_ardupilot_port(16000)
         self.context_push()
         self.set_parameters({
             "NET_ENABLE": 1,
@@ -4875,7 +4907,7 @@ class TestSuite(ABC):
             # UDP client
             "NET_P1_TYPE": 1,
             "NET_P1_PROTOCOL": 2,
-            "NET_P1_PORT": 16001,
+            "NET_P1_PORT": port + 1,
             "NET_P1_IP0": 127,
             "NET_P1_IP1": 0,
             "NET_P1_IP2": 0,
@@ -4883,7 +4915,7 @@ class TestSuite(ABC):
             # UDP server
             "NET_P2_TYPE": 2,
             "NET_P2_PROTOCOL": 2,
-            "NET_P2_PORT": 16002,
+            "NET_P2_PORT": port + 2,
             "NET_P2_IP0": 0,
             "NET_P2_IP1": 0,
             "NET_P2_IP2": 0,
@@ -4891,7 +4923,7 @@ class TestSuite(ABC):
             # TCP client
             "NET_P3_TYPE": 3,
             "NET_P3_PROTOCOL": 2,
-            "NET_P3_PORT": 16003,
+            "NET_P3_PORT": port + 3,
             "NET_P3_IP0": 127,
             "NET_P3_IP1": 0,
             "NET_P3_IP2": 0,
@@ -4899,7 +4931,7 @@ class TestSuite(ABC):
             # TCP server
             "NET_P4_TYPE": 4,
             "NET_P4_PROTOCOL": 2,
-            "NET_P4_PORT": 16004,
+            "NET_P4_PORT": port + 4,
             "NET_P4_IP0": 0,
             "NET_P4_IP1": 0,
             "NET_P4_IP2": 0,
@@ -4920,10 +4952,10 @@ class TestSuite(ABC):
 
         self.set_parameter('SIM_SPEEDUP', 1)
 
-        endpoints = [('UDPClient', ':16001') ,
-                     ('UDPServer', 'udpout:127.0.0.1:16002'),
-                     ('TCPClient', 'tcpin:0.0.0.0:16003'),
-                     ('TCPServer', 'tcp:127.0.0.1:16004')]
+        endpoints = [('UDPClient', ':%u' % (port + 1)) ,
+                     ('UDPServer', 'udpout:127.0.0.1:%u' % (port + 2)),
+                     ('TCPClient', 'tcpin:0.0.0.0:%u' % (port + 3)),
+                     ('TCPServer', 'tcp:127.0.0.1:%u' % (port + 4))]
         for name, e in endpoints:
             self.progress("Downloading log with %s %s" % (name, e))
             filename = "MAVProxy-downloaded-net-log-%s.BIN" % name
@@ -4945,7 +4977,7 @@ class TestSuite(ABC):
             # multicast UDP client
             "NET_P1_TYPE": 1,
             "NET_P1_PROTOCOL": 2,
-            "NET_P1_PORT": 16005,
+            "NET_P1_PORT": port + 5,
             "NET_P1_IP0": 239,
             "NET_P1_IP1": 255,
             "NET_P1_IP2": 145,
@@ -4953,7 +4985,7 @@ class TestSuite(ABC):
             # Broadcast UDP client
             "NET_P2_TYPE": 1,
             "NET_P2_PROTOCOL": 2,
-            "NET_P2_PORT": 16006,
+            "NET_P2_PORT": port + 6,
             "NET_P2_IP0": 255,
             "NET_P2_IP1": 255,
             "NET_P2_IP2": 255,
@@ -4966,8 +4998,8 @@ class TestSuite(ABC):
 
         self.set_parameter('SIM_SPEEDUP', 1)
 
-        endpoints = [('UDPMulticast', 'mcast:16005') ,
-                     ('UDPBroadcast', ':16006')]
+        endpoints = [('UDPMulticast', 'mcast:%u' % (port + 5)) ,
+                     ('UDPBroadcast', ':%u' % (port + 6))]
         for name, e in endpoints:
             self.progress("Downloading log with %s %s" % (name, e))
             filename = "MAVProxy-downloaded-net-log-%s.BIN" % name
@@ -5787,7 +5819,7 @@ class TestSuite(ABC):
             # autopilot will see ~2Hz.
             timeout = 0.02
             # ... and 2Hz is too slow when we now run at 100x speedup:
-            timeout /= (self.speedup / 10.0)
+            timeout /= (self.nominal_speedup() / 10.0)
 
             try:
                 map_copy = self.rc_queue.get(timeout=timeout)
@@ -8882,12 +8914,17 @@ Also, ignores heartbeats not from our target system'''
             if len(desc) > longest:
                 longest = len(desc)
         tests_total_time = 0
+        tests_total_sim_time = 0
         for desc, test_time in sorted(self.test_timings.items(),
                                       key=self.show_test_timings_key_sorter):
             fmt = "%" + str(longest) + "s: %.2fs"
             tests_total_time += test_time
-            self.progress(fmt % (desc, test_time))
+            sim_time = self.test_sim_timings.get(desc, 0)
+            tests_total_sim_time += sim_time
+            self.progress((fmt + " (achieved speedup %.1f)") % (desc, test_time, sim_time / max(test_time, 0.001)))
         self.progress(fmt % ("**--tests_total_time--**", tests_total_time))
+        self.progress("**--tests_achieved_speedup--**: %.2f" %
+                      (tests_total_sim_time / max(tests_total_time, 0.001),))
         self.progress("mavproxy_start was called %u times" %
                       (self.start_mavproxy_count,))
         self.progress("Supplied terrain data to autopilot in %u messages" %
@@ -9026,6 +9063,8 @@ Also, ignores heartbeats not from our target system'''
 
         tee = TeeBoth(test_output_filename, 'w', self.mavproxy_logfile, suppress_stdout=suppress_stdout)
 
+        sim_time_hook = TestSuite.SimTimeAccumulator(self)
+        self.install_message_hook(sim_time_hook)
         start_message_hooks = copy.copy(self.message_hooks)
 
         prettyname = "%s (%s)" % (name, desc)
@@ -9065,6 +9104,8 @@ Also, ignores heartbeats not from our target system'''
                     self.message_hooks.remove(h)
             hooks_removed = True
         self.test_timings[desc] = time.time() - start_time
+        self.test_sim_timings[desc] = sim_time_hook.sim_time
+        self.remove_message_hook(sim_time_hook)
         reset_needed = self.contexts[-1].sitl_commandline_customised
 
         if orig_speedup is not None:
@@ -9261,6 +9302,9 @@ Also, ignores heartbeats not from our target system'''
             "enable_fgview": self.enable_fgview,
         }
         start_sitl_args.update(**sitl_args)
+        if self.sitl_instance != 0:
+            start_sitl_args["customisations"] = (["-I%u" % self.sitl_instance] +
+                                                 start_sitl_args.get("customisations", []))
         if ("defaults_filepath" not in start_sitl_args or
                 start_sitl_args["defaults_filepath"] is None):
             start_sitl_args["defaults_filepath"] = self.defaults_filepath()
@@ -9276,7 +9320,7 @@ Also, ignores heartbeats not from our target system'''
         count = 0
         for sup_binary in self.sup_binaries:
             self.progress("Starting Supplementary Program ", sup_binary)
-            start_sitl_args["customisations"] = [sup_binary['customisation']]
+            start_sitl_args["customisations"] = [self.sup_binary_customisation(sup_binary)]
             start_sitl_args["supplementary"] = True
             start_sitl_args["stdout_prefix"] = "%s-%u" % (os.path.basename(sup_binary['binary']), count)
             start_sitl_args["defaults_filepath"] = sup_binary['param_file']
@@ -9290,6 +9334,10 @@ Also, ignores heartbeats not from our target system'''
         if self.mav is not None:
             self.mav.reconnect()
 
+    def sup_binary_customisation(self, sup_binary):
+        '''instance option for a supplementary binary, offset by our own SITL instance'''
+        return "-I%u" % (sup_binary['instance'] + self.sitl_instance)
+
     def get_supplementary_programs(self):
         return self.sup_prog
 
@@ -9327,9 +9375,9 @@ Also, ignores heartbeats not from our target system'''
             if instance is not None and instance != i:
                 continue
             sup_binary = self.sup_binaries[i]
-            start_sitl_args["customisations"] = [sup_binary['customisation']]
+            start_sitl_args["customisations"] = [self.sup_binary_customisation(sup_binary)]
             if args is not None:
-                start_sitl_args["customisations"] = [sup_binary['customisation'], args]
+                start_sitl_args["customisations"].append(args)
             start_sitl_args["supplementary"] = True
             start_sitl_args["defaults_filepath"] = sup_binary['param_file']
             sup_prog_link = util.start_SITL(sup_binary['binary'], **start_sitl_args)
@@ -9509,7 +9557,7 @@ Also, ignores heartbeats not from our target system'''
         remaining_to_receive = set(range(0, m.count))
         next_to_request = 0
         timeout = m.count
-        timeout *= self.speedup / 10.0
+        timeout *= self.nominal_speedup() / 10.0
         timeout += 10
         while True:
             delta_t = self.get_sim_time_cached() - tstart
@@ -9847,7 +9895,7 @@ Also, ignores heartbeats not from our target system'''
         '''Test Fixed Yaw Calibration"'''
 
         timeout /= 8
-        timeout *= self.speedup
+        timeout *= self.nominal_speedup()
 
         def reset_pos_and_start_magcal(mavproxy, tmask):
             mavproxy.send("sitl_stop\n")
@@ -13391,7 +13439,7 @@ switch value'''
 
         received_frsky_texts = []
         last_len_received_statustexts = 0
-        timeout = 7 * self.speedup # it can take a *long* time to get these messages down!
+        timeout = 7 * self.nominal_speedup() # it can take a *long* time to get these messages down!
         while True:
             self.drain_mav()
             now = self.get_sim_time_cached()
@@ -13515,7 +13563,7 @@ switch value'''
         '''read bytes from frsky mavlite stream, trying to form up a mavlite
         message'''
         tstart = self.get_sim_time()
-        timeout = 30 * self.speedup/10.0
+        timeout = 30 * self.nominal_speedup()/10.0
         if self.valgrind or self.callgrind:
             timeout *= 10
         while True:
@@ -13534,7 +13582,7 @@ switch value'''
         tstart = self.get_sim_time()
         while True:
             tnow = self.get_sim_time_cached()
-            if tnow - tstart > 30 * self.speedup / 10.0:
+            if tnow - tstart > 30 * self.nominal_speedup() / 10.0:
                 raise NotAchievedException("Did not get parameter via mavlite")
             message = self.read_message_via_mavlite(frsky, sport_to_mavlite)
             if message.msgid != mavutil.mavlink.MAVLINK_MSG_ID_PARAM_VALUE:
@@ -14682,10 +14730,11 @@ SERIAL5_BAUD 128
     def IBus(self):
         '''test the IBus protocol'''
         self.set_parameter("SERIAL5_PROTOCOL", 49)
+        port = self.spare_network_port()
         self.customise_SITL_commandline([
-            "--serial5=tcp:6735" # serial5 spews to localhost:6735
+            "--serial5=tcp:%u" % port # serial5 spews to localhost port
         ])
-        ibus = IBus(("127.0.0.1", 6735))
+        ibus = IBus(("127.0.0.1", port))
         ibus.connect()
 
         # expected_sensors should match the list created in AP_IBus_Telem
@@ -117,7 +117,8 @@ function run_autotest() {
     if [ "$NAME" == "Examples" ]; then
         w="$w --speedup=5 --timeout=14400 --debug --no-clean"
     fi
-    Tools/autotest/autotest.py --show-test-timings --junit --waf-configure-args="$w" "$BVEHICLE" "$RVEHICLE"
+    # any further arguments are passed to autotest
+    Tools/autotest/autotest.py --show-test-timings --junit --waf-configure-args="$w" "$BVEHICLE" "$RVEHICLE" "${@:4}"
     ccache -s && ccache -z
 }
 
@@ -156,6 +157,11 @@ for t in $CI_BUILD_TARGET; do
         run_autotest "Copter" "build.Copter" "test.CopterTests2b"
         continue
     fi
+    if [ "$t" == "sitltest-copter-freerun" ]; then
+        # simulation free running rather than paced against the wall clock
+        run_autotest "Copter" "build.Copter" "test.Copter.NavDelay" "test.Copter.LoiterToAlt" "test.Copter.Landing" "test.Copter.ThrottleFailsafe" "test.Copter.GCSFailsafe" "--speedup=0"
+        continue
+    fi
     if [ "$t" == "sitltest-can" ]; then
         echo "Building SITL Periph GPS"
         $waf configure --board sitl
@@ -97,6 +97,9 @@ bool AP_OABendyRuler::update(const Location& current_loc, const Location& destin
     const float bearing_to_dest = current_loc.get_bearing_to(destination) * 0.01f;
     const float distance_to_dest = current_loc.get_distance(destination);
 
+    // rebuild fence cache if fence has been reloaded
+    _fence_cache.update();
+
     // make sure user has set a meaningful value for _lookahead
     _lookahead.set(MAX(_lookahead,1.0f));
 
@@ -445,12 +448,19 @@ float AP_OABendyRuler::calc_avoidance_margin(const Location &start, const Locati
     }
     #endif
 
-    if (calc_margin_from_inclusion_and_exclusion_polygons(start, end, latest_margin)) {
-        margin_min = MIN(margin_min, latest_margin);
-    }
+    if (_fence_cache.valid()) {
+        if (calc_margin_from_fence_cache(start, end, latest_margin)) {
+            margin_min = MIN(margin_min, latest_margin);
+        }
+    } else {
+        // fence cache could not be built so check the fence directly
+        if (calc_margin_from_inclusion_and_exclusion_polygons(start, end, latest_margin)) {
+            margin_min = MIN(margin_min, latest_margin);
+        }
 
-    if (calc_margin_from_inclusion_and_exclusion_circles(start, end, latest_margin)) {
-        margin_min = MIN(margin_min, latest_margin);
+        if (calc_margin_from_inclusion_and_exclusion_circles(start, end, latest_margin)) {
+            margin_min = MIN(margin_min, latest_margin);
+        }
     }
 
     // return smallest margin from any obstacle
@@ -675,6 +685,34 @@ bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_circles(const Loc
 #endif // AP_FENCE_ENABLED
 }
 
+// calculate minimum distance between a path and all inclusion and exclusion polygons and circles using the fence cache
+// on success returns true and updates margin
+bool AP_OABendyRuler::calc_margin_from_fence_cache(const Location &start, const Location &end, float &margin) const
+{
+#if AP_FENCE_ENABLED
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return false;
+    }
+
+    // inclusion/exclusion polygons and circles enabled along with polygon fences
+    if ((fence->get_enabled_fences() & AC_FENCE_TYPE_POLYGON) == 0) {
+        return false;
+    }
+
+    // convert start and end to offsets from EKF origin
+    Vector2f start_NE, end_NE;
+    if (!start.get_vector_xy_from_origin_NE_cm(start_NE) ||
+        !end.get_vector_xy_from_origin_NE_cm(end_NE)) {
+        return false;
+    }
+
+    return _fence_cache.calc_margin(start_NE, end_NE, fence->get_margin(), margin);
+#else
+    return false;
+#endif // AP_FENCE_ENABLED
+}
+
 // calculate minimum distance between a path and proximity sensor obstacles
 // on success returns true and updates margin
 bool AP_OABendyRuler::calc_margin_from_object_database(const Location &start, const Location &end, float &margin) const
@@ -695,25 +733,8 @@ bool AP_OABendyRuler::calc_margin_from_object_database(const Location &start, co
         return false;
     }
 
-    // check each obstacle's distance from segment
-    float smallest_margin = FLT_MAX;
-    for (uint16_t i=0; i<oaDb->database_count(); i++) {
-        const AP_OADatabase::OA_DbItem& item = oaDb->get_item(i);
-        const Vector3f point_cm = item.pos * 100.0f;
-        // margin is distance between line segment and obstacle minus obstacle's radius
-        const float m = Vector3f::closest_distance_between_line_and_point(start_NEU, end_NEU, point_cm) * 0.01f - item.radius;
-        if (m < smallest_margin) {
-            smallest_margin = m;
-        }
-    }
-
-    // return smallest margin
-    if (smallest_margin < FLT_MAX) {
-        margin = smallest_margin;
-        return true;
-    }
-
-    return false;
+    // check nearby obstacles' distance from segment
+    return oaDb->calc_margin_from_items(start_NEU * 0.01f, end_NEU * 0.01f, margin);
 }
 
 #endif  // AP_OAPATHPLANNER_BENDYRULER_ENABLED
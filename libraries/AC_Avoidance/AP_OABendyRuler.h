@@ -8,6 +8,7 @@
 #include <AP_Common/Location.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Logger/AP_Logger_config.h>
+#include "AP_OAFenceCache.h"
 
 /*
  * BendyRuler avoidance algorithm for avoiding the polygon and circular fence and dynamic objects detected by the proximity sensor
@@ -67,6 +68,10 @@ private:
     // on success returns true and updates margin
     bool calc_margin_from_inclusion_and_exclusion_circles(const Location &start, const Location &end, float &margin) const;
 
+    // calculate minimum distance between a path and all inclusion and exclusion polygons and circles using the fence cache
+    // on success returns true and updates margin
+    bool calc_margin_from_fence_cache(const Location &start, const Location &end, float &margin) const;
+
     // calculate minimum distance between a path and proximity sensor obstacles
     // on success returns true and updates margin
     bool calc_margin_from_object_database(const Location &start, const Location &end, float &margin) const;
@@ -91,6 +96,7 @@ private:
     float _current_lookahead;       // distance (in meters) ahead of the vehicle we are looking for obstacles
     float _bearing_prev;            // stored bearing in degrees 
     Location _destination_prev;     // previous destination, to check if there has been a change in destination
+    AP_OAFenceCache _fence_cache;   // copy of inclusion and exclusion polygons and circles, rebuilt when the fence is reloaded
 };
 
 #endif  // AP_OAPATHPLANNER_BENDYRULER_ENABLED
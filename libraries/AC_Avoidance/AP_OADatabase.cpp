@@ -40,6 +40,10 @@ extern const AP_HAL::HAL& hal;
     #define AP_OADATABASE_DISTANCE_FROM_HOME 3
 #endif
 
+#ifndef AP_OADATABASE_GRID_CELL_SIZE
+    #define AP_OADATABASE_GRID_CELL_SIZE 4.0f   // width in meters of the cells used to index items
+#endif
+
 const AP_Param::GroupInfo AP_OADatabase::var_info[] = {
 
     // @Param: SIZE
@@ -222,6 +226,11 @@ void AP_OADatabase::init_database()
     }
 
     _database.items = NEW_NOTHROW OA_DbItem[_database.size];
+
+    // spatial index is optional, without it all items are checked
+    if (!_database.grid.init(_database.size, AP_OADATABASE_GRID_CELL_SIZE)) {
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "DB index init failed");
+    }
 }
 
 // get bitmask of gcs channels item should be sent to based on its importance
@@ -303,17 +312,20 @@ bool AP_OADatabase::process_queue()
 
         item.send_to_gcs = get_send_to_gcs_flags(item.importance);
 
-        // compare item to all items in database. If found a similar item, update the existing, else add it as a new one
-        bool found = false;
-        for (uint16_t i=0; i<_database.count; i++) {
-            if (item_match(_database.items[i], item)) {
-                database_item_refresh(_database.items[i], item);
-                found = true;
-                break;
+        WITH_SEMAPHORE(_database.sem);
+
+        // compare item to items in database. If found a similar item, update the existing, else add it as a new one
+        uint16_t index;
+        if (database_item_find_match(item, index)) {
+            OA_DbItem &current_item = _database.items[index];
+            const Vector2f old_pos = current_item.pos.xy();
+            const float old_radius = current_item.radius;
+            database_item_refresh(current_item, item);
+            if ((old_pos != current_item.pos.xy()) || !is_equal(old_radius, current_item.radius)) {
+                _database.grid.remove(index, old_pos, old_radius);
+                _database.grid.add(index, current_item.pos.xy(), current_item.radius);
             }
-        }
-
-        if (!found) {
+        } else {
             database_item_add(item);
         }
     }
@@ -327,9 +339,84 @@ void AP_OADatabase::database_item_add(const OA_DbItem &item)
     }
     _database.items[_database.count] = item;
     _database.items[_database.count].send_to_gcs = get_send_to_gcs_flags(_database.items[_database.count].importance);
+    _database.grid.add(_database.count, item.pos.xy(), item.radius);
     _database.count++;
 }
 
+// find the lowest index item in the database which is likely the same as item
+// returns true if found and updates index
+bool AP_OADatabase::database_item_find_match(const OA_DbItem &item, uint16_t &index) const
+{
+    bool found = false;
+    index = UINT16_MAX;
+
+    if (item.source != OA_DbItem::Source::proximity) {
+        // items matched by id may be anywhere
+        for (uint16_t i=0; i<_database.count; i++) {
+            if (item_match(_database.items[i], item)) {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // matching proximity items are within the larger of the two radii. Items
+    // are indexed in every cell they cover so an item with the larger radius
+    // is found in the cell containing the other item's position
+    AP_OASpatialGrid::Query q;
+    const Vector2f pos = item.pos.xy();
+    _database.grid.begin_query(q, pos - Vector2f{item.radius, item.radius}, pos + Vector2f{item.radius, item.radius}, _database.count);
+    uint16_t i;
+    while (_database.grid.next(q, i)) {
+        if ((i < index) && item_match(_database.items[i], item)) {
+            index = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// calculate smallest margin (distance minus radius) between a line segment and the items in the database
+// start and end are offsets in meters from the EKF origin
+// returns true on success and updates margin, false if the database is empty
+bool AP_OADatabase::calc_margin_from_items(const Vector3f &start, const Vector3f &end, float &margin)
+{
+    WITH_SEMAPHORE(_database.sem);
+
+    if (!healthy() || (_database.count == 0)) {
+        return false;
+    }
+
+    // search an area around the segment which is doubled in size until it
+    // holds an item closer than the area's edge. Items outside of the area
+    // are further away because the index holds each item in every cell
+    // it covers
+    const Vector2f seg_min {MIN(start.x, end.x), MIN(start.y, end.y)};
+    const Vector2f seg_max {MAX(start.x, end.x), MAX(start.y, end.y)};
+    float smallest_margin = FLT_MAX;
+    float search_dist = AP_OADATABASE_GRID_CELL_SIZE;
+    while (true) {
+        AP_OASpatialGrid::Query q;
+        const Vector2f search_margin {search_dist, search_dist};
+        _database.grid.begin_query(q, seg_min - search_margin, seg_max + search_margin, _database.count);
+        uint16_t i;
+        while (_database.grid.next(q, i)) {
+            const OA_DbItem &item = _database.items[i];
+            // margin is distance between line segment and obstacle minus obstacle's radius
+            const float m = Vector3f::closest_distance_between_line_and_point(start, end, item.pos) - item.radius;
+            smallest_margin = MIN(smallest_margin, m);
+        }
+        if (q.all || (smallest_margin <= search_dist)) {
+            break;
+        }
+        search_dist *= 2.0f;
+    }
+
+    margin = smallest_margin;
+    return true;
+}
+
 void AP_OADatabase::database_item_remove(const uint16_t index)
 {
     if (index >= _database.count || _database.count == 0) {
@@ -337,6 +424,8 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
         return;
     }
 
+    _database.grid.remove(index, _database.items[index].pos.xy(), _database.items[index].radius);
+
     // radius of 0 tells the GCS we don't care about it any more (aka it expired)
     _database.items[index].radius = 0;
     _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
@@ -349,6 +438,7 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
     if (index != _database.count) {
         // copy last object in array over expired object
         _database.items[index] = _database.items[_database.count];
+        _database.grid.move(_database.count, index, _database.items[index].pos.xy(), _database.items[index].radius);
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
     }
 }
@@ -383,6 +473,8 @@ void AP_OADatabase::database_items_remove_all_expired()
         return;
     }
 
+    WITH_SEMAPHORE(_database.sem);
+
     const uint32_t now_ms = AP_HAL::millis();
     const uint32_t expiry_ms = (uint32_t)_database_expiry_seconds * 1000;
     uint16_t index = 0;
@@ -410,6 +502,9 @@ void AP_OADatabase::send_adsb_vehicle(mavlink_channel_t chan, uint16_t interval_
     const uint8_t chan_as_bitmask = 1 << chan;
     const char callsign[9] = "OA_DB";
 
+    // items are reordered as they expire
+    WITH_SEMAPHORE(_database.sem);
+
     // calculate how many messages we should send
     const uint32_t now_ms = AP_HAL::millis();
     uint16_t num_to_send = 1;
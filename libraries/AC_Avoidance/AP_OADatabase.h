@@ -8,6 +8,7 @@
 #include <AP_Math/AP_Math.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_Param/AP_Param.h>
+#include "AP_OASpatialGrid.h"
 
 class AP_OADatabase {
 public:
@@ -61,6 +62,11 @@ public:
     // get number of items in the database
     uint16_t database_count() const { return _database.count; }
 
+    // calculate smallest margin (distance minus radius) between a line segment and the items in the database
+    // start and end are offsets in meters from the EKF origin
+    // returns true on success and updates margin, false if the database is empty
+    bool calc_margin_from_items(const Vector3f &start, const Vector3f &end, float &margin);
+
     // empty queue and try and put into database. Return true if there's more work to do
     bool process_queue();
 
@@ -75,8 +81,9 @@ private:
     void init_queue();
     void init_database();
 
-    // database item management
+    // database item management, the database semaphore must be held
     void database_item_add(const OA_DbItem &item);
+    bool database_item_find_match(const OA_DbItem &item, uint16_t &index) const;
     void database_item_refresh(OA_DbItem &current_item, const OA_DbItem &new_item) const;
     void database_item_remove(const uint16_t index);
     void database_items_remove_all_expired();
@@ -117,6 +124,8 @@ private:
         OA_DbItem       *items;                             // array of objects in the database
         uint16_t        count;                              // number of objects in the items array
         uint16_t        size;                               // cached value of _database_size_param that sticks after initialized
+        AP_OASpatialGrid grid;                              // spatial index of items used to find items near a position
+        HAL_Semaphore   sem;                                // semaphore for multi-thread use of items and grid
     } _database;
 
     uint16_t _next_index_to_send[MAVLINK_COMM_NUM_BUFFERS]; // index of next object in _database to send to GCS
@@ -26,6 +26,7 @@
 
 #include <AP_AHRS/AP_AHRS.h>
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Math/crc.h>
 #include <GCS_MAVLink/GCS.h>
 
 #define OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK  32      // expanding arrays for fence points and paths to destination will grow in increments of 20 elements
@@ -37,7 +38,9 @@ AP_OADijkstra::AP_OADijkstra(AP_Int16 &options) :
         _inclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_circle_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _fence_items{{OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK}, {OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK}},
         _short_path_data(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _open_set(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _path(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _options(options)
 {
@@ -76,6 +79,7 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
     if (check_inclusion_polygon_updated()) {
         _inclusion_polygon_with_margin_ok = false;
         _polyfence_visgraph_ok = false;
+        _fence_polygons_ok = false;
         _shortest_path_ok = false;
     }
 
@@ -83,6 +87,7 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
     if (check_exclusion_polygon_updated()) {
         _exclusion_polygon_with_margin_ok = false;
         _polyfence_visgraph_ok = false;
+        _fence_polygons_ok = false;
         _shortest_path_ok = false;
     }
 
@@ -93,6 +98,11 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
         _shortest_path_ok = false;
     }
 
+    // prepare polygons for intersection checks
+    if (!_fence_polygons_ok) {
+        _fence_polygons_ok = prepare_fence_polygons();
+    }
+
     // create inner polygon fence
     if (!_inclusion_polygon_with_margin_ok) {
         _inclusion_polygon_with_margin_ok = create_inclusion_polygon_with_margin(_polyfence_margin * 100.0f, _error_id);
@@ -609,6 +619,49 @@ bool AP_OADijkstra::get_point(uint16_t index, Vector2f &point) const
     return false;
 }
 
+// prepare inclusion and exclusion polygons for intersection checks
+// returns false on failure to allocate memory in which case intersects_fence checks the polygons directly
+bool AP_OADijkstra::prepare_fence_polygons()
+{
+    delete[] _fence_polygons;
+    _fence_polygons = nullptr;
+    _fence_polygons_num = 0;
+
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return false;
+    }
+
+    const uint8_t num_inclusion_polygons = fence->polyfence().get_inclusion_polygon_count();
+    const uint8_t num_exclusion_polygons = fence->polyfence().get_exclusion_polygon_count();
+    const uint16_t num_polygons = num_inclusion_polygons + num_exclusion_polygons;
+    if (num_polygons == 0) {
+        return true;
+    }
+    if (num_polygons > UINT8_MAX) {
+        return false;
+    }
+    _fence_polygons = NEW_NOTHROW PreparedPolygon[num_polygons];
+    if (_fence_polygons == nullptr) {
+        return false;
+    }
+
+    // polygons which can't be indexed are checked edge by edge
+    for (uint8_t i = 0; i < num_polygons; i++) {
+        uint16_t num_points;
+        const Vector2f* boundary;
+        if (i < num_inclusion_polygons) {
+            boundary = fence->polyfence().get_inclusion_polygon(i, num_points);
+        } else {
+            boundary = fence->polyfence().get_exclusion_polygon(i - num_inclusion_polygons, num_points);
+        }
+        if (boundary != nullptr) {
+            _fence_polygons[_fence_polygons_num++].prepare(boundary, num_points);
+        }
+    }
+    return true;
+}
+
 // returns true if line segment intersects polygon or circular fence
 bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const
 {
@@ -618,9 +671,19 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
         return false;
     }
 
+    // determine if segment crosses any of the prepared inclusion or exclusion polygons
+    if (_fence_polygons_ok) {
+        for (uint8_t i = 0; i < _fence_polygons_num; i++) {
+            Vector2f intersection;
+            if (_fence_polygons[i].intersects(seg_start, seg_end, intersection)) {
+                return true;
+            }
+        }
+    }
+
     // determine if segment crosses any of the inclusion polygons
     uint16_t num_points = 0;
-    for (uint8_t i = 0; i < fence->polyfence().get_inclusion_polygon_count(); i++) {
+    for (uint8_t i = 0; !_fence_polygons_ok && (i < fence->polyfence().get_inclusion_polygon_count()); i++) {
         const Vector2f* boundary = fence->polyfence().get_inclusion_polygon(i, num_points);
         if (boundary != nullptr) {
             Vector2f intersection;
@@ -631,7 +694,7 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
     }
 
     // determine if segment crosses any of the exclusion polygons
-    for (uint8_t i = 0; i < fence->polyfence().get_exclusion_polygon_count(); i++) {
+    for (uint8_t i = 0; !_fence_polygons_ok && (i < fence->polyfence().get_exclusion_polygon_count()); i++) {
         const Vector2f* boundary = fence->polyfence().get_exclusion_polygon(i, num_points);
         if (boundary != nullptr) {
             Vector2f intersection;
@@ -676,9 +739,108 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
     return false;
 }
 
+// update summaries of the fence items, the previous summaries are kept to find changes
+// returns false on failure to allocate memory
+bool AP_OADijkstra::update_fence_item_summaries()
+{
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return false;
+    }
+
+    // latest summaries become the previous summaries
+    _fence_items_latest = (_fence_items_latest + 1) % ARRAY_SIZE(_fence_items);
+    AP_ExpandingArray<FenceItemSummary> &items = _fence_items[_fence_items_latest];
+    uint16_t &num_items = _fence_items_num[_fence_items_latest];
+    num_items = 0;
+
+    const AC_PolyFence_loader &polyfence = fence->polyfence();
+    const uint8_t num_inclusion_polygons = polyfence.get_inclusion_polygon_count();
+    const uint8_t num_exclusion_polygons = polyfence.get_exclusion_polygon_count();
+    const uint8_t num_inclusion_circles = polyfence.get_inclusion_circle_count();
+    const uint8_t num_exclusion_circles = polyfence.get_exclusion_circle_count();
+    if (!items.expand_to_hold(num_inclusion_polygons + num_exclusion_polygons + num_inclusion_circles + num_exclusion_circles)) {
+        return false;
+    }
+
+    // polygons cover the area of their points
+    for (uint8_t type = 0; type < 2; type++) {
+        const uint8_t num_polygons = (type == 0) ? num_inclusion_polygons : num_exclusion_polygons;
+        for (uint8_t i = 0; i < num_polygons; i++) {
+            uint16_t num_points = 0;
+            const Vector2f* boundary = (type == 0) ? polyfence.get_inclusion_polygon(i, num_points) : polyfence.get_exclusion_polygon(i, num_points);
+            if ((boundary == nullptr) || (num_points == 0)) {
+                continue;
+            }
+            FenceItemSummary &item = items[num_items++];
+            item.crc = crc_crc32(type, (const uint8_t *)boundary, num_points * sizeof(Vector2f));
+            item.area.min = item.area.max = boundary[0];
+            for (uint16_t j = 1; j < num_points; j++) {
+                item.area.min.x = MIN(item.area.min.x, boundary[j].x);
+                item.area.min.y = MIN(item.area.min.y, boundary[j].y);
+                item.area.max.x = MAX(item.area.max.x, boundary[j].x);
+                item.area.max.y = MAX(item.area.max.y, boundary[j].y);
+            }
+        }
+    }
+
+    // a segment intersects an inclusion circle if either end is outside it so a change to an inclusion circle affects all segments
+    for (uint8_t i = 0; i < num_inclusion_circles; i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (polyfence.get_inclusion_circle(i, center_pos_cm, radius)) {
+            const float circle[] {center_pos_cm.x, center_pos_cm.y, radius};
+            FenceItemSummary &item = items[num_items++];
+            item.crc = crc_crc32(2, (const uint8_t *)circle, sizeof(circle));
+            item.area.min = Vector2f{-FLT_MAX, -FLT_MAX};
+            item.area.max = Vector2f{FLT_MAX, FLT_MAX};
+        }
+    }
+
+    // exclusion circles cover the square around them
+    for (uint8_t i = 0; i < num_exclusion_circles; i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        if (polyfence.get_exclusion_circle(i, center_pos_cm, radius)) {
+            const float circle[] {center_pos_cm.x, center_pos_cm.y, radius};
+            const float radius_cm = radius * 100.0f;
+            FenceItemSummary &item = items[num_items++];
+            item.crc = crc_crc32(3, (const uint8_t *)circle, sizeof(circle));
+            item.area.min = center_pos_cm - Vector2f{radius_cm, radius_cm};
+            item.area.max = center_pos_cm + Vector2f{radius_cm, radius_cm};
+        }
+    }
+
+    return true;
+}
+
+// add areas of fence items which have been added or removed since the previous summaries to the fence visibility matrix
+void AP_OADijkstra::add_fence_changed_areas()
+{
+    for (uint8_t latest = 0; latest < ARRAY_SIZE(_fence_items); latest++) {
+        // check latest items against previous items and then previous items against latest
+        const uint8_t from = (latest == 0) ? _fence_items_latest : (_fence_items_latest + 1) % ARRAY_SIZE(_fence_items);
+        const uint8_t to = (from + 1) % ARRAY_SIZE(_fence_items);
+        for (uint16_t i = 0; i < _fence_items_num[from]; i++) {
+            const FenceItemSummary &item = _fence_items[from][i];
+            bool found = false;
+            for (uint16_t j = 0; j < _fence_items_num[to]; j++) {
+                if (_fence_items[to][j].crc == item.crc) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                _fence_vismatrix.add_changed_area(item.area);
+            }
+        }
+    }
+}
+
 // create visibility graph for all fence (with margin) points
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin
+// visibility of pairs of points which are unaffected by changes to the fence since the previous call is carried over
 bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
 {
     // exit immediately if fence is not enabled
@@ -689,35 +851,44 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
     }
 
     // fail if more fence points than algorithm can handle
-    if (total_numpoints() >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+    const uint16_t num_points = total_numpoints();
+    if (num_points >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_TOO_MANY_FENCE_POINTS;
         return false;
     }
 
-    // clear fence points visibility graph
-    _fence_visgraph.clear();
-
-    // calculate distance from each point to all other points
-    for (uint8_t i = 0; i < total_numpoints() - 1; i++) {
-        Vector2f start_seg;
-        if (get_point(i, start_seg)) {
-            for (uint8_t j = i + 1; j < total_numpoints(); j++) {
-                Vector2f end_seg;
-                if (get_point(j, end_seg)) {
-                    // if line segment does not intersect with any inclusion or exclusion zones add to visgraph
-                    if (!intersects_fence(start_seg, end_seg)) {
-                        if (!_fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i},
-                                                      {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, j},
-                                                      (start_seg - end_seg).length())) {
-                            // failure to add a point can only be caused by out-of-memory
-                            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-                            return false;
-                        }
-                    }
-                }
+    // find which areas of the fence have changed
+    const bool reuse = _fence_items_ok;
+    _fence_items_ok = false;
+    if (!update_fence_item_summaries() ||
+        !_fence_vismatrix.begin_update(num_points, reuse)) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        return false;
+    }
+    for (uint16_t i = 0; i < num_points; i++) {
+        Vector2f point;
+        if (get_point(i, point)) {
+            _fence_vismatrix.set_point(i, point);
+        }
+    }
+    if (reuse) {
+        add_fence_changed_areas();
+    }
+
+    // check visibility from each point to all other points
+    for (uint16_t i = 1; i < num_points; i++) {
+        const Vector2f &start_seg = _fence_vismatrix.point(i);
+        for (uint16_t j = 0; j < i; j++) {
+            bool visible;
+            if (!_fence_vismatrix.carried_over(i, j, visible)) {
+                // visible if line segment does not intersect with any inclusion or exclusion zones
+                visible = !intersects_fence(start_seg, _fence_vismatrix.point(j));
             }
+            _fence_vismatrix.set_visible(i, j, visible);
         }
     }
+    _fence_vismatrix.end_update();
+    _fence_items_ok = true;
 
     return true;
 }
@@ -768,33 +939,37 @@ void AP_OADijkstra::update_visible_node_distances(node_index curr_node_idx)
     // get current node for convenience
     const ShortPathNode &curr_node = _short_path_data[curr_node_idx];
 
-    // for each visibility graph
-    const AP_OAVisGraph* visgraphs[] = {&_fence_visgraph, &_destination_visgraph};
-    for (uint8_t v=0; v<ARRAY_SIZE(visgraphs); v++) {
-
-        // skip if empty
-        const AP_OAVisGraph &curr_visgraph = *visgraphs[v];
-        if (curr_visgraph.num_items() == 0) {
-            continue;
-        }
-
-        // search visibility graph for items visible from current_node
-        for (uint16_t i = 0; i < curr_visgraph.num_items(); i++) {
-            const AP_OAVisGraph::VisGraphItem &item = curr_visgraph[i];
-            // match if current node's id matches either of the id's in the graph (i.e. either end of the vector)
-            if ((curr_node.id == item.id1) || (curr_node.id == item.id2)) {
-                AP_OAVisGraph::OAItemID matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
-                // find item's id in node array
-                node_index item_node_idx;
-                if (find_node_from_id(matching_id, item_node_idx)) {
-                    // if current node's distance + distance to item is less than item's current distance, update item's distance
-                    const float dist_to_item_via_current_node = _short_path_data[curr_node_idx].distance_cm + item.distance_cm;
-                    if (dist_to_item_via_current_node < _short_path_data[item_node_idx].distance_cm) {
-                        // update item's distance and set "distance_from_idx" to current node's index
-                        _short_path_data[item_node_idx].distance_cm = dist_to_item_via_current_node;
-                        _short_path_data[item_node_idx].distance_from_idx = curr_node_idx;
-                    }
-                }
+    // update distance to node if it is shorter via the current node
+    auto update_distance = [&](node_index item_node_idx, float item_distance_cm) {
+        ShortPathNode &item_node = _short_path_data[item_node_idx];
+        const float dist_to_item_via_current_node = curr_node.distance_cm + item_distance_cm;
+        if (!item_node.visited && (dist_to_item_via_current_node < item_node.distance_cm)) {
+            // update item's distance and set "distance_from_idx" to current node's index
+            item_node.distance_cm = dist_to_item_via_current_node;
+            item_node.distance_from_idx = curr_node_idx;
+            open_set_update(item_node_idx);
+        }
+    };
+
+    // destination
+    if (curr_node.dest_distance_cm < FLT_MAX) {
+        node_index dest_node_idx;
+        if (find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION, 0}, dest_node_idx)) {
+            update_distance(dest_node_idx, curr_node.dest_distance_cm);
+        }
+    }
+
+    // other fence points visible from an intermediate point
+    if (curr_node.id.id_type != AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT) {
+        return;
+    }
+    const uint16_t curr_point = curr_node.id.id_num;
+    const Vector2f &curr_pos = _fence_vismatrix.point(curr_point);
+    for (uint16_t i = 0; i < _fence_vismatrix.num_points(); i++) {
+        if (_fence_vismatrix.visible(curr_point, i)) {
+            node_index item_node_idx;
+            if (find_node_from_id({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)i}, item_node_idx)) {
+                update_distance(item_node_idx, (curr_pos - _fence_vismatrix.point(i)).length());
             }
         }
     }
@@ -832,45 +1007,88 @@ bool AP_OADijkstra::find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_in
     return false;
 }
 
-// find index of node with lowest tentative distance (ignore visited nodes)
-// returns true if successful and node_idx argument is updated
-bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx) const
+// return node's distance from source plus heuristic used to order the open set
+float AP_OADijkstra::open_set_cost(node_index node_idx) const
 {
-    node_index lowest_idx = 0;
-    float lowest_dist = FLT_MAX;
-
-    // scan through all nodes looking for closest
-    for (node_index i=0; i<_short_path_data_numpoints; i++) {
-        const ShortPathNode &node = _short_path_data[i];
-        if (node.visited || is_equal(_short_path_data[i].distance_cm, FLT_MAX)) {
-            // if node is already visited OR cannot be reached yet, we can't use it
-            continue;
-        }
-        // figure out the pos of this node
-        Vector2f node_pos;
-        float dist_with_heuristics = FLT_MAX;
-        if (convert_node_to_point(node.id, node_pos)) {
-            // heuristics is is simple Euclidean distance from the node to the destination
-            // This should be admissible, therefore optimal path is guaranteed
-            const float heuristics = (node_pos-_path_destination).length();
-            dist_with_heuristics = node.distance_cm + heuristics;
-        } else {
-            // shouldn't happen
-            return false;
+    const ShortPathNode &node = _short_path_data[node_idx];
+    return node.distance_cm + node.heuristic_cm;
+}
+
+// move element of open set towards the top of the heap until ordering is restored
+void AP_OADijkstra::open_set_sift_up(node_index heap_idx)
+{
+    const node_index node_idx = _open_set[heap_idx];
+    const float cost = open_set_cost(node_idx);
+    while (heap_idx > 0) {
+        const node_index parent_idx = (heap_idx - 1) / 2;
+        const node_index parent_node_idx = _open_set[parent_idx];
+        if (open_set_cost(parent_node_idx) <= cost) {
+            break;
+        }
+        _open_set[heap_idx] = parent_node_idx;
+        _short_path_data[parent_node_idx].open_set_idx = heap_idx;
+        heap_idx = parent_idx;
+    }
+    _open_set[heap_idx] = node_idx;
+    _short_path_data[node_idx].open_set_idx = heap_idx;
+}
+
+// move element of open set towards the bottom of the heap until ordering is restored
+void AP_OADijkstra::open_set_sift_down(node_index heap_idx)
+{
+    const node_index node_idx = _open_set[heap_idx];
+    const float cost = open_set_cost(node_idx);
+    while (true) {
+        const uint16_t left_idx = 2 * uint16_t(heap_idx) + 1;
+        if (left_idx >= _open_set_numpoints) {
+            break;
         }
-        if (dist_with_heuristics < lowest_dist) {
-            // for NOW, this is the closest node
-            lowest_idx = i;
-            lowest_dist = dist_with_heuristics;
+        // find the child with the lowest cost
+        uint16_t child_idx = left_idx;
+        if ((left_idx + 1 < _open_set_numpoints) &&
+            (open_set_cost(_open_set[left_idx + 1]) < open_set_cost(_open_set[left_idx]))) {
+            child_idx = left_idx + 1;
         }
+        const node_index child_node_idx = _open_set[child_idx];
+        if (cost <= open_set_cost(child_node_idx)) {
+            break;
+        }
+        _open_set[heap_idx] = child_node_idx;
+        _short_path_data[child_node_idx].open_set_idx = heap_idx;
+        heap_idx = (node_index)child_idx;
     }
+    _open_set[heap_idx] = node_idx;
+    _short_path_data[node_idx].open_set_idx = heap_idx;
+}
 
-    if (lowest_dist < FLT_MAX) {
-        // found the closest node
-        node_idx = lowest_idx;
-        return true;
+// add node to open set or move it up the open set after its distance has been reduced
+// the open set is always large enough to hold all nodes
+void AP_OADijkstra::open_set_update(node_index node_idx)
+{
+    ShortPathNode &node = _short_path_data[node_idx];
+    if (node.open_set_idx == OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+        node.open_set_idx = _open_set_numpoints;
+        _open_set[_open_set_numpoints++] = node_idx;
     }
-    return false;
+    open_set_sift_up(node.open_set_idx);
+}
+
+// remove the node with the lowest distance plus heuristic from the open set
+// returns true if successful and node_idx argument is updated
+bool AP_OADijkstra::open_set_pop(node_index &node_idx)
+{
+    if (_open_set_numpoints == 0) {
+        return false;
+    }
+    node_idx = _open_set[0];
+    _short_path_data[node_idx].open_set_idx = OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX;
+    _open_set_numpoints--;
+    if (_open_set_numpoints > 0) {
+        // move last element to the top and restore ordering
+        _open_set[0] = _open_set[_open_set_numpoints];
+        open_set_sift_down(0);
+    }
+    return true;
 }
 
 // calculate shortest path from origin to destination
@@ -896,24 +1114,46 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         return false;
     }
 
-    // expand _short_path_data if necessary
-    if (!_short_path_data.expand_to_hold(2 + total_numpoints())) {
+    return find_shortest_path(err_id);
+}
+
+// search the source, destination and fence visibility graphs for the shortest path
+// returns true on success.  returns false on failure and err_id is updated
+// requires _path_source, _path_destination and the visibility graphs to have been updated
+// resulting path is stored in _path array
+bool AP_OADijkstra::find_shortest_path(AP_OADijkstra_Error &err_id)
+{
+    // expand _short_path_data and _open_set if necessary
+    if (!_short_path_data.expand_to_hold(2 + total_numpoints()) ||
+        !_open_set.expand_to_hold(2 + total_numpoints())) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
         return false;
     }
 
-    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm) to short_path_data array
-    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0};
-    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
+    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm, heuristic_cm, dest_distance_cm, open_set_idx) to short_path_data array
+    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0, (_path_destination - _path_source).length(), FLT_MAX, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX};
+    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX, 0, FLT_MAX, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX};
     _short_path_data_numpoints = 2;
 
-    // add all inclusion and exclusion fence points to short_path_data array (node_type, id, visited, distance_from_idx, distance_cm)
+    // add all inclusion and exclusion fence points to short_path_data array
+    // heuristic is simple Euclidean distance from the node to the destination
+    // This should be admissible, therefore optimal path is guaranteed
     for (uint8_t i=0; i<total_numpoints(); i++) {
-        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
+        const float heuristic_cm = (_fence_vismatrix.point(i) - _path_destination).length();
+        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX, heuristic_cm, FLT_MAX, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX};
+    }
+
+    // record distance to destination from nodes which can see it
+    for (uint16_t i = 0; i < _destination_visgraph.num_items(); i++) {
+        node_index node_idx;
+        if (find_node_from_id(_destination_visgraph[i].id2, node_idx)) {
+            _short_path_data[node_idx].dest_distance_cm = _destination_visgraph[i].distance_cm;
+        }
     }
 
     // start algorithm from source point
     node_index current_node_idx = 0;
+    _open_set_numpoints = 0;
 
     // update nodes visible from source point
     for (uint16_t i = 0; i < _source_visgraph.num_items(); i++) {
@@ -921,6 +1161,7 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
             _short_path_data[node_idx].distance_cm = _source_visgraph[i].distance_cm;
             _short_path_data[node_idx].distance_from_idx = current_node_idx;
+            open_set_update(node_idx);
         } else {
             err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
             return false;
@@ -929,19 +1170,18 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
     // mark source node as visited
     _short_path_data[current_node_idx].visited = true;
 
-    // move current_node_idx to node with lowest distance
-    while (find_closest_node_idx(current_node_idx)) {
-        node_index dest_node;
+    // move current_node_idx to node with lowest distance plus heuristic
+    while (open_set_pop(current_node_idx)) {
+        // mark current node as visited
+        _short_path_data[current_node_idx].visited = true;
+
         // See if this next "closest" node is actually the destination
-        if (find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION,0}, dest_node) && current_node_idx == dest_node) {
+        if (_short_path_data[current_node_idx].id.id_type == AP_OAVisGraph::OATYPE_DESTINATION) {
             // We have discovered destination.. Don't bother with the rest of the graph
             break;
         }
         // update distances to all neighbours of current node
         update_visible_node_distances(current_node_idx);
-
-        // mark current node as visited
-        _short_path_data[current_node_idx].visited = true;
     }
 
     // extract path starting from destination
@@ -8,6 +8,7 @@
 #include <AP_Common/Location.h>
 #include <AP_Math/AP_Math.h>
 #include "AP_OAVisGraph.h"
+#include "AP_OAVisMatrix.h"
 #include <AP_Logger/AP_Logger_config.h>
 
 /*
@@ -15,6 +16,8 @@
  */
 
 class AP_OADijkstra {
+    friend class AP_OADijkstra_Test;
+
 public:
 
     AP_OADijkstra(AP_Int16 &options);
@@ -116,6 +119,10 @@ private:
     // also returns the type of point
     bool get_point(uint16_t index, Vector2f& point) const;
 
+    // prepare inclusion and exclusion polygons for intersection checks
+    // returns false on failure to allocate memory in which case intersects_fence checks the polygons directly
+    bool prepare_fence_polygons();
+
     // returns true if line segment intersects polygon or circular fence
     bool intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const;
 
@@ -123,17 +130,31 @@ private:
     // returns true on success.  returns false on failure and err_id is updated
     bool create_fence_visgraph(AP_OADijkstra_Error &err_id);
 
+    // update summaries of the fence items, the previous summaries are kept to find changes
+    // returns false on failure to allocate memory
+    bool update_fence_item_summaries();
+
+    // add areas of fence items which have been added or removed since the previous summaries to the fence visibility matrix
+    void add_fence_changed_areas();
+
     // calculate shortest path from origin to destination
     // returns true on success.  returns false on failure and err_id is updated
     // requires create_polygon_fence_with_margin and create_polygon_fence_visgraph to have been run
     // resulting path is stored in _shortest_path array as vector offsets from EKF origin
     bool calc_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id);
 
+    // search the source, destination and fence visibility graphs for the shortest path
+    // returns true on success.  returns false on failure and err_id is updated
+    // requires _path_source, _path_destination and the visibility graphs to have been updated
+    // resulting path is stored in _path array
+    bool find_shortest_path(AP_OADijkstra_Error &err_id);
+
     // shortest path state variables
     bool _inclusion_polygon_with_margin_ok;
     bool _exclusion_polygon_with_margin_ok;
     bool _exclusion_circle_with_margin_ok;
     bool _polyfence_visgraph_ok;
+    bool _fence_polygons_ok;
     bool _shortest_path_ok;
 
     Location _destination_prev;     // destination of previous iterations (used to determine if path should be re-calculated)
@@ -157,8 +178,22 @@ private:
     uint8_t _exclusion_circle_numpoints;    // number of points held in above array
     uint32_t _exclusion_circle_update_ms;   // system time exclusion circles were updated (used to detect changes)
 
+    // inclusion and exclusion polygons prepared for intersection checks
+    PreparedPolygon *_fence_polygons = nullptr; // inclusion polygons followed by exclusion polygons
+    uint8_t _fence_polygons_num;                // number of polygons held in above array
+
+    // summary of a fence item used to find which areas of the fence have changed
+    struct FenceItemSummary {
+        uint32_t crc;                       // crc of the item's type and points
+        AP_OAVisMatrix::Area area;          // area covered by item
+    };
+    AP_ExpandingArray<FenceItemSummary> _fence_items[2];    // summaries of fence items from the last two updates
+    uint16_t _fence_items_num[2];                           // number of summaries held in above arrays
+    uint8_t _fence_items_latest;                            // index of the array holding the latest summaries
+    bool _fence_items_ok;                                   // true if the latest summaries match the fence visibility matrix
+
     // visibility graphs
-    AP_OAVisGraph _fence_visgraph;          // holds distances between all inclusion/exclusion fence points (with margin)
+    AP_OAVisMatrix _fence_vismatrix;        // holds visibility between all inclusion/exclusion fence points (with margin)
     AP_OAVisGraph _source_visgraph;         // holds distances from source point to all other nodes
     AP_OAVisGraph _destination_visgraph;    // holds distances from the destination to all other nodes
 
@@ -174,6 +209,9 @@ private:
         bool visited;                   // true if all this node's neighbour's distances have been updated
         node_index distance_from_idx;   // index into _short_path_data from where distance was updated (or 255 if not set)
         float distance_cm;              // distance from source (number is tentative until this node is the current node and/or visited = true)
+        float heuristic_cm;             // straight line distance to destination
+        float dest_distance_cm;         // distance to destination if it is visible from this node (or FLT_MAX if not)
+        node_index open_set_idx;        // index into _open_set (or 255 if not in open set)
     };
     AP_ExpandingArray<ShortPathNode> _short_path_data;
     node_index _short_path_data_numpoints;  // number of elements in _short_path_data array
@@ -186,9 +224,24 @@ private:
     // returns true if successful and node_idx is updated
     bool find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const;
 
-    // find index of node with lowest tentative distance (ignore visited nodes)
+    // open set of nodes which have a tentative distance held as a binary heap ordered by
+    // distance from source plus heuristic so the most promising node is first
+    AP_ExpandingArray<node_index> _open_set;
+    node_index _open_set_numpoints;     // number of nodes in open set
+
+    // add node to open set or move it up the open set after its distance has been reduced
+    void open_set_update(node_index node_idx);
+
+    // remove the node with the lowest distance plus heuristic from the open set
     // returns true if successful and node_idx argument is updated
-    bool find_closest_node_idx(node_index &node_idx) const;
+    bool open_set_pop(node_index &node_idx);
+
+    // return node's distance from source plus heuristic used to order the open set
+    float open_set_cost(node_index node_idx) const;
+
+    // move element of open set towards the top or bottom of the heap until ordering is restored
+    void open_set_sift_up(node_index heap_idx);
+    void open_set_sift_down(node_index heap_idx);
 
     // final path variables and functions
     AP_ExpandingArray<AP_OAVisGraph::OAItemID> _path;   // ids of points on return path in reverse order (i.e. destination is first element)
@@ -0,0 +1,488 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AC_Avoidance_config.h"
+
+#if AP_OAPATHPLANNER_BENDYRULER_ENABLED
+
+#include "AP_OAFenceCache.h"
+#include <AC_Fence/AC_Fence.h>
+
+#include <string.h>
+
+#define OA_FENCECACHE_LEAF_EDGES_MAX    4   // nodes with more edges than this are split in two
+#define OA_FENCECACHE_STACK_SIZE        32  // depth of node stack used when searching hierarchy
+
+AP_OAFenceCache::~AP_OAFenceCache()
+{
+    clear();
+}
+
+// release all memory
+void AP_OAFenceCache::clear()
+{
+    delete[] _points;
+    delete[] _edges;
+    delete[] _nodes;
+    delete[] _polygons;
+    delete[] _circles;
+    delete[] _origin_outside;
+    _points = nullptr;
+    _edges = nullptr;
+    _nodes = nullptr;
+    _polygons = nullptr;
+    _circles = nullptr;
+    _origin_outside = nullptr;
+    _num_points = _max_points = 0;
+    _num_edges = 0;
+    _num_nodes = _max_nodes = 0;
+    _num_polygons = _max_polygons = 0;
+    _num_circles = _max_circles = 0;
+    _origin_valid = false;
+    _valid = false;
+}
+
+// rebuild from the fence if it has been reloaded since the last build
+// returns true if the cache holds the latest fence
+bool AP_OAFenceCache::update()
+{
+#if AP_FENCE_ENABLED
+    AC_Fence *fence = AC_Fence::get_singleton();
+    if (fence == nullptr) {
+        return false;
+    }
+    AC_PolyFence_loader &polyfence = fence->polyfence();
+
+    // inclusion circles are reloaded along with the other fence items
+    if ((_inclusion_polygon_update_ms == polyfence.get_inclusion_polygon_update_ms()) &&
+        (_exclusion_polygon_update_ms == polyfence.get_exclusion_polygon_update_ms()) &&
+        (_exclusion_circle_update_ms == polyfence.get_exclusion_circle_update_ms())) {
+        return _valid;
+    }
+
+    WITH_SEMAPHORE(polyfence.get_loaded_fence_semaphore());
+
+    _inclusion_polygon_update_ms = polyfence.get_inclusion_polygon_update_ms();
+    _exclusion_polygon_update_ms = polyfence.get_exclusion_polygon_update_ms();
+    _exclusion_circle_update_ms = polyfence.get_exclusion_circle_update_ms();
+
+    // count polygon points and circles
+    const uint8_t num_inclusion_polygons = polyfence.get_inclusion_polygon_count();
+    const uint8_t num_exclusion_polygons = polyfence.get_exclusion_polygon_count();
+    const uint8_t num_inclusion_circles = polyfence.get_inclusion_circle_count();
+    const uint8_t num_exclusion_circles = polyfence.get_exclusion_circle_count();
+    const uint16_t num_polygons = num_inclusion_polygons + num_exclusion_polygons;
+    const uint16_t num_circles = num_inclusion_circles + num_exclusion_circles;
+    if ((num_polygons > UINT8_MAX) || (num_circles > UINT8_MAX)) {
+        clear();
+        return false;
+    }
+    uint32_t total_points = 0;
+    for (uint8_t i = 0; i < num_polygons; i++) {
+        uint16_t num_points;
+        if (i < num_inclusion_polygons) {
+            polyfence.get_inclusion_polygon(i, num_points);
+        } else {
+            polyfence.get_exclusion_polygon(i - num_inclusion_polygons, num_points);
+        }
+        total_points += num_points;
+    }
+    if ((total_points > UINT16_MAX) || !begin_build(num_polygons, total_points, num_circles)) {
+        return false;
+    }
+
+    // copy polygons and circles
+    for (uint8_t i = 0; i < num_polygons; i++) {
+        uint16_t num_points;
+        const bool inclusion = (i < num_inclusion_polygons);
+        const Vector2f *boundary = inclusion ? polyfence.get_inclusion_polygon(i, num_points) : polyfence.get_exclusion_polygon(i - num_inclusion_polygons, num_points);
+        if ((boundary != nullptr) && !add_polygon(boundary, num_points, inclusion)) {
+            clear();
+            return false;
+        }
+    }
+    for (uint8_t i = 0; i < num_circles; i++) {
+        Vector2f center_pos_cm;
+        float radius;
+        const bool inclusion = (i < num_inclusion_circles);
+        const bool ok = inclusion ? polyfence.get_inclusion_circle(i, center_pos_cm, radius) : polyfence.get_exclusion_circle(i - num_inclusion_circles, center_pos_cm, radius);
+        if (ok && !add_circle(center_pos_cm, radius, inclusion)) {
+            clear();
+            return false;
+        }
+    }
+    end_build();
+    return _valid;
+#else
+    return false;
+#endif // AP_FENCE_ENABLED
+}
+
+// build from polygons and circles provided by the caller
+// returns false on allocation failure in which case the cache is empty and invalid
+bool AP_OAFenceCache::begin_build(uint8_t num_polygons, uint16_t total_points, uint8_t num_circles)
+{
+    clear();
+
+    // each polygon may need its first point repeated after the last
+    // and has at most two nodes for each edge
+    const uint32_t max_points = uint32_t(total_points) + num_polygons;
+    const uint32_t max_nodes = 2 * max_points;
+    if (max_nodes > UINT16_MAX) {
+        return false;
+    }
+
+    if (max_points > 0) {
+        _points = NEW_NOTHROW Vector2f[max_points];
+        _edges = NEW_NOTHROW uint16_t[max_points];
+        _nodes = NEW_NOTHROW Node[max_nodes];
+        if ((_points == nullptr) || (_edges == nullptr) || (_nodes == nullptr)) {
+            clear();
+            return false;
+        }
+    }
+    if (num_polygons > 0) {
+        _polygons = NEW_NOTHROW Polygon[num_polygons];
+        _origin_outside = NEW_NOTHROW bool[num_polygons];
+        if ((_polygons == nullptr) || (_origin_outside == nullptr)) {
+            clear();
+            return false;
+        }
+    }
+    if (num_circles > 0) {
+        _circles = NEW_NOTHROW Circle[num_circles];
+        if (_circles == nullptr) {
+            clear();
+            return false;
+        }
+    }
+    _max_points = max_points;
+    _max_nodes = max_nodes;
+    _max_polygons = num_polygons;
+    _max_circles = num_circles;
+    return true;
+}
+
+// add polygon of num_points points, returns false if there is no space left
+bool AP_OAFenceCache::add_polygon(const Vector2f *points, uint16_t num_points, bool inclusion)
+{
+    if ((num_points < 2) || (_num_polygons >= _max_polygons) || (_num_points + num_points + 1U > _max_points)) {
+        return false;
+    }
+
+    Polygon &poly = _polygons[_num_polygons];
+    poly.first_point = _num_points;
+    poly.num_points = num_points;
+    poly.inclusion = inclusion;
+    memcpy(&_points[_num_points], points, num_points * sizeof(Vector2f));
+
+    // repeat first point after the last so edges can be checked without wrapping
+    uint16_t num_polygon_points = num_points;
+    if (!Polygon_complete(points, num_points)) {
+        _points[_num_points + num_polygon_points++] = points[0];
+    }
+    poly.num_edges = num_polygon_points - 1;
+    for (uint16_t i = 0; i < poly.num_edges; i++) {
+        _edges[_num_edges + i] = _num_points + i;
+    }
+    _num_points += num_polygon_points;
+
+    build_hierarchy(poly);
+    _num_edges += poly.num_edges;
+    _num_polygons++;
+    return true;
+}
+
+// add circle, returns false if there is no space left
+bool AP_OAFenceCache::add_circle(const Vector2f &center_pos_cm, float radius, bool inclusion)
+{
+    if (_num_circles >= _max_circles) {
+        return false;
+    }
+    _circles[_num_circles++] = {center_pos_cm, radius, inclusion};
+    return true;
+}
+
+// finish build, after which the cache may be queried
+void AP_OAFenceCache::end_build()
+{
+    _origin_valid = false;
+    _valid = true;
+}
+
+// sum of the edge's end points along one axis
+float AP_OAFenceCache::edge_centre(uint16_t edge, bool axis_x) const
+{
+    return axis_x ? (_points[edge].x + _points[edge+1].x) : (_points[edge].y + _points[edge+1].y);
+}
+
+// move edges so the nth (from first) edge is in its sorted position by centre along one axis
+// with lower edges before it and higher edges after it
+void AP_OAFenceCache::select_edges(uint16_t first, uint16_t count, uint16_t nth, bool axis_x)
+{
+    int32_t lo = first;
+    int32_t hi = first + count - 1;
+    const int32_t target = first + nth;
+    while (lo < hi) {
+        const float pivot = edge_centre(_edges[(lo + hi) / 2], axis_x);
+        int32_t i = lo;
+        int32_t j = hi;
+        while (i <= j) {
+            while (edge_centre(_edges[i], axis_x) < pivot) {
+                i++;
+            }
+            while (edge_centre(_edges[j], axis_x) > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                const uint16_t tmp = _edges[i];
+                _edges[i] = _edges[j];
+                _edges[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+        // continue in the part holding the target
+        if (target <= j) {
+            hi = j;
+        } else if (target >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+}
+
+// build edge hierarchy for a polygon
+// nodes are split in two with half the edges in each until they hold only a few edges
+void AP_OAFenceCache::build_hierarchy(Polygon &poly)
+{
+    poly.root = _num_nodes;
+    _nodes[_num_nodes++] = {{}, {}, _num_edges, poly.num_edges};
+
+    // children are added after their parent so every node is visited in one pass
+    for (uint16_t n = poly.root; n < _num_nodes; n++) {
+        Node &node = _nodes[n];
+
+        // calculate bounding box of edges and their centres
+        node.min = node.max = _points[_edges[node.first]];
+        Vector2f centre_min {FLT_MAX, FLT_MAX};
+        Vector2f centre_max {-FLT_MAX, -FLT_MAX};
+        for (uint16_t i = 0; i < node.count; i++) {
+            const uint16_t edge = _edges[node.first + i];
+            for (uint8_t k = 0; k < 2; k++) {
+                const Vector2f &pt = _points[edge + k];
+                node.min.x = MIN(node.min.x, pt.x);
+                node.min.y = MIN(node.min.y, pt.y);
+                node.max.x = MAX(node.max.x, pt.x);
+                node.max.y = MAX(node.max.y, pt.y);
+            }
+            const Vector2f centre {edge_centre(edge, true), edge_centre(edge, false)};
+            centre_min.x = MIN(centre_min.x, centre.x);
+            centre_min.y = MIN(centre_min.y, centre.y);
+            centre_max.x = MAX(centre_max.x, centre.x);
+            centre_max.y = MAX(centre_max.y, centre.y);
+        }
+
+        if ((node.count <= OA_FENCECACHE_LEAF_EDGES_MAX) || (_num_nodes + 2 > _max_nodes)) {
+            continue;
+        }
+
+        // split along the axis the edge centres are most spread out
+        const bool axis_x = (centre_max.x - centre_min.x) >= (centre_max.y - centre_min.y);
+        const uint16_t half = node.count / 2;
+        select_edges(node.first, node.count, half, axis_x);
+        _nodes[_num_nodes] = {{}, {}, node.first, half};
+        _nodes[_num_nodes+1] = {{}, {}, uint16_t(node.first + half), uint16_t(node.count - half)};
+        node.first = _num_nodes;
+        node.count = 0;
+        _num_nodes += 2;
+    }
+}
+
+// squared distance between a node's bounding box and a rectangle, zero if they overlap
+float AP_OAFenceCache::box_distance_sq(const Node &node, const Vector2f &rect_min, const Vector2f &rect_max)
+{
+    const float dx = MAX(MAX(node.min.x - rect_max.x, rect_min.x - node.max.x), 0.0f);
+    const float dy = MAX(MAX(node.min.y - rect_max.y, rect_min.y - node.max.y), 0.0f);
+    return sq(dx) + sq(dy);
+}
+
+// distance between a path and a polygon's edges as calculated by Polygon_closest_distance_line
+// returns false if the path does not cross the polygon and no edge is closer than sqrtf(max_dist_sq)
+bool AP_OAFenceCache::polygon_distance(const Polygon &poly, const Vector2f &p1, const Vector2f &p2, float max_dist_sq, float &dist) const
+{
+    const Vector2f seg_min {MIN(p1.x, p2.x), MIN(p1.y, p2.y)};
+    const Vector2f seg_max {MAX(p1.x, p2.x), MAX(p1.y, p2.y)};
+    uint16_t stack[OA_FENCECACHE_STACK_SIZE];
+    uint8_t stack_size;
+
+    // find the intersection closest to p1 checking only edges whose bounding box overlaps the path's
+    float intersect_dist_sq = FLT_MAX;
+    Vector2f intersection;
+    stack[0] = poly.root;
+    stack_size = 1;
+    while (stack_size > 0) {
+        const Node &node = _nodes[stack[--stack_size]];
+        if ((node.min.x > seg_max.x) || (node.min.y > seg_max.y) || (node.max.x < seg_min.x) || (node.max.y < seg_min.y)) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack[stack_size++] = node.first;
+            stack[stack_size++] = node.first + 1;
+            continue;
+        }
+        for (uint16_t i = 0; i < node.count; i++) {
+            const uint16_t edge = _edges[node.first + i];
+            const Vector2f &v1 = _points[edge];
+            const Vector2f &v2 = _points[edge+1];
+            if ((MIN(v1.x, v2.x) > seg_max.x) || (MIN(v1.y, v2.y) > seg_max.y) ||
+                (MAX(v1.x, v2.x) < seg_min.x) || (MAX(v1.y, v2.y) < seg_min.y)) {
+                continue;
+            }
+            Vector2f intersect_tmp;
+            if (Vector2f::segment_intersection(v1, v2, p1, p2, intersect_tmp)) {
+                const float dist_sq = sq(intersect_tmp.x - p1.x) + sq(intersect_tmp.y - p1.y);
+                if (dist_sq < intersect_dist_sq) {
+                    intersect_dist_sq = dist_sq;
+                    intersection = intersect_tmp;
+                }
+            }
+        }
+    }
+    if (intersect_dist_sq < FLT_MAX) {
+        dist = -sqrtf(sq(intersection.x - p2.x) + sq(intersection.y - p2.y));
+        return true;
+    }
+
+    // find closest edge, skipping nodes whose bounding box is further away than the closest edge so far
+    // the closing edge is not checked to match Polygon_closest_distance_line
+    const uint16_t last_edge = poly.first_point + poly.num_points - 1;
+    float closest_sq = max_dist_sq;
+    bool found = false;
+    stack[0] = poly.root;
+    stack_size = 1;
+    while (stack_size > 0) {
+        const Node &node = _nodes[stack[--stack_size]];
+        if (box_distance_sq(node, seg_min, seg_max) >= closest_sq) {
+            continue;
+        }
+        if (node.count == 0) {
+            // search nearer child first by pushing it last
+            const bool first_nearer = box_distance_sq(_nodes[node.first], seg_min, seg_max) <= box_distance_sq(_nodes[node.first+1], seg_min, seg_max);
+            stack[stack_size++] = first_nearer ? node.first + 1 : node.first;
+            stack[stack_size++] = first_nearer ? node.first : node.first + 1;
+            continue;
+        }
+        for (uint16_t i = 0; i < node.count; i++) {
+            const uint16_t edge = _edges[node.first + i];
+            if (edge >= last_edge) {
+                continue;
+            }
+            const float dist_sq = Vector2f::closest_distance_between_lines_squared(_points[edge], _points[edge+1], p1, p2);
+            if (dist_sq < closest_sq) {
+                closest_sq = dist_sq;
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    dist = sqrtf(closest_sq);
+    return true;
+}
+
+// update which polygons contain the start of the path, paths checked one after another usually have the same start
+void AP_OAFenceCache::update_origin(const Vector2f &start_cm) const
+{
+    if (_origin_valid && (_origin_cm == start_cm)) {
+        return;
+    }
+    for (uint8_t i = 0; i < _num_polygons; i++) {
+        const Polygon &poly = _polygons[i];
+        const Node &root = _nodes[poly.root];
+        if ((start_cm.x < root.min.x) || (start_cm.y < root.min.y) || (start_cm.x > root.max.x) || (start_cm.y > root.max.y)) {
+            _origin_outside[i] = true;
+        } else {
+            _origin_outside[i] = Polygon_outside(start_cm, &_points[poly.first_point], poly.num_points);
+        }
+    }
+    _origin_cm = start_cm;
+    _origin_valid = true;
+}
+
+// calculate minimum distance (in meters) between a path and all inclusion and exclusion polygons and circles
+// start and end are offsets in cm from EKF origin in NE frame, fence_margin is in meters
+// on success returns true and updates margin
+bool AP_OAFenceCache::calc_margin(const Vector2f &start_cm, const Vector2f &end_cm, float fence_margin, float &margin) const
+{
+    if (!_valid) {
+        return false;
+    }
+
+    update_origin(start_cm);
+
+    // iterate through polygons and calculate minimum margin
+    bool margin_updated = false;
+    for (uint8_t i = 0; i < _num_polygons; i++) {
+        const Polygon &poly = _polygons[i];
+
+        // margin is positive if start is inside an inclusion polygon or outside an exclusion polygon
+        const float sign = (poly.inclusion != _origin_outside[i]) ? 1.0f : -1.0f;
+
+        // with a positive margin edges further away than the lowest margin so far can be skipped
+        float max_dist_sq = FLT_MAX;
+        if (margin_updated && is_positive(sign)) {
+            const float max_dist_cm = (margin + fence_margin) * 100.0f;
+            max_dist_sq = is_positive(max_dist_cm) ? sq(max_dist_cm) : 0.0f;
+        }
+
+        // calculate min distance (in meters) from line to polygon
+        float dist;
+        if (!polygon_distance(poly, start_cm, end_cm, max_dist_sq, dist)) {
+            continue;
+        }
+        const float margin_new = (sign * dist * 0.01f) - fence_margin;
+        if (!margin_updated || (margin_new < margin)) {
+            margin_updated = true;
+            margin = margin_new;
+        }
+    }
+
+    // iterate through circles and calculate minimum margin
+    for (uint8_t i = 0; i < _num_circles; i++) {
+        const Circle &circle = _circles[i];
+        float margin_new;
+        if (circle.inclusion) {
+            // margin is fence radius minus the longer of start or end distance
+            const float start_dist_sq = (start_cm - circle.center_pos_cm).length_squared();
+            const float end_dist_sq = (end_cm - circle.center_pos_cm).length_squared();
+            margin_new = (circle.radius + fence_margin) - (sqrtf(MAX(start_dist_sq, end_dist_sq)) * 0.01f);
+        } else {
+            // margin is distance to the center minus the radius
+            const float dist_cm = Vector2f::closest_distance_between_line_and_point(start_cm, end_cm, circle.center_pos_cm);
+            margin_new = (dist_cm * 0.01f) - (circle.radius + fence_margin);
+        }
+        if (!margin_updated || (margin_new < margin)) {
+            margin_updated = true;
+            margin = margin_new;
+        }
+    }
+
+    return margin_updated;
+}
+
+#endif  // AP_OAPATHPLANNER_BENDYRULER_ENABLED
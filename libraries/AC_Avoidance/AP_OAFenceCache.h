@@ -0,0 +1,115 @@
+#pragma once
+
+#include "AC_Avoidance_config.h"
+
+#if AP_OAPATHPLANNER_BENDYRULER_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+ * Copy of the inclusion and exclusion polygons and circles used by BendyRuler to
+ * calculate the margin between a path and the fence.
+ * The copy is only rebuilt when the fence is reloaded.  Each polygon's edges are held
+ * in a bounding volume hierarchy so only edges near a path need to be checked
+ */
+class AP_OAFenceCache {
+public:
+    AP_OAFenceCache() {}
+    ~AP_OAFenceCache();
+
+    CLASS_NO_COPY(AP_OAFenceCache);  /* Do not allow copies */
+
+    // rebuild from the fence if it has been reloaded since the last build
+    // returns true if the cache holds the latest fence
+    bool update();
+
+    // returns true if the cache holds the latest fence
+    bool valid() const { return _valid; }
+
+    // build from polygons and circles provided by the caller
+    // points are offsets in cm from EKF origin in NE frame, radius is in meters
+    // returns false on allocation failure in which case the cache is empty and invalid
+    bool begin_build(uint8_t num_polygons, uint16_t total_points, uint8_t num_circles);
+    bool add_polygon(const Vector2f *points, uint16_t num_points, bool inclusion);
+    bool add_circle(const Vector2f &center_pos_cm, float radius, bool inclusion);
+    void end_build();
+
+    // calculate minimum distance (in meters) between a path and all inclusion and exclusion polygons and circles
+    // start and end are offsets in cm from EKF origin in NE frame, fence_margin is in meters
+    // on success returns true and updates margin
+    bool calc_margin(const Vector2f &start_cm, const Vector2f &end_cm, float fence_margin, float &margin) const;
+
+private:
+
+    struct Polygon {
+        uint16_t first_point;   // index of first point in _points
+        uint16_t num_points;    // number of points as provided by the fence
+        uint16_t num_edges;     // number of edges including the closing edge
+        uint16_t root;          // index of top node of edge hierarchy in _nodes
+        bool inclusion;         // true if inclusion polygon
+    };
+
+    struct Node {
+        Vector2f min;           // bounding box of all edges below this node
+        Vector2f max;
+        uint16_t first;         // leaf: first index into _edges, otherwise: index of first of two child nodes
+        uint16_t count;         // leaf: number of edges, otherwise: zero
+    };
+
+    struct Circle {
+        Vector2f center_pos_cm; // offset in cm from EKF origin in NE frame
+        float radius;           // radius in meters
+        bool inclusion;         // true if inclusion circle
+    };
+
+    // release all memory
+    void clear();
+
+    // build edge hierarchy for a polygon
+    void build_hierarchy(Polygon &poly);
+
+    // move edges so the nth (from first) edge is in its sorted position by centre along one axis
+    void select_edges(uint16_t first, uint16_t count, uint16_t nth, bool axis_x);
+
+    // sum of the edge's end points along one axis
+    float edge_centre(uint16_t edge, bool axis_x) const;
+
+    // squared distance between a node's bounding box and a rectangle, zero if they overlap
+    static float box_distance_sq(const Node &node, const Vector2f &rect_min, const Vector2f &rect_max);
+
+    // distance between a path and a polygon's edges as calculated by Polygon_closest_distance_line
+    // returns false if the path does not cross the polygon and no edge is closer than sqrtf(max_dist_sq)
+    bool polygon_distance(const Polygon &poly, const Vector2f &p1, const Vector2f &p2, float max_dist_sq, float &dist) const;
+
+    // update which polygons contain the start of the path, paths checked one after another usually have the same start
+    void update_origin(const Vector2f &start_cm) const;
+
+    Vector2f *_points = nullptr;        // polygon points with the first point repeated after the last
+    uint16_t _num_points = 0;           // number of points
+    uint16_t _max_points = 0;           // number of points allocated
+    uint16_t *_edges = nullptr;         // index of each edge's first point in _points, ordered by hierarchy
+    uint16_t _num_edges = 0;            // number of edges
+    Node *_nodes = nullptr;             // edge hierarchy of all polygons
+    uint16_t _num_nodes = 0;            // number of nodes
+    uint16_t _max_nodes = 0;            // number of nodes allocated
+    Polygon *_polygons = nullptr;       // polygons
+    uint8_t _num_polygons = 0;          // number of polygons
+    uint8_t _max_polygons = 0;          // number of polygons allocated
+    Circle *_circles = nullptr;         // circles
+    uint8_t _num_circles = 0;           // number of circles
+    uint8_t _max_circles = 0;           // number of circles allocated
+    bool _valid = false;                // true if the cache holds the latest fence
+
+    // which polygons the most recent path started outside of
+    bool *_origin_outside = nullptr;
+    mutable Vector2f _origin_cm;
+    mutable bool _origin_valid = false;
+
+    // fence update times when the cache was built
+    uint32_t _inclusion_polygon_update_ms = 0;
+    uint32_t _exclusion_polygon_update_ms = 0;
+    uint32_t _exclusion_circle_update_ms = 0;
+};
+
+#endif  // AP_OAPATHPLANNER_BENDYRULER_ENABLED
@@ -0,0 +1,276 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AC_Avoidance_config.h"
+
+#if AP_OADATABASE_ENABLED
+
+#include "AP_OASpatialGrid.h"
+
+#define OA_SPATIALGRID_NODE_NOTSET          UINT16_MAX  // end of bucket or free list
+#define OA_SPATIALGRID_NODES_PER_ITEM       4           // average number of cells an object may cover before objects are held in the oversized list
+#define OA_SPATIALGRID_MAX_CELLS_PER_ITEM   16          // objects covering more cells than this are held in the oversized list
+#define OA_SPATIALGRID_BUCKETS_MIN          16          // minimum number of buckets
+
+AP_OASpatialGrid::~AP_OASpatialGrid()
+{
+    delete[] _buckets;
+    delete[] _nodes;
+    delete[] _oversized;
+}
+
+// allocate index for up to max_items objects using cells of cell_size
+// returns false on allocation failure in which case queries return all objects
+bool AP_OASpatialGrid::init(uint16_t max_items, float cell_size)
+{
+    if ((max_items == 0) || !is_positive(cell_size)) {
+        return false;
+    }
+
+    // at least one bucket per object
+    uint32_t num_buckets = OA_SPATIALGRID_BUCKETS_MIN;
+    while (num_buckets < max_items) {
+        num_buckets *= 2;
+    }
+    const uint32_t num_nodes = MIN(uint32_t(max_items) * OA_SPATIALGRID_NODES_PER_ITEM, UINT16_MAX - 1U);
+
+    _buckets = NEW_NOTHROW uint16_t[num_buckets];
+    _nodes = NEW_NOTHROW Node[num_nodes];
+    _oversized = NEW_NOTHROW uint16_t[max_items];
+    if ((_buckets == nullptr) || (_nodes == nullptr) || (_oversized == nullptr)) {
+        delete[] _buckets;
+        delete[] _nodes;
+        delete[] _oversized;
+        _buckets = nullptr;
+        _nodes = nullptr;
+        _oversized = nullptr;
+        return false;
+    }
+    _num_buckets = num_buckets;
+    _num_nodes = num_nodes;
+    _cell_size = cell_size;
+    clear();
+    return true;
+}
+
+// remove all objects
+void AP_OASpatialGrid::clear()
+{
+    if (!healthy()) {
+        return;
+    }
+    for (uint16_t i = 0; i < _num_buckets; i++) {
+        _buckets[i] = OA_SPATIALGRID_NODE_NOTSET;
+    }
+    for (uint16_t i = 0; i < _num_nodes; i++) {
+        _nodes[i].next = (i + 1 < _num_nodes) ? i + 1 : OA_SPATIALGRID_NODE_NOTSET;
+    }
+    _free_node = 0;
+    _free_count = _num_nodes;
+    _oversized_count = 0;
+}
+
+// range of cells covered by a rectangle
+void AP_OASpatialGrid::cell_range(const Vector2f &rect_min, const Vector2f &rect_max, int32_t &x_min, int32_t &x_max, int32_t &y_min, int32_t &y_max) const
+{
+    const float limit = INT32_MAX / 2;
+    x_min = constrain_float(floorf(rect_min.x / _cell_size), -limit, limit);
+    x_max = constrain_float(floorf(rect_max.x / _cell_size), -limit, limit);
+    y_min = constrain_float(floorf(rect_min.y / _cell_size), -limit, limit);
+    y_max = constrain_float(floorf(rect_max.y / _cell_size), -limit, limit);
+}
+
+// bucket holding a cell
+uint16_t AP_OASpatialGrid::bucket(int32_t x, int32_t y) const
+{
+    const uint32_t hash = (uint32_t(x) * 73856093U) ^ (uint32_t(y) * 19349663U);
+    return hash & (_num_buckets - 1);
+}
+
+// returns true if object is held in the oversized list (i.e. does not fit in cells)
+bool AP_OASpatialGrid::oversized(const Vector2f &pos, float radius) const
+{
+    int32_t x_min, x_max, y_min, y_max;
+    cell_range(pos - Vector2f{radius, radius}, pos + Vector2f{radius, radius}, x_min, x_max, y_min, y_max);
+    const int64_t num_cells = int64_t(x_max - x_min + 1) * (y_max - y_min + 1);
+    return (num_cells > OA_SPATIALGRID_MAX_CELLS_PER_ITEM) || (num_cells > _free_count);
+}
+
+// find object in oversized list, returns true on success and updates idx
+bool AP_OASpatialGrid::find_oversized(uint16_t index, uint16_t &idx) const
+{
+    for (uint16_t i = 0; i < _oversized_count; i++) {
+        if (_oversized[i] == index) {
+            idx = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// add object with given array index
+void AP_OASpatialGrid::add(uint16_t index, const Vector2f &pos, float radius)
+{
+    if (!healthy()) {
+        return;
+    }
+
+    // objects which cover too many cells are always checked
+    if (oversized(pos, radius)) {
+        _oversized[_oversized_count++] = index;
+        return;
+    }
+
+    // add to bucket of each cell covered
+    int32_t x_min, x_max, y_min, y_max;
+    cell_range(pos - Vector2f{radius, radius}, pos + Vector2f{radius, radius}, x_min, x_max, y_min, y_max);
+    for (int32_t x = x_min; x <= x_max; x++) {
+        for (int32_t y = y_min; y <= y_max; y++) {
+            const uint16_t b = bucket(x, y);
+            const uint16_t node = _free_node;
+            _free_node = _nodes[node].next;
+            _free_count--;
+            _nodes[node] = {index, _buckets[b]};
+            _buckets[b] = node;
+        }
+    }
+}
+
+// remove object with given array index
+void AP_OASpatialGrid::remove(uint16_t index, const Vector2f &pos, float radius)
+{
+    if (!healthy()) {
+        return;
+    }
+
+    uint16_t idx;
+    if (find_oversized(index, idx)) {
+        _oversized[idx] = _oversized[--_oversized_count];
+        return;
+    }
+
+    // remove one node from the bucket of each cell covered
+    int32_t x_min, x_max, y_min, y_max;
+    cell_range(pos - Vector2f{radius, radius}, pos + Vector2f{radius, radius}, x_min, x_max, y_min, y_max);
+    for (int32_t x = x_min; x <= x_max; x++) {
+        for (int32_t y = y_min; y <= y_max; y++) {
+            uint16_t *link = &_buckets[bucket(x, y)];
+            while (*link != OA_SPATIALGRID_NODE_NOTSET) {
+                const uint16_t node = *link;
+                if (_nodes[node].index == index) {
+                    *link = _nodes[node].next;
+                    _nodes[node].next = _free_node;
+                    _free_node = node;
+                    _free_count++;
+                    break;
+                }
+                link = &_nodes[node].next;
+            }
+        }
+    }
+}
+
+// change the array index of an object
+void AP_OASpatialGrid::move(uint16_t from, uint16_t to, const Vector2f &pos, float radius)
+{
+    if (!healthy()) {
+        return;
+    }
+
+    uint16_t idx;
+    if (find_oversized(from, idx)) {
+        _oversized[idx] = to;
+        return;
+    }
+
+    // renumber one node in the bucket of each cell covered
+    int32_t x_min, x_max, y_min, y_max;
+    cell_range(pos - Vector2f{radius, radius}, pos + Vector2f{radius, radius}, x_min, x_max, y_min, y_max);
+    for (int32_t x = x_min; x <= x_max; x++) {
+        for (int32_t y = y_min; y <= y_max; y++) {
+            for (uint16_t node = _buckets[bucket(x, y)]; node != OA_SPATIALGRID_NODE_NOTSET; node = _nodes[node].next) {
+                if (_nodes[node].index == from) {
+                    _nodes[node].index = to;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// start query for objects which may overlap the rectangle from rect_min to rect_max
+// num_items is the number of objects in the array, all of which are returned if the rectangle covers many cells
+void AP_OASpatialGrid::begin_query(Query &q, const Vector2f &rect_min, const Vector2f &rect_max, uint16_t num_items) const
+{
+    // when returning all objects node is used as the next array index
+    q.all_count = num_items;
+    q.oversized_idx = 0;
+    q.node = 0;
+    q.all = !healthy();
+    if (q.all) {
+        return;
+    }
+
+    cell_range(rect_min, rect_max, q.x_min, q.x_max, q.y_min, q.y_max);
+
+    // checking every object is quicker than visiting more cells than there are buckets
+    const int64_t num_cells = int64_t(q.x_max - q.x_min + 1) * (q.y_max - q.y_min + 1);
+    if (num_cells > _num_buckets) {
+        q.all = true;
+        return;
+    }
+    q.x = q.x_min;
+    q.y = q.y_min;
+    q.node = _buckets[bucket(q.x, q.y)];
+}
+
+// get next object's array index from query, returns false when there are no more
+bool AP_OASpatialGrid::next(Query &q, uint16_t &index) const
+{
+    if (q.all) {
+        if (q.node < q.all_count) {
+            index = q.node++;
+            return true;
+        }
+        return false;
+    }
+
+    while (true) {
+        if (q.node != OA_SPATIALGRID_NODE_NOTSET) {
+            index = _nodes[q.node].index;
+            q.node = _nodes[q.node].next;
+            return true;
+        }
+        // move to next cell
+        if (q.y < q.y_max) {
+            q.y++;
+        } else if (q.x < q.x_max) {
+            q.x++;
+            q.y = q.y_min;
+        } else {
+            break;
+        }
+        q.node = _buckets[bucket(q.x, q.y)];
+    }
+
+    // objects held outside of cells
+    if (q.oversized_idx < _oversized_count) {
+        index = _oversized[q.oversized_idx++];
+        return true;
+    }
+    return false;
+}
+
+#endif  // AP_OADATABASE_ENABLED
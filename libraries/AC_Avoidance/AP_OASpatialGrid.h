@@ -0,0 +1,89 @@
+#pragma once
+
+#include "AC_Avoidance_config.h"
+
+#if AP_OADATABASE_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+ * Spatial index of circular objects held in an array, used by AP_OADatabase so
+ * queries only check objects near a given area.
+ * The horizontal plane is divided into square cells which are hashed into a fixed
+ * number of buckets.  Each object is added to the bucket of every cell its circle
+ * overlaps.  Objects covering many cells are held in a separate list which is
+ * always checked
+ */
+class AP_OASpatialGrid {
+public:
+    AP_OASpatialGrid() {}
+    ~AP_OASpatialGrid();
+
+    CLASS_NO_COPY(AP_OASpatialGrid);  /* Do not allow copies */
+
+    // allocate index for up to max_items objects using cells of cell_size
+    // returns false on allocation failure in which case queries return all objects
+    bool init(uint16_t max_items, float cell_size);
+
+    // returns true if index has been allocated
+    bool healthy() const { return _buckets != nullptr; }
+
+    // remove all objects
+    void clear();
+
+    // add, remove or renumber object with given array index
+    // pos and radius must be the same as when the object was added
+    void add(uint16_t index, const Vector2f &pos, float radius);
+    void remove(uint16_t index, const Vector2f &pos, float radius);
+    void move(uint16_t from, uint16_t to, const Vector2f &pos, float radius);
+
+    // state of a query for objects overlapping a rectangle
+    struct Query {
+        int32_t x_min, x_max, y_min, y_max;     // range of cells
+        int32_t x, y;                           // current cell
+        uint16_t node;                          // next node in current cell's bucket
+        uint16_t oversized_idx;                 // next index into oversized list
+        uint16_t all_count;                     // number of objects if returning all objects
+        bool all;                               // true if all objects are returned
+    };
+
+    // start query for objects which may overlap the rectangle from rect_min to rect_max
+    // num_items is the number of objects in the array, all of which are returned if the rectangle covers many cells
+    void begin_query(Query &q, const Vector2f &rect_min, const Vector2f &rect_max, uint16_t num_items) const;
+
+    // get next object's array index from query, returns false when there are no more
+    // objects may be returned more than once and may not overlap the rectangle
+    bool next(Query &q, uint16_t &index) const;
+
+private:
+
+    struct Node {
+        uint16_t index;     // object's array index
+        uint16_t next;      // next node in bucket or free list
+    };
+
+    // range of cells covered by a rectangle
+    void cell_range(const Vector2f &rect_min, const Vector2f &rect_max, int32_t &x_min, int32_t &x_max, int32_t &y_min, int32_t &y_max) const;
+
+    // bucket holding a cell
+    uint16_t bucket(int32_t x, int32_t y) const;
+
+    // returns true if object is held in the oversized list (i.e. does not fit in cells)
+    bool oversized(const Vector2f &pos, float radius) const;
+
+    // find object in oversized list, returns true on success and updates idx
+    bool find_oversized(uint16_t index, uint16_t &idx) const;
+
+    uint16_t *_buckets = nullptr;       // first node of each bucket
+    uint16_t _num_buckets;              // number of buckets, always a power of two
+    Node *_nodes = nullptr;             // pool of nodes
+    uint16_t _num_nodes;                // number of nodes in pool
+    uint16_t _free_node;                // first node in free list
+    uint16_t _free_count;               // number of nodes in free list
+    uint16_t *_oversized = nullptr;     // array indexes of objects held outside of cells
+    uint16_t _oversized_count;          // number of objects in oversized list
+    float _cell_size;                   // width of square cell
+};
+
+#endif  // AP_OADATABASE_ENABLED
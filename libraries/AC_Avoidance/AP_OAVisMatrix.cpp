@@ -0,0 +1,235 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AC_Avoidance_config.h"
+
+#if AP_OAPATHPLANNER_DIJKSTRA_ENABLED
+
+#include "AP_OAVisMatrix.h"
+
+#include <string.h>
+
+#define OA_VISMATRIX_INDEX_NOTSET   UINT16_MAX  // index used to indicate a point was not in the previous build
+
+// constructor initialises expanding array to use 8 elements per chunk
+AP_OAVisMatrix::AP_OAVisMatrix() :
+    _changed(8)
+{
+}
+
+AP_OAVisMatrix::~AP_OAVisMatrix()
+{
+    end_update();
+    clear();
+}
+
+// number of bytes required to hold all pairs of num_points
+uint32_t AP_OAVisMatrix::num_bytes(uint16_t num_points)
+{
+    const uint32_t num_pairs = (uint32_t(num_points) * (num_points - 1)) / 2;
+    return (num_pairs + 7) / 8;
+}
+
+// bit index of the pair i,j. Pairs are stored as a lower triangle so
+// the pairs of the highest point are at the end
+uint32_t AP_OAVisMatrix::bit_index(uint16_t i, uint16_t j)
+{
+    if (i > j) {
+        const uint16_t tmp = i;
+        i = j;
+        j = tmp;
+    }
+    return (uint32_t(j) * (j - 1)) / 2 + i;
+}
+
+// start a new build for num_points points, all pairs are initially not visible
+// returns false on allocation failure in which case the matrix is empty
+bool AP_OAVisMatrix::begin_update(uint16_t num_points, bool reuse)
+{
+    // release any build which was not finished
+    end_update();
+
+    // keep previous build to carry results over from
+    if (reuse && (_num_points > 1)) {
+        _prev_bits = _bits;
+        _prev_points = _points;
+        _prev_num_points = _num_points;
+        _bits = nullptr;
+        _points = nullptr;
+        _num_points = 0;
+    }
+    clear();
+
+    if (num_points == 0) {
+        end_update();
+        return true;
+    }
+
+    const uint32_t bytes = MAX(num_bytes(num_points), 1U);
+    _bits = NEW_NOTHROW uint8_t[bytes];
+    _points = NEW_NOTHROW Vector2f[num_points];
+    if ((_bits == nullptr) || (_points == nullptr)) {
+        end_update();
+        clear();
+        return false;
+    }
+    memset(_bits, 0, bytes);
+    _num_points = num_points;
+
+    if (_prev_num_points == 0) {
+        return true;
+    }
+
+    _prev_index = NEW_NOTHROW uint16_t[num_points];
+    if (_prev_index == nullptr) {
+        // build without reuse
+        end_update();
+        return true;
+    }
+    for (uint16_t i = 0; i < num_points; i++) {
+        _prev_index[i] = OA_VISMATRIX_INDEX_NOTSET;
+    }
+    _prev_index_next = 0;
+    return true;
+}
+
+// set the position of a point, all points should be set after begin_update
+void AP_OAVisMatrix::set_point(uint16_t i, const Vector2f &point)
+{
+    if (i >= _num_points) {
+        return;
+    }
+    _points[i] = point;
+
+    if (_prev_index == nullptr) {
+        return;
+    }
+
+    // match point with the previous build. Points are usually in the same
+    // order as before with some added or removed so start looking after the
+    // last match
+    _prev_index[i] = OA_VISMATRIX_INDEX_NOTSET;
+    for (uint16_t k = 0; k < _prev_num_points; k++) {
+        const uint16_t idx = (_prev_index_next + k) % _prev_num_points;
+        if (_prev_points[idx] == point) {
+            _prev_index[i] = idx;
+            _prev_index_next = idx + 1;
+            break;
+        }
+    }
+}
+
+// add an area in which the fence has changed since the previous build
+void AP_OAVisMatrix::add_changed_area(const Area &area)
+{
+    if (_prev_index == nullptr) {
+        // nothing will be carried over
+        return;
+    }
+    if (!_changed.expand_to_hold(_num_changed + 1)) {
+        // without the area results can't be carried over
+        end_update();
+        return;
+    }
+    _changed[_num_changed++] = area;
+}
+
+// returns true if the segment between a and b may be affected by a changed area
+bool AP_OAVisMatrix::in_changed_area(const Vector2f &a, const Vector2f &b) const
+{
+    const Vector2f seg_min {MIN(a.x, b.x), MIN(a.y, b.y)};
+    const Vector2f seg_max {MAX(a.x, b.x), MAX(a.y, b.y)};
+    for (uint16_t i = 0; i < _num_changed; i++) {
+        const Area &area = _changed[i];
+        if ((seg_max.x >= area.min.x) && (seg_min.x <= area.max.x) &&
+            (seg_max.y >= area.min.y) && (seg_min.y <= area.max.y)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// returns true if the visibility of points i and j was carried over from
+// the previous build in which case visible is updated
+bool AP_OAVisMatrix::carried_over(uint16_t i, uint16_t j, bool &visible) const
+{
+    if ((_prev_index == nullptr) || (i == j)) {
+        return false;
+    }
+    const uint16_t prev_i = _prev_index[i];
+    const uint16_t prev_j = _prev_index[j];
+    if ((prev_i == OA_VISMATRIX_INDEX_NOTSET) || (prev_j == OA_VISMATRIX_INDEX_NOTSET)) {
+        return false;
+    }
+    if (prev_i == prev_j) {
+        // points at the same position matched the same previous point
+        return false;
+    }
+    if (in_changed_area(_points[i], _points[j])) {
+        return false;
+    }
+    const uint32_t idx = bit_index(prev_i, prev_j);
+    visible = (_prev_bits[idx / 8] & (1U << (idx % 8))) != 0;
+    return true;
+}
+
+// set whether points i and j are visible from each other
+void AP_OAVisMatrix::set_visible(uint16_t i, uint16_t j, bool visible)
+{
+    if ((i == j) || (i >= _num_points) || (j >= _num_points)) {
+        return;
+    }
+    const uint32_t idx = bit_index(i, j);
+    if (visible) {
+        _bits[idx / 8] |= (1U << (idx % 8));
+    } else {
+        _bits[idx / 8] &= ~(1U << (idx % 8));
+    }
+}
+
+// finish build, releasing the previous build's results
+void AP_OAVisMatrix::end_update()
+{
+    delete[] _prev_bits;
+    delete[] _prev_points;
+    delete[] _prev_index;
+    _prev_bits = nullptr;
+    _prev_points = nullptr;
+    _prev_index = nullptr;
+    _prev_num_points = 0;
+    _num_changed = 0;
+}
+
+// returns true if points i and j are visible from each other
+bool AP_OAVisMatrix::visible(uint16_t i, uint16_t j) const
+{
+    if (i == j) {
+        return false;
+    }
+    const uint32_t idx = bit_index(i, j);
+    return (_bits[idx / 8] & (1U << (idx % 8))) != 0;
+}
+
+// release all memory
+void AP_OAVisMatrix::clear()
+{
+    delete[] _bits;
+    delete[] _points;
+    _bits = nullptr;
+    _points = nullptr;
+    _num_points = 0;
+}
+
+#endif  // AP_OAPATHPLANNER_DIJKSTRA_ENABLED
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "AC_Avoidance_config.h"
+
+#if AP_OAPATHPLANNER_DIJKSTRA_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Common/AP_ExpandingArray.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+ * Visibility between all pairs of fence points held as one bit per pair.
+ * When the points or fence change the results for pairs whose points have
+ * not moved and whose segment is clear of the changed parts of the fence
+ * are carried over from the previous build
+ */
+class AP_OAVisMatrix {
+public:
+    AP_OAVisMatrix();
+    ~AP_OAVisMatrix();
+
+    CLASS_NO_COPY(AP_OAVisMatrix);  /* Do not allow copies */
+
+    // rectangular area (in the same units as the points) in which the fence has changed
+    struct Area {
+        Vector2f min;
+        Vector2f max;
+    };
+
+    // start a new build for num_points points, all pairs are initially not visible
+    // if reuse is true, results from the previous build are carried over for pairs
+    // whose points have not moved and whose segment's bounding box does not overlap
+    // any of the changed areas
+    // returns false on allocation failure in which case the matrix is empty
+    bool begin_update(uint16_t num_points, bool reuse);
+
+    // set the position of a point, all points should be set after begin_update
+    void set_point(uint16_t i, const Vector2f &point);
+
+    // add an area in which the fence has changed since the previous build
+    // should be called after begin_update and before any calls to carried_over
+    void add_changed_area(const Area &area);
+
+    // returns true if the visibility of points i and j was carried over from
+    // the previous build in which case visible is updated
+    bool carried_over(uint16_t i, uint16_t j, bool &visible) const;
+
+    // set whether points i and j are visible from each other
+    void set_visible(uint16_t i, uint16_t j, bool visible);
+
+    // finish build, releasing the previous build's results
+    void end_update();
+
+    // returns true if points i and j are visible from each other
+    // Note: no protection against out-of-bounds accesses so use with num_points()
+    bool visible(uint16_t i, uint16_t j) const;
+
+    // number of points and access to them
+    uint16_t num_points() const { return _num_points; }
+    const Vector2f& point(uint16_t i) const { return _points[i]; }
+
+    // release all memory
+    void clear();
+
+private:
+
+    // number of bytes required to hold all pairs of num_points
+    static uint32_t num_bytes(uint16_t num_points);
+
+    // bit index of the pair i,j
+    static uint32_t bit_index(uint16_t i, uint16_t j);
+
+    // returns true if the segment between a and b may be affected by a changed area
+    bool in_changed_area(const Vector2f &a, const Vector2f &b) const;
+
+    uint8_t *_bits = nullptr;       // visibility with one bit per pair
+    Vector2f *_points = nullptr;    // points the visibility is for
+    uint16_t _num_points;           // number of points
+
+    // previous build, only held between begin_update and end_update
+    uint8_t *_prev_bits = nullptr;
+    Vector2f *_prev_points = nullptr;
+    uint16_t _prev_num_points;
+    uint16_t *_prev_index = nullptr;    // index of each point in the previous build, or UINT16_MAX if it is new
+    uint16_t _prev_index_next;          // index in previous build after the last matched point
+    AP_ExpandingArray<Area> _changed;   // areas of fence which have changed
+    uint16_t _num_changed;              // number of changed areas
+};
+
+#endif  // AP_OAPATHPLANNER_DIJKSTRA_ENABLED
@@ -0,0 +1,165 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AC_Avoidance/AP_OASpatialGrid.h>
+
+#if AP_OADATABASE_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  compare a linear scan of all obstacles against the spatial index used by
+  AP_OADatabase for the two queries it makes: finding an obstacle matching a
+  new proximity reading and finding the smallest margin between a path
+  segment and the obstacles. The number of obstacles is the benchmark
+  argument, spread over a 200m square around the vehicle as a 360 degree
+  lidar would report them
+ */
+
+#define BENCH_AREA_M        100.0f
+#define BENCH_CELL_SIZE_M   4.0f
+
+struct bench_item {
+    Vector3f pos;
+    float radius;
+};
+
+static uint32_t rand_state = 1;
+static float rand_float(float min, float max)
+{
+    rand_state = rand_state * 1664525U + 1013904223U;
+    return min + (max - min) * ((rand_state >> 8) / float(1U << 24));
+}
+
+static bench_item random_item(void)
+{
+    const float angle = rand_float(0, M_2PI);
+    const float dist = rand_float(1, BENCH_AREA_M);
+    // radius from distance using a 5 degree beam width
+    return bench_item {Vector3f{cosf(angle) * dist, sinf(angle) * dist, 0}, MAX(dist * 0.0875f, 0.01f)};
+}
+
+static bench_item *create_items(uint16_t num_items, AP_OASpatialGrid *grid)
+{
+    bench_item *items = NEW_NOTHROW bench_item[num_items];
+    if ((items == nullptr) || ((grid != nullptr) && !grid->init(num_items, BENCH_CELL_SIZE_M))) {
+        AP_HAL::panic("out of memory");
+    }
+    rand_state = 1;
+    for (uint16_t i = 0; i < num_items; i++) {
+        items[i] = random_item();
+        if (grid != nullptr) {
+            grid->add(i, items[i].pos.xy(), items[i].radius);
+        }
+    }
+    return items;
+}
+
+static bool item_match(const bench_item &a, const bench_item &b)
+{
+    return (a.pos - b.pos).length_squared() < sq(MAX(a.radius, b.radius));
+}
+
+static void BM_OADatabaseMatchLinear(benchmark::State& state)
+{
+    const uint16_t num_items = state.range(0);
+    bench_item *items = create_items(num_items, nullptr);
+
+    while (state.KeepRunning()) {
+        const bench_item item = random_item();
+        uint16_t index = UINT16_MAX;
+        for (uint16_t i = 0; i < num_items; i++) {
+            if (item_match(items[i], item)) {
+                index = i;
+                break;
+            }
+        }
+        gbenchmark_escape(&index);
+    }
+    delete[] items;
+}
+
+static void BM_OADatabaseMatchGrid(benchmark::State& state)
+{
+    const uint16_t num_items = state.range(0);
+    AP_OASpatialGrid *grid = NEW_NOTHROW AP_OASpatialGrid();
+    bench_item *items = create_items(num_items, grid);
+
+    while (state.KeepRunning()) {
+        const bench_item item = random_item();
+        const Vector2f r {item.radius, item.radius};
+        AP_OASpatialGrid::Query q;
+        grid->begin_query(q, item.pos.xy() - r, item.pos.xy() + r, num_items);
+        uint16_t index = UINT16_MAX;
+        uint16_t i;
+        while (grid->next(q, i)) {
+            if ((i < index) && item_match(items[i], item)) {
+                index = i;
+            }
+        }
+        gbenchmark_escape(&index);
+    }
+    delete[] items;
+    delete grid;
+}
+
+static void BM_OADatabaseMarginLinear(benchmark::State& state)
+{
+    const uint16_t num_items = state.range(0);
+    bench_item *items = create_items(num_items, nullptr);
+
+    while (state.KeepRunning()) {
+        // short segment from near the vehicle as BendyRuler checks
+        const Vector3f start {rand_float(-2, 2), rand_float(-2, 2), 0};
+        const Vector3f end = start + Vector3f{rand_float(-10, 10), rand_float(-10, 10), 0};
+        float margin = FLT_MAX;
+        for (uint16_t i = 0; i < num_items; i++) {
+            margin = MIN(margin, Vector3f::closest_distance_between_line_and_point(start, end, items[i].pos) - items[i].radius);
+        }
+        gbenchmark_escape(&margin);
+    }
+    delete[] items;
+}
+
+static void BM_OADatabaseMarginGrid(benchmark::State& state)
+{
+    const uint16_t num_items = state.range(0);
+    AP_OASpatialGrid *grid = NEW_NOTHROW AP_OASpatialGrid();
+    bench_item *items = create_items(num_items, grid);
+
+    while (state.KeepRunning()) {
+        const Vector3f start {rand_float(-2, 2), rand_float(-2, 2), 0};
+        const Vector3f end = start + Vector3f{rand_float(-10, 10), rand_float(-10, 10), 0};
+        const Vector2f seg_min {MIN(start.x, end.x), MIN(start.y, end.y)};
+        const Vector2f seg_max {MAX(start.x, end.x), MAX(start.y, end.y)};
+
+        // same search as AP_OADatabase::calc_margin_from_items
+        float margin = FLT_MAX;
+        float search_dist = BENCH_CELL_SIZE_M;
+        while (true) {
+            AP_OASpatialGrid::Query q;
+            const Vector2f search_margin {search_dist, search_dist};
+            grid->begin_query(q, seg_min - search_margin, seg_max + search_margin, num_items);
+            uint16_t i;
+            while (grid->next(q, i)) {
+                margin = MIN(margin, Vector3f::closest_distance_between_line_and_point(start, end, items[i].pos) - items[i].radius);
+            }
+            if (q.all || (margin <= search_dist)) {
+                break;
+            }
+            search_dist *= 2.0f;
+        }
+        gbenchmark_escape(&margin);
+    }
+    delete[] items;
+    delete grid;
+}
+
+BENCHMARK(BM_OADatabaseMatchLinear)->Arg(100)->Arg(1000)->Arg(5000);
+BENCHMARK(BM_OADatabaseMatchGrid)->Arg(100)->Arg(1000)->Arg(5000);
+BENCHMARK(BM_OADatabaseMarginLinear)->Arg(100)->Arg(1000)->Arg(5000);
+BENCHMARK(BM_OADatabaseMarginGrid)->Arg(100)->Arg(1000)->Arg(5000);
+#endif
+
+BENCHMARK_MAIN()
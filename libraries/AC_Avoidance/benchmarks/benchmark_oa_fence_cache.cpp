@@ -0,0 +1,109 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AC_Avoidance/AP_OAFenceCache.h>
+
+#if AP_OAPATHPLANNER_BENDYRULER_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  calculate the margin between BendyRuler's candidate paths and a
+  synthetic fence of one inclusion polygon and four exclusion polygons,
+  either directly from the polygons as BendyRuler did or using
+  AP_OAFenceCache. Each iteration checks the 35 bearings BendyRuler
+  searches from one location. The number of points in each polygon is
+  the benchmark argument
+ */
+
+#define BENCH_FENCE_RADIUS_CM       100000.0f
+#define BENCH_EXCLUSION_RADIUS_CM   5000.0f
+#define BENCH_LOOKAHEAD_CM          1500.0f
+#define BENCH_FENCE_MARGIN          2.0f
+#define BENCH_NUM_POLYGONS          5
+#define BENCH_NUM_BEARINGS          35
+
+struct bench_fence {
+    Vector2f points[BENCH_NUM_POLYGONS][250];
+    uint16_t num_points;
+};
+
+static void create_fence(bench_fence &fence, uint16_t num_points)
+{
+    const Vector2f centres[BENCH_NUM_POLYGONS] {{0, 0}, {20000, 20000}, {-20000, 20000}, {20000, -20000}, {-20000, -20000}};
+    fence.num_points = MIN(num_points, ARRAY_SIZE(fence.points[0]));
+    for (uint8_t i = 0; i < BENCH_NUM_POLYGONS; i++) {
+        const float radius = (i == 0) ? BENCH_FENCE_RADIUS_CM : BENCH_EXCLUSION_RADIUS_CM;
+        for (uint16_t j = 0; j < fence.num_points; j++) {
+            const float angle = M_2PI * j / fence.num_points;
+            fence.points[i][j] = centres[i] + Vector2f{cosf(angle), sinf(angle)} * radius;
+        }
+    }
+}
+
+// candidate path ends around a location between the exclusion polygons
+static void bench_paths(Vector2f &start, Vector2f ends[BENCH_NUM_BEARINGS])
+{
+    start = Vector2f{5000, 1000};
+    for (uint8_t i = 0; i < BENCH_NUM_BEARINGS; i++) {
+        const float angle = radians(i * 10.0f);
+        ends[i] = start + Vector2f{cosf(angle), sinf(angle)} * BENCH_LOOKAHEAD_CM;
+    }
+}
+
+static void BM_OAFenceMarginDirect(benchmark::State& state)
+{
+    bench_fence fence {};
+    create_fence(fence, state.range(0));
+    Vector2f start;
+    Vector2f ends[BENCH_NUM_BEARINGS];
+    bench_paths(start, ends);
+
+    while (state.KeepRunning()) {
+        for (uint8_t b = 0; b < BENCH_NUM_BEARINGS; b++) {
+            // same calculation as AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_polygons
+            float margin = FLT_MAX;
+            for (uint8_t i = 0; i < BENCH_NUM_POLYGONS; i++) {
+                const bool outside = Polygon_outside(start, fence.points[i], fence.num_points);
+                const float sign = ((i == 0) != outside) ? 1.0f : -1.0f;
+                const float margin_new = (sign * Polygon_closest_distance_line(fence.points[i], fence.num_points, start, ends[b]) * 0.01f) - BENCH_FENCE_MARGIN;
+                margin = MIN(margin, margin_new);
+            }
+            gbenchmark_escape(&margin);
+        }
+    }
+}
+
+static void BM_OAFenceMarginCache(benchmark::State& state)
+{
+    bench_fence fence {};
+    create_fence(fence, state.range(0));
+    Vector2f start;
+    Vector2f ends[BENCH_NUM_BEARINGS];
+    bench_paths(start, ends);
+
+    AP_OAFenceCache *cache = NEW_NOTHROW AP_OAFenceCache();
+    if ((cache == nullptr) || !cache->begin_build(BENCH_NUM_POLYGONS, BENCH_NUM_POLYGONS * fence.num_points, 0)) {
+        AP_HAL::panic("out of memory");
+    }
+    for (uint8_t i = 0; i < BENCH_NUM_POLYGONS; i++) {
+        cache->add_polygon(fence.points[i], fence.num_points, i == 0);
+    }
+    cache->end_build();
+
+    while (state.KeepRunning()) {
+        for (uint8_t b = 0; b < BENCH_NUM_BEARINGS; b++) {
+            float margin;
+            cache->calc_margin(start, ends[b], BENCH_FENCE_MARGIN, margin);
+            gbenchmark_escape(&margin);
+        }
+    }
+    delete cache;
+}
+
+BENCHMARK(BM_OAFenceMarginDirect)->Arg(16)->Arg(64)->Arg(250);
+BENCHMARK(BM_OAFenceMarginCache)->Arg(16)->Arg(64)->Arg(250);
+#endif
+
+BENCHMARK_MAIN()
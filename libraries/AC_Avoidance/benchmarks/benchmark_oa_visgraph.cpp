@@ -0,0 +1,148 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AC_Avoidance/AP_OAVisMatrix.h>
+
+#if AP_OAPATHPLANNER_DIJKSTRA_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  build the fence point visibility matrix used by Dijkstra's for a
+  synthetic fence of one large inclusion polygon and a grid of square
+  exclusion polygons, either from scratch or after moving one exclusion
+  polygon. The number of fence points is the benchmark argument
+ */
+
+#define BENCH_FENCE_RADIUS_CM   100000.0f
+#define BENCH_SQUARE_SIZE_CM    2000.0f
+#define BENCH_MARGIN_CM         200.0f
+
+struct bench_fence {
+    Vector2f inclusion[128];
+    uint16_t num_inclusion;
+    Vector2f exclusion[32][4];
+    uint16_t num_exclusion;
+    Vector2f points[254];
+    uint16_t num_points;
+};
+
+// place square exclusion polygon i, offset moves it east
+static void place_square(bench_fence &fence, uint16_t i, float offset)
+{
+    const uint16_t row = i / 6;
+    const uint16_t col = i % 6;
+    const Vector2f center {(row - 2.5f) * 20000.0f, (col - 2.5f) * 20000.0f + offset};
+    const float h = BENCH_SQUARE_SIZE_CM * 0.5f;
+    const Vector2f corners[] {{-h, -h}, {-h, h}, {h, h}, {h, -h}};
+    for (uint8_t j = 0; j < 4; j++) {
+        fence.exclusion[i][j] = center + corners[j];
+        // fence point is outside corner by margin
+        fence.points[fence.num_inclusion + i * 4 + j] = center + corners[j] * ((h + BENCH_MARGIN_CM) / h);
+    }
+}
+
+// half of the points on the inclusion polygon and half around exclusion polygons
+static void create_fence(bench_fence &fence, uint16_t num_points)
+{
+    fence.num_exclusion = MIN(num_points / 8U, ARRAY_SIZE(fence.exclusion));
+    fence.num_inclusion = MIN(num_points - fence.num_exclusion * 4U, ARRAY_SIZE(fence.inclusion));
+    fence.num_points = fence.num_inclusion + fence.num_exclusion * 4;
+    for (uint16_t i = 0; i < fence.num_inclusion; i++) {
+        const float angle = M_2PI * i / fence.num_inclusion;
+        const Vector2f unit {cosf(angle), sinf(angle)};
+        fence.inclusion[i] = unit * BENCH_FENCE_RADIUS_CM;
+        fence.points[i] = unit * (BENCH_FENCE_RADIUS_CM - BENCH_MARGIN_CM);
+    }
+    for (uint16_t i = 0; i < fence.num_exclusion; i++) {
+        place_square(fence, i, 0);
+    }
+}
+
+static bool intersects_fence(const bench_fence &fence, const Vector2f &seg_start, const Vector2f &seg_end)
+{
+    Vector2f intersection;
+    if (Polygon_intersects(fence.inclusion, fence.num_inclusion, seg_start, seg_end, intersection)) {
+        return true;
+    }
+    for (uint16_t i = 0; i < fence.num_exclusion; i++) {
+        if (Polygon_intersects(fence.exclusion[i], 4, seg_start, seg_end, intersection)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void build(AP_OAVisMatrix &matrix, const bench_fence &fence, bool reuse)
+{
+    for (uint16_t i = 1; i < fence.num_points; i++) {
+        for (uint16_t j = 0; j < i; j++) {
+            bool visible;
+            if (!reuse || !matrix.carried_over(i, j, visible)) {
+                visible = !intersects_fence(fence, fence.points[i], fence.points[j]);
+            }
+            matrix.set_visible(i, j, visible);
+        }
+    }
+    matrix.end_update();
+}
+
+static void begin(AP_OAVisMatrix &matrix, const bench_fence &fence, bool reuse)
+{
+    if (!matrix.begin_update(fence.num_points, reuse)) {
+        AP_HAL::panic("out of memory");
+    }
+    for (uint16_t i = 0; i < fence.num_points; i++) {
+        matrix.set_point(i, fence.points[i]);
+    }
+}
+
+static void BM_OAVisMatrixFull(benchmark::State& state)
+{
+    bench_fence fence {};
+    create_fence(fence, state.range(0));
+    AP_OAVisMatrix *matrix = NEW_NOTHROW AP_OAVisMatrix();
+
+    while (state.KeepRunning()) {
+        begin(*matrix, fence, false);
+        build(*matrix, fence, false);
+        gbenchmark_escape(matrix);
+    }
+    delete matrix;
+}
+
+static void BM_OAVisMatrixIncremental(benchmark::State& state)
+{
+    bench_fence fence {};
+    create_fence(fence, state.range(0));
+    AP_OAVisMatrix *matrix = NEW_NOTHROW AP_OAVisMatrix();
+    begin(*matrix, fence, false);
+    build(*matrix, fence, false);
+
+    // move one exclusion polygon back and forth
+    const float shift = 3000.0f;
+    float offset = 0;
+    while (state.KeepRunning()) {
+        const float h = BENCH_SQUARE_SIZE_CM * 0.5f;
+        const Vector2f old_min = fence.exclusion[0][0];
+        offset = is_zero(offset) ? shift : 0;
+        place_square(fence, 0, offset);
+        const Vector2f new_min = fence.exclusion[0][0];
+        const AP_OAVisMatrix::Area changed {
+            {MIN(old_min.x, new_min.x), MIN(old_min.y, new_min.y)},
+            {MAX(old_min.x, new_min.x) + 2*h, MAX(old_min.y, new_min.y) + 2*h}
+        };
+        begin(*matrix, fence, true);
+        matrix->add_changed_area(changed);
+        build(*matrix, fence, true);
+        gbenchmark_escape(matrix);
+    }
+    delete matrix;
+}
+
+BENCHMARK(BM_OAVisMatrixFull)->Arg(100)->Arg(175)->Arg(250);
+BENCHMARK(BM_OAVisMatrixIncremental)->Arg(100)->Arg(175)->Arg(250);
+#endif
+
+BENCHMARK_MAIN()
@@ -0,0 +1,175 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AC_Avoidance/AP_OAFenceCache.h>
+
+#if AP_OAPATHPLANNER_BENDYRULER_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  the cache's margins are compared with those calculated directly from
+  the polygons using Polygon_outside and Polygon_closest_distance_line
+  as BendyRuler did before the cache was added
+ */
+
+#define TEST_MAX_POLYGONS   8
+#define TEST_MAX_POINTS     60
+#define TEST_AREA           10000.0f    // cm
+#define TEST_PATH_LENGTH    2000.0f     // cm
+
+struct test_polygon {
+    Vector2f points[TEST_MAX_POINTS+1];
+    uint16_t num_points;
+    bool inclusion;
+};
+
+static uint32_t test_seed = 1;
+
+// random float between low and high
+static float test_rand(float low, float high)
+{
+    test_seed = test_seed * 1664525U + 1013904223U;
+    return low + (high - low) * float(test_seed >> 8) / float(1U << 24);
+}
+
+static Vector2f test_rand_point(float range)
+{
+    return Vector2f{test_rand(-range, range), test_rand(-range, range)};
+}
+
+// mostly star shaped polygons with some self intersecting ones, half of them closed by repeating the first point
+static void test_rand_polygon(test_polygon &poly)
+{
+    const Vector2f centre = test_rand_point(TEST_AREA);
+    const float radius = test_rand(500, 5000);
+    const bool star = test_rand(0, 1) < 0.8f;
+    poly.num_points = uint16_t(test_rand(3, TEST_MAX_POINTS));
+    for (uint16_t i=0; i<poly.num_points; i++) {
+        const float angle = star ? (M_2PI * (i + test_rand(0, 0.9f)) / poly.num_points) : test_rand(0, M_2PI);
+        const float r = radius * test_rand(0.2f, 1);
+        poly.points[i] = centre + Vector2f{cosf(angle) * r, sinf(angle) * r};
+    }
+    if (test_rand(0, 1) < 0.5f) {
+        poly.points[poly.num_points++] = poly.points[0];
+    }
+    poly.inclusion = test_rand(0, 1) < 0.5f;
+}
+
+static bool test_build(AP_OAFenceCache &cache, const test_polygon *polygons, uint8_t num_polygons)
+{
+    uint16_t total_points = 0;
+    for (uint8_t i=0; i<num_polygons; i++) {
+        total_points += polygons[i].num_points;
+    }
+    if (!cache.begin_build(num_polygons, total_points, 0)) {
+        return false;
+    }
+    for (uint8_t i=0; i<num_polygons; i++) {
+        if (!cache.add_polygon(polygons[i].points, polygons[i].num_points, polygons[i].inclusion)) {
+            return false;
+        }
+    }
+    cache.end_build();
+    return true;
+}
+
+// margin calculated directly from the polygons
+static bool test_margin(const test_polygon *polygons, uint8_t num_polygons, const Vector2f &start, const Vector2f &end, float fence_margin, float &margin)
+{
+    bool margin_updated = false;
+    for (uint8_t i=0; i<num_polygons; i++) {
+        const test_polygon &poly = polygons[i];
+        const bool outside = Polygon_outside(start, poly.points, poly.num_points);
+        const float sign = (poly.inclusion != outside) ? 1.0f : -1.0f;
+        const float margin_new = (sign * Polygon_closest_distance_line(poly.points, poly.num_points, start, end) * 0.01f) - fence_margin;
+        if (!margin_updated || (margin_new < margin)) {
+            margin_updated = true;
+            margin = margin_new;
+        }
+    }
+    return margin_updated;
+}
+
+// check paths from a few starts, each checked with several ends as BendyRuler does
+static void test_paths(const AP_OAFenceCache &cache, const test_polygon *polygons, uint8_t num_polygons)
+{
+    for (uint8_t i=0; i<5; i++) {
+        const Vector2f start = test_rand_point(TEST_AREA * 1.2f);
+        for (uint8_t j=0; j<10; j++) {
+            const Vector2f end = start + test_rand_point(TEST_PATH_LENGTH);
+            const float fence_margin = (j < 5) ? 0 : test_rand(0, 10);
+            float expected = 0;
+            float margin = 0;
+            const bool expected_ok = test_margin(polygons, num_polygons, start, end, fence_margin, expected);
+            ASSERT_EQ(cache.calc_margin(start, end, fence_margin, margin), expected_ok);
+            if (expected_ok) {
+                EXPECT_NEAR(margin, expected, 0.01f) << "start " << start.x << "," << start.y << " end " << end.x << "," << end.y;
+            }
+        }
+    }
+}
+
+TEST(AP_OAFenceCache, MatchesPolygonFunctions)
+{
+    AP_OAFenceCache cache;
+    test_polygon polygons[TEST_MAX_POLYGONS];
+
+    for (uint16_t build=0; build<200; build++) {
+        const uint8_t num_polygons = uint8_t(test_rand(1, TEST_MAX_POLYGONS + 1)) % (TEST_MAX_POLYGONS + 1);
+        for (uint8_t i=0; i<num_polygons; i++) {
+            test_rand_polygon(polygons[i]);
+        }
+        ASSERT_TRUE(test_build(cache, polygons, num_polygons));
+        ASSERT_TRUE(cache.valid());
+        test_paths(cache, polygons, num_polygons);
+    }
+}
+
+TEST(AP_OAFenceCache, RebuildForgetsPreviousStart)
+{
+    AP_OAFenceCache cache;
+    test_polygon polygon;
+
+    // a square around the start, then the same square moved away from it
+    const Vector2f start {0, 0};
+    const Vector2f end {100, 0};
+    polygon.num_points = 4;
+    polygon.inclusion = true;
+    polygon.points[0] = Vector2f{-1000, -1000};
+    polygon.points[1] = Vector2f{1000, -1000};
+    polygon.points[2] = Vector2f{1000, 1000};
+    polygon.points[3] = Vector2f{-1000, 1000};
+
+    for (uint8_t i=0; i<2; i++) {
+        ASSERT_TRUE(test_build(cache, &polygon, 1));
+        float expected = 0;
+        float margin = 0;
+        ASSERT_TRUE(test_margin(&polygon, 1, start, end, 0, expected));
+        ASSERT_TRUE(cache.calc_margin(start, end, 0, margin));
+        EXPECT_NEAR(margin, expected, 0.01f);
+        EXPECT_EQ(is_positive(margin), i == 0);
+        for (uint8_t j=0; j<4; j++) {
+            polygon.points[j] += Vector2f{5000, 0};
+        }
+    }
+}
+
+TEST(AP_OAFenceCache, EmptyUntilBuilt)
+{
+    AP_OAFenceCache cache;
+    float margin;
+    EXPECT_FALSE(cache.valid());
+    EXPECT_FALSE(cache.calc_margin(Vector2f{0, 0}, Vector2f{100, 0}, 0, margin));
+
+    // a fence with nothing in it has no margin
+    ASSERT_TRUE(cache.begin_build(0, 0, 0));
+    cache.end_build();
+    EXPECT_TRUE(cache.valid());
+    EXPECT_FALSE(cache.calc_margin(Vector2f{0, 0}, Vector2f{100, 0}, 0, margin));
+}
+
+#endif  // AP_OAPATHPLANNER_BENDYRULER_ENABLED
+
+AP_GTEST_MAIN()
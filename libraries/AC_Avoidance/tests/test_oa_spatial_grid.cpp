@@ -0,0 +1,143 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AC_Avoidance/AP_OASpatialGrid.h>
+
+#if AP_OADATABASE_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  objects are held in an array which, like AP_OADatabase's, is kept
+  packed by moving the last object into the place of a removed one
+ */
+
+#define TEST_MAX_ITEMS      100
+#define TEST_CELL_SIZE      10.0f
+#define TEST_AREA           200.0f
+
+struct test_object {
+    Vector2f pos;
+    float radius;
+};
+
+static uint32_t test_seed = 1;
+
+// random float between low and high
+static float test_rand(float low, float high)
+{
+    test_seed = test_seed * 1664525U + 1013904223U;
+    return low + (high - low) * float(test_seed >> 8) / float(1U << 24);
+}
+
+static test_object test_rand_object()
+{
+    test_object obj;
+    obj.pos = Vector2f{test_rand(-TEST_AREA, TEST_AREA), test_rand(-TEST_AREA, TEST_AREA)};
+    // mostly small objects with some covering too many cells to be held in them
+    obj.radius = (test_rand(0, 1) < 0.9f) ? test_rand(0.1f, 2 * TEST_CELL_SIZE) : test_rand(2 * TEST_CELL_SIZE, 20 * TEST_CELL_SIZE);
+    return obj;
+}
+
+// returns true if an object's circle overlaps the rectangle
+static bool test_overlaps(const test_object &obj, const Vector2f &rect_min, const Vector2f &rect_max)
+{
+    const Vector2f closest {constrain_float(obj.pos.x, rect_min.x, rect_max.x), constrain_float(obj.pos.y, rect_min.y, rect_max.y)};
+    return (obj.pos - closest).length() <= obj.radius;
+}
+
+// check a query returns every object a brute force scan finds, and nothing which isn't an object
+static void test_queries(const AP_OASpatialGrid &grid, const test_object *objects, uint16_t count)
+{
+    for (uint8_t i=0; i<10; i++) {
+        const Vector2f centre {test_rand(-TEST_AREA, TEST_AREA), test_rand(-TEST_AREA, TEST_AREA)};
+        // small searches use the cells, large ones return all objects
+        const float half_width = (i < 8) ? test_rand(0, 3 * TEST_CELL_SIZE) : test_rand(0, TEST_AREA);
+        const float half_height = (i < 8) ? test_rand(0, 3 * TEST_CELL_SIZE) : test_rand(0, TEST_AREA);
+        const Vector2f rect_min = centre - Vector2f{half_width, half_height};
+        const Vector2f rect_max = centre + Vector2f{half_width, half_height};
+
+        bool found[TEST_MAX_ITEMS] {};
+        AP_OASpatialGrid::Query q;
+        grid.begin_query(q, rect_min, rect_max, count);
+        uint16_t index;
+        uint32_t results = 0;
+        while (grid.next(q, index)) {
+            ASSERT_LT(index, count);
+            found[index] = true;
+            // objects may be returned once for each cell they cover
+            ASSERT_LT(++results, 100000U);
+        }
+
+        for (uint16_t j=0; j<count; j++) {
+            if (test_overlaps(objects[j], rect_min, rect_max)) {
+                EXPECT_TRUE(found[j]) << "object " << j << " missing from query";
+            }
+        }
+    }
+}
+
+TEST(AP_OASpatialGrid, QueriesFindAllOverlappingObjects)
+{
+    AP_OASpatialGrid grid;
+    ASSERT_TRUE(grid.init(TEST_MAX_ITEMS, TEST_CELL_SIZE));
+    ASSERT_TRUE(grid.healthy());
+
+    test_object objects[TEST_MAX_ITEMS];
+    uint16_t count = 0;
+
+    for (uint16_t step=0; step<2000; step++) {
+        const float action = test_rand(0, 1);
+        if ((count < TEST_MAX_ITEMS) && ((action < 0.5f) || (count == 0))) {
+            // add an object
+            objects[count] = test_rand_object();
+            grid.add(count, objects[count].pos, objects[count].radius);
+            count++;
+        } else if (action < 0.8f) {
+            // remove an object, moving the last object into its place
+            const uint16_t index = uint16_t(test_rand(0, count)) % count;
+            grid.remove(index, objects[index].pos, objects[index].radius);
+            count--;
+            if (index != count) {
+                objects[index] = objects[count];
+                grid.move(count, index, objects[index].pos, objects[index].radius);
+            }
+        } else {
+            // change an object's position and radius
+            const uint16_t index = uint16_t(test_rand(0, count)) % count;
+            grid.remove(index, objects[index].pos, objects[index].radius);
+            objects[index] = test_rand_object();
+            grid.add(index, objects[index].pos, objects[index].radius);
+        }
+        test_queries(grid, objects, count);
+    }
+
+    // an emptied grid returns nothing
+    grid.clear();
+    AP_OASpatialGrid::Query q;
+    grid.begin_query(q, Vector2f{-1, -1}, Vector2f{1, 1}, 0);
+    uint16_t index;
+    EXPECT_FALSE(grid.next(q, index));
+}
+
+TEST(AP_OASpatialGrid, UnallocatedReturnsAllObjects)
+{
+    AP_OASpatialGrid grid;
+    EXPECT_FALSE(grid.healthy());
+
+    // without an index every object is returned
+    AP_OASpatialGrid::Query q;
+    grid.begin_query(q, Vector2f{-1, -1}, Vector2f{1, 1}, 5);
+    uint16_t index;
+    uint16_t expected = 0;
+    while (grid.next(q, index)) {
+        EXPECT_EQ(index, expected);
+        expected++;
+    }
+    EXPECT_EQ(expected, 5U);
+}
+
+#endif  // AP_OADATABASE_ENABLED
+
+AP_GTEST_MAIN()
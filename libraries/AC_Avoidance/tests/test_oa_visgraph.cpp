@@ -0,0 +1,403 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AC_Avoidance/AP_OADijkstra.h>
+
+#if AP_OAPATHPLANNER_DIJKSTRA_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  a fence of square exclusion polygons scattered at random, with a
+  fence point outside each corner as Dijkstra's uses
+ */
+
+#define TEST_AREA_CM            60000.0f
+#define TEST_SQUARE_SIZE_CM     4000.0f
+#define TEST_MARGIN_CM          200.0f
+#define TEST_NUM_SQUARES        24
+
+struct test_fence {
+    Vector2f exclusion[TEST_NUM_SQUARES][4];
+    Vector2f points[TEST_NUM_SQUARES * 4];
+    uint16_t num_squares;
+    uint16_t num_points() const { return num_squares * 4; }
+};
+
+static uint32_t test_seed = 1;
+
+// random float between low and high
+static float test_rand(float low, float high)
+{
+    test_seed = test_seed * 1664525U + 1013904223U;
+    return low + (high - low) * float(test_seed >> 8) / float(1U << 24);
+}
+
+static Vector2f test_rand_position()
+{
+    return Vector2f{test_rand(-TEST_AREA_CM, TEST_AREA_CM), test_rand(-TEST_AREA_CM, TEST_AREA_CM)};
+}
+
+// place square exclusion polygon i around center
+static void place_square(test_fence &fence, uint16_t i, const Vector2f &center)
+{
+    const float h = TEST_SQUARE_SIZE_CM * 0.5f;
+    const Vector2f corners[] {{-h, -h}, {-h, h}, {h, h}, {h, -h}};
+    for (uint8_t j = 0; j < 4; j++) {
+        fence.exclusion[i][j] = center + corners[j];
+        // fence point is outside corner by margin
+        fence.points[i * 4 + j] = center + corners[j] * ((h + TEST_MARGIN_CM) / h);
+    }
+}
+
+// area covered by square exclusion polygon i
+static AP_OAVisMatrix::Area square_area(const test_fence &fence, uint16_t i)
+{
+    return AP_OAVisMatrix::Area{fence.exclusion[i][0], fence.exclusion[i][2]};
+}
+
+static void create_fence(test_fence &fence, uint16_t num_squares)
+{
+    fence.num_squares = num_squares;
+    for (uint16_t i = 0; i < num_squares; i++) {
+        place_square(fence, i, test_rand_position());
+    }
+}
+
+static bool intersects_fence(const test_fence &fence, const Vector2f &seg_start, const Vector2f &seg_end)
+{
+    Vector2f intersection;
+    for (uint16_t i = 0; i < fence.num_squares; i++) {
+        if (Polygon_intersects(fence.exclusion[i], 4, seg_start, seg_end, intersection)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// set the matrix's points to the fence points
+static void begin(AP_OAVisMatrix &matrix, const test_fence &fence, bool reuse)
+{
+    ASSERT_TRUE(matrix.begin_update(fence.num_points(), reuse));
+    for (uint16_t i = 0; i < fence.num_points(); i++) {
+        matrix.set_point(i, fence.points[i]);
+    }
+}
+
+// calculate visibility of all pairs not carried over, returns number carried over
+static uint32_t build(AP_OAVisMatrix &matrix, const test_fence &fence, bool reuse)
+{
+    uint32_t carried = 0;
+    for (uint16_t i = 1; i < fence.num_points(); i++) {
+        for (uint16_t j = 0; j < i; j++) {
+            bool visible;
+            if (reuse && matrix.carried_over(i, j, visible)) {
+                carried++;
+            } else {
+                visible = !intersects_fence(fence, fence.points[i], fence.points[j]);
+            }
+            matrix.set_visible(i, j, visible);
+        }
+    }
+    matrix.end_update();
+    return carried;
+}
+
+// visibility after moving, adding and removing squares one at a time
+// must be the same whether it is carried over or calculated from scratch
+TEST(AP_OAVisMatrix, IncrementalMatchesFull)
+{
+    test_fence fence {};
+    create_fence(fence, TEST_NUM_SQUARES - 4);
+    AP_OAVisMatrix *incremental = NEW_NOTHROW AP_OAVisMatrix();
+    ASSERT_NE(incremental, nullptr);
+    begin(*incremental, fence, false);
+    build(*incremental, fence, false);
+
+    uint32_t carried = 0;
+    for (uint16_t n = 0; n < 60; n++) {
+        AP_OAVisMatrix::Area changed[2];
+        uint8_t num_changed = 0;
+        const uint16_t square = uint16_t(test_rand(0, fence.num_squares)) % fence.num_squares;
+        switch (n % 3) {
+        case 0:
+            // move a square
+            changed[num_changed++] = square_area(fence, square);
+            place_square(fence, square, test_rand_position());
+            changed[num_changed++] = square_area(fence, square);
+            break;
+        case 1:
+            // remove a square, the last square takes its place
+            if (fence.num_squares > 1) {
+                changed[num_changed++] = square_area(fence, square);
+                fence.num_squares--;
+                for (uint8_t j = 0; j < 4; j++) {
+                    fence.exclusion[square][j] = fence.exclusion[fence.num_squares][j];
+                    fence.points[square * 4 + j] = fence.points[fence.num_squares * 4 + j];
+                }
+            }
+            break;
+        case 2:
+            // add a square
+            if (fence.num_squares < TEST_NUM_SQUARES) {
+                place_square(fence, fence.num_squares, test_rand_position());
+                changed[num_changed++] = square_area(fence, fence.num_squares);
+                fence.num_squares++;
+            }
+            break;
+        }
+
+        begin(*incremental, fence, true);
+        for (uint8_t i = 0; i < num_changed; i++) {
+            incremental->add_changed_area(changed[i]);
+        }
+        carried += build(*incremental, fence, true);
+
+        AP_OAVisMatrix *full = NEW_NOTHROW AP_OAVisMatrix();
+        ASSERT_NE(full, nullptr);
+        begin(*full, fence, false);
+        build(*full, fence, false);
+
+        ASSERT_EQ(incremental->num_points(), full->num_points());
+        for (uint16_t i = 1; i < full->num_points(); i++) {
+            for (uint16_t j = 0; j < i; j++) {
+                ASSERT_EQ(incremental->visible(i, j), full->visible(i, j)) << "update " << n << " pair " << i << "," << j;
+            }
+        }
+        delete full;
+    }
+    delete incremental;
+
+    // pairs clear of the changes should have been carried over
+    EXPECT_GT(carried, 0U);
+}
+
+// two new points at the same position both match the one previous point
+// at that position, the pair between them must not be carried over
+TEST(AP_OAVisMatrix, DuplicatePointsNotCarriedOver)
+{
+    const Vector2f points[] {{0, 0}, {100, 0}, {0, 100}};
+    AP_OAVisMatrix *matrix = NEW_NOTHROW AP_OAVisMatrix();
+    ASSERT_NE(matrix, nullptr);
+    ASSERT_TRUE(matrix->begin_update(ARRAY_SIZE(points), false));
+    for (uint16_t i = 0; i < ARRAY_SIZE(points); i++) {
+        matrix->set_point(i, points[i]);
+    }
+    matrix->set_visible(0, 1, true);
+    matrix->set_visible(0, 2, false);
+    matrix->set_visible(1, 2, true);
+    matrix->end_update();
+
+    ASSERT_TRUE(matrix->begin_update(4, true));
+    matrix->set_point(0, points[0]);
+    matrix->set_point(1, points[1]);
+    matrix->set_point(2, points[2]);
+    matrix->set_point(3, points[2]);
+
+    bool visible;
+    EXPECT_FALSE(matrix->carried_over(2, 3, visible));
+    EXPECT_FALSE(matrix->carried_over(3, 2, visible));
+    ASSERT_TRUE(matrix->carried_over(0, 3, visible));
+    EXPECT_FALSE(visible);
+    ASSERT_TRUE(matrix->carried_over(1, 3, visible));
+    EXPECT_TRUE(visible);
+    matrix->end_update();
+    delete matrix;
+}
+
+/*
+  runs Dijkstra's search over a test fence, and the linear scan of
+  unvisited nodes it used before the open set was held as a heap
+ */
+class AP_OADijkstra_Test {
+public:
+    AP_OADijkstra_Test() : dijkstra(options) {}
+
+    // update the fence and the source and destination visibility graphs
+    void setup(const test_fence &fence, const Vector2f &source, const Vector2f &destination)
+    {
+        dijkstra._inclusion_polygon_numpoints = 0;
+        dijkstra._exclusion_circle_numpoints = 0;
+        ASSERT_TRUE(dijkstra._exclusion_polygon_pts.expand_to_hold(fence.num_points()));
+        for (uint16_t i = 0; i < fence.num_points(); i++) {
+            dijkstra._exclusion_polygon_pts[i] = fence.points[i];
+        }
+        dijkstra._exclusion_polygon_numpoints = fence.num_points();
+        begin(dijkstra._fence_vismatrix, fence, false);
+        build(dijkstra._fence_vismatrix, fence, false);
+
+        dijkstra._path_source = source;
+        dijkstra._path_destination = destination;
+        update_visgraph(fence, dijkstra._source_visgraph, {AP_OAVisGraph::OATYPE_SOURCE, 0}, source, true, destination);
+        update_visgraph(fence, dijkstra._destination_visgraph, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, destination, false, destination);
+    }
+
+    // returns true if a path was found, path holds the ids of its points from the destination to the source
+    bool heap_search(AP_OAVisGraph::OAItemID *path, uint8_t &path_len)
+    {
+        AP_OADijkstra::AP_OADijkstra_Error err_id;
+        if (!dijkstra.find_shortest_path(err_id)) {
+            return false;
+        }
+        path_len = dijkstra._path_numpoints;
+        for (uint8_t i = 0; i < path_len; i++) {
+            path[i] = dijkstra._path[i];
+        }
+        return true;
+    }
+
+    bool linear_search(AP_OAVisGraph::OAItemID *path, uint8_t &path_len) const;
+
+private:
+    void update_visgraph(const test_fence &fence, AP_OAVisGraph &visgraph, const AP_OAVisGraph::OAItemID &oaid,
+                         const Vector2f &position, bool add_extra_position, const Vector2f &extra_position)
+    {
+        visgraph.clear();
+        for (uint16_t i = 0; i < fence.num_points(); i++) {
+            if (!intersects_fence(fence, position, fence.points[i])) {
+                ASSERT_TRUE(visgraph.add_item(oaid, {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)i}, (position - fence.points[i]).length()));
+            }
+        }
+        if (add_extra_position && !intersects_fence(fence, position, extra_position)) {
+            ASSERT_TRUE(visgraph.add_item(oaid, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, (position - extra_position).length()));
+        }
+    }
+
+    AP_Int16 options;
+    AP_OADijkstra dijkstra;
+};
+
+bool AP_OADijkstra_Test::linear_search(AP_OAVisGraph::OAItemID *path, uint8_t &path_len) const
+{
+    // nodes are the source, the destination and then the fence points
+    const AP_OAVisMatrix &matrix = dijkstra._fence_vismatrix;
+    const uint16_t num_nodes = 2 + matrix.num_points();
+    float distance[2 + TEST_NUM_SQUARES * 4];
+    float dest_distance[2 + TEST_NUM_SQUARES * 4];
+    uint16_t distance_from[2 + TEST_NUM_SQUARES * 4];
+    bool visited[2 + TEST_NUM_SQUARES * 4];
+    for (uint16_t i = 0; i < num_nodes; i++) {
+        distance[i] = FLT_MAX;
+        dest_distance[i] = FLT_MAX;
+        distance_from[i] = UINT16_MAX;
+        visited[i] = false;
+    }
+    auto node_pos = [&](uint16_t node) {
+        if (node == 0) {
+            return dijkstra._path_source;
+        }
+        if (node == 1) {
+            return dijkstra._path_destination;
+        }
+        return matrix.point(node - 2);
+    };
+    auto node_idx = [](const AP_OAVisGraph::OAItemID &id) {
+        return (id.id_type == AP_OAVisGraph::OATYPE_DESTINATION) ? 1 : id.id_num + 2;
+    };
+    auto update_distance = [&](uint16_t curr, uint16_t node, float dist) {
+        if (distance[curr] + dist < distance[node]) {
+            distance[node] = distance[curr] + dist;
+            distance_from[node] = curr;
+        }
+    };
+    for (uint16_t i = 0; i < dijkstra._destination_visgraph.num_items(); i++) {
+        dest_distance[node_idx(dijkstra._destination_visgraph[i].id2)] = dijkstra._destination_visgraph[i].distance_cm;
+    }
+    distance[0] = 0;
+    visited[0] = true;
+    for (uint16_t i = 0; i < dijkstra._source_visgraph.num_items(); i++) {
+        update_distance(0, node_idx(dijkstra._source_visgraph[i].id2), dijkstra._source_visgraph[i].distance_cm);
+    }
+
+    while (true) {
+        // scan for the unvisited node with the lowest distance plus heuristic
+        uint16_t curr = 0;
+        float lowest = FLT_MAX;
+        for (uint16_t i = 0; i < num_nodes; i++) {
+            if (visited[i] || (distance[i] >= FLT_MAX)) {
+                continue;
+            }
+            const float cost = distance[i] + (node_pos(i) - dijkstra._path_destination).length();
+            if (cost < lowest) {
+                curr = i;
+                lowest = cost;
+            }
+        }
+        if (lowest >= FLT_MAX) {
+            break;
+        }
+        visited[curr] = true;
+        if (curr == 1) {
+            break;
+        }
+        if (dest_distance[curr] < FLT_MAX) {
+            update_distance(curr, 1, dest_distance[curr]);
+        }
+        for (uint16_t i = 0; i < matrix.num_points(); i++) {
+            if (matrix.visible(curr - 2, i)) {
+                update_distance(curr, i + 2, (matrix.point(curr - 2) - matrix.point(i)).length());
+            }
+        }
+    }
+
+    if (distance[1] >= FLT_MAX) {
+        return false;
+    }
+    path_len = 0;
+    for (uint16_t node = 1; node != UINT16_MAX; node = distance_from[node]) {
+        if (node == 0) {
+            path[path_len++] = {AP_OAVisGraph::OATYPE_SOURCE, 0};
+        } else if (node == 1) {
+            path[path_len++] = {AP_OAVisGraph::OATYPE_DESTINATION, 0};
+        } else {
+            path[path_len++] = {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, (AP_OAVisGraph::oaid_num)(node - 2)};
+        }
+    }
+    return true;
+}
+
+// the heap ordered search must find the same paths as the linear scan
+TEST(AP_OADijkstra, HeapSearchMatchesLinearScan)
+{
+    AP_OADijkstra_Test *test = NEW_NOTHROW AP_OADijkstra_Test();
+    ASSERT_NE(test, nullptr);
+    uint16_t num_found = 0;
+    uint16_t num_avoiding = 0;
+
+    for (uint16_t n = 0; n < 50; n++) {
+        test_fence fence {};
+        create_fence(fence, TEST_NUM_SQUARES);
+        const Vector2f source = test_rand_position();
+        const Vector2f destination = test_rand_position();
+        test->setup(fence, source, destination);
+
+        AP_OAVisGraph::OAItemID heap_path[2 + TEST_NUM_SQUARES * 4];
+        AP_OAVisGraph::OAItemID linear_path[2 + TEST_NUM_SQUARES * 4];
+        uint8_t heap_len = 0;
+        uint8_t linear_len = 0;
+        const bool heap_found = test->heap_search(heap_path, heap_len);
+        const bool linear_found = test->linear_search(linear_path, linear_len);
+        ASSERT_EQ(heap_found, linear_found) << "search " << n;
+        if (!heap_found) {
+            continue;
+        }
+        num_found++;
+        if (heap_len > 2) {
+            num_avoiding++;
+        }
+        ASSERT_EQ(heap_len, linear_len) << "search " << n;
+        for (uint8_t i = 0; i < heap_len; i++) {
+            EXPECT_TRUE(heap_path[i] == linear_path[i]) << "search " << n << " point " << unsigned(i);
+        }
+    }
+
+    // most searches should find a path, some around the fence
+    EXPECT_GT(num_found, 25U);
+    EXPECT_GT(num_avoiding, 5U);
+    delete test;
+}
+
+#endif  // AP_OAPATHPLANNER_DIJKSTRA_ENABLED
+
+AP_GTEST_MAIN()
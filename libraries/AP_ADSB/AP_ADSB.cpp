@@ -213,6 +213,9 @@ void AP_ADSB::init(void)
             return;
         }
         in_state.list_size_allocated = in_state.list_size_param;
+
+        // vehicles are searched for linearly if the map can't be allocated
+        in_state.icao_map.init(in_state.list_size_allocated);
     }
 
     if (detected_num_instances == 0) {
@@ -492,8 +495,10 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
         in_state.furthest_vehicle_distance = 0;
         in_state.furthest_vehicle_index = 0;
     }
+    in_state.icao_map.remove(in_state.vehicle_list[index].info.ICAO_address);
     if (index != (in_state.vehicle_count-1)) {
         in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
+        in_state.icao_map.set(in_state.vehicle_list[index].info.ICAO_address, index);
     }
     // TODO: is memset needed? When we decrement the index we essentially forget about it
     memset(&in_state.vehicle_list[in_state.vehicle_count-1], 0, sizeof(adsb_vehicle_t));
@@ -507,6 +512,9 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
+    if (in_state.icao_map.initialised()) {
+        return in_state.icao_map.find(vehicle.info.ICAO_address, *index);
+    }
     for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
         if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
             *index = i;
@@ -610,7 +618,13 @@ void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle)
         // out of range
         return;
     }
+    if ((index < in_state.vehicle_count) &&
+        (in_state.vehicle_list[index].info.ICAO_address != vehicle.info.ICAO_address)) {
+        // a different vehicle is being replaced
+        in_state.icao_map.remove(in_state.vehicle_list[index].info.ICAO_address);
+    }
     in_state.vehicle_list[index] = vehicle;
+    in_state.icao_map.set(vehicle.info.ICAO_address, index);
 
 #if HAL_LOGGING_ENABLED
     write_log(vehicle);
@@ -29,6 +29,7 @@
 #include <AP_Common/Location.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_GPS/AP_GPS_FixType.h>
+#include "AP_ADSB_ICAO_Map.h"
 
 #define ADSB_MAX_INSTANCES             1   // Maximum number of ADSB sensor instances available on this platform
 
@@ -269,6 +270,7 @@ private:
         uint16_t    list_size_allocated;
         adsb_vehicle_t *vehicle_list;
         uint16_t    vehicle_count;
+        AP_ADSB_ICAO_Map icao_map;  // index of each vehicle in vehicle_list by ICAO address
         AP_Int32    list_radius;
         AP_Int16    list_altitude;
 
@@ -0,0 +1,146 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_ADSB_ICAO_Map.h"
+
+#if HAL_ADSB_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+
+#define AP_ADSB_ICAO_MAP_EMPTY UINT16_MAX
+
+AP_ADSB_ICAO_Map::~AP_ADSB_ICAO_Map()
+{
+    delete[] _table;
+}
+
+// allocate table for up to max_items addresses, returns false on allocation failure
+bool AP_ADSB_ICAO_Map::init(uint16_t max_items)
+{
+    delete[] _table;
+    _table = nullptr;
+    _max_items = 0;
+    _count = 0;
+
+    // table size is the power of two at least twice max_items
+    uint32_t size = 2;
+    while (size < 2U * max_items) {
+        size *= 2;
+    }
+    if ((max_items >= AP_ADSB_ICAO_MAP_EMPTY) || (size > UINT16_MAX + 1U)) {
+        return false;
+    }
+    _table = NEW_NOTHROW Entry[size];
+    if (_table == nullptr) {
+        return false;
+    }
+    _mask = size - 1;
+    _max_items = max_items;
+    clear();
+    return true;
+}
+
+// remove all addresses
+void AP_ADSB_ICAO_Map::clear()
+{
+    if (_table == nullptr) {
+        return;
+    }
+    for (uint32_t i = 0; i <= _mask; i++) {
+        _table[i].index = AP_ADSB_ICAO_MAP_EMPTY;
+    }
+    _count = 0;
+}
+
+// slot in table searching for icao starts from
+uint16_t AP_ADSB_ICAO_Map::home(uint32_t icao) const
+{
+    // multiplicative hash, addresses are often allocated in sequence
+    return ((icao * 2654435761U) >> 16) & _mask;
+}
+
+// slot holding icao or the empty slot ending its search
+uint16_t AP_ADSB_ICAO_Map::slot(uint32_t icao) const
+{
+    uint16_t i = home(icao);
+    while ((_table[i].index != AP_ADSB_ICAO_MAP_EMPTY) && (_table[i].icao != icao)) {
+        i = (i + 1) & _mask;
+    }
+    return i;
+}
+
+// find index of an address, returns false if not found
+bool AP_ADSB_ICAO_Map::find(uint32_t icao, uint16_t &index) const
+{
+    if (_table == nullptr) {
+        return false;
+    }
+    const Entry &entry = _table[slot(icao)];
+    if (entry.index == AP_ADSB_ICAO_MAP_EMPTY) {
+        return false;
+    }
+    index = entry.index;
+    return true;
+}
+
+// add an address or update its index, returns false if the map is full
+bool AP_ADSB_ICAO_Map::set(uint32_t icao, uint16_t index)
+{
+    if ((_table == nullptr) || (index == AP_ADSB_ICAO_MAP_EMPTY)) {
+        return false;
+    }
+    Entry &entry = _table[slot(icao)];
+    if (entry.index == AP_ADSB_ICAO_MAP_EMPTY) {
+        if (_count >= _max_items) {
+            return false;
+        }
+        entry.icao = icao;
+        _count++;
+    }
+    entry.index = index;
+    return true;
+}
+
+// remove an address if present
+void AP_ADSB_ICAO_Map::remove(uint32_t icao)
+{
+    if (_table == nullptr) {
+        return;
+    }
+    uint16_t empty = slot(icao);
+    if (_table[empty].index == AP_ADSB_ICAO_MAP_EMPTY) {
+        return;
+    }
+    _table[empty].index = AP_ADSB_ICAO_MAP_EMPTY;
+    _count--;
+
+    // move later entries of the probe sequence back so no search stops early at the new gap
+    uint16_t i = empty;
+    while (true) {
+        i = (i + 1) & _mask;
+        if (_table[i].index == AP_ADSB_ICAO_MAP_EMPTY) {
+            return;
+        }
+        // entry can fill the gap if its home slot is not cyclically within (empty, i]
+        const uint16_t h = home(_table[i].icao);
+        if (((i - h) & _mask) >= ((i - empty) & _mask)) {
+            _table[empty] = _table[i];
+            _table[i].index = AP_ADSB_ICAO_MAP_EMPTY;
+            empty = i;
+        }
+    }
+}
+
+#endif  // HAL_ADSB_ENABLED
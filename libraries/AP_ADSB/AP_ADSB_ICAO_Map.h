@@ -0,0 +1,58 @@
+#pragma once
+
+#include "AP_ADSB_config.h"
+
+#if HAL_ADSB_ENABLED
+
+#include <AP_Common/AP_Common.h>
+
+/*
+  hash map from ICAO address to index in AP_ADSB's vehicle list.
+  Open addressing with linear probing in a table at least twice the size
+  of the vehicle list so lookups stay constant time as the list fills
+ */
+class AP_ADSB_ICAO_Map {
+public:
+    AP_ADSB_ICAO_Map() {}
+    ~AP_ADSB_ICAO_Map();
+
+    CLASS_NO_COPY(AP_ADSB_ICAO_Map);  /* Do not allow copies */
+
+    // allocate table for up to max_items addresses, returns false on allocation failure
+    bool init(uint16_t max_items);
+
+    // true if init has succeeded
+    bool initialised() const { return _table != nullptr; }
+
+    // remove all addresses
+    void clear();
+
+    // find index of an address, returns false if not found
+    bool find(uint32_t icao, uint16_t &index) const WARN_IF_UNUSED;
+
+    // add an address or update its index, returns false if the map is full
+    bool set(uint32_t icao, uint16_t index);
+
+    // remove an address if present
+    void remove(uint32_t icao);
+
+private:
+
+    struct Entry {
+        uint32_t icao;
+        uint16_t index;     // UINT16_MAX if the entry is empty
+    };
+
+    // slot in table searching for icao starts from
+    uint16_t home(uint32_t icao) const;
+
+    // slot holding icao or the empty slot ending its search
+    uint16_t slot(uint32_t icao) const;
+
+    Entry *_table = nullptr;
+    uint16_t _mask;         // table size minus one, table size is a power of two
+    uint16_t _max_items;    // maximum number of addresses
+    uint16_t _count;        // number of addresses held
+};
+
+#endif  // HAL_ADSB_ENABLED
@@ -0,0 +1,107 @@
+#include <AP_gtest.h>
+
+#include <AP_ADSB/AP_ADSB.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_ADSB_ENABLED
+
+static uint32_t test_seed = 1;
+static uint32_t test_rand(uint32_t max)
+{
+    test_seed = test_seed * 1664525U + 1013904223U;
+    return (test_seed >> 8) % max;
+}
+
+TEST(ADSB_ICAO_Map, Basic)
+{
+    AP_ADSB_ICAO_Map map;
+    uint16_t index;
+    EXPECT_FALSE(map.find(1234, index));
+    EXPECT_FALSE(map.set(1234, 0));
+
+    ASSERT_TRUE(map.init(3));
+    EXPECT_TRUE(map.set(1234, 0));
+    EXPECT_TRUE(map.set(5678, 1));
+    EXPECT_TRUE(map.set(0, 2));
+    EXPECT_FALSE(map.set(42, 3));
+
+    EXPECT_TRUE(map.find(1234, index));
+    EXPECT_EQ(index, 0);
+    EXPECT_TRUE(map.find(0, index));
+    EXPECT_EQ(index, 2);
+
+    // update index of existing address
+    EXPECT_TRUE(map.set(1234, 1));
+    EXPECT_TRUE(map.find(1234, index));
+    EXPECT_EQ(index, 1);
+
+    map.remove(5678);
+    EXPECT_FALSE(map.find(5678, index));
+    EXPECT_TRUE(map.set(42, 3));
+    EXPECT_TRUE(map.find(42, index));
+    EXPECT_EQ(index, 3);
+
+    map.clear();
+    EXPECT_FALSE(map.find(1234, index));
+    EXPECT_FALSE(map.find(42, index));
+}
+
+// the map must always agree with a linear search of a list as AP_ADSB maintains it
+TEST(ADSB_ICAO_Map, MatchesList)
+{
+    const uint16_t list_size = 200;
+    uint32_t list[list_size];
+    uint16_t count = 0;
+    AP_ADSB_ICAO_Map map;
+    ASSERT_TRUE(map.init(list_size));
+
+    for (uint32_t n = 0; n < 100000; n++) {
+        // small address range so adds often find an existing vehicle and probe sequences collide
+        const uint32_t icao = test_rand(400);
+        uint16_t list_index = UINT16_MAX;
+        for (uint16_t i = 0; i < count; i++) {
+            if (list[i] == icao) {
+                list_index = i;
+                break;
+            }
+        }
+        uint16_t map_index;
+        const bool found = map.find(icao, map_index);
+        ASSERT_EQ(found, list_index != UINT16_MAX);
+        if (found) {
+            ASSERT_EQ(map_index, list_index);
+        }
+
+        switch (test_rand(3)) {
+        case 0:
+            // delete as AP_ADSB::delete_vehicle, moving the last vehicle into the gap
+            if (found) {
+                map.remove(icao);
+                if (list_index != count-1) {
+                    list[list_index] = list[count-1];
+                    EXPECT_TRUE(map.set(list[list_index], list_index));
+                }
+                count--;
+            }
+            break;
+        default:
+            if (!found && (count < list_size)) {
+                list[count] = icao;
+                EXPECT_TRUE(map.set(icao, count));
+                count++;
+            } else if (!found) {
+                // replace a vehicle as when the list is full
+                const uint16_t i = test_rand(count);
+                map.remove(list[i]);
+                list[i] = icao;
+                EXPECT_TRUE(map.set(icao, i));
+            }
+            break;
+        }
+    }
+}
+
+#endif  // HAL_ADSB_ENABLED
+
+AP_GTEST_MAIN()
@@ -148,8 +148,13 @@ void AP_Avoidance::init(void)
     if (_obstacles == nullptr) {
         _obstacles = NEW_NOTHROW AP_Avoidance::Obstacle[_obstacles_max];
 
+        if ((_obstacles != nullptr) && !_cpa.init(_obstacles_max)) {
+            delete [] _obstacles;
+            _obstacles = nullptr;
+        }
+
         if (_obstacles == nullptr) {
-            // dynamic RAM allocation of _obstacles[] failed, disable gracefully
+            // dynamic RAM allocation of _obstacles[] or _cpa failed, disable gracefully
             DEV_PRINTF("Unable to initialize Avoidance obstacle list\n");
             // disable ourselves to avoid repeated allocation attempts
             _enabled.set(0);
@@ -334,60 +339,6 @@ float closest_approach_z(const Location &my_loc,
     return ret*0.01f;
 }
 
-void AP_Avoidance::update_threat_level(const Location &my_loc,
-                                       const Vector3f &my_vel,
-                                       AP_Avoidance::Obstacle &obstacle)
-{
-
-    Location &obstacle_loc = obstacle._location;
-    Vector3f &obstacle_vel = obstacle._velocity;
-
-    obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
-
-    const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
-    float closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
-    if (closest_xy < _fail_distance_xy) {
-        obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_HIGH;
-    } else {
-        closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
-        if (closest_xy < _warn_distance_xy) {
-            obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
-        }
-    }
-
-    // check for vertical separation; our threat level is the minimum
-    // of vertical and horizontal threat levels
-    float closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
-    if (obstacle.threat_level != MAV_COLLISION_THREAT_LEVEL_NONE) {
-        if (closest_z > _warn_distance_z) {
-            obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
-        } else {
-            closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
-            if (closest_z > _fail_distance_z) {
-                obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
-            }
-        }
-    }
-
-    // If we haven't heard from a vehicle then assume it is no threat
-    if (obstacle_age > MAX_OBSTACLE_AGE_MS) {
-        obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
-    }
-
-    // could optimise this to not calculate a lot of this if threat
-    // level is none - but only *once the GCS has been informed*!
-    obstacle.closest_approach_xy = closest_xy;
-    obstacle.closest_approach_z = closest_z;
-    float current_distance = my_loc.get_distance(obstacle_loc);
-    obstacle.distance_to_closest_approach = current_distance - closest_xy;
-    Vector2f net_velocity_ne = Vector2f(my_vel[0] - obstacle_vel[0], my_vel[1] - obstacle_vel[1]);
-    obstacle.time_to_closest_approach = 0.0f;
-    if (!is_zero(obstacle.distance_to_closest_approach) &&
-        ! is_zero(net_velocity_ne.length())) {
-        obstacle.time_to_closest_approach = obstacle.distance_to_closest_approach / net_velocity_ne.length();
-    }
-}
-
 MAV_COLLISION_THREAT_LEVEL AP_Avoidance::current_threat_level() const {
     if (_obstacles == nullptr) {
         return MAV_COLLISION_THREAT_LEVEL_NONE;
@@ -476,16 +427,42 @@ void AP_Avoidance::check_for_threats()
     }
 
     // we always check all obstacles to see if they are threats since it
-    // is most likely our own position and/or velocity have changed
+    // is most likely our own position and/or velocity have changed.
+    // The closest approach of all obstacles is calculated together
+    const uint32_t now_ms = AP_HAL::millis();
+    _cpa.reset();
+    for (uint8_t i=0; i<_obstacle_count; i++) {
+        const AP_Avoidance::Obstacle &obstacle = _obstacles[i];
+        const uint32_t obstacle_age = now_ms - obstacle.timestamp_ms;
+        // time horizons are extended by the age of the obstacle's data
+        const uint8_t fail_time_horizon = _fail_time_horizon + obstacle_age/1000;
+        const uint8_t warn_time_horizon = _warn_time_horizon + obstacle_age/1000;
+        _cpa.add(obstacle._location.get_distance_NE(my_loc),
+                 obstacle._location.alt - my_loc.alt,
+                 obstacle._velocity - my_vel,
+                 fail_time_horizon,
+                 warn_time_horizon);
+    }
+    _cpa.calculate(_fail_distance_xy, _fail_distance_z, _warn_distance_xy, _warn_distance_z);
+
     // determine the current most-serious-threat
     _current_most_serious_threat = -1;
-    for (uint8_t i=0; i<_obstacle_count; i++) {
+    for (uint8_t i=0; i<_obstacle_count && i<_cpa.count(); i++) {
 
         AP_Avoidance::Obstacle &obstacle = _obstacles[i];
-        const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
+        const uint32_t obstacle_age = now_ms - obstacle.timestamp_ms;
         debug("i=%d src_id=%d timestamp=%u age=%d", i, obstacle.src_id, obstacle.timestamp_ms, obstacle_age);
 
-        update_threat_level(my_loc, my_vel, obstacle);
+        obstacle.threat_level = _cpa.threat_level(i);
+        obstacle.closest_approach_xy = _cpa.closest_approach_xy(i);
+        obstacle.closest_approach_z = _cpa.closest_approach_z(i);
+        obstacle.distance_to_closest_approach = _cpa.distance_to_closest_approach(i);
+        obstacle.time_to_closest_approach = _cpa.time_to_closest_approach(i);
+
+        // If we haven't heard from a vehicle then assume it is no threat
+        if (obstacle_age > MAX_OBSTACLE_AGE_MS) {
+            obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
+        }
         debug("   threat-level=%d", obstacle.threat_level);
 
         // ignore any really old data:
@@ -30,6 +30,7 @@
 #if AP_ADSB_AVOIDANCE_ENABLED
 
 #include <AP_ADSB/AP_ADSB.h>
+#include "AP_Avoidance_CPA.h"
 
 #define AP_AVOIDANCE_STATE_RECOVERY_TIME_MS                 2000    // we will not downgrade state any faster than this (2 seconds)
 
@@ -173,9 +174,6 @@ private:
     uint32_t src_id_for_adsb_vehicle(const AP_ADSB::adsb_vehicle_t &vehicle) const;
 
     void check_for_threats();
-    void update_threat_level(const Location &my_loc,
-                             const Vector3f &my_vel,
-                             AP_Avoidance::Obstacle &obstacle);
 
     // calls into the AP_ADSB library to retrieve vehicle data
     void get_adsb_samples();
@@ -189,6 +187,7 @@ private:
     uint8_t _obstacles_allocated;
     uint8_t _obstacle_count;
     int8_t _current_most_serious_threat;
+    AP_Avoidance_CPA _cpa;  // closest approach of all obstacles
     MAV_COLLISION_ACTION _latest_action = MAV_COLLISION_ACTION_NONE;
 
     // external references
@@ -0,0 +1,156 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_Avoidance_CPA.h"
+
+#if AP_ADSB_AVOIDANCE_ENABLED
+
+// number of float arrays held in _buffer
+#define AP_AVOIDANCE_CPA_NUM_ARRAYS 14
+
+AP_Avoidance_CPA::~AP_Avoidance_CPA()
+{
+    delete[] _buffer;
+}
+
+// allocate space for max_obstacles, returns false on allocation failure
+bool AP_Avoidance_CPA::init(uint16_t max_obstacles)
+{
+    _count = 0;
+    if ((_buffer != nullptr) && (max_obstacles == _max_obstacles)) {
+        return true;
+    }
+    delete[] _buffer;
+    _max_obstacles = 0;
+
+    // threat levels are stored after the float arrays
+    const uint32_t len = max_obstacles * AP_AVOIDANCE_CPA_NUM_ARRAYS + (max_obstacles + sizeof(float) - 1) / sizeof(float);
+    _buffer = NEW_NOTHROW float[len];
+    if (_buffer == nullptr) {
+        return false;
+    }
+    float *p = _buffer;
+    _pos_n = p; p += max_obstacles;
+    _pos_e = p; p += max_obstacles;
+    _pos_d_cm = p; p += max_obstacles;
+    _vel_n = p; p += max_obstacles;
+    _vel_e = p; p += max_obstacles;
+    _vel_d = p; p += max_obstacles;
+    _fail_time = p; p += max_obstacles;
+    _warn_time = p; p += max_obstacles;
+    _closest_xy = p; p += max_obstacles;
+    _closest_z = p; p += max_obstacles;
+    _distance_to_closest = p; p += max_obstacles;
+    _time_to_closest = p; p += max_obstacles;
+    _fail_xy = p; p += max_obstacles;
+    _fail_z = p; p += max_obstacles;
+    _threat_level = (uint8_t *)p;
+    _max_obstacles = max_obstacles;
+    return true;
+}
+
+// add an obstacle, returns false if full
+bool AP_Avoidance_CPA::add(const Vector2f &delta_pos_ne, float delta_pos_d_cm, const Vector3f &delta_vel,
+                           float fail_time_horizon, float warn_time_horizon)
+{
+    if (_count >= _max_obstacles) {
+        return false;
+    }
+    _pos_n[_count] = delta_pos_ne.x;
+    _pos_e[_count] = delta_pos_ne.y;
+    _pos_d_cm[_count] = delta_pos_d_cm;
+    _vel_n[_count] = delta_vel.x;
+    _vel_e[_count] = delta_vel.y;
+    _vel_d[_count] = delta_vel.z;
+    _fail_time[_count] = fail_time_horizon;
+    _warn_time[_count] = warn_time_horizon;
+    _count++;
+    return true;
+}
+
+// closest distance between the point p and the line segment from the origin to w
+// same as Vector2f::closest_distance_between_radial_and_point but without branches
+static inline float radial_distance(float p_n, float p_e, float w_n, float w_e)
+{
+    const float l2 = w_n*w_n + w_e*w_e;
+    // the division is always done, so the denominator is kept away
+    // from zero for SITL, which traps floating point exceptions
+    const float t_unconstrained = (p_n*w_n + p_e*w_e) / MAX(l2, FLT_EPSILON);
+    const float t = (l2 < FLT_EPSILON) ? 1.0f : MIN(MAX(t_unconstrained, 0.0f), 1.0f);
+    const float d_n = w_n*t - p_n;
+    const float d_e = w_e*t - p_e;
+    return sqrtf(d_n*d_n + d_e*d_e);
+}
+
+// closest vertical distance in meters, same as closest_approach_z()
+static inline float vertical_distance(float pos_d_cm, float vel_d, float time_horizon)
+{
+    float ret;
+    if (pos_d_cm >= 0 && vel_d >= 0) {
+        ret = pos_d_cm;
+    } else if (pos_d_cm <= 0 && vel_d <= 0) {
+        ret = fabsf(pos_d_cm);
+    } else {
+        ret = fabsf(pos_d_cm - vel_d * time_horizon);
+    }
+    return ret * 0.01f;
+}
+
+// calculate closest approach and threat level of all obstacles
+void AP_Avoidance_CPA::calculate(float fail_distance_xy, float fail_distance_z, float warn_distance_xy, float warn_distance_z)
+{
+    // closest approach over both time horizons
+    for (uint16_t i = 0; i < _count; i++) {
+        _fail_xy[i] = radial_distance(_pos_n[i], _pos_e[i], _vel_n[i] * _fail_time[i], _vel_e[i] * _fail_time[i]);
+        _closest_xy[i] = radial_distance(_pos_n[i], _pos_e[i], _vel_n[i] * _warn_time[i], _vel_e[i] * _warn_time[i]);
+        _fail_z[i] = vertical_distance(_pos_d_cm[i], _vel_d[i], _fail_time[i]);
+        _closest_z[i] = vertical_distance(_pos_d_cm[i], _vel_d[i], _warn_time[i]);
+        _distance_to_closest[i] = sqrtf(_pos_n[i]*_pos_n[i] + _pos_e[i]*_pos_e[i]);
+        _time_to_closest[i] = sqrtf(_vel_n[i]*_vel_n[i] + _vel_e[i]*_vel_e[i]);
+    }
+
+    // threat level is the minimum of horizontal and vertical threat levels
+    for (uint16_t i = 0; i < _count; i++) {
+        MAV_COLLISION_THREAT_LEVEL level = MAV_COLLISION_THREAT_LEVEL_NONE;
+        if (_fail_xy[i] < fail_distance_xy) {
+            level = MAV_COLLISION_THREAT_LEVEL_HIGH;
+            _closest_xy[i] = _fail_xy[i];
+        } else if (_closest_xy[i] < warn_distance_xy) {
+            level = MAV_COLLISION_THREAT_LEVEL_LOW;
+        }
+        if (level != MAV_COLLISION_THREAT_LEVEL_NONE) {
+            if (_closest_z[i] > warn_distance_z) {
+                level = MAV_COLLISION_THREAT_LEVEL_NONE;
+            } else {
+                _closest_z[i] = _fail_z[i];
+                if (_closest_z[i] > fail_distance_z) {
+                    level = MAV_COLLISION_THREAT_LEVEL_LOW;
+                }
+            }
+        }
+        _threat_level[i] = level;
+
+        // current distance and relative speed were stored in the result arrays above
+        const float current_distance = _distance_to_closest[i];
+        const float speed = _time_to_closest[i];
+        _distance_to_closest[i] = current_distance - _closest_xy[i];
+        _time_to_closest[i] = 0.0f;
+        if (!is_zero(_distance_to_closest[i]) && !is_zero(speed)) {
+            _time_to_closest[i] = _distance_to_closest[i] / speed;
+        }
+    }
+}
+
+#endif  // AP_ADSB_AVOIDANCE_ENABLED
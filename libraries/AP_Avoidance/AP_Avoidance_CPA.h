@@ -0,0 +1,82 @@
+#pragma once
+
+#include "AP_Avoidance_config.h"
+
+#if AP_ADSB_AVOIDANCE_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS_MAVLink.h>
+
+/*
+  closest point of approach between our vehicle and many obstacles
+
+  Obstacle positions and velocities relative to our vehicle are held as
+  one array per component so each stage of the calculation is a simple
+  loop over all obstacles which the compiler can vectorise.  Results match
+  closest_approach_xy() and closest_approach_z() for each obstacle
+ */
+class AP_Avoidance_CPA {
+public:
+    AP_Avoidance_CPA() {}
+    ~AP_Avoidance_CPA();
+
+    CLASS_NO_COPY(AP_Avoidance_CPA);  /* Do not allow copies */
+
+    // allocate space for max_obstacles, returns false on allocation failure
+    bool init(uint16_t max_obstacles);
+
+    // remove all obstacles
+    void reset() { _count = 0; }
+
+    // add an obstacle, returns false if full
+    // delta_pos_ne is the horizontal position of our vehicle relative to the obstacle in meters
+    // delta_pos_d_cm is the altitude of the obstacle above our vehicle in cm
+    // delta_vel is the obstacle's velocity minus our velocity in m/s NED
+    // time horizons are in seconds
+    bool add(const Vector2f &delta_pos_ne, float delta_pos_d_cm, const Vector3f &delta_vel,
+             float fail_time_horizon, float warn_time_horizon);
+
+    // number of obstacles added since reset
+    uint16_t count() const { return _count; }
+
+    // calculate closest approach and threat level of all obstacles
+    // distances are in meters
+    void calculate(float fail_distance_xy, float fail_distance_z, float warn_distance_xy, float warn_distance_z);
+
+    // results of calculate() for an obstacle, index is the order it was added
+    MAV_COLLISION_THREAT_LEVEL threat_level(uint16_t i) const { return (MAV_COLLISION_THREAT_LEVEL)_threat_level[i]; }
+    float closest_approach_xy(uint16_t i) const { return _closest_xy[i]; }
+    float closest_approach_z(uint16_t i) const { return _closest_z[i]; }
+    float distance_to_closest_approach(uint16_t i) const { return _distance_to_closest[i]; }
+    float time_to_closest_approach(uint16_t i) const { return _time_to_closest[i]; }
+
+private:
+
+    // inputs
+    float *_pos_n;
+    float *_pos_e;
+    float *_pos_d_cm;
+    float *_vel_n;
+    float *_vel_e;
+    float *_vel_d;
+    float *_fail_time;
+    float *_warn_time;
+
+    // results
+    float *_closest_xy;
+    float *_closest_z;
+    float *_distance_to_closest;
+    float *_time_to_closest;
+    uint8_t *_threat_level;
+
+    // temporary values between stages of calculate()
+    float *_fail_xy;
+    float *_fail_z;
+
+    float *_buffer = nullptr;   // single allocation holding all of the above arrays
+    uint16_t _max_obstacles;    // number of obstacles allocated
+    uint16_t _count;            // number of obstacles added
+};
+
+#endif  // AP_ADSB_AVOIDANCE_ENABLED
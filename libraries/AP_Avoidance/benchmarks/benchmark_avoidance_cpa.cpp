@@ -0,0 +1,191 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Avoidance/AP_Avoidance.h>
+
+#if AP_ADSB_AVOIDANCE_ENABLED
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  one AP_Avoidance threat check and one round of ADS-B reports for dense
+  airspace. Targets are spread around the vehicle with the distributions
+  used by the SITL ADSB simulator (SIM_ADSB.cpp). The number of targets is
+  the benchmark argument
+ */
+
+#define BENCH_ADSB_RADIUS_M         10000.0f
+#define BENCH_FAIL_TIME_HORIZON     30
+#define BENCH_WARN_TIME_HORIZON     60
+#define BENCH_FAIL_DISTANCE_XY      300.0f
+#define BENCH_FAIL_DISTANCE_Z       100.0f
+#define BENCH_WARN_DISTANCE_XY      1000.0f
+#define BENCH_WARN_DISTANCE_Z       300.0f
+
+struct bench_target {
+    uint32_t icao;
+    Location loc;
+    Vector3f vel;
+};
+
+static uint32_t rand_state = 1;
+static float rand_float(float min, float max)
+{
+    rand_state = rand_state * 1664525U + 1013904223U;
+    return min + (max - min) * ((rand_state >> 8) / float(1U << 24));
+}
+
+// approximately normal distribution, as Aircraft::rand_normal
+static float rand_normal(float mean, float stddev)
+{
+    float sum = 0;
+    for (uint8_t i = 0; i < 12; i++) {
+        sum += rand_float(0, 1);
+    }
+    return mean + (sum - 6) * stddev;
+}
+
+static const Location bench_loc{-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE};
+static const Vector3f bench_vel{15, 5, 0};
+
+static bench_target *create_targets(uint16_t num_targets)
+{
+    bench_target *targets = NEW_NOTHROW bench_target[num_targets];
+    if (targets == nullptr) {
+        AP_HAL::panic("out of memory");
+    }
+    rand_state = 1;
+    for (uint16_t i = 0; i < num_targets; i++) {
+        targets[i].icao = 0x7C0000 + (uint32_t)rand_float(0, 0xFFFF);
+        targets[i].loc = bench_loc;
+        targets[i].loc.offset(rand_normal(0, BENCH_ADSB_RADIUS_M), rand_normal(0, BENCH_ADSB_RADIUS_M));
+        targets[i].loc.alt += rand_float(-100000, 100000);
+        // light aircraft to jets
+        const float scale = (i % 3) == 0 ? 1 : ((i % 3) == 1 ? 3 : 10);
+        targets[i].vel = Vector3f{rand_normal(5, 20) * scale, rand_normal(5, 20) * scale, rand_normal(-3, 3)};
+    }
+    return targets;
+}
+
+static void BM_AvoidanceThreatsSingle(benchmark::State& state)
+{
+    const uint16_t num_targets = state.range(0);
+    bench_target *targets = create_targets(num_targets);
+
+    while (state.KeepRunning()) {
+        // calculation made for each obstacle by AP_Avoidance before batching
+        uint16_t num_threats = 0;
+        for (uint16_t i = 0; i < num_targets; i++) {
+            uint8_t level = 0;
+            float closest_xy = closest_approach_xy(bench_loc, bench_vel, targets[i].loc, targets[i].vel, BENCH_FAIL_TIME_HORIZON);
+            if (closest_xy < BENCH_FAIL_DISTANCE_XY) {
+                level = 2;
+            } else {
+                closest_xy = closest_approach_xy(bench_loc, bench_vel, targets[i].loc, targets[i].vel, BENCH_WARN_TIME_HORIZON);
+                if (closest_xy < BENCH_WARN_DISTANCE_XY) {
+                    level = 1;
+                }
+            }
+            float closest_z = closest_approach_z(bench_loc, bench_vel, targets[i].loc, targets[i].vel, BENCH_WARN_TIME_HORIZON);
+            if (level != 0) {
+                if (closest_z > BENCH_WARN_DISTANCE_Z) {
+                    level = 0;
+                } else {
+                    closest_z = closest_approach_z(bench_loc, bench_vel, targets[i].loc, targets[i].vel, BENCH_FAIL_TIME_HORIZON);
+                    if (closest_z > BENCH_FAIL_DISTANCE_Z) {
+                        level = 1;
+                    }
+                }
+            }
+            float distance_to_closest = bench_loc.get_distance(targets[i].loc) - closest_xy;
+            gbenchmark_escape(&distance_to_closest);
+            gbenchmark_escape(&closest_z);
+            num_threats += (level != 0);
+        }
+        gbenchmark_escape(&num_threats);
+    }
+    delete[] targets;
+}
+
+static void BM_AvoidanceThreatsBatch(benchmark::State& state)
+{
+    const uint16_t num_targets = state.range(0);
+    bench_target *targets = create_targets(num_targets);
+    AP_Avoidance_CPA *cpa = NEW_NOTHROW AP_Avoidance_CPA();
+    if ((cpa == nullptr) || !cpa->init(num_targets)) {
+        AP_HAL::panic("out of memory");
+    }
+
+    while (state.KeepRunning()) {
+        // same steps as AP_Avoidance::check_for_threats
+        cpa->reset();
+        for (uint16_t i = 0; i < num_targets; i++) {
+            cpa->add(targets[i].loc.get_distance_NE(bench_loc), targets[i].loc.alt - bench_loc.alt,
+                     targets[i].vel - bench_vel, BENCH_FAIL_TIME_HORIZON, BENCH_WARN_TIME_HORIZON);
+        }
+        cpa->calculate(BENCH_FAIL_DISTANCE_XY, BENCH_FAIL_DISTANCE_Z, BENCH_WARN_DISTANCE_XY, BENCH_WARN_DISTANCE_Z);
+        uint16_t num_threats = 0;
+        for (uint16_t i = 0; i < num_targets; i++) {
+            num_threats += (cpa->threat_level(i) != MAV_COLLISION_THREAT_LEVEL_NONE);
+        }
+        gbenchmark_escape(&num_threats);
+    }
+    delete cpa;
+    delete[] targets;
+}
+
+static void BM_ADSBFindLinear(benchmark::State& state)
+{
+    const uint16_t num_targets = state.range(0);
+    bench_target *targets = create_targets(num_targets);
+
+    while (state.KeepRunning()) {
+        // one report from each target, searching as AP_ADSB::find_index did
+        for (uint16_t n = 0; n < num_targets; n++) {
+            const uint32_t icao = targets[(n * 7) % num_targets].icao;
+            uint16_t index = UINT16_MAX;
+            for (uint16_t i = 0; i < num_targets; i++) {
+                if (targets[i].icao == icao) {
+                    index = i;
+                    break;
+                }
+            }
+            gbenchmark_escape(&index);
+        }
+    }
+    delete[] targets;
+}
+
+static void BM_ADSBFindMap(benchmark::State& state)
+{
+    const uint16_t num_targets = state.range(0);
+    bench_target *targets = create_targets(num_targets);
+    AP_ADSB_ICAO_Map *map = NEW_NOTHROW AP_ADSB_ICAO_Map();
+    if ((map == nullptr) || !map->init(num_targets)) {
+        AP_HAL::panic("out of memory");
+    }
+    for (uint16_t i = 0; i < num_targets; i++) {
+        map->set(targets[i].icao, i);
+    }
+
+    while (state.KeepRunning()) {
+        for (uint16_t n = 0; n < num_targets; n++) {
+            const uint32_t icao = targets[(n * 7) % num_targets].icao;
+            uint16_t index = UINT16_MAX;
+            bool found = map->find(icao, index);
+            gbenchmark_escape(&found);
+            gbenchmark_escape(&index);
+        }
+    }
+    delete map;
+    delete[] targets;
+}
+
+BENCHMARK(BM_AvoidanceThreatsSingle)->Arg(50)->Arg(100)->Arg(500);
+BENCHMARK(BM_AvoidanceThreatsBatch)->Arg(50)->Arg(100)->Arg(500);
+BENCHMARK(BM_ADSBFindLinear)->Arg(50)->Arg(100)->Arg(500);
+BENCHMARK(BM_ADSBFindMap)->Arg(50)->Arg(100)->Arg(500);
+#endif
+
+BENCHMARK_MAIN()
@@ -0,0 +1,173 @@
+#include <AP_gtest.h>
+
+#include <AP_Avoidance/AP_Avoidance.h>
+
+#include <fenv.h>
+#include <setjmp.h>
+#include <signal.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_ADSB_AVOIDANCE_ENABLED
+
+#define TEST_FAIL_DISTANCE_XY   300.0f
+#define TEST_FAIL_DISTANCE_Z    100.0f
+#define TEST_WARN_DISTANCE_XY   1000.0f
+#define TEST_WARN_DISTANCE_Z    300.0f
+
+static uint32_t test_seed = 1;
+static float test_rand(float min, float max)
+{
+    test_seed = test_seed * 1664525U + 1013904223U;
+    return min + (max - min) * ((test_seed >> 8) / float(1U << 24));
+}
+
+// threat level and closest approach as calculated for a single obstacle by AP_Avoidance before batching
+static MAV_COLLISION_THREAT_LEVEL reference_threat(const Location &my_loc, const Vector3f &my_vel,
+                                                   const Location &obstacle_loc, const Vector3f &obstacle_vel,
+                                                   uint8_t fail_time_horizon, uint8_t warn_time_horizon,
+                                                   float &closest_xy, float &closest_z)
+{
+    MAV_COLLISION_THREAT_LEVEL level = MAV_COLLISION_THREAT_LEVEL_NONE;
+    closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, fail_time_horizon);
+    if (closest_xy < TEST_FAIL_DISTANCE_XY) {
+        level = MAV_COLLISION_THREAT_LEVEL_HIGH;
+    } else {
+        closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, warn_time_horizon);
+        if (closest_xy < TEST_WARN_DISTANCE_XY) {
+            level = MAV_COLLISION_THREAT_LEVEL_LOW;
+        }
+    }
+    closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, warn_time_horizon);
+    if (level != MAV_COLLISION_THREAT_LEVEL_NONE) {
+        if (closest_z > TEST_WARN_DISTANCE_Z) {
+            level = MAV_COLLISION_THREAT_LEVEL_NONE;
+        } else {
+            closest_z = closest_approach_z(my_loc, my_vel, obstacle_loc, obstacle_vel, fail_time_horizon);
+            if (closest_z > TEST_FAIL_DISTANCE_Z) {
+                level = MAV_COLLISION_THREAT_LEVEL_LOW;
+            }
+        }
+    }
+    return level;
+}
+
+TEST(AvoidanceCPA, MatchesSingleObstacle)
+{
+    const uint16_t num_obstacles = 500;
+    AP_Avoidance_CPA cpa;
+    ASSERT_TRUE(cpa.init(num_obstacles));
+
+    Location obstacle_locs[num_obstacles];
+    Vector3f obstacle_vels[num_obstacles];
+    const Location my_loc{-353632610, 1491652300, 50000, Location::AltFrame::ABSOLUTE};
+    const Vector3f my_vel{test_rand(-20, 20), test_rand(-20, 20), test_rand(-3, 3)};
+
+    for (uint16_t i = 0; i < num_obstacles; i++) {
+        obstacle_locs[i] = my_loc;
+        obstacle_locs[i].offset(test_rand(-5000, 5000), test_rand(-5000, 5000));
+        obstacle_locs[i].alt += test_rand(-50000, 50000);
+        obstacle_vels[i] = Vector3f{test_rand(-60, 60), test_rand(-60, 60), test_rand(-5, 5)};
+        // every fifth obstacle is stationary relative to us
+        if ((i % 5) == 0) {
+            obstacle_vels[i] = my_vel;
+        }
+        EXPECT_TRUE(cpa.add(obstacle_locs[i].get_distance_NE(my_loc), obstacle_locs[i].alt - my_loc.alt,
+                            obstacle_vels[i] - my_vel, 30 + (i % 3), 60 + (i % 3)));
+    }
+    EXPECT_EQ(cpa.count(), num_obstacles);
+    EXPECT_FALSE(cpa.add(Vector2f{}, 0, Vector3f{}, 30, 60));
+
+    cpa.calculate(TEST_FAIL_DISTANCE_XY, TEST_FAIL_DISTANCE_Z, TEST_WARN_DISTANCE_XY, TEST_WARN_DISTANCE_Z);
+
+    uint16_t num_threats = 0;
+    for (uint16_t i = 0; i < num_obstacles; i++) {
+        float closest_xy, closest_z;
+        const MAV_COLLISION_THREAT_LEVEL level = reference_threat(my_loc, my_vel, obstacle_locs[i], obstacle_vels[i],
+                                                                  30 + (i % 3), 60 + (i % 3), closest_xy, closest_z);
+        EXPECT_EQ(cpa.threat_level(i), level);
+        EXPECT_NEAR(cpa.closest_approach_xy(i), closest_xy, 0.01f);
+        EXPECT_NEAR(cpa.closest_approach_z(i), closest_z, 0.01f);
+        EXPECT_NEAR(cpa.distance_to_closest_approach(i), my_loc.get_distance(obstacle_locs[i]) - closest_xy, 0.1f);
+        if (level != MAV_COLLISION_THREAT_LEVEL_NONE) {
+            num_threats++;
+        }
+    }
+    // the random obstacles should include some threats
+    EXPECT_GT(num_threats, 0);
+}
+
+TEST(AvoidanceCPA, HeadOn)
+{
+    AP_Avoidance_CPA cpa;
+    ASSERT_TRUE(cpa.init(2));
+
+    // obstacle 1km north at the same altitude flying towards us at 40m/s
+    cpa.add(Vector2f{-1000, 0}, 0, Vector3f{-40, 0, 0}, 30, 60);
+    // obstacle 1km north flying away from us
+    cpa.add(Vector2f{-1000, 0}, 0, Vector3f{20, 0, 0}, 30, 60);
+    cpa.calculate(TEST_FAIL_DISTANCE_XY, TEST_FAIL_DISTANCE_Z, TEST_WARN_DISTANCE_XY, TEST_WARN_DISTANCE_Z);
+
+    EXPECT_EQ(cpa.threat_level(0), MAV_COLLISION_THREAT_LEVEL_HIGH);
+    EXPECT_FLOAT_EQ(cpa.closest_approach_xy(0), 0);
+    EXPECT_FLOAT_EQ(cpa.distance_to_closest_approach(0), 1000);
+    EXPECT_FLOAT_EQ(cpa.time_to_closest_approach(0), 25);
+
+    EXPECT_EQ(cpa.threat_level(1), MAV_COLLISION_THREAT_LEVEL_NONE);
+    EXPECT_FLOAT_EQ(cpa.closest_approach_xy(1), 1000);
+    EXPECT_FLOAT_EQ(cpa.time_to_closest_approach(1), 0);
+
+    // re-using the same allocation drops previous obstacles
+    ASSERT_TRUE(cpa.init(2));
+    EXPECT_EQ(cpa.count(), 0);
+}
+
+static sigjmp_buf fpe_jmp;
+static void cpa_sig_fpe(int signum)
+{
+    siglongjmp(fpe_jmp, 1);
+}
+
+// obstacles not moving relative to us, or with no time horizon, must
+// not raise the floating point exceptions SITL traps
+TEST(AvoidanceCPA, NoFloatExceptions)
+{
+    AP_Avoidance_CPA cpa;
+    ASSERT_TRUE(cpa.init(3));
+    cpa.add(Vector2f{-1000, 0}, 0, Vector3f{0, 0, 0}, 30, 60);
+    cpa.add(Vector2f{0, 0}, 0, Vector3f{0, 0, 0}, 30, 60);
+    cpa.add(Vector2f{-200, 100}, 0, Vector3f{-40, 0, 0}, 0, 0);
+
+    struct sigaction old_sa_fpe {};
+    struct sigaction sa_fpe {};
+    sigemptyset(&sa_fpe.sa_mask);
+    sa_fpe.sa_handler = cpa_sig_fpe;
+    ASSERT_EQ(sigaction(SIGFPE, &sa_fpe, &old_sa_fpe), 0);
+    // the exceptions enabled by SIM_FLOAT_EXCEPT
+    const int excepts = FE_OVERFLOW | FE_DIVBYZERO | FE_INVALID;
+    feclearexcept(excepts);
+    feenableexcept(excepts);
+
+    bool signal_caught = false;
+    if (sigsetjmp(fpe_jmp, 1)) {
+        signal_caught = true;
+    } else {
+        cpa.calculate(TEST_FAIL_DISTANCE_XY, TEST_FAIL_DISTANCE_Z, TEST_WARN_DISTANCE_XY, TEST_WARN_DISTANCE_Z);
+    }
+
+    fedisableexcept(excepts);
+    feclearexcept(excepts);
+    sigaction(SIGFPE, &old_sa_fpe, nullptr);
+    ASSERT_FALSE(signal_caught);
+
+    EXPECT_EQ(cpa.threat_level(0), MAV_COLLISION_THREAT_LEVEL_NONE);
+    EXPECT_FLOAT_EQ(cpa.closest_approach_xy(0), 1000);
+    EXPECT_EQ(cpa.threat_level(1), MAV_COLLISION_THREAT_LEVEL_HIGH);
+    EXPECT_FLOAT_EQ(cpa.closest_approach_xy(1), 0);
+    EXPECT_EQ(cpa.threat_level(2), MAV_COLLISION_THREAT_LEVEL_HIGH);
+    EXPECT_FLOAT_EQ(cpa.closest_approach_xy(2), sqrtf(200*200 + 100*100));
+}
+
+#endif  // AP_ADSB_AVOIDANCE_ENABLED
+
+AP_GTEST_MAIN()
@@ -282,6 +282,52 @@ void AP_DAL::free_type(void *ptr, size_t size, MemoryType mem_type) const
     return hal.util->free_type(ptr, size, AP_HAL::Util::Memory_Type(mem_type));
 }
 
+AP_DAL_IMUHistory *AP_DAL::imu_history_acquire(uint8_t gyro_index, uint8_t accel_index, uint8_t length,
+                                               const AP_DAL_IMUHistory *copy_from)
+{
+    AP_DAL_IMUHistory **free_slot = nullptr;
+    for (auto &h : _imu_history) {
+        if (h == nullptr || h->users == 0) {
+            if (free_slot == nullptr) {
+                free_slot = &h;
+            }
+            continue;
+        }
+        if (h->gyro_index() == gyro_index &&
+            h->accel_index() == accel_index &&
+            h->length() == length) {
+            h->users++;
+            return h;
+        }
+    }
+    if (free_slot == nullptr) {
+        return nullptr;
+    }
+    if (*free_slot == nullptr) {
+        *free_slot = NEW_NOTHROW AP_DAL_IMUHistory();
+        if (*free_slot == nullptr) {
+            return nullptr;
+        }
+    }
+    AP_DAL_IMUHistory *h = *free_slot;
+    if (!h->init(gyro_index, accel_index, length)) {
+        return nullptr;
+    }
+    if (copy_from != nullptr) {
+        h->copy_from(*copy_from);
+    }
+    h->users = 1;
+    return h;
+}
+
+void AP_DAL::imu_history_release(AP_DAL_IMUHistory *history)
+{
+    if (history != nullptr && history->users > 0) {
+        // the history is kept allocated for reuse
+        history->users--;
+    }
+}
+
 // map core number for replay
 uint8_t AP_DAL::logging_core(uint8_t c) const
 {
@@ -8,6 +8,7 @@
 #include "AP_DAL_Airspeed.h"
 #include "AP_DAL_Beacon.h"
 #include "AP_DAL_VisualOdom.h"
+#include "AP_DAL_IMUHistory.h"
 
 #include "LogStructure.h"
 
@@ -136,6 +137,17 @@ public:
     void free_type(void *ptr, size_t size, MemoryType memtype) const;
 
     AP_DAL_InertialSensor &ins() { return _ins; }
+
+    /*
+      get a downsampled IMU history for a gyro and accel pair with
+      the given buffer length, allocating one if needed. If a new
+      history is allocated it starts with a copy of the data in
+      copy_from, if not null. Returns nullptr on allocation failure.
+      Each successful call must be matched by imu_history_release()
+     */
+    AP_DAL_IMUHistory *imu_history_acquire(uint8_t gyro_index, uint8_t accel_index, uint8_t length,
+                                           const AP_DAL_IMUHistory *copy_from);
+    void imu_history_release(AP_DAL_IMUHistory *history);
     AP_DAL_Baro &baro() { return _baro; }
     AP_DAL_GPS &gps() { return _gps; }
 
@@ -374,6 +386,9 @@ private:
     uint32_t _last_imu_time_us;
 
     AP_DAL_InertialSensor _ins;
+    // one history per IMU pair in use, plus one so a user can switch
+    // IMUs while keeping its old history to copy from
+    AP_DAL_IMUHistory *_imu_history[INS_MAX_INSTANCES+1];
     AP_DAL_Baro _baro;
     AP_DAL_GPS _gps;
 #if AP_RANGEFINDER_ENABLED
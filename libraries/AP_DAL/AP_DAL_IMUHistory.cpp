@@ -0,0 +1,118 @@
+#include "AP_DAL_IMUHistory.h"
+
+#include "AP_DAL_InertialSensor.h"
+
+bool AP_DAL_IMUHistory::init(uint8_t gyro_index, uint8_t accel_index, uint8_t length)
+{
+    if (!buffer.init(length)) {
+        return false;
+    }
+    _gyro_index = gyro_index;
+    _accel_index = accel_index;
+    _length = length;
+
+    frame = {};
+    frame.gyro_index = gyro_index;
+    frame.accel_index = accel_index;
+    downsampled = frame;
+    quat.initialise();
+    last_frame_us = 0;
+    last_push_us = 0;
+    return true;
+}
+
+void AP_DAL_IMUHistory::reset(void)
+{
+    buffer.reset();
+    downsampled.delAng.zero();
+    downsampled.delVel.zero();
+    downsampled.delAngDT = 0.0f;
+    downsampled.delVelDT = 0.0f;
+}
+
+void AP_DAL_IMUHistory::copy_from(const AP_DAL_IMUHistory &other)
+{
+    if (!buffer.copy_from(other.buffer)) {
+        return;
+    }
+    frame = other.frame;
+    downsampled = other.downsampled;
+    quat = other.quat;
+    last_frame_us = other.last_frame_us;
+    last_push_us = other.last_push_us;
+}
+
+void AP_DAL_IMUHistory::update(const AP_DAL_InertialSensor &ins, uint64_t frame_us, uint32_t time_ms,
+                               bool allow_push, ftype dt_imu_avg, ftype target_dt)
+{
+    if (frame_us == last_frame_us) {
+        // another user has already added this frame
+        return;
+    }
+    last_frame_us = frame_us;
+
+    if (_accel_index < ins.get_accel_count()) {
+        Vector3f dVelF;
+        float dVel_dtF;
+        ins.get_delta_velocity(_accel_index, dVelF, dVel_dtF);
+        frame.delVel = dVelF.toftype();
+        frame.delVelDT = dVel_dtF;
+        frame.delVelDT = MAX(frame.delVelDT,1.0e-4);
+    }
+    frame.accel_index = _accel_index;
+
+    if (_gyro_index < ins.get_gyro_count()) {
+        Vector3f dAngF;
+        float dAngDTF;
+        ins.get_delta_angle(_gyro_index, dAngF, dAngDTF);
+        frame.delAng = dAngF.toftype();
+        frame.delAngDT = dAngDTF;
+    }
+    frame.delAngDT = MAX(frame.delAngDT, 1.0e-4f);
+    frame.gyro_index = _gyro_index;
+    frame.time_ms = time_ms;
+
+    // Accumulate the measurement time interval for the delta velocity and angle data
+    downsampled.delAngDT += frame.delAngDT;
+    downsampled.delVelDT += frame.delVelDT;
+    downsampled.gyro_index = _gyro_index;
+    downsampled.accel_index = _accel_index;
+
+    // Rotate quaternon atitude from previous to new and normalise.
+    quat.rotate(frame.delAng);
+    quat.normalize();
+
+    // Rotate the latest delta velocity into body frame at the start of accumulation
+    Matrix3F deltaRotMat;
+    quat.rotation_matrix(deltaRotMat);
+
+    // Apply the delta velocity to the delta velocity accumulator
+    downsampled.delVel += deltaRotMat*frame.delVel;
+
+    /*
+     * If the target EKF time step has been accumulated, and the user has allowed start of a new predict cycle,
+     * then store the accumulated IMU data to be used by the state prediction, ignoring the user permission if more
+     * than twice the target time has lapsed. Adjust the target EKF step time threshold to allow for timing jitter in the
+     * IMU data.
+     */
+    if ((downsampled.delAngDT >= (target_dt-(dt_imu_avg*0.5f)) && allow_push) ||
+        (downsampled.delAngDT >= 2.0f*target_dt)) {
+
+        // convert the accumulated quaternion to an equivalent delta angle
+        quat.to_axis_angle(downsampled.delAng);
+
+        // Time stamp the data
+        downsampled.time_ms = time_ms;
+
+        // Write data to the FIFO IMU buffer
+        buffer.push_youngest_element(downsampled);
+        last_push_us = frame_us;
+
+        // zero the accumulated IMU data and quaternion
+        downsampled.delAng.zero();
+        downsampled.delVel.zero();
+        downsampled.delAngDT = 0.0f;
+        downsampled.delVelDT = 0.0f;
+        quat.initialise();
+    }
+}
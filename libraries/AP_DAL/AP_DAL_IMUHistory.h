@@ -0,0 +1,86 @@
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+#include <AP_NavEKF/EKF_Buffer.h>
+
+class AP_DAL_InertialSensor;
+
+/*
+  IMU data for one gyro and accel pair downsampled to the EKF
+  prediction rate, with a ring buffer of downsampled samples covering
+  the EKF fusion delay. EKF cores using the same IMUs reference one
+  history rather than each downsampling the same data into their own
+  buffer
+ */
+class AP_DAL_IMUHistory {
+public:
+    struct Sample {
+        Vector3F    delAng;         // IMU delta angle measurements in body frame (rad)
+        Vector3F    delVel;         // IMU delta velocity measurements in body frame (m/sec)
+        ftype       delAngDT;       // time interval over which delAng has been measured (sec)
+        ftype       delVelDT;       // time interval over which delVelDT has been measured (sec)
+        uint32_t    time_ms;        // measurement timestamp (msec)
+        uint8_t     gyro_index;
+        uint8_t     accel_index;
+    };
+
+    // allocate the buffer, returns false on allocation failure
+    bool init(uint8_t gyro_index, uint8_t accel_index, uint8_t length);
+
+    // zero the buffered and partially downsampled data
+    void reset(void);
+
+    // take over the buffered and partially downsampled data of
+    // another history, used when a user switches IMUs so it keeps
+    // its history
+    void copy_from(const AP_DAL_IMUHistory &other);
+
+    /*
+      add the IMU data for the frame starting at frame_us. Only the
+      first call in a frame has any effect, so all users of the
+      history can call this. A downsampled sample is pushed into the
+      buffer once target_dt has been accumulated if allow_push is
+      true, or once twice target_dt has been accumulated regardless
+     */
+    void update(const AP_DAL_InertialSensor &ins, uint64_t frame_us, uint32_t time_ms,
+                bool allow_push, ftype dt_imu_avg, ftype target_dt);
+
+    // true if a downsampled sample was pushed in the frame
+    bool pushed(uint64_t frame_us) const { return last_push_us == frame_us; }
+
+    // the IMU data for the most recent frame
+    const Sample &latest() const { return frame; }
+
+    // the most recently pushed and the oldest downsampled samples
+    const Sample &youngest() { return buffer[buffer.get_youngest_index()]; }
+    Sample oldest() { return buffer.get_oldest_element(); }
+
+    uint8_t get_youngest_index() { return buffer.get_youngest_index(); }
+    uint8_t get_oldest_index() { return buffer.get_oldest_index(); }
+    bool is_filled() const { return buffer.is_filled(); }
+
+    uint8_t gyro_index() const { return _gyro_index; }
+    uint8_t accel_index() const { return _accel_index; }
+    uint8_t length() const { return _length; }
+
+    // number of EKF cores referencing this history
+    uint8_t users;
+
+private:
+    EKF_IMU_buffer_t<Sample> buffer;
+
+    // the latest frame and the downsampled sample being accumulated
+    Sample frame;
+    Sample downsampled;
+
+    // rotation since the start of the downsampled sample. Accumulating
+    // with a quaternion prevents coning errors from downsampling
+    QuaternionF quat;
+
+    uint64_t last_frame_us;
+    uint64_t last_push_us;
+
+    uint8_t _gyro_index;
+    uint8_t _accel_index;
+    uint8_t _length;
+};
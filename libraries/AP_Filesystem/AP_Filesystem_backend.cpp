@@ -18,6 +18,26 @@
 
 extern const AP_HAL::HAL& hal;
 
+/*
+  gather write for backends without a native writev. Each buffer is
+  written in turn, stopping at the first short write
+*/
+int32_t AP_Filesystem_Backend::writev(int fd, const ByteBuffer::IoVec *iov, uint8_t iovcnt)
+{
+    int32_t total = 0;
+    for (uint8_t i=0; i<iovcnt; i++) {
+        const int32_t ret = write(fd, iov[i].data, iov[i].len);
+        if (ret < 0) {
+            return total > 0 ? total : ret;
+        }
+        total += ret;
+        if (uint32_t(ret) != iov[i].len) {
+            break;
+        }
+    }
+    return total;
+}
+
 /*
   Load a file's contents into memory. Returned object must be `delete`d to free
   the data. The data is guaranteed to be null-terminated such that it can be
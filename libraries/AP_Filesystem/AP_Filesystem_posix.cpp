@@ -34,6 +34,10 @@
 #include <utime.h>
 #endif
 
+#if AP_FILESYSTEM_POSIX_HAVE_WRITEV
+#include <sys/uio.h>
+#endif
+
 extern const AP_HAL::HAL& hal;
 
 /*
@@ -113,6 +117,22 @@ int32_t AP_Filesystem_Posix::write(int fd, const void *buf, uint32_t count)
     return ::write(fd, buf, count);
 }
 
+int32_t AP_Filesystem_Posix::writev(int fd, const ByteBuffer::IoVec *iov, uint8_t iovcnt)
+{
+#if AP_FILESYSTEM_POSIX_HAVE_WRITEV
+    FS_CHECK_ALLOWED(-1);
+    struct iovec vec[4];
+    if (iovcnt <= ARRAY_SIZE(vec)) {
+        for (uint8_t i=0; i<iovcnt; i++) {
+            vec[i].iov_base = iov[i].data;
+            vec[i].iov_len = iov[i].len;
+        }
+        return ::writev(fd, vec, iovcnt);
+    }
+#endif
+    return AP_Filesystem_Backend::writev(fd, iov, iovcnt);
+}
+
 int AP_Filesystem_Posix::fsync(int fd)
 {
 #if AP_FILESYSTEM_POSIX_HAVE_FSYNC
@@ -169,8 +169,8 @@ const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
 
     // @Param: OPTIONS
     // @DisplayName: FFT options
-    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference
-    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise
+    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference,4:Use an incremental sliding DFT restricted to the MINHZ-MAXHZ range rather than a full FFT per frame, this updates the spectrum on every sample at a lower CPU cost for large windows
+    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise,2:Sliding DFT
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("OPTIONS", 15, AP_GyroFFT, _options, 0),
@@ -318,6 +318,21 @@ __INITFUNC__ void AP_GyroFFT::init(uint16_t loop_rate_hz)
         return;
     }
 
+    // the sliding DFT keeps a spectrum per axis, fall back to the FFT if it cannot be allocated
+    if (using_sliding_dft()) {
+        for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            _sliding_dft[axis] = hal.dsp->sdft_init(_window_size);
+            if (_sliding_dft[axis] == nullptr) {
+                GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AP_GyroFFT: sliding DFT disabled");
+                for (uint8_t i = 0; i < axis; i++) {
+                    delete _sliding_dft[i];
+                    _sliding_dft[i] = nullptr;
+                }
+                break;
+            }
+        }
+    }
+
     // per-axis frame time
     _frame_time_ms = _samples_per_frame * 1000 / _fft_sampling_rate_hz;
     // The update rate for the output, defaults are 1Khz / (1 - 0.5) * 32 == 62hz
@@ -456,16 +471,24 @@ uint16_t AP_GyroFFT::run_cycle()
 
     // get the appropriate gyro buffer
     FloatBuffer& gyro_buffer = (_sample_mode == 0 ?_ins->get_raw_gyro_window(_update_axis) : _downsampled_gyro_data[_update_axis]);
-    // if we have many more samples than the window size then we are struggling to 
-    // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
-    if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
-        gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
-    }
-    // let's go!
-    hal.dsp->fft_start(_state, gyro_buffer, _samples_per_frame);
+    uint16_t bin_max;
 
-    // calculate FFT and update filters outside the semaphore
-    uint16_t bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+    if (_sliding_dft[_update_axis] != nullptr) {
+        // fold every new sample into the tracked bins and analyse the resulting spectrum
+        hal.dsp->sdft_update(_sliding_dft[_update_axis], gyro_buffer, gyro_buffer.available());
+        bin_max = hal.dsp->sdft_analyse(_state, _sliding_dft[_update_axis], config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+    } else {
+        // if we have many more samples than the window size then we are struggling to
+        // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
+        if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
+            gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
+        }
+        // let's go!
+        hal.dsp->fft_start(_state, gyro_buffer, _samples_per_frame);
+
+        // calculate FFT and update filters outside the semaphore
+        bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+    }
 
     // something has been detected, update the peak frequency and associated metrics
     update_ref_energy(bin_max);
@@ -532,7 +555,7 @@ bool AP_GyroFFT::start_analysis() {
         return false;
     }
 
-    if (get_available_samples(_update_axis) >= _state->_window_size) {
+    if (get_available_samples(_update_axis) >= get_required_samples()) {
         _thread_state._analysis_started = true;
         return true;
     }
@@ -576,7 +599,7 @@ void AP_GyroFFT::update_thread(void)
         // this is to stop us burning CPU while waiting for samples, the reduction by _samples_per_frame is a heuristic to prevent waiting too long
         // and missing frames (easy to see in SITL because the noise will keep calibrating)
         // we always delay by at least 1us to give logging a chance to run at the same priority
-        uint32_t delay = constrain_int32((int16_t)_state->_window_size - (int16_t)remaining_samples, 0, _samples_per_frame)
+        uint32_t delay = constrain_int32((int16_t)get_required_samples() - (int16_t)remaining_samples, 0, _samples_per_frame)
             * 1e6 / _fft_sampling_rate_hz;
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         // in SITL the gyros do not run in a different thread
@@ -1400,8 +1423,14 @@ void AP_GyroFFT::update_ref_energy(uint16_t max_bin)
 // called from main thread
 float AP_GyroFFT::self_test_bin_frequencies()
 {
-    if (_state->_window_size * sizeof(float) > hal.util->available_memory() / 2) {
-        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "FFT: unable to run self-test, required %u bytes", (unsigned int)(_state->_window_size * sizeof(float)));
+    // the sliding DFT is tested with its own state so that the test tone never enters the gyro history
+    const bool sliding = _sliding_dft[0] != nullptr;
+    uint32_t required = _state->_window_size * sizeof(float);
+    if (sliding) {
+        required += (_state->_window_size + 4 * (_state->_window_size / 2 + 1)) * sizeof(float);
+    }
+    if (required > hal.util->available_memory() / 2) {
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "FFT: unable to run self-test, required %u bytes", (unsigned int)required);
         return 0.0f;
     }
 
@@ -1410,23 +1439,32 @@ float AP_GyroFFT::self_test_bin_frequencies()
     if (test_window.get_size() == 0) {
         return 0.0f;
     }
+    AP_HAL::DSP::SlidingDFTState* test_sdft = nullptr;
+    if (sliding) {
+        test_sdft = hal.dsp->sdft_init(_state->_window_size);
+        if (test_sdft == nullptr) {
+            return 0.0f;
+        }
+    }
 
     float max_divergence = 0;
 
     for (uint16_t bin = _config._fft_start_bin; bin <= _config._fft_end_bin; bin++) {
         // the algorithm will only ever return values in this range
         float frequency = constrain_float(bin * _state->_bin_resolution, _fft_min_hz, _fft_max_hz);
-        max_divergence = MAX(max_divergence, self_test(frequency, test_window)); // test bin centers
+        max_divergence = MAX(max_divergence, self_test(frequency, test_window, test_sdft)); // test bin centers
         frequency = constrain_float(bin * _state->_bin_resolution - _state->_bin_resolution / 4, _fft_min_hz, _fft_max_hz);
-        max_divergence = MAX(max_divergence, self_test(frequency, test_window)); // test bin off-centers
+        max_divergence = MAX(max_divergence, self_test(frequency, test_window, test_sdft)); // test bin off-centers
     }
 
+    delete test_sdft;
+
     return max_divergence;
 }
 
-// perform FFT analysis of a single sine wave at the selected frequency
+// perform FFT analysis of a single sine wave at the selected frequency, using test_sdft if not null
 // called from main thread
-float AP_GyroFFT::self_test(float frequency, FloatBuffer& test_window)
+float AP_GyroFFT::self_test(float frequency, FloatBuffer& test_window, AP_HAL::DSP::SlidingDFTState* test_sdft)
 {
     test_window.clear();
     for(uint16_t i = 0; i < _state->_window_size; i++) {
@@ -1436,15 +1474,27 @@ float AP_GyroFFT::self_test(float frequency, FloatBuffer& test_window)
     }
 
     _update_axis = 0;
-
-    // if using averaging we need to process _num_frames in order to not bias the result
-    for (uint8_t i = 1; i < _num_frames; i++) {
+    uint16_t max_bin;
+
+    if (test_sdft != nullptr) {
+        // a whole window of samples completely replaces the sliding DFT history
+        hal.dsp->sdft_update(test_sdft, test_window, _state->_window_size);
+        // if using averaging we need to process _num_frames in order to not bias the result
+        for (uint8_t i = 1; i < _num_frames; i++) {
+            hal.dsp->sdft_analyse(_state, test_sdft, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
+        }
+        // final cycle is the one we want
+        max_bin = hal.dsp->sdft_analyse(_state, test_sdft, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
+    } else {
+        // if using averaging we need to process _num_frames in order to not bias the result
+        for (uint8_t i = 1; i < _num_frames; i++) {
+            hal.dsp->fft_start(_state, test_window, 0);
+            hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
+        }
+        // final cycle is the one we want
         hal.dsp->fft_start(_state, test_window, 0);
-        hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
+        max_bin = hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
     }
-    // final cycle is the one we want
-    hal.dsp->fft_start(_state, test_window, 0);
-    uint16_t max_bin = hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
 
     if (max_bin == 0) {
         GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "FFT: self-test failed, failed to find frequency %.1f", frequency);
@@ -40,7 +40,8 @@ public:
 
     enum class Options : uint32_t {
         FFTPostFilter = 1 << 0,
-        ESCNoiseCheck = 1 << 1
+        ESCNoiseCheck = 1 << 1,
+        SlidingDFT = 1 << 2
     };
 
     AP_GyroFFT();
@@ -111,6 +112,8 @@ public:
     bool using_post_filter_samples() const { return (_options & uint32_t(Options::FFTPostFilter)) != 0; }
     // post filter mask of IMUs
     bool check_esc_noise() const { return (_options & uint32_t(Options::ESCNoiseCheck)) != 0; }
+    // use an incremental sliding DFT rather than a full FFT per frame
+    bool using_sliding_dft() const { return (_options & uint32_t(Options::SlidingDFT)) != 0; }
     // look for a frequency in the detected noise
     float has_noise_at_frequency_hz(float freq) const;
     static float calculate_notch_frequency(float* freqs, uint16_t numpeaks, float harmonic_fit, uint8_t& harmonics);
@@ -215,11 +218,13 @@ private:
     // test frequency detection for all of the allowable bins
     float self_test_bin_frequencies();
     // detect the provided frequency
-    float self_test(float frequency, FloatBuffer& test_window);
+    float self_test(float frequency, FloatBuffer& test_window, AP_HAL::DSP::SlidingDFTState* test_sdft);
     // whether to run analysis or not
     bool analysis_enabled() const { return _initialized && _analysis_enabled && _thread_created; };
     // whether analysis can be run again or not
     bool start_analysis();
+    // number of samples required before analysis can be run
+    uint16_t get_required_samples() const { return _sliding_dft[0] != nullptr ? _samples_per_frame : _state->_window_size; }
     // return samples available in the gyro window
     uint16_t get_available_samples(uint8_t axis) {
         return _sample_mode == 0 ?_ins->get_raw_gyro_window(axis).available() : _downsampled_gyro_data[axis].available();
@@ -283,6 +288,8 @@ private:
 
     // state of the FFT engine
     AP_HAL::DSP::FFTWindowState* _state;
+    // per-axis state of the sliding DFT engine, if enabled
+    AP_HAL::DSP::SlidingDFTState* _sliding_dft[XYZ_AXIS_COUNT];
     // update state machine step information
     uint8_t _update_axis;
     // noise base of the gyros
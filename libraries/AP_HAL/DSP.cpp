@@ -373,6 +373,185 @@ uint16_t DSP::fft_stop_average(FFTWindowState* fft, uint16_t start_bin, uint16_t
     return numpeaks;
 }
 
+// create an instance of the sliding DFT state
+DSP::SlidingDFTState::SlidingDFTState(uint16_t window_size) :
+    _window_size(window_size),
+    _first_bin(1),
+    _last_bin(0),
+    _history_idx(0),
+    _samples_since_resync(0)
+{
+    // storage for all possible bins so that the tracked range can change without reallocation
+    const uint16_t num_bins = window_size / 2 + 1;
+    _bins_re = (float*)hal.util->malloc_type(sizeof(float) * num_bins, DSP_MEM_REGION);
+    _bins_im = (float*)hal.util->malloc_type(sizeof(float) * num_bins, DSP_MEM_REGION);
+    _rotation_re = (float*)hal.util->malloc_type(sizeof(float) * num_bins, DSP_MEM_REGION);
+    _rotation_im = (float*)hal.util->malloc_type(sizeof(float) * num_bins, DSP_MEM_REGION);
+    _history = (float*)hal.util->malloc_type(sizeof(float) * window_size, DSP_MEM_REGION);
+
+    if (_bins_re == nullptr || _bins_im == nullptr || _rotation_re == nullptr || _rotation_im == nullptr || _history == nullptr) {
+        free_data_structures();
+    }
+}
+
+DSP::SlidingDFTState::~SlidingDFTState()
+{
+    free_data_structures();
+}
+
+void DSP::SlidingDFTState::free_data_structures()
+{
+    const uint16_t num_bins = _window_size / 2 + 1;
+    hal.util->free_type(_bins_re, sizeof(float) * num_bins, DSP_MEM_REGION);
+    _bins_re = nullptr;
+    hal.util->free_type(_bins_im, sizeof(float) * num_bins, DSP_MEM_REGION);
+    _bins_im = nullptr;
+    hal.util->free_type(_rotation_re, sizeof(float) * num_bins, DSP_MEM_REGION);
+    _rotation_re = nullptr;
+    hal.util->free_type(_rotation_im, sizeof(float) * num_bins, DSP_MEM_REGION);
+    _rotation_im = nullptr;
+    hal.util->free_type(_history, sizeof(float) * _window_size, DSP_MEM_REGION);
+    _history = nullptr;
+}
+
+// initialise a sliding DFT, no bins are tracked until the first analysis
+DSP::SlidingDFTState* DSP::sdft_init(uint16_t window_size)
+{
+    SlidingDFTState* sdft = NEW_NOTHROW SlidingDFTState(window_size);
+    if (sdft == nullptr || sdft->_bins_re == nullptr) {
+        delete sdft;
+        return nullptr;
+    }
+    return sdft;
+}
+
+// consume samples from the buffer, for each sample X[k] = (X[k] - x_oldest + x_newest) * e^(i*2*pi*k/N)
+// this costs one complex multiply per tracked bin per sample rather than a full FFT per frame
+void DSP::sdft_update(SlidingDFTState* sdft, FloatBuffer& samples, uint32_t count)
+{
+    float* bins_re = sdft->_bins_re;
+    float* bins_im = sdft->_bins_im;
+    const float* rotation_re = sdft->_rotation_re;
+    const float* rotation_im = sdft->_rotation_im;
+
+    while (count > 0) {
+        uint32_t n = 0;
+        const float* data = samples.readptr(n);
+        if (data == nullptr || n == 0) {
+            break;
+        }
+        n = MIN(n, count);
+
+        for (uint32_t i = 0; i < n; i++) {
+            const float delta = data[i] - sdft->_history[sdft->_history_idx];
+            sdft->_history[sdft->_history_idx] = data[i];
+            if (++sdft->_history_idx >= sdft->_window_size) {
+                sdft->_history_idx = 0;
+            }
+
+            for (uint16_t k = sdft->_first_bin; k <= sdft->_last_bin; k++) {
+                const float re = bins_re[k] + delta;
+                const float im = bins_im[k];
+                bins_re[k] = re * rotation_re[k] - im * rotation_im[k];
+                bins_im[k] = re * rotation_im[k] + im * rotation_re[k];
+            }
+        }
+
+        samples.advance(n);
+        count -= n;
+        sdft->_samples_since_resync += n;
+    }
+
+    // rounding errors accumulate in the recursion, so periodically start again from the history
+    if (sdft->_samples_since_resync >= sdft->_window_size) {
+        sdft_resync(sdft);
+    }
+}
+
+// change the tracked bins, recalculating them from the sample history if necessary
+void DSP::sdft_set_bins(SlidingDFTState* sdft, uint16_t first_bin, uint16_t last_bin)
+{
+    if (first_bin == sdft->_first_bin && last_bin == sdft->_last_bin) {
+        return;
+    }
+
+    sdft->_first_bin = first_bin;
+    sdft->_last_bin = last_bin;
+
+    for (uint16_t k = first_bin; k <= last_bin; k++) {
+        const float angle = 2.0f * M_PI * k / sdft->_window_size;
+        sdft->_rotation_re[k] = cosf(angle);
+        sdft->_rotation_im[k] = sinf(angle);
+    }
+
+    sdft_resync(sdft);
+}
+
+// calculate the DFT of the tracked bins directly from the sample history, oldest sample first
+void DSP::sdft_resync(SlidingDFTState* sdft)
+{
+    for (uint16_t k = sdft->_first_bin; k <= sdft->_last_bin; k++) {
+        // step backwards around the unit circle by e^(-i*2*pi*k/N) for each sample
+        const float step_re = sdft->_rotation_re[k];
+        const float step_im = -sdft->_rotation_im[k];
+        float phase_re = 1.0f, phase_im = 0.0f;
+        float sum_re = 0.0f, sum_im = 0.0f;
+        uint16_t idx = sdft->_history_idx;
+
+        for (uint16_t n = 0; n < sdft->_window_size; n++) {
+            const float x = sdft->_history[idx];
+            sum_re += x * phase_re;
+            sum_im += x * phase_im;
+            const float re = phase_re * step_re - phase_im * step_im;
+            phase_im = phase_re * step_im + phase_im * step_re;
+            phase_re = re;
+            if (++idx >= sdft->_window_size) {
+                idx = 0;
+            }
+        }
+
+        sdft->_bins_re[k] = sum_re;
+        sdft->_bins_im[k] = sum_im;
+    }
+
+    sdft->_samples_since_resync = 0;
+}
+
+// analyse the sliding DFT spectrum using the same peak detection and interpolation as the FFT
+uint16_t DSP::sdft_analyse(FFTWindowState* fft, SlidingDFTState* sdft, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff)
+{
+    // peak detection looks a few bins beyond end_bin and interpolation one bin either side of the peak
+    const uint16_t first_bin = start_bin > 0 ? start_bin - 1 : 0;
+    const uint16_t last_bin = MIN(end_bin + 3, fft->_bin_count);
+    // the Hanning window needs one further raw bin either side
+    sdft_set_bins(sdft, first_bin > 0 ? first_bin - 1 : 0, MIN(last_bin + 1, fft->_bin_count));
+
+    memset(fft->_freq_bins, 0, sizeof(float) * fft->_window_size);
+    memset(fft->_rfft_data, 0, sizeof(float) * (fft->_window_size + 2));
+
+    const float* bins_re = sdft->_bins_re;
+    const float* bins_im = sdft->_bins_im;
+
+    // apply the Hanning window in the frequency domain, Xw[k] = 0.5 * X[k] - 0.25 * (X[k-1] + X[k+1])
+    // the bins beyond DC and nyquist are the complex conjugates of their mirror images
+    for (uint16_t k = first_bin; k <= last_bin; k++) {
+        const uint16_t below = k > 0 ? k - 1 : 1;
+        const uint16_t above = k < fft->_bin_count ? k + 1 : k - 1;
+        const float below_im = k > 0 ? bins_im[below] : -bins_im[below];
+        const float above_im = k < fft->_bin_count ? bins_im[above] : -bins_im[above];
+
+        const float re = 0.5f * bins_re[k] - 0.25f * (bins_re[below] + bins_re[above]);
+        const float im = 0.5f * bins_im[k] - 0.25f * (below_im + above_im);
+
+        fft->_rfft_data[k * 2] = re;
+        fft->_rfft_data[k * 2 + 1] = im;
+        fft->_freq_bins[k] = sq(re) + sq(im);
+    }
+
+    step_cmplx_mag(fft, start_bin, end_bin, noise_att_cutoff);
+    return step_calc_frequencies(fft, start_bin, end_bin);
+}
+
 // find all the peaks in the fft window using https://terpconnect.umd.edu/~toh/spectrum/PeakFindingandMeasurement.htm
 // in general peakgrup > 2 is only good for very broad noisy peaks, <= 2 better for spikey peaks, although 1 will miss
 // a true spike 50% of the time
@@ -90,6 +90,30 @@ public:
         virtual ~FFTWindowState();
         FFTWindowState(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size);
     };
+    // incremental DFT of the most recent window of samples, restricted to a range of bins
+    class SlidingDFTState {
+    public:
+        // size of the DFT window
+        const uint16_t _window_size;
+        // first and last raw bins tracked, includes the neighbours needed to apply the Hanning window
+        uint16_t _first_bin;
+        uint16_t _last_bin;
+        // real and imaginary parts of the unwindowed DFT of each tracked bin
+        float* _bins_re;
+        float* _bins_im;
+        // per-bin rotation e^(i*2*pi*k/N) applied on each new sample
+        float* _rotation_re;
+        float* _rotation_im;
+        // the last _window_size samples, oldest at _history_idx
+        float* _history;
+        uint16_t _history_idx;
+        // samples since the bins were last recalculated from the history to remove accumulated rounding error
+        uint16_t _samples_since_resync;
+
+        void free_data_structures();
+        ~SlidingDFTState();
+        SlidingDFTState(uint16_t window_size);
+    };
     // initialise an FFT instance
     virtual FFTWindowState* fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size = 0) = 0;
     // start an FFT analysis with an ObjectBuffer
@@ -100,6 +124,12 @@ public:
     bool fft_start_average(FFTWindowState* fft);
     // finish the averaging process
     uint16_t fft_stop_average(FFTWindowState* fft, uint16_t start_bin, uint16_t end_bin, float* peaks);
+    // initialise a sliding DFT instance for use with an FFT instance of the same window size
+    SlidingDFTState* sdft_init(uint16_t window_size);
+    // consume count samples, updating only the tracked bins for each sample
+    void sdft_update(SlidingDFTState* sdft, FloatBuffer& samples, uint32_t count);
+    // analyse the current sliding DFT spectrum, populating the FFT instance as fft_analyse() would
+    uint16_t sdft_analyse(FFTWindowState* fft, SlidingDFTState* sdft, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff);
 
 protected:
     // step 3: find the magnitudes of the complex data
@@ -135,6 +165,10 @@ protected:
     float calculate_jains_estimator(const FFTWindowState* fft, const float* real_fft, uint16_t k_max);
     // init averaging FFT data
     bool fft_init_average(FFTWindowState* fft);
+    // change the bins tracked by a sliding DFT
+    void sdft_set_bins(SlidingDFTState* sdft, uint16_t first_bin, uint16_t last_bin);
+    // recalculate the tracked bins of a sliding DFT from the sample history
+    void sdft_resync(SlidingDFTState* sdft);
 
 #endif // HAL_WITH_DSP
 };
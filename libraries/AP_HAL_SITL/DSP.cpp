@@ -36,11 +36,23 @@ extern const AP_HAL::HAL& hal;
 // for understanding the underlying theory although we do not use spectral density here since time resolution is equally
 // important as frequency resolution. Referred to as [Heinz] throughout the code.
 
+// simple integer log2
+static uint16_t fft_log2(uint16_t n)
+{
+    uint16_t k = n, i = 0;
+    while (k) {
+        k >>= 1;
+        i++;
+    }
+    return i - 1;
+}
+
 // initialize the FFT state machine
 AP_HAL::DSP::FFTWindowState* DSP::fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size)
 {
     DSP::FFTWindowStateSITL* fft = NEW_NOTHROW DSP::FFTWindowStateSITL(window_size, sample_rate, sliding_window_size);
-    if (fft == nullptr || fft->_hanning_window == nullptr || fft->_rfft_data == nullptr || fft->_freq_bins == nullptr || fft->_derivative_freq_bins == nullptr) {
+    if (fft == nullptr || fft->_hanning_window == nullptr || fft->_rfft_data == nullptr || fft->_freq_bins == nullptr || fft->_derivative_freq_bins == nullptr
+        || fft->buf == nullptr || fft->twiddle == nullptr || fft->bitrev == nullptr) {
         delete fft;
         return nullptr;
     }
@@ -71,12 +83,38 @@ DSP::FFTWindowStateSITL::FFTWindowStateSITL(uint16_t window_size, uint16_t sampl
         return;
     }
 
-    buf = NEW_NOTHROW complexf[window_size];
+    // a real FFT of size N is calculated as a complex FFT of size N/2
+    const uint16_t half_size = window_size / 2;
+    buf = NEW_NOTHROW complexf[half_size];
+    twiddle = NEW_NOTHROW complexf[half_size];
+    bitrev = NEW_NOTHROW uint16_t[half_size];
+    if (buf == nullptr || twiddle == nullptr || bitrev == nullptr) {
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Failed to allocate FFT tables for DSP");
+        return;
+    }
+
+    // twiddles for the full window, the half length FFT uses every other entry
+    for (uint16_t k = 0; k < half_size; k++) {
+        const double angle = 2.0 * M_PI * k / window_size;
+        twiddle[k] = complexf(cos(angle), sin(angle));
+    }
+
+    const uint16_t m = fft_log2(half_size);
+    for (uint16_t k = 0; k < half_size; k++) {
+        uint16_t ki = k, kr = 0;
+        for (uint16_t i = 0; i < m; i++) {
+            kr = (kr << 1) | (ki & 1);
+            ki >>= 1;
+        }
+        bitrev[k] = kr;
+    }
 }
 
 DSP::FFTWindowStateSITL::~FFTWindowStateSITL()
 {
     delete[] buf;
+    delete[] twiddle;
+    delete[] bitrev;
 }
 
 // step 1: filter the incoming samples through a Hanning window
@@ -96,20 +134,33 @@ void DSP::step_hanning(FFTWindowStateSITL* fft, FloatBuffer& samples, uint16_t a
 // step 2: perform an in-place FFT on the windowed data
 void DSP::step_fft(FFTWindowStateSITL* fft)
 {
-    for (uint16_t i = 0; i < fft->_window_size; i++) {
-        fft->buf[i] = complexf(fft->_freq_bins[i], 0);
+    const uint16_t half_size = fft->_bin_count;
+    complexf* buf = fft->buf;
+
+    // pack pairs of real samples as complex values, stored in bit reversed order ready for the butterflies
+    for (uint16_t i = 0; i < half_size; i++) {
+        buf[fft->bitrev[i]] = complexf(fft->_freq_bins[2 * i], fft->_freq_bins[2 * i + 1]);
     }
 
-    calculate_fft(fft->buf, fft->_window_size);
+    calculate_fft(buf, fft->twiddle, half_size);
 
-    for (uint16_t i = 0; i < fft->_bin_count; i++) {
-        fft->_freq_bins[i] = std::norm(fft->buf[i]);
-    }
+    // separate the transforms of the even and odd samples and combine them into the spectrum of the real input
+    // DC and nyquist components are real only
+    fft->_rfft_data[0] = buf[0].real() + buf[0].imag();
+    fft->_rfft_data[1] = 0.0f;
+    fft->_rfft_data[2 * half_size] = buf[0].real() - buf[0].imag();
+    fft->_rfft_data[2 * half_size + 1] = 0.0f;
+    fft->_freq_bins[0] = sq(fft->_rfft_data[0]);
 
-    // components at the nyquist frequency are real only
-    for (uint16_t i = 0, j = 0; i <= fft->_bin_count; i++, j += 2) {
-        fft->_rfft_data[j] = fft->buf[i].real();
-        fft->_rfft_data[j+1] = fft->buf[i].imag();
+    for (uint16_t k = 1; k < half_size; k++) {
+        const complexf zk = buf[k];
+        const complexf zc = std::conj(buf[half_size - k]);
+        const complexf even = 0.5f * (zk + zc);
+        const complexf odd = complexf(0.0f, -0.5f) * (zk - zc);
+        const complexf x = even + fft->twiddle[k] * odd;
+        fft->_rfft_data[2 * k] = x.real();
+        fft->_rfft_data[2 * k + 1] = x.imag();
+        fft->_freq_bins[k] = std::norm(x);
     }
 }
 
@@ -156,59 +207,52 @@ float DSP::vector_mean_float(const float* vin, uint16_t len) const
     return mean_value;
 }
 
-// simple integer log2
-static uint16_t fft_log2(uint16_t n)
+// calculate the in-place FFT of bit reversed input using precomputed twiddles
+// two radix-2 stages are combined into a single radix-4 pass over the data, with a lone radix-2 stage first for odd powers of two
+// twiddle holds e^(i*2*pi*k/(2*fftlen)) for k in [0, fftlen)
+void DSP::calculate_fft(complexf* samples, const complexf* twiddle, uint16_t fftlen)
 {
-    uint16_t k = n, i = 0;
-    while (k) {
-        k >>= 1;
-        i++;
-    }
-    return i - 1;
-}
+    const uint16_t m = fft_log2(fftlen);
+    // the twiddle table spans a full turn in table_size steps, only the first half is stored
+    const uint32_t table_size = fftlen * 2;
+    uint16_t len = 1;
 
-// calculate the in-place FFT of the input using the Cooley–Tukey algorithm
-// this is a translation of Ron Nicholson's version in http://www.nicholson.com/dsp.fft1.html
-void DSP::calculate_fft(complexf *samples, uint16_t fftlen)
-{
-    uint16_t m = fft_log2(fftlen);
-    // shuffle data using bit reversed addressing ***
-    for (uint16_t k = 0; k < fftlen; k++) {
-        // generate a bit reversed address for samples[k] ***
-        uint16_t ki = k, kr = 0;
-        for (uint16_t i=1; i<=m; i++) {
-            kr <<= 1; //  left shift result kr by 1 bit
-            if (ki % 2 == 1) {
-                kr++;
-            }
-            ki >>= 1; // right shift temp ki by 1 bit
-        }
-        // swap data samples[k] to bit reversed address samples[kr]
-        if (kr > k) {
-            complexf t = samples[kr];
-            samples[kr] = samples[k];
-            samples[k] = t;
+    if (m & 1) {
+        for (uint16_t i = 0; i < fftlen; i += 2) {
+            const complexf a = samples[i];
+            const complexf b = samples[i + 1];
+            samples[i] = a + b;
+            samples[i + 1] = a - b;
         }
+        len = 2;
     }
 
-    // do fft butterflys in place
-    uint16_t istep = 2;
-    while (istep <= fftlen) {// layers 2,4,8,16, ... ,n
-        uint16_t is2 = istep / 2;
-        uint16_t astep = fftlen / istep;
-        for (uint16_t km = 0; km < is2; km++) { // outer row loop
-            uint16_t a  = km * astep; // twiddle angle index
-            complexf w(sinf(2 * M_PI * (a+(fftlen/4)) / fftlen), sinf(2 * M_PI * a / fftlen));
-            for (uint16_t ki = 0; ki <= (fftlen - istep); ki += istep) { // inner column loop
-                uint16_t i = km + ki;
-                uint16_t j = is2 + i;
-                complexf t = w * samples[j];
-                complexf q = samples[i];
-                samples[j] = q - t;
-                samples[i] = q + t;
+    // each pass combines the stages of size 2*len and 4*len
+    for (; len < fftlen; len <<= 2) {
+        const uint32_t step1 = table_size / (2 * len);
+        const uint32_t step2 = table_size / (4 * len);
+        for (uint16_t base = 0; base < fftlen; base += 4 * len) {
+            complexf* s0 = &samples[base];
+            complexf* s1 = s0 + len;
+            complexf* s2 = s1 + len;
+            complexf* s3 = s2 + len;
+            for (uint16_t k = 0; k < len; k++) {
+                const complexf w1 = twiddle[k * step1];
+                const complexf w2 = twiddle[k * step2];
+                const complexf t1 = w1 * s1[k];
+                const complexf t3 = w1 * s3[k];
+                const complexf y0 = s0[k] + t1;
+                const complexf y1 = s0[k] - t1;
+                const complexf y2 = (s2[k] + t3) * w2;
+                // the twiddle of the upper half of the second stage is i*w2
+                const complexf v = (s2[k] - t3) * w2;
+                const complexf y3(-v.imag(), v.real());
+                s0[k] = y0 + y2;
+                s2[k] = y0 - y2;
+                s1[k] = y1 + y3;
+                s3[k] = y1 - y3;
             }
         }
-        istep <<= 1;
     }
 }
 
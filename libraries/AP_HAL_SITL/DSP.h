@@ -45,10 +45,15 @@ public:
         virtual ~FFTWindowStateSITL();
 
     private:
-        complexf* buf;
+        // half-length complex workspace for the real-input FFT
+        complexf* buf = nullptr;
+        // precomputed twiddle factors e^(i*2*pi*k/N) for k in [0, N/2)
+        complexf* twiddle = nullptr;
+        // precomputed bit reversal permutation of the N/2 point complex FFT
+        uint16_t* bitrev = nullptr;
     };
 
-private:
+protected:
     void step_hanning(FFTWindowStateSITL* fft, FloatBuffer& samples, uint16_t advance);
     void step_fft(FFTWindowStateSITL* fft);
     void mult_f32(const float* v1, const float* v2, float* vout, uint16_t len);
@@ -56,7 +61,7 @@ private:
     void vector_scale_float(const float* vin, float scale, float* vout, uint16_t len) const override;
     float vector_mean_float(const float* vin, uint16_t len) const override;
     void vector_add_float(const float* vin1, const float* vin2, float* vout, uint16_t len) const override;
-    void calculate_fft(complexf* f, uint16_t length);
+    void calculate_fft(complexf* samples, const complexf* twiddle, uint16_t fftlen);
 };
 
 #endif
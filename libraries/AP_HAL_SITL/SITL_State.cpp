@@ -148,7 +148,10 @@ void SITL_State::_fdm_input_step(void)
 void SITL_State::wait_clock(uint64_t wait_time_usec)
 {
     float speedup = sitl_model->get_speedup();
-    if (speedup < 1) {
+    if (sitl_model->free_running()) {
+        // for purposes of sleeps treat free running as a high speedup
+        speedup = 100.0;
+    } else if (speedup < 1) {
         // for purposes of sleeps treat low speedups as 1
         speedup = 1.0;
     }
@@ -156,6 +159,11 @@ void SITL_State::wait_clock(uint64_t wait_time_usec)
         if (hal.scheduler->in_main_thread() ||
             Scheduler::from(hal.scheduler)->semaphore_wait_hack_required()) {
             _fdm_input_step();
+            Scheduler::from(hal.scheduler)->lockstep_step(sitl_model->free_running());
+        } else if (sitl_model->free_running() &&
+                   Scheduler::from(hal.scheduler)->lockstep_wait(wait_time_usec)) {
+            // woken by the main thread stepping time to wait_time_usec
+            continue;
         } else {
 #ifdef CYGWIN_BUILD
             if (speedup > 2 && hal.util->get_soft_armed()) {
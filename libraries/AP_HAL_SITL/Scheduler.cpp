@@ -46,6 +46,21 @@ bool Scheduler::_in_semaphore_take_wait = false;
 Scheduler::thread_attr *Scheduler::threads;
 HAL_Semaphore Scheduler::_thread_sem;
 
+pthread_mutex_t Scheduler::_lockstep_mtx = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t Scheduler::_lockstep_wake_cond = PTHREAD_COND_INITIALIZER;
+pthread_cond_t Scheduler::_lockstep_idle_cond = PTHREAD_COND_INITIALIZER;
+Scheduler::lockstep_waiter *Scheduler::_lockstep_waiters;
+uint32_t Scheduler::_lockstep_running;
+uint32_t Scheduler::_lockstep_generation = 1;
+thread_local uint32_t Scheduler::_lockstep_thread_generation;
+
+// longest the main thread waits in wall clock time for woken threads
+// before stepping on without them, so a thread blocked on something
+// other than simulation time can't stop the simulation
+#ifndef SITL_LOCKSTEP_TIMEOUT_US
+#define SITL_LOCKSTEP_TIMEOUT_US 10000
+#endif
+
 Scheduler::Scheduler(SITL_State *sitlState) :
     _sitlState(sitlState),
     _stopped_clock_usec(0)
@@ -158,6 +173,82 @@ void Scheduler::delay(uint16_t ms)
     } while (now - start < ms);
 }
 
+void Scheduler::lockstep_thread_idle(void)
+{
+    if (_lockstep_thread_generation == _lockstep_generation && _lockstep_running > 0) {
+        _lockstep_running--;
+        if (_lockstep_running == 0) {
+            pthread_cond_signal(&_lockstep_idle_cond);
+        }
+    }
+    _lockstep_thread_generation = 0;
+}
+
+bool Scheduler::lockstep_wait(uint64_t wake_usec)
+{
+    if (pthread_self() == _main_ctx) {
+        return false;
+    }
+    pthread_mutex_lock(&_lockstep_mtx);
+    lockstep_thread_idle();
+    struct lockstep_waiter w {};
+    w.next = _lockstep_waiters;
+    w.wake_usec = wake_usec;
+    _lockstep_waiters = &w;
+    while (!w.woken) {
+        pthread_cond_wait(&_lockstep_wake_cond, &_lockstep_mtx);
+    }
+    // the main thread removed us from the waiters when waking us
+    _lockstep_thread_generation = w.generation;
+    pthread_mutex_unlock(&_lockstep_mtx);
+    return true;
+}
+
+void Scheduler::lockstep_step(bool wait_for_threads)
+{
+    pthread_mutex_lock(&_lockstep_mtx);
+    const uint64_t now = AP_HAL::micros64();
+    bool woke = false;
+    for (struct lockstep_waiter **w = &_lockstep_waiters; *w != nullptr; ) {
+        struct lockstep_waiter *waiter = *w;
+        if (waiter->wake_usec > now) {
+            w = &waiter->next;
+            continue;
+        }
+        *w = waiter->next;
+        waiter->woken = true;
+        if (wait_for_threads) {
+            waiter->generation = _lockstep_generation;
+            _lockstep_running++;
+        }
+        woke = true;
+    }
+    if (woke) {
+        pthread_cond_broadcast(&_lockstep_wake_cond);
+    }
+    if (!wait_for_threads || _lockstep_running == 0) {
+        pthread_mutex_unlock(&_lockstep_mtx);
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += SITL_LOCKSTEP_TIMEOUT_US * 1000UL;
+    while (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    while (_lockstep_running > 0) {
+        if (pthread_cond_timedwait(&_lockstep_idle_cond, &_lockstep_mtx, &ts) != 0) {
+            // stop waiting for the threads still running; they are
+            // not counted when they next wait
+            _lockstep_generation++;
+            _lockstep_running = 0;
+        }
+    }
+    pthread_mutex_unlock(&_lockstep_mtx);
+}
+
 void Scheduler::register_timer_process(AP_HAL::MemberProc proc)
 {
     for (uint8_t i = 0; i < _num_timer_procs; i++) {
@@ -315,7 +406,11 @@ void *Scheduler::thread_create_trampoline(void *ctx)
     struct thread_attr *a = (struct thread_attr *)ctx;
     a->thread = pthread_self();
     a->f[0]();
-    
+
+    pthread_mutex_lock(&_lockstep_mtx);
+    lockstep_thread_idle();
+    pthread_mutex_unlock(&_lockstep_mtx);
+
     WITH_SEMAPHORE(_thread_sem);
     if (threads == a) {
         threads = a->next;
@@ -70,6 +70,20 @@ public:
     // get the name of the current thread, or nullptr if not known
     const char *get_current_thread_name(void) const;
 
+    /*
+      lockstep of other threads with the main thread when free
+      running. A thread waiting for simulation time blocks until the
+      main thread steps time to its wake time, and the main thread
+      then waits for the threads it woke to wait again before
+      stepping on. Returns false if called from the main thread's
+      pthread, which must not block
+     */
+    bool lockstep_wait(uint64_t wake_usec);
+
+    // wake threads due at the current time, waiting for them to
+    // wait again if wait_for_threads is true
+    void lockstep_step(bool wait_for_threads);
+
 private:
     SITL_State *_sitlState;
     uint8_t _nested_atomic_ctr;
@@ -92,6 +106,24 @@ private:
     void stop_clock(uint64_t time_usec) override;
 
     static void *thread_create_trampoline(void *ctx);
+
+    // a thread blocked in lockstep_wait()
+    struct lockstep_waiter {
+        struct lockstep_waiter *next;
+        uint64_t wake_usec;
+        uint32_t generation;    // set when woken, 0 if the main thread will not wait for it
+        bool woken;
+    };
+    static pthread_mutex_t _lockstep_mtx;
+    static pthread_cond_t _lockstep_wake_cond;  // broadcast when waiters are woken
+    static pthread_cond_t _lockstep_idle_cond;  // signalled when no woken threads are running
+    static struct lockstep_waiter *_lockstep_waiters;
+    static uint32_t _lockstep_running;      // woken threads the main thread waits for
+    static uint32_t _lockstep_generation;   // changed when the main thread stops waiting
+    static thread_local uint32_t _lockstep_thread_generation;
+
+    // the calling thread is no longer running, lockstep mutex must be held
+    static void lockstep_thread_idle(void);
     static void check_thread_stacks(void);
     
     bool _initialized;
@@ -245,17 +245,18 @@ void UARTDriver::_flush(void)
     // infinitely-loop.  This is not a good definition of "flush", but
     // it was judged that we had to return from this function even if
     // we hadn't actually done our job.
-    uint32_t start_ms = AP_HAL::millis();
-    while (AP_HAL::millis() - start_ms < 1000) {
+    // Simulation time may not advance while we wait, so the waits are
+    // bounded by a number of 1ms sleeps rather than by AP_HAL::millis()
+    for (uint16_t i=0; i<1000; i++) {
+        _timer_tick();
         if (_writebuffer.available() == 0) {
             break;
         }
-        _timer_tick();
+        usleep(1000);
     }
 
     // ensure that the outbound TCP queue is also empty...
-    start_ms = AP_HAL::millis();
-    while (AP_HAL::millis() - start_ms < 1000) {
+    for (uint16_t i=0; i<1000; i++) {
         if (((HALSITL::UARTDriver*)hal.serial(0))->get_system_outqueue_length() == 0) {
             break;
         }
@@ -0,0 +1,136 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL && HAL_WITH_DSP
+
+#include <AP_HAL_SITL/DSP.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// expose the FFT step so it can be timed without the peak finding
+class BenchmarkDSP : public HALSITL::DSP {
+public:
+    using HALSITL::DSP::step_fft;
+};
+
+static BenchmarkDSP dsp;
+
+// the textbook Cooley-Tukey FFT previously used by HALSITL::DSP, kept for comparison
+static void legacy_fft(complexf *samples, uint16_t fftlen)
+{
+    uint16_t m = 0;
+    while ((1U << (m + 1)) <= fftlen) {
+        m++;
+    }
+    for (uint16_t k = 0; k < fftlen; k++) {
+        uint16_t ki = k, kr = 0;
+        for (uint16_t i=1; i<=m; i++) {
+            kr <<= 1;
+            if (ki % 2 == 1) {
+                kr++;
+            }
+            ki >>= 1;
+        }
+        if (kr > k) {
+            complexf t = samples[kr];
+            samples[kr] = samples[k];
+            samples[k] = t;
+        }
+    }
+
+    uint16_t istep = 2;
+    while (istep <= fftlen) {
+        uint16_t is2 = istep / 2;
+        uint16_t astep = fftlen / istep;
+        for (uint16_t km = 0; km < is2; km++) {
+            uint16_t a  = km * astep;
+            complexf w(sinf(2 * M_PI * (a+(fftlen/4)) / fftlen), sinf(2 * M_PI * a / fftlen));
+            for (uint16_t ki = 0; ki <= (fftlen - istep); ki += istep) {
+                uint16_t i = km + ki;
+                uint16_t j = is2 + i;
+                complexf t = w * samples[j];
+                complexf q = samples[i];
+                samples[j] = q - t;
+                samples[i] = q + t;
+            }
+        }
+        istep <<= 1;
+    }
+}
+
+static float test_signal(uint16_t i)
+{
+    return sinf(i * 0.37f) + 0.3f * cosf(i * 1.9f);
+}
+
+static void BM_FFTLegacy(benchmark::State& state)
+{
+    const uint16_t window_size = state.range_x();
+    complexf* buf = new complexf[window_size];
+    float* bins = new float[window_size / 2 + 1];
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < window_size; i++) {
+            buf[i] = complexf(test_signal(i), 0);
+        }
+        legacy_fft(buf, window_size);
+        for (uint16_t i = 0; i < window_size / 2; i++) {
+            bins[i] = std::norm(buf[i]);
+        }
+        gbenchmark_escape(bins);
+    }
+
+    delete[] buf;
+    delete[] bins;
+}
+
+static void BM_FFT(benchmark::State& state)
+{
+    const uint16_t window_size = state.range_x();
+    auto* fft = (HALSITL::DSP::FFTWindowStateSITL*)dsp.fft_init(window_size, 1000, 0);
+    if (fft == nullptr) {
+        fprintf(stderr, "error: couldn't allocate FFT window\n");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < window_size; i++) {
+            fft->_freq_bins[i] = test_signal(i);
+        }
+        dsp.step_fft(fft);
+        gbenchmark_escape(fft->_freq_bins);
+    }
+
+    delete fft;
+}
+
+static void BM_FFTAnalyse(benchmark::State& state)
+{
+    const uint16_t window_size = state.range_x();
+    AP_HAL::DSP::FFTWindowState* fft = dsp.fft_init(window_size, 1000, 0);
+    FloatBuffer samples(window_size);
+    if (fft == nullptr || samples.get_size() < window_size) {
+        fprintf(stderr, "error: couldn't allocate FFT window\n");
+        delete fft;
+        return;
+    }
+    for (uint16_t i = 0; i < window_size; i++) {
+        samples.push(test_signal(i));
+    }
+
+    while (state.KeepRunning()) {
+        dsp.fft_start(fft, samples, 0);
+        uint16_t peak = dsp.fft_analyse(fft, 1, window_size / 2 - 1, 0.5f);
+        gbenchmark_escape(&peak);
+    }
+
+    delete fft;
+}
+
+BENCHMARK(BM_FFTLegacy)->RangeMultiplier(2)->Range(32, 1024);
+BENCHMARK(BM_FFT)->RangeMultiplier(2)->Range(32, 1024);
+BENCHMARK(BM_FFTAnalyse)->RangeMultiplier(2)->Range(32, 1024);
+#endif
+
+BENCHMARK_MAIN()
@@ -0,0 +1,202 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL && HAL_WITH_DSP
+
+#include <AP_HAL_SITL/DSP.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// expose the FFT step so it can be checked without the peak finding
+class TestDSP : public HALSITL::DSP {
+public:
+    using HALSITL::DSP::step_fft;
+};
+
+static TestDSP dsp;
+
+// the textbook Cooley-Tukey FFT previously used by HALSITL::DSP
+static void legacy_fft(complexf *samples, uint16_t fftlen)
+{
+    uint16_t m = 0;
+    while ((1U << (m + 1)) <= fftlen) {
+        m++;
+    }
+    for (uint16_t k = 0; k < fftlen; k++) {
+        uint16_t ki = k, kr = 0;
+        for (uint16_t i=1; i<=m; i++) {
+            kr <<= 1;
+            if (ki % 2 == 1) {
+                kr++;
+            }
+            ki >>= 1;
+        }
+        if (kr > k) {
+            complexf t = samples[kr];
+            samples[kr] = samples[k];
+            samples[k] = t;
+        }
+    }
+
+    uint16_t istep = 2;
+    while (istep <= fftlen) {
+        uint16_t is2 = istep / 2;
+        uint16_t astep = fftlen / istep;
+        for (uint16_t km = 0; km < is2; km++) {
+            uint16_t a  = km * astep;
+            complexf w(sinf(2 * M_PI * (a+(fftlen/4)) / fftlen), sinf(2 * M_PI * a / fftlen));
+            for (uint16_t ki = 0; ki <= (fftlen - istep); ki += istep) {
+                uint16_t i = km + ki;
+                uint16_t j = is2 + i;
+                complexf t = w * samples[j];
+                complexf q = samples[i];
+                samples[j] = q - t;
+                samples[i] = q + t;
+            }
+        }
+        istep <<= 1;
+    }
+}
+
+static float test_signal(uint16_t i, uint16_t signal)
+{
+    switch (signal) {
+    case 0:
+        // tones, one between bins
+        return sinf(i * 0.37f) + 0.3f * cosf(i * 1.9f);
+    case 1:
+        // a tone on a bin and a DC offset
+        return 0.5f + cosf(i * M_PI / 8);
+    default:
+        // broadband noise
+        return float((i * 1103515245U + 12345U) >> 16 & 0xFF) / 128.0f - 1.0f;
+    }
+}
+
+/*
+  the real-input radix-4 FFT must give the same spectrum as the
+  complex Cooley-Tukey FFT, for half lengths that are both odd and
+  even powers of two
+ */
+TEST(DSP, FFTMatchesLegacy)
+{
+    for (uint16_t window_size = 32; window_size <= 1024; window_size *= 2) {
+        auto* fft = (HALSITL::DSP::FFTWindowStateSITL*)dsp.fft_init(window_size, 1000, 0);
+        ASSERT_NE(fft, nullptr);
+        complexf* legacy = new complexf[window_size];
+        ASSERT_NE(legacy, nullptr);
+
+        for (uint16_t signal = 0; signal < 3; signal++) {
+            for (uint16_t i = 0; i < window_size; i++) {
+                fft->_freq_bins[i] = test_signal(i, signal);
+                legacy[i] = complexf(test_signal(i, signal), 0);
+            }
+            dsp.step_fft(fft);
+            legacy_fft(legacy, window_size);
+
+            // amplitudes grow with the window size
+            const float tolerance = 1.0e-5f * window_size;
+            for (uint16_t i = 0; i <= fft->_bin_count; i++) {
+                EXPECT_NEAR(fft->_rfft_data[2 * i], legacy[i].real(), tolerance) << window_size << " bin " << i;
+                EXPECT_NEAR(fft->_rfft_data[2 * i + 1], legacy[i].imag(), tolerance) << window_size << " bin " << i;
+            }
+            for (uint16_t i = 0; i < fft->_bin_count; i++) {
+                const float norm = std::norm(legacy[i]);
+                EXPECT_NEAR(fft->_freq_bins[i], norm, tolerance * (1.0f + 2.0f * sqrtf(norm))) << window_size << " bin " << i;
+            }
+        }
+
+        delete[] legacy;
+        delete fft;
+    }
+}
+
+/*
+  the sliding DFT must find the same peak as a full FFT of the same
+  window of samples. The FFT multiplies the samples by a symmetric
+  Hann window (N-1 denominator) while the sliding DFT convolves its
+  bins with the periodic Hann window, which has a little more gain, so
+  the spectra differ slightly. A tone exactly between two bins can then
+  peak in either of them, so for those only the estimated frequencies
+  are checked
+ */
+TEST(DSP, SlidingDFTMatchesFFT)
+{
+    const uint16_t sample_rate = 1000;
+    const float noise_att_cutoff = 0.0316f;     // 15dB
+    // allowed difference in the interpolated frequencies as a fraction
+    // of a bin, on top of the truncation of frequencies to whole Hz
+    const float max_bin_error = 0.05f;
+    // allowed relative difference in the power of the peak, seen to be
+    // under 0.6% once the difference in window gain is allowed for
+    const float max_power_error = 0.01f;
+    const uint16_t chunk = 8;
+
+    for (uint16_t window_size = 32; window_size <= 256; window_size *= 2) {
+        auto* fft = dsp.fft_init(window_size, sample_rate, 0);
+        ASSERT_NE(fft, nullptr);
+        AP_HAL::DSP::FFTWindowState* sdft_fft = dsp.fft_init(window_size, sample_rate, 0);
+        ASSERT_NE(sdft_fft, nullptr);
+        const uint16_t start_bin = 2;
+        const uint16_t end_bin = fft->_bin_count - 4;
+
+        // tones on a bin, a quarter of a bin off and between two bins
+        for (float offset = 0; offset < 0.75f; offset += 0.25f) {
+            for (uint16_t bin = start_bin + 1; bin < end_bin; bin += 3) {
+                const float freq = (bin + offset) * fft->_bin_resolution;
+                AP_HAL::DSP::SlidingDFTState* sdft = dsp.sdft_init(window_size);
+                ASSERT_NE(sdft, nullptr);
+                FloatBuffer sdft_samples(chunk);
+                FloatBuffer fft_samples(window_size);
+
+                // start from noise so the tone has to replace a full
+                // window of history, analysing as samples arrive so
+                // the bins are both resynced and slid
+                const uint32_t total = 3 * window_size + 3 * chunk;
+                uint16_t max_bin = 0;
+                for (uint32_t i = 0; i < total; i++) {
+                    const float sample = i < window_size ? test_signal(i, 2) : sinf(2 * M_PI * freq * i / sample_rate);
+                    sdft_samples.push(sample);
+                    fft_samples.push_force(sample);
+                    if (sdft_samples.space() == 0) {
+                        dsp.sdft_update(sdft, sdft_samples, chunk);
+                        max_bin = dsp.sdft_analyse(sdft_fft, sdft, start_bin, end_bin, noise_att_cutoff);
+                    }
+                }
+                // the last analysis was of bins slid since the last resync
+                EXPECT_GT(sdft->_samples_since_resync, 0U);
+
+                dsp.fft_start(fft, fft_samples, 0);
+                const uint16_t fft_max_bin = dsp.fft_analyse(fft, start_bin, end_bin, noise_att_cutoff);
+
+                const auto &sdft_peak = sdft_fft->_peak_data[AP_HAL::DSP::CENTER];
+                const auto &fft_peak = fft->_peak_data[AP_HAL::DSP::CENTER];
+                const float half_bin = 0.5f * fft->_bin_resolution + 1.0f;
+                EXPECT_NEAR(sdft_peak._freq_hz, freq, half_bin) << window_size << " " << freq << "Hz";
+                EXPECT_NEAR(fft_peak._freq_hz, freq, half_bin) << window_size << " " << freq << "Hz";
+                if (is_equal(offset, 0.5f)) {
+                    EXPECT_NEAR(max_bin, fft_max_bin, 1) << window_size << " " << freq << "Hz";
+                } else {
+                    EXPECT_EQ(max_bin, fft_max_bin) << window_size << " " << freq << "Hz";
+                    EXPECT_EQ(sdft_peak._bin, fft_peak._bin) << window_size << " " << freq << "Hz";
+                    EXPECT_NEAR(sdft_peak._freq_hz, fft_peak._freq_hz, max_bin_error * fft->_bin_resolution + 1.0f)
+                        << window_size << " " << freq << "Hz";
+                    // the periodic window sums to N/2 rather than (N-1)/2
+                    const float window_gain = sq(window_size / (window_size - 1.0f));
+                    EXPECT_NEAR(sdft_fft->_freq_bins[max_bin] / fft->_freq_bins[fft_max_bin], window_gain, max_power_error * window_gain)
+                        << window_size << " " << freq << "Hz";
+                }
+
+                delete sdft;
+            }
+        }
+
+        delete sdft_fft;
+        delete fft;
+    }
+}
+
+#endif
+
+AP_GTEST_MAIN()
@@ -723,6 +723,7 @@ void AP_Logger::save_format_Replay(const void *pBuffer)
         f->msg_len = fmt->length;
         f->name = strndup(fmt->name, sizeof(fmt->name));
         f->fmt = strndup(fmt->format, sizeof(fmt->format));
+        f->num_fields = strnlen(fmt->format, sizeof(fmt->format));
         f->labels = strndup(fmt->labels, sizeof(fmt->labels));
         f->next = log_write_fmts;
         log_write_fmts = f;
@@ -952,7 +953,7 @@ void AP_Logger::Write_NamedValueFloat(const char *name, float value)
 }
 
 // output a FMT message for each backend if not already done so
-void AP_Logger::Safe_Write_Emit_FMT(log_write_fmt *f)
+void AP_Logger::Safe_Write_Emit_FMT(const log_write_fmt *f)
 {
     for (uint8_t i=0; i<_next_backend; i++) {
         backends[i]->Safe_Write_Emit_FMT(f->msg_type);
@@ -1040,11 +1041,321 @@ void AP_Logger::WriteV(const char *name, const char *labels, const char *units,
         return;
     }
 
+    WriteV(*f, arg_list, is_critical, is_streaming);
+}
+
+const AP_Logger::log_write_fmt *AP_Logger::compile_fmt(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, bool copy_strings)
+{
+    // copied strings must be compared by value
+    const bool direct_comp = copy_strings || APM_BUILD_TYPE(APM_BUILD_Replay);
+    struct log_write_fmt *f = msg_fmt_for_name(name, labels, units, mults, fmt, direct_comp, copy_strings);
+    if (f == nullptr) {
+        return nullptr;
+    }
+    WITH_SEMAPHORE(log_write_fmts_sem);
+    if (f->fields == nullptr) {
+        f->fields = compile_fields(f->fmt, f->num_fields);
+        if (f->fields == nullptr) {
+            return nullptr;
+        }
+    }
+    return f;
+}
+
+AP_Logger::log_write_field *AP_Logger::compile_fields(const char *fmt, uint8_t num_fields)
+{
+    struct log_write_field *fields = NEW_NOTHROW log_write_field[num_fields];
+    if (fields == nullptr) {
+        return nullptr;
+    }
+    uint8_t offset = LOG_PACKET_HEADER_LEN;
+    for (uint8_t i=0; i<num_fields; i++) {
+        struct log_write_field &field = fields[i];
+        field.offset = offset;
+        field.size = fmt_field_size(fmt[i]);
+        offset += field.size;
+        switch (fmt[i]) {
+        case 'b':
+        case 'B':
+        case 'M':
+            field.type = log_arg_type::INT8;
+            break;
+        case 'c':
+        case 'C':
+        case 'h':
+        case 'H':
+            field.type = log_arg_type::INT16;
+            break;
+        case 'e':
+        case 'i':
+        case 'L':
+            field.type = log_arg_type::INT32;
+            break;
+        case 'E':
+        case 'I':
+            field.type = log_arg_type::UINT32;
+            break;
+        case 'q':
+            field.type = log_arg_type::INT64;
+            break;
+        case 'Q':
+            field.type = log_arg_type::UINT64;
+            break;
+        case 'f':
+            field.type = log_arg_type::FLOAT;
+            break;
+        case 'g':
+            field.type = log_arg_type::FLOAT16;
+            break;
+        case 'd':
+            field.type = log_arg_type::DOUBLE;
+            break;
+        case 'n':
+        case 'N':
+        case 'Z':
+            field.type = log_arg_type::STRING;
+            break;
+        case 'a':
+            field.type = log_arg_type::ARRAY;
+            break;
+        }
+    }
+    return fields;
+}
+
+void AP_Logger::Write(const log_write_fmt *f, ...)
+{
+    if (f == nullptr) {
+        return;
+    }
+    va_list arg_list;
+    va_start(arg_list, f);
+    WriteV(*f, arg_list);
+    va_end(arg_list);
+}
+
+void AP_Logger::WriteStreaming(const log_write_fmt *f, ...)
+{
+    if (f == nullptr) {
+        return;
+    }
+    va_list arg_list;
+    va_start(arg_list, f);
+    WriteV(*f, arg_list, false, true);
+    va_end(arg_list);
+}
+
+void AP_Logger::WriteCritical(const log_write_fmt *f, ...)
+{
+    if (f == nullptr) {
+        return;
+    }
+    va_list arg_list;
+    va_start(arg_list, f);
+    WriteV(*f, arg_list, true);
+    va_end(arg_list);
+}
+
+/*
+  pack the values in arg_list according to f and write the message to
+  each backend. The message is packed once for all backends, and not
+  at all if no backend would write it
+ */
+void AP_Logger::WriteV(const log_write_fmt &f, va_list arg_list, bool is_critical, bool is_streaming)
+{
+    bool should_write = false;
+    for (uint8_t i=0; i<_next_backend; i++) {
+        if (backends[i]->should_write(is_critical)) {
+            should_write = true;
+            break;
+        }
+    }
+    if (!should_write) {
+        return;
+    }
+
+    uint8_t buffer[f.msg_len];
+    pack_msg(f, buffer, arg_list);
+
     for (uint8_t i=0; i<_next_backend; i++) {
-        va_list arg_copy;
-        va_copy(arg_copy, arg_list);
-        backends[i]->Write(f->msg_type, arg_copy, is_critical, is_streaming);
-        va_end(arg_copy);
+        backends[i]->WritePrioritisedBlock(buffer, f.msg_len, is_critical, is_streaming);
+    }
+}
+
+void AP_Logger::pack_msg(const log_write_fmt &f, uint8_t *buffer, va_list arg_list)
+{
+    buffer[0] = HEAD_BYTE1;
+    buffer[1] = HEAD_BYTE2;
+    buffer[2] = f.msg_type;
+
+    if (f.fields == nullptr) {
+        // not compiled, work through the format
+        uint8_t offset = LOG_PACKET_HEADER_LEN;
+        for (uint8_t i=0; i<f.num_fields; i++) {
+            uint8_t charlen = 0;
+            switch(f.fmt[i]) {
+            case 'b': {
+                int8_t tmp = va_arg(arg_list, int);
+                memcpy(&buffer[offset], &tmp, sizeof(int8_t));
+                offset += sizeof(int8_t);
+                break;
+            }
+            case 'h':
+            case 'c': {
+                int16_t tmp = va_arg(arg_list, int);
+                memcpy(&buffer[offset], &tmp, sizeof(int16_t));
+                offset += sizeof(int16_t);
+                break;
+            }
+            case 'd': {
+                double tmp = va_arg(arg_list, double);
+                memcpy(&buffer[offset], &tmp, sizeof(double));
+                offset += sizeof(double);
+                break;
+            }
+            case 'i':
+            case 'L':
+            case 'e': {
+                int32_t tmp = va_arg(arg_list, int);
+                memcpy(&buffer[offset], &tmp, sizeof(int32_t));
+                offset += sizeof(int32_t);
+                break;
+            }
+            case 'f': {
+                float tmp = va_arg(arg_list, double);
+                memcpy(&buffer[offset], &tmp, sizeof(float));
+                offset += sizeof(float);
+                break;
+            }
+            case 'g': {
+                Float16_t tmp;
+                tmp.set(va_arg(arg_list, double));
+                memcpy(&buffer[offset], &tmp, sizeof(tmp));
+                offset += sizeof(tmp);
+                break;
+            }
+            case 'n':
+                charlen = 4;
+                break;
+            case 'M':
+            case 'B': {
+                uint8_t tmp = va_arg(arg_list, int);
+                memcpy(&buffer[offset], &tmp, sizeof(uint8_t));
+                offset += sizeof(uint8_t);
+                break;
+            }
+            case 'H':
+            case 'C': {
+                uint16_t tmp = va_arg(arg_list, int);
+                memcpy(&buffer[offset], &tmp, sizeof(uint16_t));
+                offset += sizeof(uint16_t);
+                break;
+            }
+            case 'I':
+            case 'E': {
+                uint32_t tmp = va_arg(arg_list, uint32_t);
+                memcpy(&buffer[offset], &tmp, sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                break;
+            }
+            case 'N':
+                charlen = 16;
+                break;
+            case 'Z':
+                charlen = 64;
+                break;
+            case 'q': {
+                int64_t tmp = va_arg(arg_list, int64_t);
+                memcpy(&buffer[offset], &tmp, sizeof(int64_t));
+                offset += sizeof(int64_t);
+                break;
+            }
+            case 'Q': {
+                uint64_t tmp = va_arg(arg_list, uint64_t);
+                memcpy(&buffer[offset], &tmp, sizeof(uint64_t));
+                offset += sizeof(uint64_t);
+                break;
+            }
+            case 'a': {
+                int16_t *tmp = va_arg(arg_list, int16_t*);
+                const uint8_t bytes = 32*2;
+                memcpy(&buffer[offset], tmp, bytes);
+                offset += bytes;
+                break;
+            }
+            }
+            if (charlen != 0) {
+                char *tmp = va_arg(arg_list, char*);
+                uint8_t len = strnlen(tmp, charlen);
+                memcpy(&buffer[offset], tmp, len);
+                memset(&buffer[offset+len], 0, charlen-len);
+                offset += charlen;
+            }
+        }
+        return;
+    }
+
+    for (uint8_t i=0; i<f.num_fields; i++) {
+        const struct log_write_field &field = f.fields[i];
+        uint8_t *p = &buffer[field.offset];
+        switch (field.type) {
+        case log_arg_type::INT8: {
+            const int8_t tmp = va_arg(arg_list, int);
+            memcpy(p, &tmp, sizeof(tmp));
+            break;
+        }
+        case log_arg_type::INT16: {
+            const int16_t tmp = va_arg(arg_list, int);
+            memcpy(p, &tmp, sizeof(tmp));
+            break;
+        }
+        case log_arg_type::INT32: {
+            const int32_t tmp = va_arg(arg_list, int);
+            memcpy(p, &tmp, sizeof(tmp));
+            break;
+        }
+        case log_arg_type::UINT32: {
+            const uint32_t tmp = va_arg(arg_list, uint32_t);
+            memcpy(p, &tmp, sizeof(tmp));
+            break;
+        }
+        case log_arg_type::INT64: {
+            const int64_t tmp = va_arg(arg_list, int64_t);
+            memcpy(p, &tmp, sizeof(tmp));
+            break;
+        }
+        case log_arg_type::UINT64: {
+            const uint64_t tmp = va_arg(arg_list, uint64_t);
+            memcpy(p, &tmp, sizeof(tmp));
+            break;
+        }
+        case log_arg_type::FLOAT: {
+            const float tmp = va_arg(arg_list, double);
+            memcpy(p, &tmp, sizeof(tmp));
+            break;
+        }
+        case log_arg_type::FLOAT16: {
+            Float16_t tmp;
+            tmp.set(va_arg(arg_list, double));
+            memcpy(p, &tmp, sizeof(tmp));
+            break;
+        }
+        case log_arg_type::DOUBLE: {
+            const double tmp = va_arg(arg_list, double);
+            memcpy(p, &tmp, sizeof(tmp));
+            break;
+        }
+        case log_arg_type::STRING: {
+            const char *tmp = va_arg(arg_list, char*);
+            const uint8_t len = strnlen(tmp, field.size);
+            memcpy(p, tmp, len);
+            memset(&p[len], 0, field.size-len);
+            break;
+        }
+        case log_arg_type::ARRAY:
+            memcpy(p, va_arg(arg_list, int16_t*), field.size);
+            break;
+        }
     }
 }
 
@@ -1200,6 +1511,7 @@ AP_Logger::log_write_fmt *AP_Logger::msg_fmt_for_name(const char *name, const ch
     }
 
     f->msg_len = tmp;
+    f->num_fields = strlen(f->fmt);
 
     // add direct_comp formats to start of list, otherwise add to the end, this minimises the number of string comparisons when walking the list in future calls
     if (direct_comp || (log_write_fmts == nullptr)) {
@@ -1361,35 +1673,16 @@ bool AP_Logger::fill_logstructure(struct LogStructure &logstruct, const uint8_t
 int16_t AP_Logger::Write_calc_msg_len(const char *fmt) const
 {
     uint8_t len =  LOG_PACKET_HEADER_LEN;
-    for (uint8_t i=0; i<strlen(fmt); i++) {
-        switch(fmt[i]) {
-        case 'a' : len += sizeof(int16_t[32]); break;
-        case 'b' : len += sizeof(int8_t); break;
-        case 'c' : len += sizeof(int16_t); break;
-        case 'd' : len += sizeof(double); break;
-        case 'e' : len += sizeof(int32_t); break;
-        case 'f' : len += sizeof(float); break;
-        case 'g' : len += sizeof(float16_s); break;
-        case 'h' : len += sizeof(int16_t); break;
-        case 'i' : len += sizeof(int32_t); break;
-        case 'n' : len += sizeof(char[4]); break;
-        case 'B' : len += sizeof(uint8_t); break;
-        case 'C' : len += sizeof(uint16_t); break;
-        case 'E' : len += sizeof(uint32_t); break;
-        case 'H' : len += sizeof(uint16_t); break;
-        case 'I' : len += sizeof(uint32_t); break;
-        case 'L' : len += sizeof(int32_t); break;
-        case 'M' : len += sizeof(uint8_t); break;
-        case 'N' : len += sizeof(char[16]); break;
-        case 'Z' : len += sizeof(char[64]); break;
-        case 'q' : len += sizeof(int64_t); break;
-        case 'Q' : len += sizeof(uint64_t); break;
-        default:
+    const uint8_t fmt_len = strlen(fmt);
+    for (uint8_t i=0; i<fmt_len; i++) {
+        const uint8_t field_size = fmt_field_size(fmt[i]);
+        if (field_size == 0) {
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
             AP_HAL::panic("Unknown format specifier (%c)", fmt[i]);
 #endif
             return -1;
         }
+        len += field_size;
     }
     return len;
 }
@@ -294,6 +294,22 @@ public:
     void WriteCritical(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, ...);
     void WriteV(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, va_list arg_list, bool is_critical=false, bool is_streaming=false);
 
+    /*
+      precompiled formats for Write(). compile_fmt() finds or
+      allocates the message type for a format once and works out the
+      offset, size and argument type of each field. Writes using the
+      returned handle pack the arguments straight into place with no
+      format parsing or name lookup. copy_strings must be set if the
+      strings passed may not remain valid. Returns nullptr if the
+      format can't be mapped to a message type
+     */
+    struct log_write_fmt;
+    const struct log_write_fmt *compile_fmt(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, bool copy_strings=false);
+    void Write(const struct log_write_fmt *f, ...);
+    void WriteStreaming(const struct log_write_fmt *f, ...);
+    void WriteCritical(const struct log_write_fmt *f, ...);
+    void WriteV(const struct log_write_fmt &f, va_list arg_list, bool is_critical=false, bool is_streaming=false);
+
     void Write_PID(uint8_t msg_type, const class AP_PIDInfo &info);
 
     // returns true if logging of a message should be attempted
@@ -387,6 +403,47 @@ public:
     // fmt; includes the message header
     int16_t Write_calc_msg_len(const char *fmt) const;
 
+    // size of a field for a format character, 0 if unknown
+    static constexpr uint8_t fmt_field_size(const char c) {
+        return (c == 'b' || c == 'B' || c == 'M') ? 1 :
+               (c == 'c' || c == 'C' || c == 'h' || c == 'H' || c == 'g') ? 2 :
+               (c == 'e' || c == 'E' || c == 'f' || c == 'i' || c == 'I' || c == 'L' || c == 'n') ? 4 :
+               (c == 'd' || c == 'q' || c == 'Q') ? 8 :
+               (c == 'N') ? 16 :
+               (c == 'a' || c == 'Z') ? 64 :
+               0;
+    }
+
+    // compile time version of Write_calc_msg_len(), for use in
+    // static_assert against the size of a packed structure
+    static constexpr int16_t calc_msg_len(const char *fmt, int16_t len=LOG_PACKET_HEADER_LEN) {
+        return *fmt == 0 ? len :
+               fmt_field_size(*fmt) == 0 ? -1 :
+               calc_msg_len(fmt+1, len + fmt_field_size(*fmt));
+    }
+
+    // how the value of a field of a compiled format is passed to Write()
+    enum class log_arg_type : uint8_t {
+        INT8,       // int, stored as one byte
+        INT16,      // int, stored as two bytes
+        INT32,      // int
+        UINT32,     // uint32_t
+        INT64,      // int64_t
+        UINT64,     // uint64_t
+        FLOAT,      // double, stored as float
+        FLOAT16,    // double, stored as half precision float
+        DOUBLE,     // double
+        STRING,     // char *, zero padded to the field size
+        ARRAY,      // int16_t *, copied to fill the field
+    };
+
+    // a field of a format compiled by compile_fmt()
+    struct log_write_field {
+        uint8_t offset;         // offset of the field in the message
+        uint8_t size;           // size of the field in the message
+        log_arg_type type;
+    };
+
     // this structure looks much like struct LogStructure in
     // LogStructure.h, however we need to remember a pointer value for
     // efficiency of finding message types
@@ -394,18 +451,36 @@ public:
         struct log_write_fmt *next;
         uint8_t msg_type;
         uint8_t msg_len;
+        // number of fields in fmt
+        uint8_t num_fields;
         const char *name;
         const char *fmt;
         const char *labels;
         const char *units;
         const char *mults;
+        // field layout, only allocated by compile_fmt()
+        const struct log_write_field *fields;
     } *log_write_fmts;
 
+    /*
+      work out the layout of num_fields fields of a format. fmt must
+      only hold valid format characters. Returns nullptr on allocation
+      failure
+     */
+    static struct log_write_field *compile_fields(const char *fmt, uint8_t num_fields);
+
+    /*
+      pack a message for f into buffer, which must be f.msg_len bytes,
+      taking the field values from arg_list. Uses the compiled field
+      layout if f has one
+     */
+    static void pack_msg(const struct log_write_fmt &f, uint8_t *buffer, va_list arg_list);
+
     // return (possibly allocating) a log_write_fmt for a name
     struct log_write_fmt *msg_fmt_for_name(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, const bool direct_comp = false, const bool copy_strings = false);
 
     // output a FMT message for each backend if not already done so
-    void Safe_Write_Emit_FMT(log_write_fmt *f);
+    void Safe_Write_Emit_FMT(const log_write_fmt *f);
 
     // get count of number of times we have started logging
     uint8_t get_log_start_count(void) const {
@@ -194,139 +194,6 @@ bool AP_Logger_Backend::Write_Emit_FMT(uint8_t msg_type)
     return true;
 }
 
-bool AP_Logger_Backend::Write(const uint8_t msg_type, va_list arg_list, bool is_critical, bool is_streaming)
-{
-    // stack-allocate a buffer so we can WriteBlock(); this could be
-    // 255 bytes!  If we were willing to lose the WriteBlock
-    // abstraction we could do WriteBytes() here instead?
-    const char *fmt  = nullptr;
-    uint8_t msg_len;
-    AP_Logger::log_write_fmt *f;
-    for (f = _front.log_write_fmts; f; f=f->next) {
-        if (f->msg_type == msg_type) {
-            fmt = f->fmt;
-            msg_len = f->msg_len;
-            break;
-        }
-    }
-    if (fmt == nullptr) {
-        INTERNAL_ERROR(AP_InternalError::error_t::logger_logwrite_missingfmt);
-        return false;
-    }
-    if (bufferspace_available() < msg_len) {
-        return false;
-    }
-
-    uint8_t buffer[msg_len];
-    uint8_t offset = 0;
-    buffer[offset++] = HEAD_BYTE1;
-    buffer[offset++] = HEAD_BYTE2;
-    buffer[offset++] = msg_type;
-    for (uint8_t i=0; i<strlen(fmt); i++) {
-        uint8_t charlen = 0;
-        switch(fmt[i]) {
-        case 'b': {
-            int8_t tmp = va_arg(arg_list, int);
-            memcpy(&buffer[offset], &tmp, sizeof(int8_t));
-            offset += sizeof(int8_t);
-            break;
-        }
-        case 'h':
-        case 'c': {
-            int16_t tmp = va_arg(arg_list, int);
-            memcpy(&buffer[offset], &tmp, sizeof(int16_t));
-            offset += sizeof(int16_t);
-            break;
-        }
-        case 'd': {
-            double tmp = va_arg(arg_list, double);
-            memcpy(&buffer[offset], &tmp, sizeof(double));
-            offset += sizeof(double);
-            break;
-        }
-        case 'i':
-        case 'L':
-        case 'e': {
-            int32_t tmp = va_arg(arg_list, int);
-            memcpy(&buffer[offset], &tmp, sizeof(int32_t));
-            offset += sizeof(int32_t);
-            break;
-        }
-        case 'f': {
-            float tmp = va_arg(arg_list, double);
-            memcpy(&buffer[offset], &tmp, sizeof(float));
-            offset += sizeof(float);
-            break;
-        }
-        case 'g': {
-            Float16_t tmp;
-            tmp.set(va_arg(arg_list, double));;
-            memcpy(&buffer[offset], &tmp, sizeof(tmp));
-            offset += sizeof(tmp);
-            break;
-        }
-        case 'n':
-            charlen = 4;
-            break;
-        case 'M':
-        case 'B': {
-            uint8_t tmp = va_arg(arg_list, int);
-            memcpy(&buffer[offset], &tmp, sizeof(uint8_t));
-            offset += sizeof(uint8_t);
-            break;
-        }
-        case 'H':
-        case 'C': {
-            uint16_t tmp = va_arg(arg_list, int);
-            memcpy(&buffer[offset], &tmp, sizeof(uint16_t));
-            offset += sizeof(uint16_t);
-            break;
-        }
-        case 'I':
-        case 'E': {
-            uint32_t tmp = va_arg(arg_list, uint32_t);
-            memcpy(&buffer[offset], &tmp, sizeof(uint32_t));
-            offset += sizeof(uint32_t);
-            break;
-        }
-        case 'N':
-            charlen = 16;
-            break;
-        case 'Z':
-            charlen = 64;
-            break;
-        case 'q': {
-            int64_t tmp = va_arg(arg_list, int64_t);
-            memcpy(&buffer[offset], &tmp, sizeof(int64_t));
-            offset += sizeof(int64_t);
-            break;
-        }
-        case 'Q': {
-            uint64_t tmp = va_arg(arg_list, uint64_t);
-            memcpy(&buffer[offset], &tmp, sizeof(uint64_t));
-            offset += sizeof(uint64_t);
-            break;
-        }
-        case 'a': {
-            int16_t *tmp = va_arg(arg_list, int16_t*);
-            const uint8_t bytes = 32*2;
-            memcpy(&buffer[offset], tmp, bytes);
-            offset += bytes;
-            break;
-        }
-        }
-        if (charlen != 0) {
-            char *tmp = va_arg(arg_list, char*);
-            uint8_t len = strnlen(tmp, charlen);
-            memcpy(&buffer[offset], tmp, len);
-            memset(&buffer[offset+len], 0, charlen-len);
-            offset += charlen;
-        }
-    }
-
-    return WritePrioritisedBlock(buffer, msg_len, is_critical, is_streaming);
-}
-
 bool AP_Logger_Backend::StartNewLogOK() const
 {
     if (logging_started()) {
@@ -687,6 +554,8 @@ bool AP_Logger_Backend::logging_enabled() const
 
 void AP_Logger_Backend::Write_AP_Logger_Stats_File(const struct df_stats &_stats)
 {
+    const uint32_t storage_bytes = _storage_bytes;
+    const uint32_t storage_writes = _storage_writes;
     const struct log_DSF pkt {
         LOG_PACKET_HEADER_INIT(LOG_DF_FILE_STATS),
         time_us         : AP_HAL::micros64(),
@@ -696,7 +565,11 @@ void AP_Logger_Backend::Write_AP_Logger_Stats_File(const struct df_stats &_stats
         buf_space_min   : _stats.buf_space_min,
         buf_space_max   : _stats.buf_space_max,
         buf_space_avg   : (_stats.blocks) ? (_stats.buf_space_sigma / _stats.blocks) : 0,
+        storage_bytes   : storage_bytes - _storage_bytes_logged,
+        storage_writes  : uint16_t(storage_writes - _storage_writes_logged),
     };
+    _storage_bytes_logged = storage_bytes;
+    _storage_writes_logged = storage_writes;
     WriteBlock(&pkt, sizeof(pkt));
 }
 
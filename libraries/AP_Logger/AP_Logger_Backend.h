@@ -71,6 +71,10 @@ public:
 
     bool WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical, bool writev_streaming=false);
 
+    // true if a message written now may be logged, so it is worth
+    // preparing
+    bool should_write(bool is_critical) { return ShouldLog(is_critical); }
+
     // high level interface, indexed by the position in the list of logs
     virtual uint16_t find_last_log() = 0;
     virtual void get_log_boundaries(uint16_t list_entry, uint32_t & start_page, uint32_t & end_page) = 0;
@@ -164,10 +168,6 @@ public:
     // output a FMT message if not already done so
     void Safe_Write_Emit_FMT(uint8_t msg_type);
 
-    // write a log message out to the log of msg_type type, with
-    // values contained in arg_list:
-    bool Write(uint8_t msg_type, va_list arg_list, bool is_critical=false, bool is_streaming=false);
-
     // these methods are used when reporting system status over mavlink
     virtual bool logging_enabled() const;
     virtual bool logging_failed() const = 0;
@@ -252,6 +252,11 @@ protected:
 
     AP_Logger_RateLimiter *rate_limiter;
 
+    // running totals of data written to storage by the IO thread.
+    // The stats message logs the change since the previous message
+    uint32_t _storage_bytes;
+    uint32_t _storage_writes;
+
 private:
     // statistics support
     struct df_stats {
@@ -262,6 +267,8 @@ private:
         uint32_t buf_space_sigma;
     };
     struct df_stats stats;
+    uint32_t _storage_bytes_logged;
+    uint32_t _storage_writes_logged;
 
     uint32_t _last_periodic_1Hz;
     uint32_t _last_periodic_10Hz;
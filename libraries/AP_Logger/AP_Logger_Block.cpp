@@ -91,6 +91,8 @@ void AP_Logger_Block::FinishWrite(void)
     // Write Buffer to flash
     BufferToPage(df_PageAdr);
     df_PageAdr++;
+    _storage_bytes += df_PageSize;
+    _storage_writes++;
 
     // If we reach the end of the memory, start from the beginning
     if (df_PageAdr > df_NumPages) {
@@ -965,10 +965,6 @@ void AP_Logger_File::io_timer(void)
         nbytes = _writebuf_chunk;
     }
 
-    uint32_t size;
-    const uint8_t *head = _writebuf.readptr(size);
-    nbytes = MIN(nbytes, size);
-
 #if !AP_FILESYSTEM_LITTLEFS_ENABLED
     // try to align writes on a 512 byte boundary to avoid filesystem reads
     if ((nbytes + _write_offset) % 512 != 0) {
@@ -992,7 +988,11 @@ void AP_Logger_File::io_timer(void)
         nbytes = bytes_until_fsync; // write exactly enough to sync
     }
 
-    ssize_t nwritten = AP::FS().write(_write_fd, head, nbytes);
+    // write both halves of the ring buffer in one call when the data
+    // wraps, avoiding a short write at the end of the buffer
+    ByteBuffer::IoVec vec[2];
+    const uint8_t n_vec = _writebuf.peekiovec(vec, nbytes);
+    ssize_t nwritten = AP::FS().writev(_write_fd, vec, n_vec);
     last_io_operation = "";
     if (nwritten <= 0) {
         if (errno == ENOSPC) {
@@ -1016,6 +1016,8 @@ void AP_Logger_File::io_timer(void)
         _last_write_ms = tnow;
         _write_offset += nwritten;
         _writebuf.advance(nwritten);
+        _storage_bytes += nwritten;
+        _storage_writes++;
 
         // we know nwritten > 0 so we won't sync if bytes_until_fsync == 0
         if ((uint32_t)nwritten == bytes_until_fsync) {
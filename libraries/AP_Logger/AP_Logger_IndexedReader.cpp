@@ -0,0 +1,564 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  indexed, memory mapped reading of .BIN logs
+ */
+
+#include "AP_Logger_IndexedReader.h"
+
+#if AP_LOGGER_INDEXED_READER_ENABLED
+
+#include <AP_Math/AP_Math.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define INDEX_MAGIC 0x58444942  // "BIDX"
+#define INDEX_VERSION 2
+
+bool AP_Logger_IndexedReader::open(const char *filename, bool _copy_on_write)
+{
+    close();
+
+    const int fd = ::open(filename, O_RDONLY|O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0 || uint64_t(st.st_size) > UINT32_MAX) {
+        ::close(fd);
+        return false;
+    }
+    void *p;
+    if (_copy_on_write) {
+        p = ::mmap(nullptr, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+    } else {
+        p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    ::madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+    const size_t path_len = strlen(filename) + 5;
+    idx_path = NEW_NOTHROW char[path_len];
+    if (idx_path == nullptr) {
+        ::munmap(p, st.st_size);
+        return false;
+    }
+    snprintf(idx_path, path_len, "%s.idx", filename);
+
+    base = (const uint8_t *)p;
+    log_size = st.st_size;
+    log_mtime = st.st_mtime;
+    copy_on_write = _copy_on_write;
+    prefetch_offset = 0;
+    stop = Stop::END_OF_LOG;
+    reset_formats();
+    return true;
+}
+
+void AP_Logger_IndexedReader::close(void)
+{
+    free_index();
+    if (base != nullptr) {
+        ::munmap((void *)base, log_size);
+        base = nullptr;
+    }
+    delete[] idx_path;
+    idx_path = nullptr;
+}
+
+void AP_Logger_IndexedReader::reset_formats(void)
+{
+    memset(formats, 0, sizeof(formats));
+    memset(timestamped, 0, sizeof(timestamped));
+    skipped_bytes = 0;
+
+    // FMT is the one format not defined in the log
+    struct log_Format &f = formats[LOG_FORMAT_MSG];
+    f.type = LOG_FORMAT_MSG;
+    f.length = sizeof(struct log_Format);
+    memcpy(f.name, "FMT", 3);
+    strncpy(f.format, "BBnNZ", sizeof(f.format));
+    strncpy(f.labels, "Type,Length,Name,Format,Columns", sizeof(f.labels));
+}
+
+void AP_Logger_IndexedReader::learn_format(const uint8_t *data)
+{
+    struct log_Format f;
+    memcpy(&f, data, sizeof(f));
+    if (f.type == LOG_FORMAT_MSG || f.length < 3) {
+        return;
+    }
+    formats[f.type] = f;
+
+    const uint32_t bit = 1U<<(f.type%32);
+    timestamped[f.type/32] &= ~bit;
+    if (f.format[0] == 'Q' && f.length >= 3+sizeof(uint64_t) &&
+        strncmp(f.labels, "TimeUS", 6) == 0 && (f.labels[6] == ',' || f.labels[6] == 0)) {
+        timestamped[f.type/32] |= bit;
+    }
+}
+
+void AP_Logger_IndexedReader::prefetch(uint32_t offset)
+{
+    // keep between one and two prefetch sizes of the log requested
+    // ahead of offset, starting again after a jump. prefetch_offset
+    // is kept a multiple of the prefetch size so it is page aligned
+    if (offset > prefetch_offset || prefetch_offset - offset > 2*AP_LOGGER_READER_PREFETCH_SIZE) {
+        prefetch_offset = offset - (offset % AP_LOGGER_READER_PREFETCH_SIZE);
+    }
+    if ((prefetch_offset > offset && prefetch_offset - offset > AP_LOGGER_READER_PREFETCH_SIZE) ||
+        prefetch_offset >= log_size) {
+        return;
+    }
+    const uint32_t len = MIN(uint32_t(AP_LOGGER_READER_PREFETCH_SIZE), log_size - prefetch_offset);
+    ::madvise((void *)&base[prefetch_offset], len, MADV_WILLNEED);
+    prefetch_offset += len;
+}
+
+bool AP_Logger_IndexedReader::next(uint32_t &offset, Message &msg)
+{
+    if (!read_message(offset, msg)) {
+        return false;
+    }
+    prefetch(offset);
+    return true;
+}
+
+bool AP_Logger_IndexedReader::read_message(uint32_t &offset, Message &msg)
+{
+    stop = Stop::END_OF_LOG;
+    if (base == nullptr) {
+        return false;
+    }
+    while (offset < log_size && log_size - offset >= 3) {
+        const uint8_t *p = &base[offset];
+        if (p[0] != HEAD_BYTE1 || p[1] != HEAD_BYTE2) {
+            if (!resync) {
+                stop = Stop::BAD_HEADER;
+                return false;
+            }
+            // skip to the next possible start of a message
+            const uint8_t *h = (const uint8_t *)memchr(p+1, HEAD_BYTE1, log_size - offset - 1);
+            const uint32_t next_offset = h == nullptr ? log_size : h - base;
+            skipped_bytes += next_offset - offset;
+            offset = next_offset;
+            continue;
+        }
+        const uint8_t type = p[2];
+        const uint8_t length = formats[type].length;
+        if (length < 3) {
+            if (!resync) {
+                stop = Stop::NO_FORMAT;
+                msg.data = p;
+                msg.offset = offset;
+                msg.type = type;
+                msg.length = 0;
+                return false;
+            }
+            skipped_bytes++;
+            offset++;
+            continue;
+        }
+        if (log_size - offset < length) {
+            // truncated message at the end of the log
+            break;
+        }
+        if (type == LOG_FORMAT_MSG) {
+            learn_format(p);
+        }
+        msg.data = p;
+        msg.offset = offset;
+        msg.type = type;
+        msg.length = length;
+        offset += length;
+        return true;
+    }
+    offset = log_size;
+    return false;
+}
+
+uint8_t *AP_Logger_IndexedReader::writable(const Message &msg) const
+{
+    if (!copy_on_write || base == nullptr) {
+        return nullptr;
+    }
+    return const_cast<uint8_t *>(msg.data);
+}
+
+bool AP_Logger_IndexedReader::message(uint32_t offset, Message &msg) const
+{
+    if (base == nullptr || offset >= log_size || log_size - offset < 3) {
+        return false;
+    }
+    const uint8_t *p = &base[offset];
+    const uint8_t length = formats[p[2]].length;
+    if (p[0] != HEAD_BYTE1 || p[1] != HEAD_BYTE2 || length < 3 || log_size - offset < length) {
+        return false;
+    }
+    msg.data = p;
+    msg.offset = offset;
+    msg.type = p[2];
+    msg.length = length;
+    return true;
+}
+
+const struct log_Format *AP_Logger_IndexedReader::format(uint8_t type) const
+{
+    if (formats[type].length == 0) {
+        return nullptr;
+    }
+    return &formats[type];
+}
+
+bool AP_Logger_IndexedReader::find_type(const char *name, uint8_t &type) const
+{
+    if (strlen(name) > sizeof(formats[0].name)) {
+        return false;
+    }
+    for (uint16_t i=0; i<ARRAY_SIZE(formats); i++) {
+        if (formats[i].length != 0 && strncmp(formats[i].name, name, sizeof(formats[i].name)) == 0) {
+            type = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t AP_Logger_IndexedReader::time_at(uint32_t offset) const
+{
+    uint64_t t;
+    memcpy(&t, &base[offset+3], sizeof(t));
+    return t;
+}
+
+bool AP_Logger_IndexedReader::message_time(const Message &msg, uint64_t &t) const
+{
+    if (!is_timestamped(msg.type)) {
+        return false;
+    }
+    memcpy(&t, &msg.data[3], sizeof(t));
+    return true;
+}
+
+size_t AP_Logger_IndexedReader::index_length(uint32_t num_messages, uint32_t num_time_entries)
+{
+    static_assert(sizeof(struct index_header) == 1064, "index header must not be padded");
+    return sizeof(struct index_header) +
+        num_time_entries * (sizeof(uint64_t) + sizeof(uint32_t)) +
+        num_messages * sizeof(uint32_t);
+}
+
+void AP_Logger_IndexedReader::set_index(struct index_header *header, bool mapped)
+{
+    idx = header;
+    idx_mapped = mapped;
+    time_index_us = (const uint64_t *)&header[1];
+    time_index_offsets = (const uint32_t *)&time_index_us[header->num_time_entries];
+    msg_offsets = &time_index_offsets[header->num_time_entries];
+}
+
+void AP_Logger_IndexedReader::free_index(void)
+{
+    if (idx == nullptr) {
+        return;
+    }
+    if (idx_mapped) {
+        ::munmap((void *)idx, index_length(idx->num_messages, idx->num_time_entries));
+    } else {
+        delete[] (uint64_t *)idx;
+    }
+    idx = nullptr;
+}
+
+bool AP_Logger_IndexedReader::scan(struct index_header &header, bool fill)
+{
+    uint64_t *times = nullptr;
+    uint32_t *time_offs = nullptr;
+    uint32_t *offs = nullptr;
+    uint32_t next_offs[256];
+    if (fill) {
+        times = (uint64_t *)(&header + 1);
+        time_offs = (uint32_t *)&times[header.num_time_entries];
+        offs = &time_offs[header.num_time_entries];
+        memcpy(next_offs, header.type_start, sizeof(next_offs));
+    }
+
+    // formats are learned again so both passes see the same messages
+    reset_formats();
+
+    uint32_t num_times = 0;
+    uint64_t next_time_offset = 0;
+    uint32_t offset = 0;
+    Message msg;
+    while (next(offset, msg)) {
+        if (!fill) {
+            // counts are kept one place up so they can be summed in place
+            header.type_start[msg.type+1]++;
+        } else if (next_offs[msg.type] < header.type_start[msg.type+1]) {
+            offs[next_offs[msg.type]++] = msg.offset;
+        } else {
+            return false;
+        }
+        if (msg.offset >= next_time_offset && is_timestamped(msg.type)) {
+            if (fill) {
+                if (num_times >= header.num_time_entries) {
+                    return false;
+                }
+                times[num_times] = time_at(msg.offset);
+                time_offs[num_times] = msg.offset;
+            }
+            num_times++;
+            next_time_offset = (uint64_t(msg.offset) / AP_LOGGER_INDEX_TIME_INTERVAL + 1) * AP_LOGGER_INDEX_TIME_INTERVAL;
+        }
+    }
+
+    if (fill) {
+        return num_times == header.num_time_entries &&
+            memcmp(next_offs, &header.type_start[1], sizeof(next_offs)) == 0;
+    }
+    for (uint16_t i=0; i<256; i++) {
+        header.type_start[i+1] += header.type_start[i];
+    }
+    header.num_messages = header.type_start[256];
+    header.num_time_entries = num_times;
+    return true;
+}
+
+bool AP_Logger_IndexedReader::index(bool use_sidecar)
+{
+    if (base == nullptr) {
+        return false;
+    }
+    if (idx != nullptr) {
+        return true;
+    }
+    if (use_sidecar && load_index()) {
+        return true;
+    }
+
+    struct index_header header {};
+    header.magic = INDEX_MAGIC;
+    header.version = INDEX_VERSION;
+    header.resync = resync;
+    header.log_size = log_size;
+    header.log_mtime = log_mtime;
+    scan(header, false);
+
+    // allocated as uint64_t to align the times
+    const size_t length = index_length(header.num_messages, header.num_time_entries);
+    uint64_t *buf = NEW_NOTHROW uint64_t[(length + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+    if (buf == nullptr) {
+        return false;
+    }
+    struct index_header *new_idx = (struct index_header *)buf;
+    memcpy(new_idx, &header, sizeof(header));
+    if (!scan(*new_idx, true)) {
+        // the log changed under us
+        delete[] buf;
+        return false;
+    }
+    set_index(new_idx, false);
+
+    if (use_sidecar) {
+        save_index();
+    }
+    return true;
+}
+
+/*
+  map the sidecar index, checking it is for this log and that every
+  offset in it is inside the log
+ */
+bool AP_Logger_IndexedReader::load_index(void)
+{
+    const int fd = ::open(idx_path, O_RDONLY|O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || uint64_t(st.st_size) < sizeof(struct index_header)) {
+        ::close(fd);
+        return false;
+    }
+    void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    const struct index_header *h = (const struct index_header *)p;
+    bool ok = h->magic == INDEX_MAGIC &&
+        h->version == INDEX_VERSION &&
+        h->resync == uint16_t(resync) &&
+        h->log_size == log_size &&
+        h->log_mtime == log_mtime &&
+        h->type_start[0] == 0 &&
+        h->type_start[256] == h->num_messages &&
+        h->num_time_entries <= h->num_messages &&
+        uint64_t(st.st_size) == index_length(h->num_messages, h->num_time_entries);
+    for (uint16_t i=0; ok && i<256; i++) {
+        ok = h->type_start[i] <= h->type_start[i+1];
+    }
+    if (!ok) {
+        ::munmap(p, st.st_size);
+        return false;
+    }
+    set_index((struct index_header *)p, true);
+
+    // learn the formats of the log from its FMT messages
+    reset_formats();
+    const uint32_t *fmt_offsets = offsets(LOG_FORMAT_MSG);
+    for (uint32_t i=0; ok && i<count(LOG_FORMAT_MSG); i++) {
+        Message msg;
+        ok = message(fmt_offsets[i], msg);
+        if (ok) {
+            learn_format(msg.data);
+        }
+    }
+    for (uint16_t type=0; ok && type<256; type++) {
+        const uint8_t length = formats[type].length;
+        const uint32_t *offs = offsets(type);
+        for (uint32_t i=0; ok && i<count(type); i++) {
+            ok = length >= 3 && offs[i] < log_size && log_size - offs[i] >= length;
+        }
+    }
+    for (uint32_t i=0; ok && i<h->num_time_entries; i++) {
+        Message msg;
+        ok = message(time_index_offsets[i], msg) && is_timestamped(msg.type);
+    }
+    if (!ok) {
+        free_index();
+        reset_formats();
+        return false;
+    }
+    return true;
+}
+
+/*
+  write the index next to the log, replacing any old index in one step
+  so a reader never sees a partly written file. Failure to write it
+  only means it is built again next time
+ */
+void AP_Logger_IndexedReader::save_index(void) const
+{
+    const size_t tmp_len = strlen(idx_path) + 5;
+    char *tmp_path = NEW_NOTHROW char[tmp_len];
+    if (tmp_path == nullptr) {
+        return;
+    }
+    snprintf(tmp_path, tmp_len, "%s.tmp", idx_path);
+
+    const int fd = ::open(tmp_path, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+    if (fd == -1) {
+        delete[] tmp_path;
+        return;
+    }
+    const uint8_t *p = (const uint8_t *)idx;
+    size_t remaining = index_length(idx->num_messages, idx->num_time_entries);
+    while (remaining > 0) {
+        const ssize_t n = ::write(fd, p, remaining);
+        if (n <= 0) {
+            break;
+        }
+        p += n;
+        remaining -= n;
+    }
+    if (::close(fd) != 0 || remaining != 0 || ::rename(tmp_path, idx_path) != 0) {
+        ::unlink(tmp_path);
+    }
+    delete[] tmp_path;
+}
+
+uint32_t AP_Logger_IndexedReader::count(uint8_t type) const
+{
+    if (idx == nullptr) {
+        return 0;
+    }
+    return idx->type_start[type+1] - idx->type_start[type];
+}
+
+const uint32_t *AP_Logger_IndexedReader::offsets(uint8_t type) const
+{
+    if (idx == nullptr) {
+        return nullptr;
+    }
+    return &msg_offsets[idx->type_start[type]];
+}
+
+bool AP_Logger_IndexedReader::seek_time(uint64_t t, uint32_t &offset)
+{
+    if (idx == nullptr) {
+        return false;
+    }
+    // find the first time index entry at or after t, the message
+    // wanted is between the entry before it and it
+    uint32_t lo = 0;
+    uint32_t hi = idx->num_time_entries;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (time_index_us[mid] < t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    // no prefetch as only a short way into the log is read
+    uint32_t ofs = lo > 0 ? time_index_offsets[lo-1] : 0;
+    Message msg;
+    while (read_message(ofs, msg)) {
+        uint64_t msg_time;
+        if (message_time(msg, msg_time) && msg_time >= t) {
+            offset = msg.offset;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AP_Logger_IndexedReader::time_range(uint8_t type, uint64_t start_us, uint64_t end_us, uint32_t &first, uint32_t &last) const
+{
+    if (idx == nullptr || !is_timestamped(type)) {
+        return false;
+    }
+    const uint32_t *offs = offsets(type);
+    const uint32_t n = count(type);
+    const uint64_t bounds[2] { start_us, end_us };
+    uint32_t result[2];
+    for (uint8_t i=0; i<2; i++) {
+        uint32_t lo = 0;
+        uint32_t hi = n;
+        while (lo < hi) {
+            const uint32_t mid = lo + (hi - lo) / 2;
+            if (time_at(offs[mid]) < bounds[i]) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        result[i] = lo;
+    }
+    first = result[0];
+    last = MAX(result[0], result[1]);
+    return true;
+}
+
+#endif  // AP_LOGGER_INDEXED_READER_ENABLED
@@ -0,0 +1,243 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_Logger_config.h"
+
+#if AP_LOGGER_INDEXED_READER_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include "LogStructure.h"
+
+// bytes of log between entries in the time index
+#ifndef AP_LOGGER_INDEX_TIME_INTERVAL
+#define AP_LOGGER_INDEX_TIME_INTERVAL (64*1024UL)
+#endif
+
+// amount of the log asked to be read ahead of sequential reads
+#ifndef AP_LOGGER_READER_PREFETCH_SIZE
+#define AP_LOGGER_READER_PREFETCH_SIZE (8*1024*1024UL)
+#endif
+
+/*
+  memory mapped access to a DataFlash .BIN log
+
+  Messages are returned as pointers into the mapped log, so no copy is
+  made. Once indexed, the offset of every message is held in one list
+  per message type, along with a sparse index of message time against
+  offset for seeking. The index is saved next to the log (as
+  LOGNAME.idx) and loaded instead of being rebuilt while the log is
+  unchanged.
+
+  Offsets are 32 bit as logs are written to FAT filesystems, so logs
+  of 4GiB or more are not opened.
+ */
+class AP_Logger_IndexedReader {
+public:
+    AP_Logger_IndexedReader() {}
+    ~AP_Logger_IndexedReader() { close(); }
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(AP_Logger_IndexedReader);
+
+    // a message in the mapped log, data starts with the packet header
+    struct Message {
+        const uint8_t *data;
+        uint32_t offset;
+        uint8_t type;
+        uint8_t length;
+    };
+
+    /*
+      map a log for reading, returns false if it can't be opened. With
+      copy_on_write the mapping is private and writable, so callers
+      may modify messages in place through writable() without the
+      file being changed
+     */
+    bool open(const char *filename, bool copy_on_write=false);
+
+    // unmap the log and index
+    void close(void);
+
+    bool is_open(void) const { return base != nullptr; }
+
+    // size of the log in bytes
+    uint32_t size(void) const { return log_size; }
+
+    // why next() last returned false
+    enum class Stop : uint8_t {
+        END_OF_LOG,     // including a truncated message at the end
+        BAD_HEADER,     // bytes which are not the start of a message
+        NO_FORMAT,      // a message of a type with no FMT before it
+    };
+
+    /*
+      return the message at offset and advance offset past it. Returns
+      false at the end of the log, or leaves offset at bytes which do
+      not start a message with a known format and returns false;
+      stopped() gives which. When stopped at a message with no format
+      msg holds its offset and type with a zero length
+     */
+    bool next(uint32_t &offset, Message &msg);
+
+    Stop stopped(void) const { return stop; }
+
+    // data of a message which may be modified, nullptr unless the log
+    // was opened copy on write
+    uint8_t *writable(const Message &msg) const;
+
+    /*
+      skip bytes which do not start a message with a known format
+      rather than stopping at them, counting them in skipped(). For
+      analysis of damaged logs; replay must stop instead as it can't
+      know what was lost
+     */
+    void set_resync(bool enable) { resync = enable; }
+
+    // bytes skipped since the log was opened or last indexed
+    uint32_t skipped(void) const { return skipped_bytes; }
+
+    /*
+      build the index of the log, or load it from the sidecar file if
+      that matches the log and resync setting. Without resync the
+      index ends where next() stops. A newly built index is saved to
+      the sidecar file if use_sidecar is true. Returns false on
+      allocation failure
+     */
+    bool index(bool use_sidecar=true);
+
+    bool is_indexed(void) const { return idx != nullptr; }
+
+    // true if the index was loaded from the sidecar file rather than built
+    bool index_loaded(void) const { return idx != nullptr && idx_mapped; }
+
+    // format of a message type, nullptr if the log does not define
+    // it. Formats are learned from FMT messages as they are read
+    const struct log_Format *format(uint8_t type) const;
+
+    // find a message type by name, returns false if the log does not define it
+    bool find_type(const char *name, uint8_t &type) const;
+
+    // number of messages, valid once indexed
+    uint32_t num_messages(void) const { return idx ? idx->num_messages : 0; }
+
+    // number of messages of a type, valid once indexed
+    uint32_t count(uint8_t type) const;
+
+    // offsets of the messages of a type in log order, valid once indexed
+    const uint32_t *offsets(uint8_t type) const;
+
+    // message at offset, returns false if no message starts there
+    bool message(uint32_t offset, Message &msg) const;
+
+    // time of a message with TimeUS as its first field, returns false for other messages
+    bool message_time(const Message &msg, uint64_t &time_us) const;
+
+    /*
+      offset of the first message with a time at or after time_us,
+      valid once indexed. Assumes time does not go backwards in the
+      log. Returns false if no message is that late
+     */
+    bool seek_time(uint64_t time_us, uint32_t &offset);
+
+    /*
+      range [first, last) of a type's offsets() holding the messages
+      with times from start_us up to but not including end_us, valid
+      once indexed. Returns false if the type has no TimeUS field
+     */
+    bool time_range(uint8_t type, uint64_t start_us, uint64_t end_us, uint32_t &first, uint32_t &last) const;
+
+private:
+
+    // index layout, used both in memory and as the sidecar file. All
+    // fields are naturally aligned so the layout has no padding
+    struct index_header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t resync;        // 1 if bad bytes were skipped rather than ending the index
+        uint64_t log_size;
+        int64_t log_mtime;
+        uint32_t num_messages;
+        uint32_t num_time_entries;
+        // start of each type's offsets in the message offsets, with the total at the end
+        uint32_t type_start[257];
+        uint32_t pad;           // keeps the times which follow 8 byte aligned
+    };
+    // followed by num_time_entries uint64_t times, then
+    // num_time_entries uint32_t offsets, then num_messages uint32_t
+    // message offsets grouped by type
+
+    static size_t index_length(uint32_t num_messages, uint32_t num_time_entries);
+
+    // set pointers into an index
+    void set_index(struct index_header *header, bool mapped);
+
+    // free the index
+    void free_index(void);
+
+    /*
+      read every message in the log. With fill false message and time
+      entry counts are stored in header. With fill true header must
+      hold the counts and be followed by space for the offsets, which
+      are stored. Returns false if the counts do not match the log
+     */
+    bool scan(struct index_header &header, bool fill);
+
+    // map the sidecar index if it matches the log
+    bool load_index(void);
+
+    // write the index to the sidecar file
+    void save_index(void) const;
+
+    // forget formats learned from the log and the bytes skipped
+    void reset_formats(void);
+
+    // learn the format in a FMT message
+    void learn_format(const uint8_t *data);
+
+    bool is_timestamped(uint8_t type) const { return (timestamped[type/32] & (1U<<(type%32))) != 0; }
+
+    // time of message at offset, which must be a message with a TimeUS field
+    uint64_t time_at(uint32_t offset) const;
+
+    // next() without prefetching
+    bool read_message(uint32_t &offset, Message &msg);
+
+    // ask for the log ahead of offset to be read in the background
+    void prefetch(uint32_t offset);
+
+    const uint8_t *base = nullptr;
+    uint32_t log_size;
+    int64_t log_mtime;
+    bool copy_on_write;
+    char *idx_path = nullptr;   // LOGNAME.idx
+
+    struct log_Format formats[256];
+    uint32_t timestamped[8];    // bitmask of types whose first field is TimeUS
+
+    struct index_header *idx = nullptr;
+    const uint64_t *time_index_us;      // time of time index entries
+    const uint32_t *time_index_offsets; // offset of time index entries
+    const uint32_t *msg_offsets;        // message offsets grouped by type
+    bool idx_mapped;            // idx is the mapped sidecar file rather than allocated
+
+    uint32_t prefetch_offset;   // end of log requested by prefetch()
+
+    bool resync = false;        // skip bad bytes rather than stopping
+    Stop stop;
+    uint32_t skipped_bytes;
+};
+
+#endif  // AP_LOGGER_INDEXED_READER_ENABLED
@@ -57,6 +57,11 @@
 #define REPLAY_LOG_NEW_MSG_MAX 230
 #define REPLAY_LOG_NEW_MSG_MIN 220
 
+// memory mapped, indexed reading of .BIN logs for Replay and log tools
+#ifndef AP_LOGGER_INDEXED_READER_ENABLED
+#define AP_LOGGER_INDEXED_READER_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 #include <AC_Fence/AC_Fence_config.h>
 #define HAL_LOGGER_FENCE_ENABLED HAL_LOGGING_ENABLED && AP_FENCE_ENABLED
 
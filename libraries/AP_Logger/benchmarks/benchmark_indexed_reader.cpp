@@ -0,0 +1,284 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Logger/AP_Logger_IndexedReader.h>
+
+#if AP_LOGGER_INDEXED_READER_ENABLED
+
+#include <AP_Math/AP_Math.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  compare reading a 1GB log a message at a time with read(), as
+  Replay's reader did, against the memory mapped reader, and time
+  building and loading its index and using it to find messages
+ */
+
+static const uint64_t bench_log_size = 1024*1024*1024ULL;
+
+struct PACKED bench_IMU {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    float gyro[3];
+    float accel[3];
+    uint32_t err_count[2];
+    int16_t temperature;
+    uint8_t instance;
+};
+
+struct PACKED bench_ATT {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    int16_t angles[6];
+    uint16_t error_rp;
+    uint16_t error_yaw;
+};
+
+struct PACKED bench_GPS {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t status;
+    uint32_t gps_week_ms;
+    uint16_t gps_week;
+    uint8_t num_sats;
+    uint16_t hdop;
+    int32_t lat;
+    int32_t lng;
+    int32_t alt;
+    float speed;
+    float course;
+    float vz;
+    float yaw;
+    uint8_t used;
+};
+
+#define BENCH_IMU_TYPE 200
+#define BENCH_ATT_TYPE 201
+#define BENCH_GPS_TYPE 202
+
+static char log_path[64];
+static uint64_t log_end_us;
+
+static void write_fmt(FILE *f, uint8_t type, uint8_t length, const char *name, const char *format, const char *labels)
+{
+    struct log_Format pkt {};
+    pkt.head1 = HEAD_BYTE1;
+    pkt.head2 = HEAD_BYTE2;
+    pkt.msgid = LOG_FORMAT_MSG;
+    pkt.type = type;
+    pkt.length = length;
+    memcpy(pkt.name, name, MIN(strlen(name), sizeof(pkt.name)));
+    memcpy(pkt.format, format, MIN(strlen(format), sizeof(pkt.format)));
+    memcpy(pkt.labels, labels, MIN(strlen(labels), sizeof(pkt.labels)));
+    fwrite(&pkt, sizeof(pkt), 1, f);
+}
+
+static void remove_log(void)
+{
+    char idx_path[sizeof(log_path)+4];
+    snprintf(idx_path, sizeof(idx_path), "%s.idx", log_path);
+    unlink(idx_path);
+    unlink(log_path);
+}
+
+/*
+  write a log of IMU at 1kHz, ATT at 400Hz and GPS at 10Hz
+ */
+static void create_log(void)
+{
+    if (log_path[0] != 0) {
+        return;
+    }
+    strcpy(log_path, "/tmp/indexed_reader_benchXXXXXX");
+    const int fd = mkstemp(log_path);
+    FILE *f = fd == -1 ? nullptr : fdopen(fd, "w");
+    if (f == nullptr) {
+        AP_HAL::panic("create %s failed", log_path);
+    }
+    atexit(remove_log);
+    write_fmt(f, BENCH_IMU_TYPE, sizeof(bench_IMU), "IMU", "QffffffIIhB", "TimeUS,GyrX,GyrY,GyrZ,AccX,AccY,AccZ,EG,EA,T,I");
+    write_fmt(f, BENCH_ATT_TYPE, sizeof(bench_ATT), "ATT", "QccccCCCC", "TimeUS,DesRoll,Roll,DesPitch,Pitch,DesYaw,Yaw,ErrRP,ErrYaw");
+    write_fmt(f, BENCH_GPS_TYPE, sizeof(bench_GPS), "GPS", "QBIHBcLLeffffB", "TimeUS,Status,GMS,GWk,NSats,HDop,Lat,Lng,Alt,Spd,GCrs,VZ,Yaw,U");
+
+    uint64_t written = 0;
+    uint64_t t = 0;
+    while (written < bench_log_size) {
+        t += 1000;
+        const bench_IMU imu { LOG_PACKET_HEADER_INIT(BENCH_IMU_TYPE), t, {}, {0, 0, -9.8}, {}, 2000, 0 };
+        fwrite(&imu, sizeof(imu), 1, f);
+        written += sizeof(imu);
+        if (t % 2500 < 1000) {
+            const bench_ATT att { LOG_PACKET_HEADER_INIT(BENCH_ATT_TYPE), t, {}, 0, 0 };
+            fwrite(&att, sizeof(att), 1, f);
+            written += sizeof(att);
+        }
+        if (t % 100000 == 0) {
+            const bench_GPS gps { LOG_PACKET_HEADER_INIT(BENCH_GPS_TYPE), t, 3, uint32_t(t/1000), 2300, 12, 70,
+                                  -353632621, 1491652374, 58400, 0, 0, 0, 0, 1 };
+            fwrite(&gps, sizeof(gps), 1, f);
+            written += sizeof(gps);
+        }
+    }
+    fclose(f);
+    log_end_us = t;
+}
+
+static void BM_LogReadSyscalls(benchmark::State& state)
+{
+    create_log();
+    struct log_Format formats[256] {};
+    uint64_t messages = 0;
+
+    while (state.KeepRunning()) {
+        const int fd = ::open(log_path, O_RDONLY);
+        uint8_t buf[256];
+        uint32_t sum = 0;
+        while (::read(fd, buf, 3) == 3 && buf[0] == HEAD_BYTE1 && buf[1] == HEAD_BYTE2) {
+            const uint8_t length = buf[2] == LOG_FORMAT_MSG ? sizeof(struct log_Format) : formats[buf[2]].length;
+            if (length < 3 || ::read(fd, &buf[3], length-3) != length-3) {
+                break;
+            }
+            if (buf[2] == LOG_FORMAT_MSG) {
+                const struct log_Format *fmt = (const struct log_Format *)buf;
+                formats[fmt->type] = *fmt;
+            }
+            sum += buf[length-1];
+            messages++;
+        }
+        ::close(fd);
+        gbenchmark_escape(&sum);
+    }
+    state.SetItemsProcessed(messages);
+    state.SetBytesProcessed(state.iterations() * bench_log_size);
+}
+
+static void BM_LogReadMapped(benchmark::State& state)
+{
+    create_log();
+    uint64_t messages = 0;
+
+    while (state.KeepRunning()) {
+        AP_Logger_IndexedReader reader;
+        if (!reader.open(log_path)) {
+            AP_HAL::panic("open %s failed", log_path);
+        }
+        uint32_t offset = 0;
+        uint32_t sum = 0;
+        AP_Logger_IndexedReader::Message msg;
+        while (reader.next(offset, msg)) {
+            sum += msg.data[msg.length-1];
+            messages++;
+        }
+        gbenchmark_escape(&sum);
+    }
+    state.SetItemsProcessed(messages);
+    state.SetBytesProcessed(state.iterations() * bench_log_size);
+}
+
+static void BM_LogIndexBuild(benchmark::State& state)
+{
+    create_log();
+
+    while (state.KeepRunning()) {
+        AP_Logger_IndexedReader reader;
+        if (!reader.open(log_path) || !reader.index(false)) {
+            AP_HAL::panic("index %s failed", log_path);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bench_log_size);
+}
+
+static void BM_LogIndexLoad(benchmark::State& state)
+{
+    create_log();
+    {
+        // write the sidecar index
+        AP_Logger_IndexedReader reader;
+        if (!reader.open(log_path) || !reader.index()) {
+            AP_HAL::panic("index %s failed", log_path);
+        }
+    }
+
+    while (state.KeepRunning()) {
+        AP_Logger_IndexedReader reader;
+        if (!reader.open(log_path) || !reader.index() || !reader.index_loaded()) {
+            AP_HAL::panic("load index of %s failed", log_path);
+        }
+    }
+}
+
+/*
+  sum a field of every GPS message, as a tool plotting one message
+  type would
+ */
+static void BM_LogTypeScan(benchmark::State& state)
+{
+    create_log();
+    AP_Logger_IndexedReader reader;
+    if (!reader.open(log_path) || !reader.index()) {
+        AP_HAL::panic("index %s failed", log_path);
+    }
+    const uint32_t *offsets = reader.offsets(BENCH_GPS_TYPE);
+    const uint32_t count = reader.count(BENCH_GPS_TYPE);
+
+    while (state.KeepRunning()) {
+        int64_t sum = 0;
+        for (uint32_t i=0; i<count; i++) {
+            AP_Logger_IndexedReader::Message msg;
+            reader.message(offsets[i], msg);
+            sum += ((const bench_GPS *)msg.data)->alt;
+        }
+        gbenchmark_escape(&sum);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_LogSeekTime(benchmark::State& state)
+{
+    create_log();
+    AP_Logger_IndexedReader reader;
+    if (!reader.open(log_path) || !reader.index()) {
+        AP_HAL::panic("index %s failed", log_path);
+    }
+    uint32_t r = 1;
+
+    while (state.KeepRunning()) {
+        r = r * 1664525U + 1013904223U;
+        uint32_t offset;
+        reader.seek_time(uint64_t(r) * 1000 % log_end_us, offset);
+        gbenchmark_escape(&offset);
+    }
+}
+
+static void BM_LogTimeRange(benchmark::State& state)
+{
+    create_log();
+    AP_Logger_IndexedReader reader;
+    if (!reader.open(log_path) || !reader.index()) {
+        AP_HAL::panic("index %s failed", log_path);
+    }
+    uint32_t r = 1;
+
+    while (state.KeepRunning()) {
+        r = r * 1664525U + 1013904223U;
+        const uint64_t start_us = uint64_t(r) * 1000 % log_end_us;
+        uint32_t first, last;
+        reader.time_range(BENCH_ATT_TYPE, start_us, start_us + 10000000, first, last);
+        gbenchmark_escape(&last);
+    }
+}
+
+BENCHMARK(BM_LogReadSyscalls);
+BENCHMARK(BM_LogReadMapped);
+BENCHMARK(BM_LogIndexBuild);
+BENCHMARK(BM_LogIndexLoad);
+BENCHMARK(BM_LogTypeScan);
+BENCHMARK(BM_LogSeekTime);
+BENCHMARK(BM_LogTimeRange);
+#endif
+
+BENCHMARK_MAIN()
@@ -0,0 +1,162 @@
+#include <AP_gtest.h>
+
+#include <AP_Logger/AP_Logger.h>
+
+#if HAL_LOGGING_ENABLED
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  a message using every format character, laid out as the format
+  describes it
+ */
+#define TEST_FMT "QbBhHiIfgdnNZqaLMceE"
+
+struct PACKED log_TEST {
+    LOG_PACKET_HEADER;
+    uint64_t Q;
+    int8_t b;
+    uint8_t B;
+    int16_t h;
+    uint16_t H;
+    int32_t i;
+    uint32_t I;
+    float f;
+    uint16_t g;
+    double d;
+    char n[4];
+    char N[16];
+    char Z[64];
+    int64_t q;
+    int16_t a[32];
+    int32_t L;
+    uint8_t M;
+    int16_t c;
+    int32_t e;
+    uint32_t E;
+};
+
+static_assert(AP_Logger::calc_msg_len(TEST_FMT) == sizeof(log_TEST), "TEST_FMT must match log_TEST");
+static_assert(AP_Logger::calc_msg_len("QX") == -1, "unknown format characters must be rejected");
+
+static const int16_t test_array[32] { 1, -2, 3, -4, 5, -6, 7, -8, 9, -10, 11, -12, 13, -14, 15, -16,
+                                      17, -18, 19, -20, 21, -22, 23, -24, 25, -26, 27, -28, 29, -30, 31, -32 };
+
+static void pack(const AP_Logger::log_write_fmt &f, uint8_t *buffer, ...)
+{
+    va_list arg_list;
+    va_start(arg_list, buffer);
+    AP_Logger::pack_msg(f, buffer, arg_list);
+    va_end(arg_list);
+}
+
+static void pack_test(const AP_Logger::log_write_fmt &f, uint8_t *buffer)
+{
+    pack(f, buffer,
+         uint64_t(0x123456789ABCDEFULL),
+         int8_t(-5),
+         uint8_t(250),
+         int16_t(-1234),
+         uint16_t(65000),
+         int32_t(-123456789),
+         uint32_t(4000000000U),
+         1.5f,
+         0.25f,
+         3.14159265358979,
+         "abcd",
+         "name",
+         "a longer string",
+         int64_t(-1234567890123LL),
+         test_array,
+         int32_t(-353632621),
+         uint8_t(7),
+         int16_t(-300),
+         int32_t(58400),
+         uint32_t(123456));
+}
+
+// the compiled layout of each field matches the packed structure
+TEST(AP_Logger, CompiledFieldLayout)
+{
+    const uint8_t num_fields = strlen(TEST_FMT);
+    AP_Logger::log_write_field *fields = AP_Logger::compile_fields(TEST_FMT, num_fields);
+    ASSERT_NE(fields, nullptr);
+
+    const size_t offsets[] {
+        offsetof(log_TEST, Q), offsetof(log_TEST, b), offsetof(log_TEST, B), offsetof(log_TEST, h),
+        offsetof(log_TEST, H), offsetof(log_TEST, i), offsetof(log_TEST, I), offsetof(log_TEST, f),
+        offsetof(log_TEST, g), offsetof(log_TEST, d), offsetof(log_TEST, n), offsetof(log_TEST, N),
+        offsetof(log_TEST, Z), offsetof(log_TEST, q), offsetof(log_TEST, a), offsetof(log_TEST, L),
+        offsetof(log_TEST, M), offsetof(log_TEST, c), offsetof(log_TEST, e), offsetof(log_TEST, E),
+    };
+    ASSERT_EQ(ARRAY_SIZE(offsets), num_fields);
+    for (uint8_t i=0; i<num_fields; i++) {
+        EXPECT_EQ(fields[i].offset, offsets[i]) << "field " << TEST_FMT[i];
+        EXPECT_EQ(fields[i].size, AP_Logger::fmt_field_size(TEST_FMT[i])) << "field " << TEST_FMT[i];
+    }
+    EXPECT_EQ(fields[num_fields-1].offset + fields[num_fields-1].size, sizeof(log_TEST));
+
+    delete[] fields;
+}
+
+// packing with the compiled layout gives the same message as working through the format
+TEST(AP_Logger, CompiledPackMatchesFormat)
+{
+    AP_Logger::log_write_fmt f {};
+    f.msg_type = 42;
+    f.msg_len = sizeof(log_TEST);
+    f.num_fields = strlen(TEST_FMT);
+    f.fmt = TEST_FMT;
+
+    uint8_t uncompiled[sizeof(log_TEST)];
+    memset(uncompiled, 0xAA, sizeof(uncompiled));
+    pack_test(f, uncompiled);
+
+    AP_Logger::log_write_field *fields = AP_Logger::compile_fields(TEST_FMT, f.num_fields);
+    ASSERT_NE(fields, nullptr);
+    f.fields = fields;
+    uint8_t compiled[sizeof(log_TEST)];
+    memset(compiled, 0x55, sizeof(compiled));
+    pack_test(f, compiled);
+    delete[] fields;
+
+    EXPECT_EQ(memcmp(uncompiled, compiled, sizeof(log_TEST)), 0);
+
+    log_TEST pkt;
+    memcpy(&pkt, compiled, sizeof(pkt));
+    EXPECT_EQ(pkt.head1, HEAD_BYTE1);
+    EXPECT_EQ(pkt.head2, HEAD_BYTE2);
+    EXPECT_EQ(pkt.msgid, 42);
+    EXPECT_EQ(pkt.Q, 0x123456789ABCDEFULL);
+    EXPECT_EQ(pkt.b, -5);
+    EXPECT_EQ(pkt.B, 250);
+    EXPECT_EQ(pkt.h, -1234);
+    EXPECT_EQ(pkt.H, 65000);
+    EXPECT_EQ(pkt.i, -123456789);
+    EXPECT_EQ(pkt.I, 4000000000U);
+    EXPECT_FLOAT_EQ(pkt.f, 1.5f);
+    Float16_t g;
+    memcpy(&g, &pkt.g, sizeof(g));
+    EXPECT_FLOAT_EQ(g.get(), 0.25f);
+    EXPECT_DOUBLE_EQ(pkt.d, 3.14159265358979);
+    EXPECT_EQ(memcmp(pkt.n, "abcd", 4), 0);
+    EXPECT_STREQ(pkt.N, "name");
+    EXPECT_EQ(pkt.N[15], 0);
+    EXPECT_STREQ(pkt.Z, "a longer string");
+    EXPECT_EQ(pkt.Z[63], 0);
+    EXPECT_EQ(pkt.q, -1234567890123LL);
+    EXPECT_EQ(memcmp(pkt.a, test_array, sizeof(test_array)), 0);
+    EXPECT_EQ(pkt.L, -353632621);
+    EXPECT_EQ(pkt.M, 7);
+    EXPECT_EQ(pkt.c, -300);
+    EXPECT_EQ(pkt.e, 58400);
+    EXPECT_EQ(pkt.E, 123456U);
+}
+
+#endif // HAL_LOGGING_ENABLED
+
+AP_GTEST_MAIN()
@@ -0,0 +1,392 @@
+#include <AP_gtest.h>
+
+#include <AP_Logger/AP_Logger_IndexedReader.h>
+#include <AP_Math/AP_Math.h>
+
+#if AP_LOGGER_INDEXED_READER_ENABLED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  build a log of TST1 messages at 1ms intervals with a TST2 every
+  fourth message and an untimed NOTM every hundredth
+ */
+
+#define TST1_TYPE 200
+#define TST2_TYPE 201
+#define NOTM_TYPE 202
+#define NUM_TST1 20000
+
+struct PACKED log_TST1 {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t value;
+};
+
+struct PACKED log_TST2 {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t value;
+};
+
+struct PACKED log_NOTM {
+    LOG_PACKET_HEADER;
+    uint8_t value;
+};
+
+class TestLog {
+public:
+    TestLog() {
+        strcpy(path, "/tmp/test_indexed_readerXXXXXX");
+        const int fd = mkstemp(path);
+        f = fdopen(fd, "w");
+    }
+    ~TestLog() {
+        unlink(path);
+        char idx_path[sizeof(path)+4];
+        snprintf(idx_path, sizeof(idx_path), "%s.idx", path);
+        unlink(idx_path);
+    }
+
+    void write_fmt(uint8_t type, uint8_t length, const char *name, const char *format, const char *labels) {
+        struct log_Format pkt {};
+        pkt.head1 = HEAD_BYTE1;
+        pkt.head2 = HEAD_BYTE2;
+        pkt.msgid = LOG_FORMAT_MSG;
+        pkt.type = type;
+        pkt.length = length;
+        memcpy(pkt.name, name, MIN(strlen(name), sizeof(pkt.name)));
+        memcpy(pkt.format, format, MIN(strlen(format), sizeof(pkt.format)));
+        memcpy(pkt.labels, labels, MIN(strlen(labels), sizeof(pkt.labels)));
+        write(&pkt, sizeof(pkt));
+    }
+
+    void write_formats() {
+        write_fmt(TST1_TYPE, sizeof(log_TST1), "TST1", "QI", "TimeUS,Val");
+        write_fmt(TST2_TYPE, sizeof(log_TST2), "TST2", "QB", "TimeUS,Val");
+        write_fmt(NOTM_TYPE, sizeof(log_NOTM), "NOTM", "B", "Val");
+    }
+
+    void write_messages() {
+        for (uint32_t i=0; i<NUM_TST1; i++) {
+            const uint64_t t = 1000000 + i*1000ULL;
+            const struct log_TST1 tst1 { LOG_PACKET_HEADER_INIT(TST1_TYPE), t, i };
+            write(&tst1, sizeof(tst1));
+            if (i % 4 == 0) {
+                const struct log_TST2 tst2 { LOG_PACKET_HEADER_INIT(TST2_TYPE), t, uint8_t(i) };
+                write(&tst2, sizeof(tst2));
+            }
+            if (i % 100 == 0) {
+                const struct log_NOTM notm { LOG_PACKET_HEADER_INIT(NOTM_TYPE), uint8_t(i) };
+                write(&notm, sizeof(notm));
+            }
+        }
+    }
+
+    void write(const void *data, size_t len) {
+        fwrite(data, len, 1, f);
+    }
+
+    void close() {
+        fclose(f);
+    }
+
+    char path[64];
+    FILE *f;
+};
+
+static const uint32_t num_fmt = 3;
+static const uint32_t num_tst2 = NUM_TST1 / 4;
+static const uint32_t num_notm = NUM_TST1 / 100;
+
+TEST(AP_Logger_IndexedReader, next)
+{
+    TestLog log;
+    log.write_formats();
+    log.write_messages();
+    log.close();
+
+    AP_Logger_IndexedReader reader;
+    EXPECT_FALSE(reader.open("/tmp/does/not/exist.BIN"));
+    ASSERT_TRUE(reader.open(log.path));
+
+    uint32_t counts[256] {};
+    uint32_t offset = 0;
+    uint32_t expected_offset = 0;
+    AP_Logger_IndexedReader::Message msg;
+    while (reader.next(offset, msg)) {
+        EXPECT_EQ(msg.offset, expected_offset);
+        EXPECT_EQ(msg.data[2], msg.type);
+        expected_offset += msg.length;
+        counts[msg.type]++;
+    }
+    EXPECT_EQ(offset, reader.size());
+    EXPECT_EQ(expected_offset, reader.size());
+    EXPECT_EQ(counts[LOG_FORMAT_MSG], num_fmt);
+    EXPECT_EQ(counts[TST1_TYPE], uint32_t(NUM_TST1));
+    EXPECT_EQ(counts[TST2_TYPE], num_tst2);
+    EXPECT_EQ(counts[NOTM_TYPE], num_notm);
+
+    uint8_t type;
+    EXPECT_TRUE(reader.find_type("TST2", type));
+    EXPECT_EQ(type, TST2_TYPE);
+    EXPECT_TRUE(reader.find_type("FMT", type));
+    EXPECT_EQ(type, LOG_FORMAT_MSG);
+    EXPECT_FALSE(reader.find_type("XXXX", type));
+    ASSERT_NE(reader.format(TST1_TYPE), nullptr);
+    EXPECT_EQ(reader.format(TST1_TYPE)->length, sizeof(log_TST1));
+    EXPECT_EQ(reader.format(1), nullptr);
+}
+
+TEST(AP_Logger_IndexedReader, copy_on_write)
+{
+    TestLog log;
+    log.write_formats();
+    log.write_messages();
+    log.close();
+
+    AP_Logger_IndexedReader reader;
+    ASSERT_TRUE(reader.open(log.path));
+    uint32_t offset = 0;
+    AP_Logger_IndexedReader::Message msg;
+    ASSERT_TRUE(reader.next(offset, msg));
+    EXPECT_EQ(reader.writable(msg), nullptr);
+
+    // messages may be changed in place without the file changing
+    ASSERT_TRUE(reader.open(log.path, true));
+    offset = 0;
+    while (reader.next(offset, msg)) {
+        uint8_t *data = reader.writable(msg);
+        ASSERT_EQ(data, msg.data);
+        if (msg.type == TST1_TYPE) {
+            data[msg.length-1] ^= 0xFF;
+        }
+    }
+
+    AP_Logger_IndexedReader reader2;
+    ASSERT_TRUE(reader2.open(log.path));
+    offset = 0;
+    uint32_t n = 0;
+    while (reader2.next(offset, msg)) {
+        if (msg.type == TST1_TYPE) {
+            struct log_TST1 tst1;
+            memcpy(&tst1, msg.data, sizeof(tst1));
+            EXPECT_EQ(tst1.value, n);
+            n++;
+        }
+    }
+    EXPECT_EQ(n, uint32_t(NUM_TST1));
+}
+
+TEST(AP_Logger_IndexedReader, resync)
+{
+    TestLog log;
+    log.write_formats();
+    // garbage, a false header and a message with an unknown type
+    const uint8_t junk[] { 1, 2, HEAD_BYTE1, 3, HEAD_BYTE1, HEAD_BYTE2, 99, 4, 5 };
+    log.write(junk, sizeof(junk));
+    const struct log_TST1 tst1 { LOG_PACKET_HEADER_INIT(TST1_TYPE), 5, 7 };
+    log.write(&tst1, sizeof(tst1));
+    log.write(junk, sizeof(junk));
+    log.write(&tst1, sizeof(tst1));
+    // truncated message at the end
+    log.write(&tst1, sizeof(tst1)-1);
+    log.close();
+
+    AP_Logger_IndexedReader reader;
+    ASSERT_TRUE(reader.open(log.path));
+    reader.set_resync(true);
+    ASSERT_TRUE(reader.index(false));
+    EXPECT_EQ(reader.num_messages(), num_fmt + 2);
+    EXPECT_EQ(reader.skipped(), 2*sizeof(junk));
+    ASSERT_EQ(reader.count(TST1_TYPE), 2U);
+    AP_Logger_IndexedReader::Message msg;
+    for (uint8_t i=0; i<2; i++) {
+        ASSERT_TRUE(reader.message(reader.offsets(TST1_TYPE)[i], msg));
+        EXPECT_EQ(memcmp(msg.data, &tst1, sizeof(tst1)), 0);
+    }
+    EXPECT_FALSE(reader.message(reader.offsets(TST1_TYPE)[0]+1, msg));
+}
+
+// without resync reading stops at the first bytes which are not a message
+TEST(AP_Logger_IndexedReader, stop)
+{
+    TestLog log;
+    log.write_formats();
+    const struct log_TST1 tst1 { LOG_PACKET_HEADER_INIT(TST1_TYPE), 5, 7 };
+    log.write(&tst1, sizeof(tst1));
+    const uint8_t unknown[] { HEAD_BYTE1, HEAD_BYTE2, 99, 4, 5 };
+    log.write(unknown, sizeof(unknown));
+    log.write(&tst1, sizeof(tst1));
+    const uint8_t junk[] { 1, 2 };
+    log.write(junk, sizeof(junk));
+    log.write(&tst1, sizeof(tst1));
+    log.close();
+
+    AP_Logger_IndexedReader reader;
+    ASSERT_TRUE(reader.open(log.path));
+    const uint32_t unknown_offset = num_fmt*sizeof(log_Format) + sizeof(tst1);
+    uint32_t offset = 0;
+    uint32_t num_messages = 0;
+    AP_Logger_IndexedReader::Message msg;
+    while (reader.next(offset, msg)) {
+        num_messages++;
+    }
+    EXPECT_EQ(num_messages, num_fmt + 1);
+    EXPECT_EQ(reader.stopped(), AP_Logger_IndexedReader::Stop::NO_FORMAT);
+    EXPECT_EQ(offset, unknown_offset);
+    EXPECT_EQ(msg.offset, unknown_offset);
+    EXPECT_EQ(msg.type, 99);
+    EXPECT_EQ(reader.skipped(), 0U);
+
+    // a known message after the unknown one is read, then the junk stops it
+    offset += sizeof(unknown);
+    ASSERT_TRUE(reader.next(offset, msg));
+    EXPECT_EQ(msg.type, TST1_TYPE);
+    EXPECT_FALSE(reader.next(offset, msg));
+    EXPECT_EQ(reader.stopped(), AP_Logger_IndexedReader::Stop::BAD_HEADER);
+    EXPECT_EQ(offset, unknown_offset + sizeof(unknown) + sizeof(tst1));
+
+    // the index ends where reading stops
+    ASSERT_TRUE(reader.index(false));
+    EXPECT_EQ(reader.num_messages(), num_fmt + 1);
+
+    // a sidecar index built with resync is not used without it
+    AP_Logger_IndexedReader resync_reader;
+    ASSERT_TRUE(resync_reader.open(log.path));
+    resync_reader.set_resync(true);
+    ASSERT_TRUE(resync_reader.index());
+    EXPECT_FALSE(resync_reader.index_loaded());
+    EXPECT_EQ(resync_reader.num_messages(), num_fmt + 3);
+    EXPECT_EQ(resync_reader.skipped(), sizeof(unknown) + sizeof(junk));
+    AP_Logger_IndexedReader reader2;
+    ASSERT_TRUE(reader2.open(log.path));
+    ASSERT_TRUE(reader2.index());
+    EXPECT_FALSE(reader2.index_loaded());
+    EXPECT_EQ(reader2.num_messages(), num_fmt + 1);
+    offset = 0;
+    EXPECT_TRUE(reader2.next(offset, msg));
+    EXPECT_EQ(reader2.stopped(), AP_Logger_IndexedReader::Stop::END_OF_LOG);
+}
+
+TEST(AP_Logger_IndexedReader, index)
+{
+    TestLog log;
+    log.write_formats();
+    log.write_messages();
+    log.close();
+
+    AP_Logger_IndexedReader reader;
+    ASSERT_TRUE(reader.open(log.path));
+    EXPECT_FALSE(reader.is_indexed());
+    EXPECT_EQ(reader.count(TST1_TYPE), 0U);
+    ASSERT_TRUE(reader.index());
+    EXPECT_TRUE(reader.is_indexed());
+    EXPECT_FALSE(reader.index_loaded());
+
+    EXPECT_EQ(reader.num_messages(), num_fmt + NUM_TST1 + num_tst2 + num_notm);
+    EXPECT_EQ(reader.count(LOG_FORMAT_MSG), num_fmt);
+    ASSERT_EQ(reader.count(TST1_TYPE), uint32_t(NUM_TST1));
+    ASSERT_EQ(reader.count(TST2_TYPE), num_tst2);
+    EXPECT_EQ(reader.count(NOTM_TYPE), num_notm);
+    EXPECT_EQ(reader.count(1), 0U);
+
+    // every TST1 is in the index in order
+    AP_Logger_IndexedReader::Message msg;
+    const uint32_t *offsets = reader.offsets(TST1_TYPE);
+    for (uint32_t i=0; i<NUM_TST1; i++) {
+        ASSERT_TRUE(reader.message(offsets[i], msg));
+        ASSERT_EQ(msg.type, TST1_TYPE);
+        const struct log_TST1 *tst1 = (const struct log_TST1 *)msg.data;
+        ASSERT_EQ(tst1->value, i);
+        uint64_t t;
+        ASSERT_TRUE(reader.message_time(msg, t));
+        ASSERT_EQ(t, 1000000 + i*1000ULL);
+    }
+    ASSERT_TRUE(reader.message(reader.offsets(NOTM_TYPE)[0], msg));
+    uint64_t t;
+    EXPECT_FALSE(reader.message_time(msg, t));
+
+    // a second reader loads the sidecar index
+    AP_Logger_IndexedReader reader2;
+    ASSERT_TRUE(reader2.open(log.path));
+    ASSERT_TRUE(reader2.index());
+    EXPECT_TRUE(reader2.index_loaded());
+    EXPECT_EQ(reader2.num_messages(), reader.num_messages());
+    for (uint16_t type=0; type<256; type++) {
+        ASSERT_EQ(reader2.count(type), reader.count(type));
+        ASSERT_EQ(memcmp(reader2.offsets(type), reader.offsets(type), reader.count(type)*sizeof(uint32_t)), 0);
+    }
+    ASSERT_NE(reader2.format(TST2_TYPE), nullptr);
+    EXPECT_EQ(reader2.format(TST2_TYPE)->length, sizeof(log_TST2));
+
+    // a damaged sidecar is replaced
+    reader2.close();
+    char idx_path[sizeof(log.path)+4];
+    snprintf(idx_path, sizeof(idx_path), "%s.idx", log.path);
+    ASSERT_EQ(truncate(idx_path, 2000), 0);
+    ASSERT_TRUE(reader2.open(log.path));
+    ASSERT_TRUE(reader2.index());
+    EXPECT_FALSE(reader2.index_loaded());
+    EXPECT_EQ(reader2.num_messages(), reader.num_messages());
+
+    // the sidecar is not used once the log changes
+    reader.close();
+    reader2.close();
+    log.f = fopen(log.path, "a");
+    const struct log_NOTM notm { LOG_PACKET_HEADER_INIT(NOTM_TYPE), 0 };
+    log.write(&notm, sizeof(notm));
+    log.close();
+    ASSERT_TRUE(reader.open(log.path));
+    ASSERT_TRUE(reader.index());
+    EXPECT_FALSE(reader.index_loaded());
+    EXPECT_EQ(reader.count(NOTM_TYPE), num_notm + 1);
+}
+
+TEST(AP_Logger_IndexedReader, seek)
+{
+    TestLog log;
+    log.write_formats();
+    log.write_messages();
+    log.close();
+
+    AP_Logger_IndexedReader reader;
+    ASSERT_TRUE(reader.open(log.path));
+    uint32_t offset;
+    EXPECT_FALSE(reader.seek_time(0, offset));
+    ASSERT_TRUE(reader.index(false));
+
+    AP_Logger_IndexedReader::Message msg;
+    const uint64_t times[] { 0, 1000000, 1000001, 1500000, 1000000 + (NUM_TST1-1)*1000ULL };
+    for (const uint64_t t : times) {
+        ASSERT_TRUE(reader.seek_time(t, offset));
+        ASSERT_TRUE(reader.message(offset, msg));
+        uint64_t msg_time;
+        ASSERT_TRUE(reader.message_time(msg, msg_time));
+        // the first message at or after t is always a TST1
+        EXPECT_EQ(msg.type, TST1_TYPE);
+        EXPECT_EQ(msg_time, MAX(t + 999 - (t + 999) % 1000, 1000000ULL));
+    }
+    EXPECT_FALSE(reader.seek_time(1000000 + NUM_TST1*1000ULL, offset));
+
+    // TST2 are logged every 4ms
+    uint32_t first, last;
+    ASSERT_TRUE(reader.time_range(TST2_TYPE, 1100000, 1200000, first, last));
+    EXPECT_EQ(first, 25U);
+    EXPECT_EQ(last, 50U);
+    ASSERT_TRUE(reader.time_range(TST2_TYPE, 0, UINT64_MAX, first, last));
+    EXPECT_EQ(first, 0U);
+    EXPECT_EQ(last, num_tst2);
+    ASSERT_TRUE(reader.time_range(TST2_TYPE, 1200000, 1100000, first, last));
+    EXPECT_EQ(first, last);
+    EXPECT_FALSE(reader.time_range(NOTM_TYPE, 0, UINT64_MAX, first, last));
+}
+
+#endif  // AP_LOGGER_INDEXED_READER_ENABLED
+
+AP_GTEST_MAIN()
@@ -0,0 +1,127 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  compare Polygon_outside and Polygon_intersects against PreparedPolygon
+  for a fence shaped polygon whose number of points is the benchmark
+  argument. Points and lines are spread over the polygon's bounding box
+ */
+
+#define BENCH_POLYGON_POINTS_MAX    1024
+#define BENCH_QUERIES               64
+
+struct bench_polygon {
+    Vector2f points[BENCH_POLYGON_POINTS_MAX];
+    uint16_t num_points;
+    Vector2f starts[BENCH_QUERIES];
+    Vector2f ends[BENCH_QUERIES];
+};
+
+static bench_polygon *create_polygon(uint16_t num_points)
+{
+    bench_polygon *poly = NEW_NOTHROW bench_polygon;
+    if (poly == nullptr) {
+        AP_HAL::panic("out of memory");
+    }
+    poly->num_points = MIN(num_points, BENCH_POLYGON_POINTS_MAX);
+
+    // irregular outline around a 1km circle
+    for (uint16_t i = 0; i < poly->num_points; i++) {
+        const float angle = M_2PI * i / poly->num_points;
+        const float radius = 100000.0f + 20000.0f * sinf(angle * 7) + ((i % 3) * 5000.0f);
+        poly->points[i] = Vector2f{cosf(angle), sinf(angle)} * radius;
+    }
+
+    // 100m lines starting throughout the bounding box
+    for (uint8_t i = 0; i < BENCH_QUERIES; i++) {
+        const float angle = radians(i * 37.0f);
+        poly->starts[i] = Vector2f{((i % 8) - 3.5f) * 30000.0f, ((i / 8) - 3.5f) * 30000.0f};
+        poly->ends[i] = poly->starts[i] + Vector2f{cosf(angle), sinf(angle)} * 10000.0f;
+    }
+    return poly;
+}
+
+static void BM_PolygonOutside(benchmark::State& state)
+{
+    bench_polygon *poly = create_polygon(state.range(0));
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < BENCH_QUERIES; i++) {
+            bool outside = Polygon_outside(poly->starts[i], poly->points, poly->num_points);
+            gbenchmark_escape(&outside);
+        }
+    }
+    delete poly;
+}
+
+static void BM_PreparedPolygonOutside(benchmark::State& state)
+{
+    bench_polygon *poly = create_polygon(state.range(0));
+    PreparedPolygon prepared;
+    if (!prepared.prepare(poly->points, poly->num_points)) {
+        AP_HAL::panic("out of memory");
+    }
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < BENCH_QUERIES; i++) {
+            bool outside = prepared.outside(poly->starts[i]);
+            gbenchmark_escape(&outside);
+        }
+    }
+    delete poly;
+}
+
+static void BM_PolygonIntersects(benchmark::State& state)
+{
+    bench_polygon *poly = create_polygon(state.range(0));
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < BENCH_QUERIES; i++) {
+            Vector2f intersection;
+            bool intersects = Polygon_intersects(poly->points, poly->num_points, poly->starts[i], poly->ends[i], intersection);
+            gbenchmark_escape(&intersects);
+        }
+    }
+    delete poly;
+}
+
+static void BM_PreparedPolygonIntersects(benchmark::State& state)
+{
+    bench_polygon *poly = create_polygon(state.range(0));
+    PreparedPolygon prepared;
+    if (!prepared.prepare(poly->points, poly->num_points)) {
+        AP_HAL::panic("out of memory");
+    }
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < BENCH_QUERIES; i++) {
+            Vector2f intersection;
+            bool intersects = prepared.intersects(poly->starts[i], poly->ends[i], intersection);
+            gbenchmark_escape(&intersects);
+        }
+    }
+    delete poly;
+}
+
+static void BM_PreparedPolygonPrepare(benchmark::State& state)
+{
+    bench_polygon *poly = create_polygon(state.range(0));
+    PreparedPolygon prepared;
+
+    while (state.KeepRunning()) {
+        bool ok = prepared.prepare(poly->points, poly->num_points);
+        gbenchmark_escape(&ok);
+    }
+    delete poly;
+}
+
+BENCHMARK(BM_PolygonOutside)->Arg(16)->Arg(128)->Arg(512)->Arg(1024);
+BENCHMARK(BM_PreparedPolygonOutside)->Arg(16)->Arg(128)->Arg(512)->Arg(1024);
+BENCHMARK(BM_PolygonIntersects)->Arg(16)->Arg(128)->Arg(512)->Arg(1024);
+BENCHMARK(BM_PreparedPolygonIntersects)->Arg(16)->Arg(128)->Arg(512)->Arg(1024);
+BENCHMARK(BM_PreparedPolygonPrepare)->Arg(16)->Arg(128)->Arg(512)->Arg(1024);
+
+BENCHMARK_MAIN();
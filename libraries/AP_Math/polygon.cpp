@@ -18,6 +18,7 @@
 
 #include "AP_Math.h"
 #include "float.h"
+#include <string.h>
 
 #pragma GCC optimize("O2")
 
@@ -27,6 +28,63 @@
  */
 
 
+/*
+ *  Polygon_crosses(): test if the edge from Vi to Vj crosses a ray from P,
+ *  an odd number of crossings means P is inside the polygon
+ */
+template <typename T>
+static bool Polygon_crosses(const Vector2<T> &P, const Vector2<T> &Vi, const Vector2<T> &Vj)
+{
+    if ((Vi.y > P.y) == (Vj.y > P.y)) {
+        return false;
+    }
+    const T dx1 = P.x - Vi.x;
+    const T dx2 = Vj.x - Vi.x;
+    const T dy1 = P.y - Vi.y;
+    const T dy2 = Vj.y - Vi.y;
+    const int8_t dx1s = (dx1 < 0) ? -1 : 1;
+    const int8_t dx2s = (dx2 < 0) ? -1 : 1;
+    const int8_t dy1s = (dy1 < 0) ? -1 : 1;
+    const int8_t dy2s = (dy2 < 0) ? -1 : 1;
+    const int8_t m1 = dx1s * dy2s;
+    const int8_t m2 = dx2s * dy1s;
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 > m2) {
+            return true;
+        } else if (m1 < m2) {
+            return false;
+        } else {
+            if (std::is_floating_point<T>::value) {
+                if ( dx1 * dy2 > dx2 * dy1 ) {
+                    return true;
+                }
+            } else {
+                if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
+                    return true;
+                }
+            }
+        }
+    } else {
+        if (m1 < m2) {
+            return true;
+        } else if (m1 > m2) {
+            return false;
+        } else {
+            if (std::is_floating_point<T>::value) {
+                if ( dx1 * dy2 < dx2 * dy1 ) {
+                    return true;
+                }
+            } else {
+                if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
 /*
  *  Polygon_outside(): test for a point in a polygon
  *     Input:   P = a point,
@@ -55,52 +113,8 @@ bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
         if (j >= n) {
             j = 0;
         }
-        if ((V[i].y > P.y) == (V[j].y > P.y)) {
-            continue;
-        }
-        const T dx1 = P.x - V[i].x;
-        const T dx2 = V[j].x - V[i].x;
-        const T dy1 = P.y - V[i].y;
-        const T dy2 = V[j].y - V[i].y;
-        const int8_t dx1s = (dx1 < 0) ? -1 : 1;
-        const int8_t dx2s = (dx2 < 0) ? -1 : 1;
-        const int8_t dy1s = (dy1 < 0) ? -1 : 1;
-        const int8_t dy2s = (dy2 < 0) ? -1 : 1;
-        const int8_t m1 = dx1s * dy2s;
-        const int8_t m2 = dx2s * dy1s;
-        // we avoid the 64 bit multiplies if we can based on sign checks.
-        if (dy2 < 0) {
-            if (m1 > m2) {
-                outside = !outside;
-            } else if (m1 < m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 > dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
-        } else {
-            if (m1 < m2) {
-                outside = !outside;
-            } else if (m1 > m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 < dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
+        if (Polygon_crosses(P, V[i], V[j])) {
+            outside = !outside;
         }
     }
     return outside;
@@ -125,6 +139,36 @@ template bool Polygon_complete<int32_t>(const Vector2l *V, unsigned n);
 template bool Polygon_outside<float>(const Vector2f &P, const Vector2f *V, unsigned n);
 template bool Polygon_complete<float>(const Vector2f *V, unsigned n);
 
+/*
+  check if the edge from v1 to v2 is intersected by a line from point
+  p1 to point p2, updating intersection if it is closer to p1 than
+  intersect_dist_sq
+ */
+static void Polygon_edge_intersection(const Vector2f &v1, const Vector2f &v2, const Vector2f &p1, const Vector2f &p2, float &intersect_dist_sq, Vector2f &intersection)
+{
+    // optimisations for common cases
+    if (v1.x > p1.x && v2.x > p1.x && v1.x > p2.x && v2.x > p2.x) {
+        return;
+    }
+    if (v1.y > p1.y && v2.y > p1.y && v1.y > p2.y && v2.y > p2.y) {
+        return;
+    }
+    if (v1.x < p1.x && v2.x < p1.x && v1.x < p2.x && v2.x < p2.x) {
+        return;
+    }
+    if (v1.y < p1.y && v2.y < p1.y && v1.y < p2.y && v2.y < p2.y) {
+        return;
+    }
+    Vector2f intersect_tmp;
+    if (Vector2f::segment_intersection(v1,v2,p1,p2,intersect_tmp)) {
+        float dist_sq = sq(intersect_tmp.x - p1.x) + sq(intersect_tmp.y - p1.y);
+        if (dist_sq < intersect_dist_sq) {
+            intersect_dist_sq = dist_sq;
+            intersection = intersect_tmp;
+        }
+    }
+}
+
 /*
   determine if the polygon of N verticies defined by points V is
   intersected by a line from point p1 to point p2
@@ -140,34 +184,12 @@ bool Polygon_intersects(const Vector2f *V, unsigned N, const Vector2f &p1, const
     }
 
     float intersect_dist_sq = FLT_MAX;
-    for (uint8_t i=0; i<N; i++) {
-        uint8_t j = i+1;
+    for (unsigned i=0; i<N; i++) {
+        unsigned j = i+1;
         if (j >= N) {
             j = 0;
         }
-        const Vector2f &v1 = V[i];
-        const Vector2f &v2 = V[j];
-        // optimisations for common cases
-        if (v1.x > p1.x && v2.x > p1.x && v1.x > p2.x && v2.x > p2.x) {
-            continue;
-        }
-        if (v1.y > p1.y && v2.y > p1.y && v1.y > p2.y && v2.y > p2.y) {
-            continue;
-        }
-        if (v1.x < p1.x && v2.x < p1.x && v1.x < p2.x && v2.x < p2.x) {
-            continue;
-        }
-        if (v1.y < p1.y && v2.y < p1.y && v1.y < p2.y && v2.y < p2.y) {
-            continue;
-        }
-        Vector2f intersect_tmp;
-        if (Vector2f::segment_intersection(v1,v2,p1,p2,intersect_tmp)) {
-            float dist_sq = sq(intersect_tmp.x - p1.x) + sq(intersect_tmp.y - p1.y);
-            if (dist_sq < intersect_dist_sq) {
-                intersect_dist_sq = dist_sq;
-                intersection = intersect_tmp;
-            }
-        }
+        Polygon_edge_intersection(V[i], V[j], p1, p2, intersect_dist_sq, intersection);
     }
     return (intersect_dist_sq < FLT_MAX);
 }
@@ -184,7 +206,7 @@ float Polygon_closest_distance_line(const Vector2f *V, unsigned N, const Vector2
         return -sqrtf(sq(intersection.x - p2.x) + sq(intersection.y - p2.y));
     }
     float closest_sq = FLT_MAX;
-    for (uint8_t i=0; i<N-1; i++) {
+    for (unsigned i=0; i+1<N; i++) {
         const Vector2f &v1 = V[i];
         const Vector2f &v2 = V[i+1];
 
@@ -212,7 +234,7 @@ bool Polygon_closest_distance_point(const Vector2f *V, unsigned N, const Vector2
     if (N < 3) {    // not a polygon
         return false;
     }
-    for (uint8_t i=0; i<N; i++) {
+    for (unsigned i=0; i<N; i++) {
         const Vector2f &v1 = V[i];
         const Vector2f &v2 = V[(i+1) % N];
 
@@ -228,3 +250,200 @@ bool Polygon_closest_distance_point(const Vector2f *V, unsigned N, const Vector2
     closest = sqrtf(closest_sq);
     return true;
 }
+
+#define PREPARED_POLYGON_BANDS_MAX              256 // maximum number of bands along each axis
+#define PREPARED_POLYGON_BAND_ENTRIES_PER_EDGE  4   // bands are merged until edges are held in this many bands on average
+
+PreparedPolygon::~PreparedPolygon()
+{
+    clear();
+}
+
+// release index and forget the polygon
+void PreparedPolygon::clear()
+{
+    clear_bands(_x);
+    clear_bands(_y);
+    _points = nullptr;
+    _num_points = 0;
+    _num_edges = 0;
+}
+
+// release a band index
+void PreparedPolygon::clear_bands(Bands &bands)
+{
+    delete[] bands.start;
+    delete[] bands.edges;
+    bands.start = nullptr;
+    bands.edges = nullptr;
+    bands.count = 0;
+}
+
+// band holding position along band's axis
+uint16_t PreparedPolygon::band(const Bands &bands, float pos)
+{
+    const float b = (pos - bands.min) * bands.scale;
+    if (!(b > 0)) {
+        return 0;
+    }
+    if (b >= bands.count) {
+        return bands.count - 1;
+    }
+    return uint16_t(b);
+}
+
+// build bands along x or y axis, returns false on allocation failure
+bool PreparedPolygon::build_bands(Bands &bands, bool axis_y)
+{
+    const float min = axis_y ? _min.y : _min.x;
+    const float range = axis_y ? (_max.y - _min.y) : (_max.x - _min.x);
+
+    // start with about one band per edge and use fewer bands if long
+    // edges would be held in too many of them
+    uint16_t count = MIN(_num_edges, PREPARED_POLYGON_BANDS_MAX);
+    uint32_t total;
+    while (true) {
+        bands.min = min;
+        bands.count = count;
+        bands.scale = is_positive(range) ? count / range : 0;
+        total = 0;
+        for (uint16_t i = 0; i < _num_edges; i++) {
+            const float a = axis_y ? _points[i].y : _points[i].x;
+            const float b = axis_y ? _points[edge_end(i)].y : _points[edge_end(i)].x;
+            total += band(bands, MAX(a, b)) - band(bands, MIN(a, b)) + 1;
+        }
+        if ((count == 1) || ((total <= uint32_t(_num_edges) * PREPARED_POLYGON_BAND_ENTRIES_PER_EDGE) && (total <= UINT16_MAX))) {
+            break;
+        }
+        count /= 2;
+    }
+
+    bands.start = NEW_NOTHROW uint16_t[count + 1];
+    bands.edges = NEW_NOTHROW uint16_t[total];
+    if ((bands.start == nullptr) || (bands.edges == nullptr)) {
+        clear_bands(bands);
+        return false;
+    }
+
+    // count edges in each band, then convert counts to the index of the
+    // band's first entry and fill in the edges
+    memset(bands.start, 0, (count + 1) * sizeof(bands.start[0]));
+    for (uint16_t i = 0; i < _num_edges; i++) {
+        const float a = axis_y ? _points[i].y : _points[i].x;
+        const float b = axis_y ? _points[edge_end(i)].y : _points[edge_end(i)].x;
+        for (uint16_t k = band(bands, MIN(a, b)); k <= band(bands, MAX(a, b)); k++) {
+            bands.start[k + 1]++;
+        }
+    }
+    for (uint16_t k = 0; k < count; k++) {
+        bands.start[k + 1] += bands.start[k];
+    }
+    for (uint16_t i = 0; i < _num_edges; i++) {
+        const float a = axis_y ? _points[i].y : _points[i].x;
+        const float b = axis_y ? _points[edge_end(i)].y : _points[edge_end(i)].x;
+        for (uint16_t k = band(bands, MIN(a, b)); k <= band(bands, MAX(a, b)); k++) {
+            bands.edges[bands.start[k]++] = i;
+        }
+    }
+    // filling in moved each band's start to the next band's start
+    for (uint16_t k = count; k > 0; k--) {
+        bands.start[k] = bands.start[k - 1];
+    }
+    bands.start[0] = 0;
+    return true;
+}
+
+// prepare polygon V of N points
+// returns false on failure to allocate the index in which case every edge is checked
+bool PreparedPolygon::prepare(const Vector2f *V, unsigned N)
+{
+    clear();
+    _points = V;
+    _num_points = N;
+
+    const unsigned num_edges = Polygon_complete(V, N) ? N - 1 : N;
+    if ((num_edges < 3) || (num_edges > UINT16_MAX)) {
+        return false;
+    }
+    _num_edges = num_edges;
+
+    _min = _max = V[0];
+    for (uint16_t i = 1; i < _num_edges; i++) {
+        _min.x = MIN(_min.x, V[i].x);
+        _min.y = MIN(_min.y, V[i].y);
+        _max.x = MAX(_max.x, V[i].x);
+        _max.y = MAX(_max.y, V[i].y);
+    }
+
+    if (!build_bands(_x, false) || !build_bands(_y, true)) {
+        clear_bands(_x);
+        clear_bands(_y);
+        return false;
+    }
+    return true;
+}
+
+// returns true if point P is outside the polygon
+bool PreparedPolygon::outside(const Vector2f &P) const
+{
+    if (_y.start == nullptr) {
+        return Polygon_outside(P, _points, _num_points);
+    }
+
+    // no edge can cross a ray from a point above or below the polygon
+    if ((P.y < _min.y) || (P.y >= _max.y)) {
+        return true;
+    }
+
+    // only edges in the point's band can cross a ray from the point
+    const uint16_t b = band(_y, P.y);
+    bool outside = true;
+    for (uint16_t k = _y.start[b]; k < _y.start[b + 1]; k++) {
+        const uint16_t edge = _y.edges[k];
+        if (Polygon_crosses(P, _points[edge], _points[edge_end(edge)])) {
+            outside = !outside;
+        }
+    }
+    return outside;
+}
+
+// returns true if the polygon is intersected by a line from point p1 to point p2
+// intersection argument returns the intersection closest to p1
+bool PreparedPolygon::intersects(const Vector2f &p1, const Vector2f &p2, Vector2f &intersection) const
+{
+    if ((_x.start == nullptr) || (_y.start == nullptr)) {
+        return Polygon_intersects(_points, _num_points, p1, p2, intersection);
+    }
+
+    const Vector2f seg_min {MIN(p1.x, p2.x), MIN(p1.y, p2.y)};
+    const Vector2f seg_max {MAX(p1.x, p2.x), MAX(p1.y, p2.y)};
+    if ((seg_max.x < _min.x) || (seg_max.y < _min.y) || (seg_min.x > _max.x) || (seg_min.y > _max.y)) {
+        return false;
+    }
+
+    // check the bands along whichever axis the line covers the smallest part of
+    const uint16_t x_lo = band(_x, seg_min.x);
+    const uint16_t x_hi = band(_x, seg_max.x);
+    const uint16_t y_lo = band(_y, seg_min.y);
+    const uint16_t y_hi = band(_y, seg_max.y);
+    const bool axis_y = (uint32_t(y_hi - y_lo + 1) * _x.count) < (uint32_t(x_hi - x_lo + 1) * _y.count);
+    const Bands &bands = axis_y ? _y : _x;
+    const uint16_t lo = axis_y ? y_lo : x_lo;
+    const uint16_t hi = axis_y ? y_hi : x_hi;
+
+    float intersect_dist_sq = FLT_MAX;
+    for (uint16_t b = lo; b <= hi; b++) {
+        for (uint16_t k = bands.start[b]; k < bands.start[b + 1]; k++) {
+            const uint16_t edge = bands.edges[k];
+            const Vector2f &v1 = _points[edge];
+            const Vector2f &v2 = _points[edge_end(edge)];
+            // edges in several bands are only checked in the first band searched
+            const uint16_t edge_lo = band(bands, axis_y ? MIN(v1.y, v2.y) : MIN(v1.x, v2.x));
+            if (MAX(edge_lo, lo) != b) {
+                continue;
+            }
+            Polygon_edge_intersection(v1, v2, p1, p2, intersect_dist_sq, intersection);
+        }
+    }
+    return (intersect_dist_sq < FLT_MAX);
+}
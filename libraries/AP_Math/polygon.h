@@ -44,4 +44,64 @@ float Polygon_closest_distance_line(const Vector2f *V, unsigned N, const Vector2
   closed polygon V, defined by N points of cartesian. Returns true if successful, false otherwise
  */
  bool Polygon_closest_distance_point(const Vector2f *V, unsigned N, const Vector2f &p, float& closest);
- 
\ No newline at end of file
+ 
+/*
+  polygon prepared for repeated point in polygon and line intersection
+  checks. Edges are indexed by the vertical and horizontal bands of the
+  polygon's bounding box that they cross so each check only tests the
+  edges in the bands covering the point or line. Results are the same as
+  Polygon_outside and Polygon_intersects
+ */
+class PreparedPolygon {
+public:
+    PreparedPolygon() {}
+    ~PreparedPolygon();
+
+    CLASS_NO_COPY(PreparedPolygon);  /* Do not allow copies */
+
+    // prepare polygon V of N points. Points are not copied so must remain valid until
+    // prepare or clear is called again
+    // returns false on failure to allocate the index in which case every edge is checked
+    bool prepare(const Vector2f *V, unsigned N);
+
+    // release index and forget the polygon
+    void clear();
+
+    // returns true if point P is outside the polygon
+    bool outside(const Vector2f &P) const WARN_IF_UNUSED;
+
+    // returns true if the polygon is intersected by a line from point p1 to point p2
+    // intersection argument returns the intersection closest to p1
+    bool intersects(const Vector2f &p1, const Vector2f &p2, Vector2f &intersection) const WARN_IF_UNUSED;
+
+private:
+
+    // edges crossing equally sized bands along one axis
+    struct Bands {
+        float min;                  // start of first band
+        float scale;                // number of bands per unit length
+        uint16_t count;             // number of bands
+        uint16_t *start = nullptr;  // index into edges of each band's first entry, count+1 entries
+        uint16_t *edges = nullptr;  // index of the first point of each edge in each band
+    };
+
+    // build bands along x or y axis, returns false on allocation failure
+    bool build_bands(Bands &bands, bool axis_y);
+
+    // release a band index
+    static void clear_bands(Bands &bands);
+
+    // band holding position along band's axis
+    static uint16_t band(const Bands &bands, float pos);
+
+    // index of the last point of an edge
+    uint16_t edge_end(uint16_t edge) const { return (edge + 1 < _num_edges) ? edge + 1 : 0; }
+
+    const Vector2f *_points = nullptr;  // polygon points
+    unsigned _num_points = 0;           // number of points
+    uint16_t _num_edges;        // number of edges, one less than the number of points if the polygon is complete
+    Vector2f _min;              // bounding box of polygon
+    Vector2f _max;
+    Bands _x;                   // edges indexed by position along x axis
+    Bands _y;                   // edges indexed by position along y axis
+};
@@ -355,6 +355,91 @@ TEST(Polygon, simple)
     TEST_POLYGON_POINTS(SIMPLE_boundary, SIMPLE_test_points);
 }
 
+// polygon with more than 255 points shaped like a star so points and
+// lines cross it many times
+#define STAR_POINTS 400
+static void star_polygon(Vector2f *poly, uint16_t num_points)
+{
+    for (uint16_t i = 0; i < num_points; i++) {
+        const float angle = M_2PI * i / num_points;
+        const float radius = (i % 2) ? 100.0f : 60.0f + (i % 7);
+        poly[i] = Vector2f{cosf(angle), sinf(angle)} * radius;
+    }
+}
+
+static uint32_t test_rand_state = 1;
+static float test_rand(float min, float max)
+{
+    test_rand_state = test_rand_state * 1664525U + 1013904223U;
+    return min + (max - min) * ((test_rand_state >> 8) / float(1U << 24));
+}
+
+TEST(Polygon, intersects_many_points)
+{
+    Vector2f poly[STAR_POINTS];
+    star_polygon(poly, STAR_POINTS);
+    Vector2f intersection;
+    EXPECT_TRUE(Polygon_intersects(poly, STAR_POINTS, Vector2f{0,0}, Vector2f{200,1}, intersection));
+    EXPECT_GT(intersection.length(), 59.0f);
+    EXPECT_LT(intersection.length(), 101.0f);
+    EXPECT_FALSE(Polygon_intersects(poly, STAR_POINTS, Vector2f{0,0}, Vector2f{10,10}, intersection));
+}
+
+TEST(Polygon, prepared_complex)
+{
+    const Vector2f poly[] = {
+        {0.0f,0.0f}, {0.0f,10.0f}, {5.0, 10.0f}, {5.0f,5.0f}, {3.0f,5.0f},
+        {3.0f,6.0f}, {4.0f,6.0f}, {4.0f,9.0f}, {4.0f,9.0f}, {1.0f,9.0f},
+        {1.0f,6.0f}, {2.0f,6.0f}, {2.0f,5.0f}, {1.0f,5.0f}, {1.0f,0.0f},
+    };
+    const Vector2f inside_points[] = {{0.1f, 0.1f}, {4.5f, 9.5f}, {0.5f, 9.5f}};
+    const Vector2f outside_points[] = {{3.0f, 8.0f}, {5.5f, 10.0f}, {2.0f, 2.0f}, {2.5f, 5.5f}, {1.5f, 6.5f}};
+
+    Vector2f closed_poly[ARRAY_SIZE(poly) + 1];
+    memcpy(closed_poly, poly, sizeof(poly));
+    const uint16_t n = ARRAY_SIZE(closed_poly);
+    closed_poly[n-1] = closed_poly[0];
+
+    PreparedPolygon prepared;
+    for (uint16_t num_points = n-1; num_points <= n; num_points++) {
+        EXPECT_TRUE(prepared.prepare(closed_poly, num_points));
+        for (const auto &point : inside_points) {
+            EXPECT_FALSE(prepared.outside(point));
+        }
+        for (const auto &point : outside_points) {
+            EXPECT_TRUE(prepared.outside(point));
+        }
+        Vector2f intersection;
+        EXPECT_TRUE(prepared.intersects(Vector2f{2.5f, 1.0f}, Vector2f{2.5f, 9.5f}, intersection));
+        EXPECT_FLOAT_EQ(intersection.y, 9.0f);
+        EXPECT_FALSE(prepared.intersects(Vector2f{0.5f, 1.0f}, Vector2f{0.5f, 9.5f}, intersection));
+    }
+}
+
+TEST(Polygon, prepared_matches_polygon)
+{
+    Vector2f poly[STAR_POINTS + 1];
+    star_polygon(poly, STAR_POINTS);
+    poly[STAR_POINTS] = poly[0];
+
+    PreparedPolygon prepared;
+    for (uint16_t num_points = STAR_POINTS; num_points <= STAR_POINTS + 1; num_points++) {
+        EXPECT_TRUE(prepared.prepare(poly, num_points));
+        for (uint16_t i = 0; i < 2000; i++) {
+            const Vector2f p1 {test_rand(-120, 120), test_rand(-120, 120)};
+            const Vector2f p2 = p1 + Vector2f{test_rand(-50, 50), test_rand(-50, 50)};
+            EXPECT_EQ(Polygon_outside(p1, poly, num_points), prepared.outside(p1));
+
+            Vector2f intersection, prepared_intersection;
+            const bool intersects = Polygon_intersects(poly, num_points, p1, p2, intersection);
+            EXPECT_EQ(intersects, prepared.intersects(p1, p2, prepared_intersection));
+            if (intersects) {
+                EXPECT_FLOAT_EQ((intersection - p1).length(), (prepared_intersection - p1).length());
+            }
+        }
+    }
+}
+
 AP_GTEST_MAIN()
 
 
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <AP_HAL/AP_HAL_Boards.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Math/vectorN.h>
 #include "AP_Nav_Common.h"
@@ -30,7 +31,15 @@
   we also save a lot of CPU (approx 10% on STM32F427) as the compiler
   is able to resolve the address of these variables at compile time,
   which means significantly faster code
+
+  On boards where the EKF3 cores may be run concurrently on worker
+  threads (see EK3_FEATURE_PARALLEL_CORES) the scratch space can't be
+  shared, so each core gets its own copy
  */
+#ifndef NAVEKF_SHARED_SCRATCH
+#define NAVEKF_SHARED_SCRATCH !(CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
 class NavEKF_core_common {
 public:
 #if MATH_CHECK_INDEXES
@@ -42,10 +51,17 @@ public:
 #endif
 
 protected:
+#if NAVEKF_SHARED_SCRATCH
     static Matrix24 KH;                   // intermediate result used for covariance updates
     static Matrix24 KHP;                  // intermediate result used for covariance updates
     static Matrix24 nextP;                // Predicted covariance matrix before addition of process noise to diagonals
     static Vector28 Kfusion;              // intermediate fusion vector
+#else
+    Matrix24 KH;                          // intermediate result used for covariance updates
+    Matrix24 KHP;                         // intermediate result used for covariance updates
+    Matrix24 nextP;                       // Predicted covariance matrix before addition of process noise to diagonals
+    Vector28 Kfusion;                     // intermediate fusion vector
+#endif
 
     // fill all the common scratch variables with NaN on SITL
     void fill_scratch_variables(void);
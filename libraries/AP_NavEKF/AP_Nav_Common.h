@@ -104,6 +104,7 @@ struct ekf_timing {
     float delAngDT_min;
     float delVelDT_max;
     float delVelDT_min;
+    uint32_t update_us_max;
 };
 
 #define N_MODELS_EKFGSF 5U
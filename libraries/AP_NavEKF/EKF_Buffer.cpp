@@ -195,6 +195,20 @@ void ekf_imu_buffer::reset()
     memset(buffer, 0, _size*uint32_t(elsize));
 }
 
+// copy the contents and indices of another buffer of the same size
+bool ekf_imu_buffer::copy_from(const ekf_imu_buffer &other)
+{
+    if (buffer == nullptr || other.buffer == nullptr ||
+        _size != other._size || elsize != other.elsize) {
+        return false;
+    }
+    memcpy(buffer, other.buffer, _size*uint32_t(elsize));
+    _youngest = other._youngest;
+    _oldest = other._oldest;
+    _filled = other._filled;
+    return true;
+}
+
 // retrieves data from the ring buffer at a specified index
 void *ekf_imu_buffer::get(uint8_t index) const
 {
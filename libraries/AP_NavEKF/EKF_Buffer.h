@@ -120,6 +120,10 @@ public:
     // zeroes all data in the ring buffer
     void reset();
 
+    // copy the contents and indices of another buffer of the same
+    // size, returns false if the sizes differ
+    bool copy_from(const ekf_imu_buffer &other);
+
     // retrieves data from the ring buffer at a specified index
     void *get(uint8_t index) const;
 
@@ -187,6 +191,11 @@ public:
         ekf_imu_buffer::reset();
     }
 
+    // copy the contents and indices of another buffer of the same size
+    bool copy_from(const EKF_IMU_buffer_t<element_type> &other) {
+        return ekf_imu_buffer::copy_from(other);
+    }
+
     // retrieves data from the ring buffer at a specified index
     element_type& operator[](uint32_t index) {
         element_type *ret = (element_type *)ekf_imu_buffer::get(index);
@@ -13,6 +13,8 @@
 
 #include <new>
 
+extern const AP_HAL::HAL& hal;
+
 /*
   parameter defaults for different types of vehicle. The
   APM_BUILD_DIRECTORY is taken from the main vehicle directory name
@@ -739,8 +741,8 @@ const AP_Param::GroupInfo NavEKF3::var_info2[] = {
 
     // @Param: OPTIONS
     // @DisplayName: Optional EKF behaviour
-    // @Description: EKF optional behaviour. Bit 0 (JammingExpected): Setting JammingExpected will change the EKF behaviour such that if dead reckoning navigation is possible it will require the preflight alignment GPS quality checks controlled by EK3_GPS_CHECK and EK3_CHECK_SCALE to pass before resuming GPS use if GPS lock is lost for more than 2 seconds to prevent bad position estimate. Bit 1 (Manual lane switching): DANGEROUS – If enabled, this disables automatic lane switching. If the active lane becomes unhealthy, no automatic switching will occur. Users must manually set EK3_PRIMARY to change lanes. No health checks will be performed on the selected lane. Use with extreme caution.
-    // @Bitmask: 0:JammingExpected, 1: ManualLaneSwitching
+    // @Description: EKF optional behaviour. Bit 0 (JammingExpected): Setting JammingExpected will change the EKF behaviour such that if dead reckoning navigation is possible it will require the preflight alignment GPS quality checks controlled by EK3_GPS_CHECK and EK3_CHECK_SCALE to pass before resuming GPS use if GPS lock is lost for more than 2 seconds to prevent bad position estimate. Bit 1 (Manual lane switching): DANGEROUS – If enabled, this disables automatic lane switching. If the active lane becomes unhealthy, no automatic switching will occur. Users must manually set EK3_PRIMARY to change lanes. No health checks will be performed on the selected lane. Use with extreme caution. Bit 2 (ParallelCores): On Linux boards with multiple CPUs, run each EKF core on its own thread so the cores are updated concurrently. Has no effect on other boards.
+    // @Bitmask: 0:JammingExpected, 1: ManualLaneSwitching, 2:ParallelCores
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  11, NavEKF3, _options, 0),
 
@@ -903,6 +905,103 @@ bool NavEKF3::coreBetterScore(uint8_t new_core, uint8_t current_core) const
     return coreRelativeErrors[new_core] < coreRelativeErrors[current_core];
 }
 
+#if EK3_FEATURE_PARALLEL_CORES
+/*
+  worker thread running the update of a single core. The main thread
+  starts an update with start() and waits for it with wait(). Status
+  text and takeoff expected from the core are held while it runs and
+  sent by wait(), so they only come from the main thread
+ */
+class NavEKF3_CoreWorker {
+public:
+    NavEKF3_CoreWorker(NavEKF3_core &_core) :
+        core(_core) {}
+
+    CLASS_NO_COPY(NavEKF3_CoreWorker);
+
+    bool init(uint8_t core_index) {
+        hal.util->snprintf(name, sizeof(name), "EK3C%u", (unsigned)core_index);
+        return hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&NavEKF3_CoreWorker::thread, void),
+                                            name, 16384, AP_HAL::Scheduler::PRIORITY_MAIN, 0);
+    }
+
+    void start(bool allow_state_prediction) {
+        predict = allow_state_prediction;
+        core.setDeferring(true);
+        start_sem.signal();
+    }
+
+    void wait(void) {
+        done_sem.wait_blocking();
+        core.setDeferring(false);
+        core.sendDeferred();
+    }
+
+private:
+    void thread(void) {
+        while (true) {
+            start_sem.wait_blocking();
+            core.UpdateFilter(predict);
+            done_sem.signal();
+        }
+    }
+
+    NavEKF3_core &core;
+    HAL_BinarySemaphore start_sem;
+    HAL_BinarySemaphore done_sem;
+    bool predict;
+    char name[8];
+};
+
+/*
+  return true if the cores should be run in parallel this frame. The
+  cores are run serially until the common origin has been set, as
+  the first core to set its origin claims it for all cores
+ */
+bool NavEKF3::parallel_cores_ready(void)
+{
+    if (!option_is_enabled(Option::ParallelCores) ||
+        num_cores < 2 ||
+        !common_origin_valid ||
+        coreWorkersFailed) {
+        return false;
+    }
+    // core 0 runs on the calling thread, the others each get a worker
+    for (uint8_t i=1; i<num_cores; i++) {
+        if (coreWorkers[i] != nullptr) {
+            continue;
+        }
+        coreWorkers[i] = NEW_NOTHROW NavEKF3_CoreWorker(core[i]);
+        if (coreWorkers[i] == nullptr || !coreWorkers[i]->init(i)) {
+            delete coreWorkers[i];
+            coreWorkers[i] = nullptr;
+            coreWorkersFailed = true;
+            GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "EKF3 parallel cores unavailable");
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  update all cores concurrently. All inputs come from the DAL frame
+  which was captured before the cores start, so the results are the
+  same as when the cores are run one after the other
+ */
+void NavEKF3::update_cores_parallel(const bool allow_state_prediction[])
+{
+    for (uint8_t i=1; i<num_cores; i++) {
+        coreWorkers[i]->start(allow_state_prediction[i]);
+    }
+    core[0].UpdateFilter(allow_state_prediction[0]);
+
+    // wait for all cores before doing lane selection
+    for (uint8_t i=1; i<num_cores; i++) {
+        coreWorkers[i]->wait();
+    }
+}
+#endif  // EK3_FEATURE_PARALLEL_CORES
+
 /* 
   Update Filter States - this should be called whenever new IMU data is available
   Execution speed governed by SCHED_LOOP_RATE
@@ -917,6 +1016,21 @@ void NavEKF3::UpdateFilter(void)
 
     imuSampleTime_us = dal.micros64();
 
+#if EK3_FEATURE_PARALLEL_CORES
+    if (parallel_cores_ready()) {
+        // decide on prediction for all cores before any of them
+        // runs, so the decisions don't depend on thread timing
+        bool allow_state_prediction[MAX_EKF_CORES];
+        for (uint8_t i=0; i<num_cores; i++) {
+            allow_state_prediction[i] = !(core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+                                          dal.ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i));
+            // IMU histories are shared between cores, so add this
+            // frame to them before the cores run in their threads
+            core[i].prepareUpdateFilter(allow_state_prediction[i]);
+        }
+        update_cores_parallel(allow_state_prediction);
+    } else
+#endif
     for (uint8_t i=0; i<num_cores; i++) {
         // if we have not overrun by more than 3 IMU frames, and we
         // have already used more than 1/3 of the CPU budget for this
@@ -24,9 +24,13 @@
 #include <AP_Param/AP_Param.h>
 #include <AP_NavEKF/AP_Nav_Common.h>
 #include <AP_NavEKF/AP_NavEKF_Source.h>
+#include "AP_NavEKF3_feature.h"
 
 class NavEKF3_core;
 class EKFGSF_yaw;
+#if EK3_FEATURE_PARALLEL_CORES
+class NavEKF3_CoreWorker;
+#endif
 
 class NavEKF3 {
     friend class NavEKF3_core;
@@ -459,6 +463,7 @@ private:
     enum class Option {
         JammingExpected     = (1<<0),
         ManualLaneSwitch   = (1<<1),
+        ParallelCores       = (1<<2),
     };
     bool option_is_enabled(Option option) const {
         return (_options & (uint32_t)option) != 0;
@@ -547,6 +552,21 @@ private:
     // origin set by one of the cores
     Location common_EKF_origin;
     bool common_origin_valid;
+
+#if EK3_FEATURE_PARALLEL_CORES
+    // worker threads for cores other than the first when running
+    // the cores in parallel
+    NavEKF3_CoreWorker *coreWorkers[MAX_EKF_CORES] {};
+    bool coreWorkersFailed;
+
+    // returns true if the cores can be updated on the worker threads
+    // this frame, creating the threads if needed
+    bool parallel_cores_ready(void);
+
+    // run the core updates concurrently, returning once all cores
+    // have completed their update
+    void update_cores_parallel(const bool allow_state_prediction[]);
+#endif
     
     // update the yaw reset data to capture changes due to a lane switch
     // new_primary - index of the ekf instance that we are about to switch to as the primary
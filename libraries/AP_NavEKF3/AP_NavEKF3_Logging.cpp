@@ -439,6 +439,7 @@ void NavEKF3_core::Log_Write_Timing(uint64_t time_us)
         delAngDT_max : timing.delAngDT_max,
         delVelDT_min : timing.delVelDT_min,
         delVelDT_max : timing.delVelDT_max,
+        update_us_max : timing.update_us_max,
     };
     memset(&timing, 0, sizeof(timing));
 
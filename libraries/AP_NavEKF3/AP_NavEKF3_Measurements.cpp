@@ -275,7 +275,7 @@ void NavEKF3_core::tryChangeCompass(uint8_t mag_index)
      // if the magnetometer is allowed to be used for yaw and has a different index, we start using it
     if (compass.healthy(mag_index) && compass.use_for_yaw(mag_index) && mag_index != magSelectIndex) {
         magSelectIndex = mag_index;
-        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "EKF3 IMU%u switching to compass %u",(unsigned)imu_index,magSelectIndex);
+        send_text(MAV_SEVERITY_INFO, "EKF3 IMU%u switching to compass %u",(unsigned)imu_index,magSelectIndex);
         // reset the timeout flag and timer
         magTimeout = false;
         lastHealthyMagTime_ms = imuSampleTime_ms;
@@ -395,25 +395,16 @@ void NavEKF3_core::readIMUData(bool startPredictEnabled)
 {
     const auto &ins = dal.ins();
 
-    // calculate an averaged IMU update rate using a spike and lowpass filter combination
-    dtIMUavg = 0.02f * constrain_ftype(ins.get_loop_delta_t(),0.5f * dtIMUavg, 2.0f * dtIMUavg) + 0.98f * dtIMUavg;
-
     // the imu sample time is used as a common time reference throughout the filter
     imuSampleTime_ms = frontend->imuSampleTime_us / 1000;
 
-    uint8_t accel_active, gyro_active;
-
-    if (ins.use_accel(imu_index)) {
-        accel_active = imu_index;
-    } else {
-        accel_active = ins.get_first_usable_accel();
-    }
+    // add this frame to the downsampled IMU history, which may
+    // already have been done by the frontend or by another core
+    // using the same IMUs
+    updateIMUHistory(startPredictEnabled);
 
-    if (ins.use_gyro(imu_index)) {
-        gyro_active = imu_index;
-    } else {
-        gyro_active = ins.get_first_usable_gyro();
-    }
+    const uint8_t gyro_active = imuHistory->gyro_index();
+    const uint8_t accel_active = imuHistory->accel_index();
 
     if (gyro_active != gyro_index_active) {
         // we are switching active gyro at runtime. Copy over the
@@ -436,60 +427,14 @@ void NavEKF3_core::readIMUData(bool startPredictEnabled)
     // run movement check using IMU data
     updateMovementCheck();
 
-    readDeltaVelocity(accel_index_active, imuDataNew.delVel, imuDataNew.delVelDT);
+    imuDataNew = imuHistory->latest();
     accelPosOffset = ins.get_imu_pos_offset(accel_index_active).toftype();
-    imuDataNew.accel_index = accel_index_active;
-    
-    // Get delta angle data from primary gyro or primary if not available
-    readDeltaAngle(gyro_index_active, imuDataNew.delAng, imuDataNew.delAngDT);
-    imuDataNew.delAngDT = MAX(imuDataNew.delAngDT, 1.0e-4f);
-    imuDataNew.gyro_index = gyro_index_active;
-
-    // Get current time stamp
-    imuDataNew.time_ms = imuSampleTime_ms;
-
-    // Accumulate the measurement time interval for the delta velocity and angle data
-    imuDataDownSampledNew.delAngDT += imuDataNew.delAngDT;
-    imuDataDownSampledNew.delVelDT += imuDataNew.delVelDT;
-
-    // use the most recent IMU index for the downsampled IMU
-    // data. This isn't strictly correct if we switch IMUs between
-    // samples
-    imuDataDownSampledNew.gyro_index = imuDataNew.gyro_index;
-    imuDataDownSampledNew.accel_index = imuDataNew.accel_index;
-
-    // Rotate quaternon atitude from previous to new and normalise.
-    // Accumulation using quaternions prevents introduction of coning errors due to downsampling
-    imuQuatDownSampleNew.rotate(imuDataNew.delAng);
-    imuQuatDownSampleNew.normalize();
-
-    // Rotate the latest delta velocity into body frame at the start of accumulation
-    Matrix3F deltaRotMat;
-    imuQuatDownSampleNew.rotation_matrix(deltaRotMat);
-
-    // Apply the delta velocity to the delta velocity accumulator
-    imuDataDownSampledNew.delVel += deltaRotMat*imuDataNew.delVel;
 
     // Keep track of the number of IMU frames since the last state prediction
     framesSincePredict++;
 
-    /*
-     * If the target EKF time step has been accumulated, and the frontend has allowed start of a new predict cycle,
-     * then store the accumulated IMU data to be used by the state prediction, ignoring the frontend permission if more
-     * than twice the target time has lapsed. Adjust the target EKF step time threshold to allow for timing jitter in the
-     * IMU data.
-     */
-    if ((imuDataDownSampledNew.delAngDT >= (EKF_TARGET_DT-(dtIMUavg*0.5f)) && startPredictEnabled) ||
-        (imuDataDownSampledNew.delAngDT >= 2.0f*EKF_TARGET_DT)) {
-
-        // convert the accumulated quaternion to an equivalent delta angle
-        imuQuatDownSampleNew.to_axis_angle(imuDataDownSampledNew.delAng);
-
-        // Time stamp the data
-        imuDataDownSampledNew.time_ms = imuSampleTime_ms;
-
-        // Write data to the FIFO IMU buffer
-        storedIMU.push_youngest_element(imuDataDownSampledNew);
+    if (imuHistory->pushed(frontend->imuSampleTime_us)) {
+        const imu_elements &imuDataDownSampledNew = imuHistory->youngest();
 
         // calculate the achieved average time step rate for the EKF using a combination spike and LPF
         ftype dtNow = constrain_ftype(0.5f*(imuDataDownSampledNew.delAngDT+imuDataDownSampledNew.delVelDT),0.5f * dtEkfAvg, 2.0f * dtEkfAvg);
@@ -498,14 +443,6 @@ void NavEKF3_core::readIMUData(bool startPredictEnabled)
         // do an addtional down sampling for data used to sample XY body frame drag specific forces
         SampleDragData(imuDataDownSampledNew);
 
-        // zero the accumulated IMU data and quaternion
-        imuDataDownSampledNew.delAng.zero();
-        imuDataDownSampledNew.delVel.zero();
-        imuDataDownSampledNew.delAngDT = 0.0f;
-        imuDataDownSampledNew.delVelDT = 0.0f;
-        imuQuatDownSampleNew[0] = 1.0f;
-        imuQuatDownSampleNew[3] = imuQuatDownSampleNew[2] = imuQuatDownSampleNew[1] = 0.0f;
-
         // reset the counter used to let the frontend know how many frames have elapsed since we started a new update cycle
         framesSincePredict = 0;
 
@@ -513,7 +450,7 @@ void NavEKF3_core::readIMUData(bool startPredictEnabled)
         runUpdates = true;
 
         // extract the oldest available data from the FIFO buffer
-        imuDataDelayed = storedIMU.get_oldest_element();
+        imuDataDelayed = imuHistory->oldest();
 
         // protect against delta time going to zero
         ftype minDT = 0.1f * dtEkfAvg;
@@ -534,21 +471,79 @@ void NavEKF3_core::readIMUData(bool startPredictEnabled)
     }
 }
 
-// read the delta velocity and corresponding time interval from the IMU
-// return false if data is not available
-bool NavEKF3_core::readDeltaVelocity(uint8_t ins_index, Vector3F &dVel, ftype &dVel_dt) {
+/*
+ *  Add the IMU data for this frame to the downsampled IMU history.
+ *  The history is held by AP_DAL and shared with any other core using
+ *  the same gyro and accel, so the IMU data is read and downsampled once
+ *  per frame rather than once per core. If the active IMUs change the
+ *  core moves to the history for the new IMUs, taking its buffered data
+ *  with it if no other core is using those IMUs.
+ */
+void NavEKF3_core::updateIMUHistory(bool startPredictEnabled)
+{
+    if (imuHistoryFrame_us == frontend->imuSampleTime_us) {
+        return;
+    }
+    imuHistoryFrame_us = frontend->imuSampleTime_us;
+
     const auto &ins = dal.ins();
 
-    if (ins_index < ins.get_accel_count()) {
-        Vector3f dVelF;
-        float dVel_dtF;
-        ins.get_delta_velocity(ins_index, dVelF, dVel_dtF);
-        dVel = dVelF.toftype();
-        dVel_dt = dVel_dtF;
-        dVel_dt = MAX(dVel_dt,1.0e-4);
-        return true;
+    // calculate an averaged IMU update rate using a spike and lowpass filter combination
+    dtIMUavg = 0.02f * constrain_ftype(ins.get_loop_delta_t(),0.5f * dtIMUavg, 2.0f * dtIMUavg) + 0.98f * dtIMUavg;
+
+    uint8_t accel_active, gyro_active;
+
+    if (ins.use_accel(imu_index)) {
+        accel_active = imu_index;
+    } else {
+        accel_active = ins.get_first_usable_accel();
+    }
+
+    if (ins.use_gyro(imu_index)) {
+        gyro_active = imu_index;
+    } else {
+        gyro_active = ins.get_first_usable_gyro();
+    }
+
+    if (gyro_active != imuHistory->gyro_index() ||
+        accel_active != imuHistory->accel_index()) {
+        AP_DAL_IMUHistory *h = dal.imu_history_acquire(gyro_active, accel_active, imuHistory->length(), imuHistory);
+        if (h != nullptr) {
+            const uint8_t old_youngest = imuHistory->get_youngest_index();
+            dal.imu_history_release(imuHistory);
+            imuHistory = h;
+            // if the history was already in use its ring buffer
+            // indices will differ from ours, so move the output
+            // buffer to keep outputs aligned with IMU samples
+            const uint8_t n = imuHistory->length();
+            rotateStoredOutput((imuHistory->get_youngest_index() + n - old_youngest) % n);
+        }
+        // if no history could be allocated we stay on the previous IMUs
+    }
+
+    imuHistory->update(ins, frontend->imuSampleTime_us, frontend->imuSampleTime_us / 1000,
+                       startPredictEnabled, dtIMUavg, EKF_TARGET_DT);
+}
+
+// rotate the output buffer towards the youngest end by shift elements
+void NavEKF3_core::rotateStoredOutput(uint8_t shift)
+{
+    const uint8_t n = imuHistory->length();
+    if (shift == 0 || n == 0) {
+        return;
     }
-    return false;
+    auto reverse = [this](uint8_t first, uint8_t last) {
+        while (first < last) {
+            const output_elements tmp = storedOutput[first];
+            storedOutput[first] = storedOutput[last];
+            storedOutput[last] = tmp;
+            first++;
+            last--;
+        }
+    };
+    reverse(0, n-1);
+    reverse(0, shift-1);
+    reverse(shift, n-1);
 }
 
 /********************************************************
@@ -593,7 +588,7 @@ void NavEKF3_core::readGpsData()
     gpsDataNew.time_ms -= localFilterTimeStep_ms/2;
 
     // Prevent the time stamp falling outside the oldest and newest IMU data in the buffer
-    gpsDataNew.time_ms = MIN(MAX(gpsDataNew.time_ms,imuDataDelayed.time_ms),imuDataDownSampledNew.time_ms);
+    gpsDataNew.time_ms = MIN(MAX(gpsDataNew.time_ms,imuDataDelayed.time_ms),imuHistory->youngest().time_ms);
 
     // Get which GPS we are using for position information
     gpsDataNew.sensor_idx = selected_gps;
@@ -751,23 +746,6 @@ void NavEKF3_core::readGpsYawData()
     }
 }
 
-// read the delta angle and corresponding time interval from the IMU
-// return false if data is not available
-bool NavEKF3_core::readDeltaAngle(uint8_t ins_index, Vector3F &dAng, ftype &dAngDT) {
-    const auto &ins = dal.ins();
-
-    if (ins_index < ins.get_gyro_count()) {
-        Vector3f dAngF;
-        float dAngDTF;
-        ins.get_delta_angle(ins_index, dAngF, dAngDTF);
-        dAng = dAngF.toftype();
-        dAngDT = dAngDTF;
-        return true;
-    }
-    return false;
-}
-
-
 /********************************************************
 *                  Height Measurements                  *
 ********************************************************/
@@ -31,11 +31,16 @@
 #include <AP_NavEKF/AP_NavEKF_core_common.h>
 #include <AP_NavEKF/AP_NavEKF_Source.h>
 #include <AP_NavEKF/EKF_Buffer.h>
+#include <AP_DAL/AP_DAL_IMUHistory.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <AP_RangeFinder/AP_RangeFinder.h>
 
 #include "AP_NavEKF/EKFGSF_yaw.h"
 
+#if EK3_FEATURE_PARALLEL_CORES && NAVEKF_SHARED_SCRATCH
+#error "EK3_FEATURE_PARALLEL_CORES requires per-core EKF scratch space"
+#endif
+
 // GPS pre-flight check bit locations
 #define MASK_GPS_NSATS      (1<<0)
 #define MASK_GPS_HDOP       (1<<1)
@@ -141,6 +146,20 @@ public:
     // The predict flag is set true when a new prediction cycle can be started
     void UpdateFilter(bool predict);
 
+    // do the parts of UpdateFilter that touch state shared with other
+    // cores. Called by the frontend before cores are updated in parallel
+    void prepareUpdateFilter(bool predict);
+
+#if EK3_FEATURE_PARALLEL_CORES
+    // while deferring, status text and takeoff expected are held for
+    // the main thread rather than sent from the thread running the core
+    void setDeferring(bool enable) { deferMainThread = enable; }
+
+    // send the status text and takeoff expected held while deferring.
+    // Must be called from the main thread
+    void sendDeferred(void);
+#endif
+
     // Check basic filter health metrics and return a consolidated health status
     bool healthy(void) const;
 
@@ -574,15 +593,8 @@ private:
         Vector3F    position;       // position of body frame origin in local NED earth frame (m)
     };
 
-    struct imu_elements {
-        Vector3F    delAng;         // IMU delta angle measurements in body frame (rad)
-        Vector3F    delVel;         // IMU delta velocity measurements in body frame (m/sec)
-        ftype       delAngDT;       // time interval over which delAng has been measured (sec)
-        ftype       delVelDT;       // time interval over which delVelDT has been measured (sec)
-        uint32_t    time_ms;        // measurement timestamp (msec)
-        uint8_t     gyro_index;
-        uint8_t     accel_index;
-    };
+    // downsampled IMU data is shared between cores through AP_DAL
+    typedef AP_DAL_IMUHistory::Sample imu_elements;
 
     struct gps_elements : EKF_obs_element_t {
         int32_t     lat, lng;       // latitude and longitude in 1e7 degrees
@@ -770,10 +782,6 @@ private:
     // initialise the covariance matrix
     void CovarianceInit();
 
-    // helper functions for readIMUData
-    bool readDeltaVelocity(uint8_t ins_index, Vector3F &dVel, ftype &dVel_dt);
-    bool readDeltaAngle(uint8_t ins_index, Vector3F &dAng, ftype &dAng_dt);
-
     // helper functions for correcting IMU data
     void correctDeltaAngle(Vector3F &delAng, ftype delAngDT, uint8_t gyro_index);
     void correctDeltaVelocity(Vector3F &delVel, ftype delVelDT, uint8_t accel_index);
@@ -781,6 +789,13 @@ private:
     // update IMU delta angle and delta velocity measurements
     void readIMUData(bool startPredictEnabled);
 
+    // add the latest IMU data to the downsampled IMU history, switching
+    // history if the active IMUs have changed
+    void updateIMUHistory(bool startPredictEnabled);
+
+    // rotate storedOutput so it stays aligned with imuHistory
+    void rotateStoredOutput(uint8_t shift);
+
     // update estimate of inactive bias states
     void learnInactiveBiases();
 
@@ -1075,7 +1090,8 @@ private:
 
     ftype gpsNoiseScaler;           // Used to scale the  GPS measurement noise and consistency gates to compensate for operation with small satellite counts
     Matrix24 P;                     // covariance matrix
-    EKF_IMU_buffer_t<imu_elements> storedIMU;      // IMU data buffer
+    AP_DAL_IMUHistory *imuHistory;  // downsampled IMU data buffer, shared with cores using the same IMUs
+    uint64_t imuHistoryFrame_us;    // IMU sample time of the last frame added to imuHistory
     EKF_obs_buffer_t<gps_elements> storedGPS;      // GPS data buffer
     EKF_obs_buffer_t<mag_elements> storedMag;      // Magnetometer data buffer
     EKF_obs_buffer_t<baro_elements> storedBaro;    // Baro data buffer
@@ -1174,8 +1190,6 @@ private:
     uint8_t stateIndexLim;          // Max state index used during matrix and array operations
     imu_elements imuDataDelayed;    // IMU data at the fusion time horizon
     imu_elements imuDataNew;        // IMU data at the current time horizon
-    imu_elements imuDataDownSampledNew; // IMU data at the current time horizon that has been downsampled to a 100Hz rate
-    QuaternionF imuQuatDownSampleNew; // Quaternion obtained by rotating through the IMU delta angles since the start of the current down sampled frame
     baro_elements baroDataNew;      // Baro data at the current time horizon
     baro_elements baroDataDelayed;  // Baro data at the fusion time horizon
     range_elements rangeDataNew;    // Range finder data at the current time horizon
@@ -1560,6 +1574,23 @@ private:
     // timing statistics
     struct ekf_timing timing;
 
+    // send a status text, held for the main thread while deferring
+    void send_text(uint8_t severity, const char *fmt, ...) FMT_PRINTF(3, 4);
+    static const uint8_t MAX_TEXT_LEN = 100;
+
+    // tell the vehicle a takeoff is expected, held for the main thread while deferring
+    void set_takeoff_expected(void);
+
+#if EK3_FEATURE_PARALLEL_CORES
+    bool deferMainThread;           // true while the core is updated on a worker thread
+    struct {
+        uint8_t severity;
+        char text[MAX_TEXT_LEN];
+    } deferredText[3];              // status text held while deferring, later text is dropped
+    uint8_t deferredTextCount;
+    bool deferredTakeoffExpected;   // takeoff expected held while deferring
+#endif
+
     // when was attitude filter status last non-zero?
     uint32_t last_filter_ok_ms;
     
@@ -281,6 +281,7 @@ struct PACKED log_XKFD {
 // @Field: AngMax: accumulated measurement time interval for the delta angle (maximum)
 // @Field: VMin: accumulated measurement time interval for the delta velocity (minimum)
 // @Field: VMax: accumulated measurement time interval for the delta velocity (maximum)
+// @Field: UMax: longest time taken by a single update of this core
 struct PACKED log_XKT {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -294,6 +295,7 @@ struct PACKED log_XKT {
     float delAngDT_max;
     float delVelDT_min;
     float delVelDT_max;
+    uint32_t update_us_max;
 };
 
 
@@ -450,7 +452,7 @@ struct PACKED log_XKV {
       "XKFS","QBBBBBBBBB","TimeUS,C,MI,BI,GI,AI,SS,GPS_GTA,GPS_CHK_WAIT,MAG_FUSION", "s#--------", "F---------" , true }, \
     { LOG_XKQ_MSG, sizeof(log_XKQ), "XKQ", "QBffff", "TimeUS,C,Q1,Q2,Q3,Q4", "s#????", "F-????" , true }, \
     { LOG_XKT_MSG, sizeof(log_XKT),   \
-      "XKT", "QBIffffffff", "TimeUS,C,Cnt,IMUMin,IMUMax,EKFMin,EKFMax,AngMin,AngMax,VMin,VMax", "s#sssssssss", "F-000000000", true }, \
+      "XKT", "QBIffffffffI", "TimeUS,C,Cnt,IMUMin,IMUMax,EKFMin,EKFMax,AngMin,AngMax,VMin,VMax,UMax", "s#ssssssssss", "F-000000000F", true }, \
     { LOG_XKTV_MSG, sizeof(log_XKTV),                         \
       "XKTV", "QBff", "TimeUS,C,TVS,TVD", "s#rr", "F-00", true }, \
     { LOG_XKV1_MSG, sizeof(log_XKV), \
@@ -104,6 +104,26 @@ uint16_t AP_Param::_count_marker;
 uint16_t AP_Param::_count_marker_done;
 HAL_Semaphore AP_Param::_count_sem;
 
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+// starting slot for a header in the scan cache. The group element is
+// in the high bits of the header so take the top of the product
+#define SCAN_CACHE_SLOT(hdr) ((((hdr) * 2654435761U) >> 16) & _scan_cache_mask)
+
+// name lookup index
+AP_Param::NameIndexEntry *AP_Param::_name_index;
+uint16_t AP_Param::_name_index_count;
+uint16_t AP_Param::_name_index_marker;
+HAL_Semaphore AP_Param::_name_index_sem;
+
+// storage header offset cache
+uint32_t *AP_Param::_scan_cache_hdr;
+uint16_t *AP_Param::_scan_cache_ofs;
+uint16_t AP_Param::_scan_cache_mask;
+uint16_t AP_Param::_scan_cache_count;
+uint16_t AP_Param::_scan_cache_sentinal;
+HAL_Semaphore AP_Param::_scan_cache_sem;
+#endif
+
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
@@ -185,6 +205,10 @@ void AP_Param::erase_all(void)
     hdr.spare    = 0;
     eeprom_write_check(&hdr, 0, sizeof(hdr));
 
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    scan_cache_invalidate();
+#endif
+
     // add a sentinal directly after the header
     write_sentinal(sizeof(struct EEPROM_header));
 }
@@ -378,6 +402,9 @@ bool AP_Param::setup(void)
             hdr2.revision == k_EEPROM_revision &&
             _storage.copy_area(_storage_bak)) {
             // restored from backup
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+            scan_cache_invalidate();
+#endif
             INTERNAL_ERROR(AP_InternalError::error_t::params_restored);
             return true;
         }
@@ -762,6 +789,29 @@ bool AP_Param::is_sentinal(const Param_header &phdr)
 // if the sentinal isn't found either, the offset is set to 0xFFFF
 bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
 {
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_scan_cache_sem);
+        if (_scan_cache_ofs != nullptr || scan_cache_build()) {
+            uint32_t hdr;
+            memcpy(&hdr, target, sizeof(hdr));
+            for (uint16_t i = SCAN_CACHE_SLOT(hdr);
+                 _scan_cache_ofs[i] != 0;
+                 i = (i + 1) & _scan_cache_mask) {
+                if (_scan_cache_hdr[i] == hdr) {
+                    *pofs = _scan_cache_ofs[i];
+                    return true;
+                }
+            }
+            *pofs = _scan_cache_sentinal;
+            if (_scan_cache_sentinal != 0xffff) {
+                sentinal_offset = _scan_cache_sentinal;
+            }
+            return false;
+        }
+    }
+#endif
+
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
     while (ofs < _storage.size()) {
@@ -786,6 +836,117 @@ bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
     return false;
 }
 
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+/*
+  build the storage header cache by walking the headers in storage
+  once. Must be called with _scan_cache_sem held
+ */
+bool AP_Param::scan_cache_build(void)
+{
+    if (!initialised()) {
+        return false;
+    }
+
+    // count the headers to size the table
+    struct Param_header phdr;
+    uint16_t count = 0;
+    uint16_t ofs = sizeof(AP_Param::EEPROM_header);
+    while (ofs < _storage.size()) {
+        _storage.read_block(&phdr, ofs, sizeof(phdr));
+        if (is_sentinal(phdr)) {
+            break;
+        }
+        count++;
+        ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
+    }
+
+    // keep the table at most half full, leaving room for parameters
+    // saved after it is built
+    uint32_t size = 64;
+    while (size < 2U*(count+64U)) {
+        size *= 2;
+    }
+    if (size > 0x8000) {
+        return false;
+    }
+    _scan_cache_hdr = (uint32_t *)calloc(size, sizeof(uint32_t));
+    _scan_cache_ofs = (uint16_t *)calloc(size, sizeof(uint16_t));
+    if (_scan_cache_hdr == nullptr || _scan_cache_ofs == nullptr) {
+        scan_cache_invalidate();
+        return false;
+    }
+    _scan_cache_mask = size - 1;
+    _scan_cache_count = 0;
+    _scan_cache_sentinal = 0xffff;
+
+    ofs = sizeof(AP_Param::EEPROM_header);
+    while (ofs < _storage.size()) {
+        _storage.read_block(&phdr, ofs, sizeof(phdr));
+        if (is_sentinal(phdr)) {
+            _scan_cache_sentinal = ofs;
+            break;
+        }
+        uint32_t hdr;
+        memcpy(&hdr, &phdr, sizeof(hdr));
+        // the first copy of a header in storage is the one scan() finds
+        scan_cache_insert(hdr, ofs);
+        ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
+    }
+    return true;
+}
+
+/*
+  add a header to the cache if not already present. Returns false if
+  the table is too full
+ */
+bool AP_Param::scan_cache_insert(uint32_t hdr, uint16_t ofs)
+{
+    if (_scan_cache_count >= (_scan_cache_mask+1U)*3U/4U) {
+        return false;
+    }
+    uint16_t i = SCAN_CACHE_SLOT(hdr);
+    while (_scan_cache_ofs[i] != 0) {
+        if (_scan_cache_hdr[i] == hdr) {
+            return true;
+        }
+        i = (i + 1) & _scan_cache_mask;
+    }
+    _scan_cache_hdr[i] = hdr;
+    _scan_cache_ofs[i] = ofs;
+    _scan_cache_count++;
+    return true;
+}
+
+/*
+  record a header newly written to storage along with the new sentinal
+ */
+void AP_Param::scan_cache_add(const Param_header &phdr, uint16_t ofs, uint16_t new_sentinal)
+{
+    WITH_SEMAPHORE(_scan_cache_sem);
+    if (_scan_cache_ofs == nullptr) {
+        return;
+    }
+    uint32_t hdr;
+    memcpy(&hdr, &phdr, sizeof(hdr));
+    if (!scan_cache_insert(hdr, ofs)) {
+        // rebuild with a larger table on the next scan
+        scan_cache_invalidate();
+        return;
+    }
+    _scan_cache_sentinal = new_sentinal;
+}
+
+void AP_Param::scan_cache_invalidate(void)
+{
+    WITH_SEMAPHORE(_scan_cache_sem);
+    free(_scan_cache_hdr);
+    free(_scan_cache_ofs);
+    _scan_cache_hdr = nullptr;
+    _scan_cache_ofs = nullptr;
+    _scan_cache_count = 0;
+}
+#endif // AP_PARAM_LOOKUP_INDEX_ENABLED
+
 /**
  * add a _X, _Y, _Z suffix to the name of a Vector3f element
  * @param buffer
@@ -912,11 +1073,138 @@ AP_Param::find_group(const char *name, uint16_t vindex, ptrdiff_t group_offset,
 }
 
 
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+// FNV-1a hash of a parameter name
+uint32_t AP_Param::name_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i] != 0; i++) {
+        hash = (hash ^ uint8_t(name[i])) * 16777619U;
+    }
+    return hash;
+}
+
+/*
+  build the name index from a walk of all parameters. Must be called
+  with _name_index_sem held
+ */
+bool AP_Param::build_name_index(void)
+{
+    if (!initialised()) {
+        return false;
+    }
+    const uint16_t marker = _count_marker;
+
+    uint16_t count = 0;
+    ParamToken token {};
+    enum ap_var_type type;
+    for (AP_Param *ap = first(&token, &type); ap != nullptr; ap = next(&token, &type)) {
+        count++;
+    }
+
+    NameIndexEntry *index = NEW_NOTHROW NameIndexEntry[count];
+    if (index == nullptr) {
+        return false;
+    }
+
+    uint16_t n = 0;
+    token = {};
+    for (AP_Param *ap = first(&token, &type);
+         ap != nullptr && n < count;
+         ap = next(&token, &type)) {
+        if (type == AP_PARAM_GROUP || token.idx != 0) {
+            // Vector3f elements are left to the linear search
+            continue;
+        }
+        char name[AP_MAX_NAME_SIZE+1] {};
+        ap->copy_name_token(token, name, AP_MAX_NAME_SIZE);
+        auto &e = index[n];
+        e.hash = name_hash(name);
+        e.seq = n;
+        e.type = type;
+        e.token = token;
+        e.ap = ap;
+        n++;
+    }
+    // order by hash, keeping the parameter order for equal hashes so
+    // the first parameter with a given name is found, as in find()
+    qsort(index, n, sizeof(index[0]), [](const void *p1, const void *p2) {
+        const auto *e1 = (const NameIndexEntry *)p1;
+        const auto *e2 = (const NameIndexEntry *)p2;
+        if (e1->hash != e2->hash) {
+            return e1->hash < e2->hash ? -1 : 1;
+        }
+        return int(e1->seq) - int(e2->seq);
+    });
+
+    delete[] _name_index;
+    _name_index = index;
+    _name_index_count = n;
+    _name_index_marker = marker;
+    return true;
+}
+
+/*
+  find a parameter using the name index, returning nullptr if the
+  name is not in the index
+ */
+AP_Param *AP_Param::find_in_name_index(const char *name, enum ap_var_type *ptype, ParamToken *token)
+{
+    WITH_SEMAPHORE(_name_index_sem);
+    if ((_name_index == nullptr || _name_index_marker != _count_marker) &&
+        !build_name_index()) {
+        return nullptr;
+    }
+    const uint32_t hash = name_hash(name);
+
+    // find the first entry with this hash
+    uint16_t lo = 0;
+    uint16_t hi = _name_index_count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (_name_index[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (uint16_t i=lo; i<_name_index_count && _name_index[i].hash == hash; i++) {
+        const auto &e = _name_index[i];
+        char buf[AP_MAX_NAME_SIZE+1] {};
+        e.ap->copy_name_token(e.token, buf, AP_MAX_NAME_SIZE);
+        if (strcmp(name, buf) == 0) {
+            *ptype = (enum ap_var_type)e.type;
+            if (token != nullptr) {
+                *token = e.token;
+            }
+            return e.ap;
+        }
+    }
+    return nullptr;
+}
+#endif // AP_PARAM_LOOKUP_INDEX_ENABLED
+
 // Find a variable by name.
 //
 AP_Param *
 AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
 {
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    AP_Param *indexed = find_in_name_index(name, ptype, nullptr);
+    if (indexed != nullptr) {
+        if (flags != nullptr) {
+            uint32_t group_element = 0;
+            const struct GroupInfo *ginfo;
+            struct GroupNesting group_nesting {};
+            uint8_t idx;
+            indexed->find_var_info(&group_element, ginfo, group_nesting, &idx);
+            if (ginfo != nullptr) {
+                *flags = ginfo->flags;
+            }
+        }
+        return indexed;
+    }
+#endif
     for (uint16_t i=0; i<_num_vars; i++) {
         const auto &info = var_info(i);
         uint8_t type = info.type;
@@ -977,6 +1265,14 @@ AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token
 AP_Param* AP_Param::find_by_name(const char* name, enum ap_var_type *ptype, ParamToken *token)
 {
     AP_Param *ap;
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    // a whole Vector3f is iterated as its elements here, so leave
+    // those to the linear search
+    ap = find_in_name_index(name, ptype, token);
+    if (ap != nullptr && *ptype != AP_PARAM_VECTOR3F) {
+        return ap;
+    }
+#endif
     for (ap = AP_Param::first(token, ptype);
          ap && *ptype != AP_PARAM_GROUP && *ptype != AP_PARAM_NONE;
          ap = AP_Param::next_scalar(token, ptype)) {
@@ -1249,6 +1545,9 @@ void AP_Param::save_sync(bool force_save, bool send_to_gcs)
     write_sentinal(ofs + sizeof(phdr) + type_size((enum ap_var_type)phdr.type));
     eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
     eeprom_write_check(&phdr, ofs, sizeof(phdr));
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    scan_cache_add(phdr, ofs, sentinal_offset);
+#endif
 
     if (send_to_gcs) {
         send_parameter(name, (enum ap_var_type)phdr.type, idx);
@@ -834,6 +834,44 @@ private:
     }
 #endif
 
+#if AP_PARAM_LOOKUP_INDEX_ENABLED
+    /*
+      index from parameter name to object, sorted by name hash. It is
+      built on first use and rebuilt after the parameter count is
+      invalidated. Names not in the index (such as Vector3f elements)
+      fall back to the linear search
+    */
+    struct NameIndexEntry {
+        uint32_t hash;
+        uint16_t seq;
+        uint8_t type;
+        ParamToken token;
+        AP_Param *ap;
+    };
+    static NameIndexEntry *     _name_index;
+    static uint16_t             _name_index_count;
+    static uint16_t             _name_index_marker;
+    static HAL_Semaphore        _name_index_sem;
+    static uint32_t             name_hash(const char *name);
+    static bool                 build_name_index(void);
+    static AP_Param *           find_in_name_index(const char *name, enum ap_var_type *ptype, ParamToken *token);
+
+    /*
+      open addressing hash table from storage header to storage
+      offset, so scan() doesn't need to read every header in storage
+    */
+    static uint32_t *           _scan_cache_hdr;
+    static uint16_t *           _scan_cache_ofs;
+    static uint16_t             _scan_cache_mask;
+    static uint16_t             _scan_cache_count;
+    static uint16_t             _scan_cache_sentinal;
+    static HAL_Semaphore        _scan_cache_sem;
+    static bool                 scan_cache_build(void);
+    static bool                 scan_cache_insert(uint32_t hdr, uint16_t ofs);
+    static void                 scan_cache_add(const Param_header &phdr, uint16_t ofs, uint16_t new_sentinal);
+    static void                 scan_cache_invalidate(void);
+#endif
+
     /*
       list of overridden values from load_defaults_file()
     */
@@ -8,6 +8,12 @@
 #define AP_PARAM_DEFAULTS_FILE_PARSING_ENABLED AP_FILESYSTEM_FILE_READING_ENABLED
 #endif
 
+// RAM indexes for name lookups and storage scans, for boards with
+// plenty of memory
+#ifndef AP_PARAM_LOOKUP_INDEX_ENABLED
+#define AP_PARAM_LOOKUP_INDEX_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 #ifndef FORCE_APJ_DEFAULT_PARAMETERS
 #define FORCE_APJ_DEFAULT_PARAMETERS 0
 #endif
@@ -85,4 +85,26 @@ TEST(FindByName, Bob)
     }
 }
 
+TEST(FindByName, Find)
+{
+    for (const auto &x : TestVehicle::var_info) {
+        enum ap_var_type ptype = (ap_var_type)-1;
+        AP_Param::ParamToken token = AP_Param::ParamToken {};
+        AP_Param *p1 = AP_Param::find_by_name(x.name, &ptype, &token);
+        enum ap_var_type ptype2 = (ap_var_type)-1;
+        AP_Param *p2 = AP_Param::find(x.name, &ptype2);
+        EXPECT_TRUE(p2);
+        EXPECT_EQ(p1, p2);
+        EXPECT_EQ(ptype, ptype2);
+    }
+
+    // lookups must match repeated calls and the case-insensitive
+    // linear search
+    enum ap_var_type ptype;
+    EXPECT_EQ(AP_Param::find("AA", &ptype), AP_Param::find("aa", &ptype));
+    EXPECT_EQ(AP_Param::find("CC", &ptype), AP_Param::find("CC", &ptype));
+    EXPECT_FALSE(AP_Param::find("D", &ptype));
+    EXPECT_FALSE(AP_Param::find("AAA", &ptype));
+}
+
 AP_GTEST_MAIN()
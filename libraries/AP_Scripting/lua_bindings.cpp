@@ -325,10 +325,10 @@ int AP_Logger_Write(lua_State *L) {
     char multipliers_cat[LS_FORMAT_SIZE];
 
     uint8_t field_start = 4;
-    struct AP_Logger::log_write_fmt *f;
+    const struct AP_Logger::log_write_fmt *f;
     if (!have_units) {
-        // ask for a mesage type
-        f = AP_logger->msg_fmt_for_name(name, label_cat, nullptr, nullptr, fmt_cat, true, true);
+        // ask for a mesage type and field layout
+        f = AP_logger->compile_fmt(name, label_cat, nullptr, nullptr, fmt_cat, true);
 
     } else {
         // read in units and multiplers strings
@@ -350,8 +350,8 @@ int AP_Logger_Write(lua_State *L) {
         strcpy(multipliers_cat,"F");
         strcat(multipliers_cat,multipliers);
 
-        // ask for a mesage type
-        f = AP_logger->msg_fmt_for_name(name, label_cat, units_cat, multipliers_cat, fmt_cat, true, true);
+        // ask for a mesage type and field layout
+        f = AP_logger->compile_fmt(name, label_cat, units_cat, multipliers_cat, fmt_cat, true);
     }
 
     if (f == nullptr) {
@@ -360,30 +360,27 @@ int AP_Logger_Write(lua_State *L) {
         return luaL_argerror(L, args, "could not map message type");
     }
 
-    // work out how long the block will be
-    int16_t msg_len = AP_logger->Write_calc_msg_len(fmt_cat);
-    if (msg_len == -1) {
-        return luaL_argerror(L, args, "unknown format");
-    }
+    // the block length was worked out when the format was mapped
+    const uint8_t msg_len = f->msg_len;
 
     // note that luaM_malloc will never return null, it will fault instead
     char *buffer = (char*)luaM_malloc(L, msg_len);
 
     // add logging headers
-    uint8_t offset = 0;
-    buffer[offset++] = HEAD_BYTE1;
-    buffer[offset++] = HEAD_BYTE2;
-    buffer[offset++] = f->msg_type;
+    buffer[0] = HEAD_BYTE1;
+    buffer[1] = HEAD_BYTE2;
+    buffer[2] = f->msg_type;
 
     // timestamp is always first value
     const uint64_t now = AP_HAL::micros64();
-    memcpy(&buffer[offset], &now, sizeof(uint64_t));
-    offset += sizeof(uint64_t);
+    memcpy(&buffer[f->fields[0].offset], &now, sizeof(uint64_t));
 
     for (uint8_t i=field_start; i<=args; i++) {
         uint8_t charlen = 0;
         uint8_t index = have_units ? i-5 : i-3;
         uint8_t arg_index = i + arg_offset;
+        // field offsets were worked out when the format was compiled
+        const uint8_t offset = f->fields[index].offset;
         switch(fmt_cat[index]) {
             // logger variable types not available to scripting
             // 'd': double
@@ -399,7 +396,6 @@ int AP_Logger_Write(lua_State *L) {
                 }
                 int8_t tmp = static_cast<int8_t>(tmp1);
                 memcpy(&buffer[offset], &tmp, sizeof(int8_t));
-                offset += sizeof(int8_t);
                 break;
             }
             case 'h': // int16_t
@@ -413,7 +409,6 @@ int AP_Logger_Write(lua_State *L) {
                 }
                 int16_t tmp = static_cast<int16_t>(tmp1);
                 memcpy(&buffer[offset], &tmp, sizeof(int16_t));
-                offset += sizeof(int16_t);
                 break;
             }
             case 'H': // uint16_t
@@ -427,7 +422,6 @@ int AP_Logger_Write(lua_State *L) {
                 }
                 uint16_t tmp = static_cast<uint16_t>(tmp1);
                 memcpy(&buffer[offset], &tmp, sizeof(uint16_t));
-                offset += sizeof(uint16_t);
                 break;
             }
             case 'i': // int32_t
@@ -442,7 +436,6 @@ int AP_Logger_Write(lua_State *L) {
                 }
                 const int32_t tmp = tmp1;
                 memcpy(&buffer[offset], &tmp, sizeof(int32_t));
-                offset += sizeof(int32_t);
                 break;
             }
             case 'f': { // float
@@ -455,7 +448,6 @@ int AP_Logger_Write(lua_State *L) {
                 }
                 const float tmp = tmp1;
                 memcpy(&buffer[offset], &tmp, sizeof(float));
-                offset += sizeof(float);
                 break;
             }
             case 'n': { // char[4]
@@ -479,7 +471,6 @@ int AP_Logger_Write(lua_State *L) {
                 }
                 uint8_t tmp = static_cast<uint8_t>(tmp1);
                 memcpy(&buffer[offset], &tmp, sizeof(uint8_t));
-                offset += sizeof(uint8_t);
                 break;
             }
             case 'I': // uint32_t
@@ -504,7 +495,6 @@ int AP_Logger_Write(lua_State *L) {
                     }
                 }
                 memcpy(&buffer[offset], &tmp, sizeof(uint32_t));
-                offset += sizeof(uint32_t);
                 break;
             }
             case 'Q': { // uint64_t
@@ -516,7 +506,6 @@ int AP_Logger_Write(lua_State *L) {
                 }
                 uint64_t tmp = *static_cast<uint64_t *>(ud);
                 memcpy(&buffer[offset], &tmp, sizeof(uint64_t));
-                offset += sizeof(uint64_t);
                 break;
             }
             case 'N': { // char[16]
@@ -548,7 +537,6 @@ int AP_Logger_Write(lua_State *L) {
             }
             memcpy(&buffer[offset], tmp, slen);
             memset(&buffer[offset+slen], 0, charlen-slen);
-            offset += charlen;
         }
     }
 
@@ -58,7 +58,7 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
     // @Param: OPTIONS
     // @DisplayName: Terrain options
     // @Description: Options to change behaviour of terrain system
-    // @Bitmask: 0:Disable Download
+    // @Bitmask: 0:Disable Download, 1:Read terrain files using memory mapping (Linux and SITL only)
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",   2, AP_Terrain, options, 0),
 
@@ -134,8 +134,12 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
 
     calculate_grid_info(loc, info);
 
+#if AP_TERRAIN_MMAP_ENABLED
+    WITH_SEMAPHORE(mmap_sem);
+#endif
+
     // find the grid
-    const struct grid_block &grid = find_grid_cache(info).grid;
+    const struct grid_block &grid = find_grid(info);
 
     /*
       note that we rely on the one square overlap to ensure these
@@ -390,6 +394,9 @@ void AP_Terrain::update(void)
     // update tiles surrounding our current location:
     if (pos_valid) {
         have_surrounding_tiles = update_surrounding_tiles(loc);
+
+        // pull in blocks along the upcoming mission legs
+        prefetch_mission_path(loc);
     } else {
         have_surrounding_tiles = false;
     }
@@ -480,6 +487,9 @@ void AP_Terrain::log_terrain_data()
         pending        : pending,
         loaded         : loaded,
         reference_offset : have_reference_offset?reference_offset:0,
+        cache_hits     : cache_hits,
+        cache_misses   : cache_misses,
+        prefetches     : cache_prefetches,
     };
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
 }
@@ -504,6 +514,15 @@ bool AP_Terrain::allocate(void)
         return false;
     }
     cache_size = config_cache_size;
+
+    // the hint table is optional, the cache is searched if it is
+    // not available
+    uint16_t hint_size = 16;
+    while (hint_size < 2U*cache_size) {
+        hint_size *= 2;
+    }
+    cache_hint = (uint8_t *)calloc(hint_size, sizeof(cache_hint[0]));
+    cache_hint_mask = hint_size - 1;
     return true;
 }
 
@@ -23,6 +23,7 @@
 #include <AP_Param/AP_Param.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_Logger/AP_Logger_config.h>
+#include "AP_Terrain_Mmap.h"
 
 #define TERRAIN_DEBUG 0
 
@@ -50,6 +51,11 @@
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
 #endif
 
+// number of upcoming mission legs to prefetch grid blocks for
+#ifndef TERRAIN_PREFETCH_LEGS
+#define TERRAIN_PREFETCH_LEGS 3
+#endif
+
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
 
@@ -265,8 +271,9 @@ private:
 
         volatile enum GridCacheState state;
 
-        // the last time access was requested to this block, used for LRU
-        uint32_t last_access_ms;
+        // access sequence number of the last access to this block,
+        // used for LRU
+        uint32_t last_access;
     };
 
     /*
@@ -306,6 +313,27 @@ private:
     */
     struct grid_cache &find_grid_cache(const struct grid_info &info);
 
+    /*
+      find the grid block to use for a height lookup. This is the
+      cached block unless the block can be used in place from a
+      memory mapped file
+    */
+    const struct grid_block &find_grid(const struct grid_info &info);
+#if AP_TERRAIN_MMAP_ENABLED
+    const struct grid_block *mmap_find_block(const struct grid_info &info);
+#endif
+
+    /*
+      cache lookup helpers. lookup_grid_cache() returns nullptr if the
+      block is not in the cache, lru_grid_cache() returns the least
+      recently used block and claim_grid_cache() reuses a block for a
+      new grid, marking it for disk read
+    */
+    struct grid_cache *lookup_grid_cache(const struct grid_info &info);
+    struct grid_cache &lru_grid_cache(void);
+    void claim_grid_cache(struct grid_cache &grid, const struct grid_info &info);
+    uint16_t cache_hint_index(int8_t lat_degrees, int16_t lon_degrees, uint16_t grid_idx_x, uint16_t grid_idx_y) const;
+
     /*
       calculate bit number in grid_block bitmap. This corresponds to a
       bit representing a 4x4 mavlink transmitted block
@@ -340,13 +368,13 @@ private:
       disk IO functions
      */
     int16_t find_io_idx(enum GridCacheState state);
-    uint16_t get_block_crc(struct grid_block &block);
+    uint16_t get_block_crc(const struct grid_block &block) const;
     void check_disk_read(void);
     void check_disk_write(void);
     void io_timer(void);
     void open_file(void);
     void seek_offset(void);
-    uint32_t east_blocks(struct grid_block &block) const;
+    uint32_t east_blocks(int8_t lat_degrees, int16_t lon_degrees) const;
     void write_block(void);
     void read_block(void);
 
@@ -358,6 +386,12 @@ private:
      */
     void update_mission_data(void);
 
+    /*
+      queue disk reads for grid blocks along the upcoming mission legs
+     */
+    void prefetch_mission_path(const Location &loc);
+    bool prefetch_block(const Location &loc, uint32_t evict_limit);
+
     /*
       check for missing rally data
      */
@@ -379,12 +413,39 @@ private:
 
     enum class Options {
         DisableDownload = (1U<<0),
+        MmapRead        = (1U<<1),
     };
 
     // cache of grids in memory, LRU
     uint8_t cache_size = 0;
     struct grid_cache *cache = nullptr;
 
+    // direct mapped table from block position to cache index+1,
+    // checked before searching the whole cache
+    uint8_t *cache_hint = nullptr;
+    uint16_t cache_hint_mask;
+
+    // sequence number for LRU ordering of cache accesses
+    uint32_t access_seq;
+
+    // cache statistics for logging
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+    uint32_t cache_prefetches;
+
+    // prefetch state. Blocks accessed after prefetch_access_seq are
+    // in use and are not evicted by prefetching
+    uint32_t last_prefetch_ms;
+    uint32_t prefetch_access_seq;
+
+#if AP_TERRAIN_MMAP_ENABLED
+    // read-only mapping of DAT files. The semaphore is held while a
+    // block from the mapping is in use, as a lookup on another thread
+    // may remap the file
+    AP_Terrain_Mmap mmap_reader{sizeof(union grid_io_block)};
+    HAL_Semaphore mmap_sem;
+#endif
+
     // a grid_cache block waiting for disk IO
     enum DiskIoState {
         DiskIoIdle      = 0,
@@ -0,0 +1,169 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  memory mapped reading of terrain DAT files
+ */
+
+#include "AP_Terrain_Mmap.h"
+
+#if AP_TERRAIN_MMAP_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// minimum time between attempts to map a missing file or to grow a
+// mapping when a file has been extended
+#define TERRAIN_MMAP_RETRY_MS 1000
+
+void AP_Terrain_Mmap::set_directory(const char *_directory)
+{
+    if (directory != _directory) {
+        unmap_all();
+        directory = _directory;
+    }
+}
+
+/*
+  map (or remap) a file, leaving base as nullptr if it can't be mapped
+ */
+void AP_Terrain_Mmap::map_file(struct mapped_file &f)
+{
+    unmap_file(f);
+    f.last_check_ms = AP_HAL::millis();
+
+    if (directory == nullptr) {
+        return;
+    }
+    // same naming as AP_Terrain::open_file()
+    uint32_t lat_tmp = abs((int32_t)f.lat_degrees);
+    if (lat_tmp > 99U) {
+        lat_tmp = 99U;
+    }
+    uint32_t lon_tmp = abs((int32_t)f.lon_degrees);
+    if (lon_tmp > 999U) {
+        lon_tmp = 999U;
+    }
+    char path[128];
+    const int n = snprintf(path, sizeof(path), "%s/%c%02u%c%03u.DAT",
+                           directory,
+                           f.lat_degrees<0?'S':'N',
+                           (unsigned)lat_tmp,
+                           f.lon_degrees<0?'W':'E',
+                           (unsigned)lon_tmp);
+    if (n <= 0 || size_t(n) >= sizeof(path)) {
+        return;
+    }
+
+    const int fd = ::open(path, O_RDONLY|O_CLOEXEC);
+    if (fd == -1) {
+        return;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return;
+    }
+    void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return;
+    }
+    f.base = (uint8_t *)p;
+    f.length = st.st_size;
+    // without a bitmap every record is checked on each use
+    f.checked = NEW_NOTHROW uint32_t[(f.length / record_size + 31) / 32]{};
+}
+
+void AP_Terrain_Mmap::unmap_file(struct mapped_file &f)
+{
+    if (f.base != nullptr) {
+        ::munmap(f.base, f.length);
+        f.base = nullptr;
+        f.length = 0;
+    }
+    delete[] f.checked;
+    f.checked = nullptr;
+}
+
+void AP_Terrain_Mmap::unmap_all(void)
+{
+    for (auto &f : files) {
+        unmap_file(f);
+        f.used = false;
+    }
+}
+
+const uint8_t *AP_Terrain_Mmap::find(int8_t lat_degrees, int16_t lon_degrees, uint32_t record, bool &checked)
+{
+    checked = false;
+    const uint64_t end = (uint64_t(record) + 1) * record_size;
+
+    // find the file, or the least recently used slot to map it into
+    struct mapped_file *f = nullptr;
+    struct mapped_file *oldest = &files[0];
+    for (auto &fi : files) {
+        if (fi.used && fi.lat_degrees == lat_degrees && fi.lon_degrees == lon_degrees) {
+            f = &fi;
+            break;
+        }
+        if (!fi.used) {
+            oldest = &fi;
+        } else if (oldest->used && fi.last_access < oldest->last_access) {
+            oldest = &fi;
+        }
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    if (f == nullptr) {
+        f = oldest;
+        unmap_file(*f);
+        f->used = true;
+        f->lat_degrees = lat_degrees;
+        f->lon_degrees = lon_degrees;
+        map_file(*f);
+    } else if ((f->base == nullptr || end > f->length) &&
+               now_ms - f->last_check_ms >= TERRAIN_MMAP_RETRY_MS) {
+        // the file may have been created or extended by the terrain
+        // IO thread since we last looked
+        map_file(*f);
+    }
+    f->last_access = ++access_seq;
+
+    if (f->base == nullptr || end > f->length) {
+        return nullptr;
+    }
+    checked = f->checked != nullptr && (f->checked[record/32] & (1U<<(record%32))) != 0;
+    return &f->base[end - record_size];
+}
+
+void AP_Terrain_Mmap::set_checked(int8_t lat_degrees, int16_t lon_degrees, uint32_t record)
+{
+    for (auto &f : files) {
+        if (f.used && f.lat_degrees == lat_degrees && f.lon_degrees == lon_degrees) {
+            if (f.checked != nullptr && (uint64_t(record) + 1) * record_size <= f.length) {
+                f.checked[record/32] |= 1U<<(record%32);
+            }
+            return;
+        }
+    }
+}
+
+#endif // AP_TERRAIN_MMAP_ENABLED
@@ -0,0 +1,84 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_Terrain_config.h"
+
+#if AP_TERRAIN_MMAP_ENABLED
+
+#include <AP_Common/AP_Common.h>
+
+// number of degree files kept mapped at once
+#ifndef TERRAIN_MMAP_MAX_FILES
+#define TERRAIN_MMAP_MAX_FILES 4
+#endif
+
+/*
+  read-only memory mapping of terrain DAT files, which are arrays of
+  fixed size records. The most recently used files are kept mapped and
+  a pointer into the mapping is returned, so no copy of the data is
+  needed to read a block
+ */
+class AP_Terrain_Mmap {
+public:
+    AP_Terrain_Mmap(uint32_t _record_size) :
+        record_size(_record_size) {}
+    ~AP_Terrain_Mmap() { unmap_all(); }
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(AP_Terrain_Mmap);
+
+    // set the directory holding the DAT files. The string must
+    // remain valid while files are mapped
+    void set_directory(const char *_directory);
+
+    /*
+      return a pointer to a record in the file for the given degree
+      square, or nullptr if the file does not hold it. The pointer is
+      valid until the next call to find() or unmap_all(). checked is
+      set if set_checked() has been called for the record since the
+      file was mapped
+     */
+    const uint8_t *find(int8_t lat_degrees, int16_t lon_degrees, uint32_t record, bool &checked);
+
+    // remember that a record returned by find() has been validated
+    void set_checked(int8_t lat_degrees, int16_t lon_degrees, uint32_t record);
+
+    // unmap all files
+    void unmap_all(void);
+
+private:
+    struct mapped_file {
+        uint8_t *base;
+        size_t length;
+        // bitmap of records which have been checked
+        uint32_t *checked;
+        // last time we tried to map or grow the mapping
+        uint32_t last_check_ms;
+        uint32_t last_access;
+        int16_t lon_degrees;
+        int8_t lat_degrees;
+        bool used;
+    } files[TERRAIN_MMAP_MAX_FILES] {};
+
+    const uint32_t record_size;
+    const char *directory = nullptr;
+    uint32_t access_seq = 0;
+
+    void map_file(struct mapped_file &f);
+    void unmap_file(struct mapped_file &f);
+};
+
+#endif // AP_TERRAIN_MMAP_ENABLED
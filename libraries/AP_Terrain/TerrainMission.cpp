@@ -114,6 +114,101 @@ void AP_Terrain::update_mission_data(void)
 #endif  // AP_MISSION_ENABLED
 }
 
+/*
+  load grid blocks along the next few legs of a running mission so
+  they are in the cache before the vehicle gets there
+ */
+void AP_Terrain::prefetch_mission_path(const Location &loc)
+{
+#if AP_MISSION_ENABLED
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - last_prefetch_ms < 1000) {
+        return;
+    }
+    last_prefetch_ms = now_ms;
+
+    const AP_Mission *mission = AP::mission();
+    if (mission == nullptr ||
+        mission->state() != AP_Mission::MISSION_RUNNING ||
+        !allocate() || grid_spacing <= 0) {
+        return;
+    }
+
+    // blocks accessed since the last pass are in use and must not be
+    // evicted to make room for blocks we may never reach
+    const uint32_t evict_limit = prefetch_access_seq;
+    prefetch_access_seq = access_seq;
+
+    // sample each leg at half a block spacing so no block is skipped
+    const float step = MIN(TERRAIN_GRID_BLOCK_SPACING_X, TERRAIN_GRID_BLOCK_SPACING_Y) * grid_spacing * 0.5f;
+    const uint32_t prefetches_start = cache_prefetches;
+    const uint8_t max_prefetch = MAX(cache_size/4, 1);
+    uint8_t samples = 64;
+
+    Location origin = loc;
+    uint16_t index = mission->get_current_nav_index();
+    for (uint8_t leg=0; leg<TERRAIN_PREFETCH_LEGS; leg++) {
+        AP_Mission::Mission_Command cmd;
+        while (true) {
+            if (!mission->read_cmd_from_storage(index, cmd)) {
+                return;
+            }
+            if ((cmd.id == MAV_CMD_NAV_WAYPOINT ||
+                 cmd.id == MAV_CMD_NAV_SPLINE_WAYPOINT) &&
+                (cmd.content.location.lat != 0 || cmd.content.location.lng != 0)) {
+                break;
+            }
+            index++;
+        }
+        index++;
+
+        const Location &dest = cmd.content.location;
+        const float leg_length = origin.get_distance(dest);
+        const float bearing = origin.get_bearing_to(dest) * 0.01f;
+        for (float dist = 0; ; dist += step) {
+            Location sample = origin;
+            sample.offset_bearing(bearing, MIN(dist, leg_length));
+            if (!prefetch_block(sample, evict_limit) ||
+                cache_prefetches - prefetches_start >= max_prefetch ||
+                --samples == 0) {
+                return;
+            }
+            if (dist >= leg_length) {
+                break;
+            }
+        }
+        origin = dest;
+    }
+#endif  // AP_MISSION_ENABLED
+}
+
+/*
+  make sure the block holding loc is in the cache, queueing a load if
+  it isn't. Returns false if there is no cache entry we can use
+ */
+bool AP_Terrain::prefetch_block(const Location &loc, uint32_t evict_limit)
+{
+    struct grid_info info;
+    calculate_grid_info(loc, info);
+
+    struct grid_cache *gcache = lookup_grid_cache(info);
+    if (gcache != nullptr) {
+        // keep it from being evicted before we get there
+        gcache->last_access = ++access_seq;
+        return true;
+    }
+
+    struct grid_cache &victim = lru_grid_cache();
+    if (victim.state == GRID_CACHE_DIRTY ||
+        victim.state == GRID_CACHE_DISKWAIT ||
+        victim.last_access > evict_limit) {
+        return false;
+    }
+    claim_grid_cache(victim, info);
+    cache_prefetches++;
+    return true;
+}
+
 #if HAL_RALLY_ENABLED
 /*
   check that we have fetched all rally terrain data
@@ -106,25 +106,145 @@ void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info
  */
 AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info)
 {
-    uint16_t oldest_i = 0;
-
     // see if we have that grid
-    const auto now_ms = AP_HAL::millis();
+    struct grid_cache *gcache = lookup_grid_cache(info);
+    if (gcache != nullptr) {
+        gcache->last_access = ++access_seq;
+        cache_hits++;
+        return *gcache;
+    }
+
+    // Not found. Use the oldest grid and make it this grid,
+    // initially unpopulated
+    cache_misses++;
+    struct grid_cache &grid = lru_grid_cache();
+    claim_grid_cache(grid, info);
+    return grid;
+}
+
+/*
+  find the grid block to use for a height lookup
+ */
+const AP_Terrain::grid_block &AP_Terrain::find_grid(const struct grid_info &info)
+{
+#if AP_TERRAIN_MMAP_ENABLED
+    if (options.get() & uint16_t(Options::MmapRead)) {
+        // a cached block may have newer data than the file, so only
+        // use the file when the block isn't cached or is still
+        // waiting for a disk read
+        const struct grid_cache *gcache = lookup_grid_cache(info);
+        if (gcache == nullptr || gcache->state == GRID_CACHE_DISKWAIT) {
+            const struct grid_block *mblock = mmap_find_block(info);
+            if (mblock != nullptr) {
+                return *mblock;
+            }
+        }
+    }
+#endif
+    return find_grid_cache(info).grid;
+}
+
+#if AP_TERRAIN_MMAP_ENABLED
+/*
+  return a complete and valid block from a memory mapped terrain
+  file, or nullptr if the file doesn't have one
+ */
+const AP_Terrain::grid_block *AP_Terrain::mmap_find_block(const struct grid_info &info)
+{
+    const char* terrain_dir = hal.util->get_custom_terrain_directory();
+    if (terrain_dir == nullptr) {
+        terrain_dir = HAL_BOARD_TERRAIN_DIRECTORY;
+    }
+    mmap_reader.set_directory(terrain_dir);
+
+    const uint32_t blocknum = east_blocks(info.lat_degrees, info.lon_degrees) * info.grid_idx_x + info.grid_idx_y;
+    bool checked;
+    const uint8_t *p = mmap_reader.find(info.lat_degrees, info.lon_degrees, blocknum, checked);
+    if (p == nullptr) {
+        return nullptr;
+    }
+    const struct grid_block *block = &((const union grid_io_block *)p)->block;
+    if (checked) {
+        // already validated since the file was mapped
+        return block;
+    }
+
+    // only complete blocks are used, partial blocks are loaded into
+    // the cache so the missing data can be requested from the GCS
+    if (!TERRAIN_LATLON_EQUAL(block->lat,info.grid_lat) ||
+        !TERRAIN_LATLON_EQUAL(block->lon,info.grid_lon) ||
+        block->bitmap != bitmap_mask ||
+        block->spacing != grid_spacing ||
+        block->version != TERRAIN_GRID_FORMAT_VERSION ||
+        block->crc != get_block_crc(*block)) {
+        return nullptr;
+    }
+    mmap_reader.set_checked(info.lat_degrees, info.lon_degrees, blocknum);
+    return block;
+}
+#endif // AP_TERRAIN_MMAP_ENABLED
+
+/*
+  index into the cache hint table for a block
+ */
+uint16_t AP_Terrain::cache_hint_index(int8_t lat_degrees, int16_t lon_degrees, uint16_t grid_idx_x, uint16_t grid_idx_y) const
+{
+    uint32_t h = uint8_t(lat_degrees);
+    h = h*65599U + uint16_t(lon_degrees);
+    h = h*65599U + grid_idx_x;
+    h = h*65599U + grid_idx_y;
+    return (h ^ (h >> 16)) & cache_hint_mask;
+}
+
+/*
+  find a grid in the cache, returning nullptr if not present
+ */
+AP_Terrain::grid_cache *AP_Terrain::lookup_grid_cache(const struct grid_info &info)
+{
+    uint16_t hint_idx = 0;
+    if (cache_hint != nullptr) {
+        hint_idx = cache_hint_index(info.lat_degrees, info.lon_degrees, info.grid_idx_x, info.grid_idx_y);
+        const uint8_t i = cache_hint[hint_idx];
+        if (i != 0 && i <= cache_size &&
+            TERRAIN_LATLON_EQUAL(cache[i-1].grid.lat,info.grid_lat) &&
+            TERRAIN_LATLON_EQUAL(cache[i-1].grid.lon,info.grid_lon) &&
+            cache[i-1].grid.spacing == grid_spacing) {
+            return &cache[i-1];
+        }
+    }
     for (uint16_t i=0; i<cache_size; i++) {
         if (TERRAIN_LATLON_EQUAL(cache[i].grid.lat,info.grid_lat) &&
             TERRAIN_LATLON_EQUAL(cache[i].grid.lon,info.grid_lon) &&
             cache[i].grid.spacing == grid_spacing) {
-            cache[i].last_access_ms = now_ms;
-            return cache[i];
+            if (cache_hint != nullptr) {
+                cache_hint[hint_idx] = i+1;
+            }
+            return &cache[i];
         }
-        if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
+    }
+    return nullptr;
+}
+
+/*
+  return the least recently used grid in the cache
+ */
+AP_Terrain::grid_cache &AP_Terrain::lru_grid_cache(void)
+{
+    uint16_t oldest_i = 0;
+    for (uint16_t i=1; i<cache_size; i++) {
+        if (cache[i].last_access < cache[oldest_i].last_access) {
             oldest_i = i;
         }
     }
+    return cache[oldest_i];
+}
 
-    // Not found. Use the oldest grid and make it this grid,
-    // initially unpopulated
-    struct grid_cache &grid = cache[oldest_i];
+/*
+  reuse a cache entry for a new grid, marking it as waiting for a
+  disk read
+ */
+void AP_Terrain::claim_grid_cache(struct grid_cache &grid, const struct grid_info &info)
+{
     memset(&grid, 0, sizeof(grid));
 
     grid.grid.lat = info.grid_lat;
@@ -135,12 +255,14 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     grid.grid.lat_degrees = info.lat_degrees;
     grid.grid.lon_degrees = info.lon_degrees;
     grid.grid.version = TERRAIN_GRID_FORMAT_VERSION;
-    grid.last_access_ms = now_ms;
+    grid.last_access = ++access_seq;
 
     // mark as waiting for disk read
     grid.state = GRID_CACHE_DISKWAIT;
 
-    return grid;
+    if (cache_hint != nullptr) {
+        cache_hint[cache_hint_index(info.lat_degrees, info.lon_degrees, info.grid_idx_x, info.grid_idx_y)] = (&grid - cache) + 1;
+    }
 }
 
 /*
@@ -169,13 +291,17 @@ int16_t AP_Terrain::find_io_idx(enum GridCacheState state)
 /*
   get CRC for a block
  */
-uint16_t AP_Terrain::get_block_crc(struct grid_block &block)
+uint16_t AP_Terrain::get_block_crc(const struct grid_block &block) const
 {
-    uint16_t saved_crc = block.crc;
-    block.crc = 0;
-    uint16_t ret = crc16_ccitt((const uint8_t *)&block, sizeof(block), 0);
-    block.crc = saved_crc;
-    return ret;
+    // the crc is taken with the crc field zero. The block may be in
+    // read-only memory so checksum around the field
+    const uint8_t *b = (const uint8_t *)&block;
+    const uint8_t zero[sizeof(block.crc)] {};
+    const uint32_t crc_ofs = offsetof(struct grid_block, crc);
+    const uint32_t tail_ofs = crc_ofs + sizeof(block.crc);
+    uint16_t ret = crc16_ccitt(b, crc_ofs, 0);
+    ret = crc16_ccitt(zero, sizeof(zero), ret);
+    return crc16_ccitt(&b[tail_ofs], sizeof(block) - tail_ofs, ret);
 }
 
 #endif // AP_TERRAIN_AVAILABLE
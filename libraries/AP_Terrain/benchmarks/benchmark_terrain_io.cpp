@@ -0,0 +1,131 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Terrain/AP_Terrain.h>
+
+#if AP_TERRAIN_MMAP_ENABLED
+
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  compare random height lookups over a large area using seek+read of
+  grid blocks, as the terrain IO thread does, against using the blocks
+  in place from a memory mapped DAT file
+ */
+
+// on-disk layout of a grid block, see AP_Terrain::grid_block
+struct PACKED bench_block {
+    uint64_t bitmap;
+    int32_t lat;
+    int32_t lon;
+    uint16_t crc;
+    uint16_t version;
+    uint16_t spacing;
+    int16_t height[TERRAIN_GRID_BLOCK_SIZE_X][TERRAIN_GRID_BLOCK_SIZE_Y];
+    uint16_t grid_idx_x;
+    uint16_t grid_idx_y;
+    int16_t lon_degrees;
+    int8_t lat_degrees;
+};
+
+union bench_io_block {
+    struct bench_block block;
+    uint8_t buffer[2048];
+};
+
+// 16k blocks, a 32MB file covering roughly a 1 degree square at 100m spacing
+static const uint32_t num_blocks = 16384;
+static char dat_dir[64];
+static char dat_path[80];
+
+static void create_dat_file(void)
+{
+    if (dat_path[0] != 0) {
+        return;
+    }
+    strcpy(dat_dir, "/tmp/terrain_benchXXXXXX");
+    if (mkdtemp(dat_dir) == nullptr) {
+        AP_HAL::panic("mkdtemp failed");
+    }
+    snprintf(dat_path, sizeof(dat_path), "%s/N00E000.DAT", dat_dir);
+    FILE *f = fopen(dat_path, "w");
+    if (f == nullptr) {
+        AP_HAL::panic("create %s failed", dat_path);
+    }
+    union bench_io_block b {};
+    for (uint32_t i=0; i<num_blocks; i++) {
+        b.block.grid_idx_x = i / 128;
+        b.block.grid_idx_y = i % 128;
+        for (uint8_t x=0; x<TERRAIN_GRID_BLOCK_SIZE_X; x++) {
+            for (uint8_t y=0; y<TERRAIN_GRID_BLOCK_SIZE_Y; y++) {
+                b.block.height[x][y] = (i + x * y) % 3000;
+            }
+        }
+        fwrite(&b, sizeof(b), 1, f);
+    }
+    fclose(f);
+}
+
+// height at a random point within a block
+static float interpolate(const struct bench_block &block, uint32_t r)
+{
+    const uint8_t idx_x = r % (TERRAIN_GRID_BLOCK_SIZE_X-1);
+    const uint8_t idx_y = (r >> 8) % (TERRAIN_GRID_BLOCK_SIZE_Y-1);
+    const float frac_x = ((r >> 16) & 0xFF) / 256.0f;
+    const float frac_y = (r >> 24) / 256.0f;
+    const float avg1 = (1.0f-frac_x) * block.height[idx_x][idx_y]   + frac_x * block.height[idx_x+1][idx_y];
+    const float avg2 = (1.0f-frac_x) * block.height[idx_x][idx_y+1] + frac_x * block.height[idx_x+1][idx_y+1];
+    return (1.0f-frac_y) * avg1 + frac_y * avg2;
+}
+
+static void BM_TerrainHeightRead(benchmark::State& state)
+{
+    create_dat_file();
+    const int fd = AP::FS().open(dat_path, O_RDONLY);
+    if (fd == -1) {
+        AP_HAL::panic("open %s failed", dat_path);
+    }
+    union bench_io_block b;
+    uint32_t r = 1;
+
+    while (state.KeepRunning()) {
+        r = r * 1664525U + 1013904223U;
+        const uint32_t file_offset = (r % num_blocks) * sizeof(b);
+        AP::FS().lseek(fd, file_offset, SEEK_SET);
+        AP::FS().read(fd, &b, sizeof(b));
+        float height = interpolate(b.block, r);
+        gbenchmark_escape(&height);
+    }
+
+    AP::FS().close(fd);
+}
+
+static void BM_TerrainHeightMmap(benchmark::State& state)
+{
+    create_dat_file();
+    AP_Terrain_Mmap reader{sizeof(union bench_io_block)};
+    reader.set_directory(dat_dir);
+    uint32_t r = 1;
+
+    while (state.KeepRunning()) {
+        r = r * 1664525U + 1013904223U;
+        bool checked;
+        const uint8_t *p = reader.find(0, 0, r % num_blocks, checked);
+        if (p == nullptr) {
+            AP_HAL::panic("mmap of %s failed", dat_path);
+        }
+        float height = interpolate(((const union bench_io_block *)p)->block, r);
+        gbenchmark_escape(&height);
+    }
+}
+
+BENCHMARK(BM_TerrainHeightRead);
+BENCHMARK(BM_TerrainHeightMmap);
+#endif
+
+BENCHMARK_MAIN()
@@ -15,3 +15,11 @@
  #endif // HAL_PROGRAM_SIZE_LIMIT_KB
  #endif // AP_FILTER_NUM_FILTERS
 #endif // AP_FILTER_ENABLED
+
+// apply harmonic notch filters using a packed copy of the filter
+// coefficients and state, with the axes processed together. This
+// needs a vector FPU to be faster, and costs RAM for each filter, so
+// is off on ChibiOS boards unless a board enables it
+#ifndef AP_FILTER_HNF_PACKED_ENABLED
+#define AP_FILTER_HNF_PACKED_ENABLED (CONFIG_HAL_BOARD != HAL_BOARD_CHIBIOS)
+#endif
@@ -148,12 +148,70 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
     AP_GROUPEND
 };
 
+#if AP_FILTER_HNF_PACKED_ENABLED
+/*
+  four float lanes processed together. GCC generic vectors map onto
+  SSE or NEON registers where the target has them and are lowered to
+  scalar code where it doesn't. The alignment is reduced to that of a
+  float so arrays of them can come from the normal allocator
+ */
+typedef float hnf_lanes __attribute__((vector_size(16), aligned(4)));
+
+static inline hnf_lanes to_lanes(const float &v)
+{
+    const hnf_lanes ret = { v, 0, 0, 0 };
+    return ret;
+}
+
+static inline hnf_lanes to_lanes(const Vector2f &v)
+{
+    const hnf_lanes ret = { v.x, v.y, 0, 0 };
+    return ret;
+}
+
+static inline hnf_lanes to_lanes(const Vector3f &v)
+{
+    const hnf_lanes ret = { v.x, v.y, v.z, 0 };
+    return ret;
+}
+
+static inline void from_lanes(const hnf_lanes &l, float &v)
+{
+    v = l[0];
+}
+
+static inline void from_lanes(const hnf_lanes &l, Vector2f &v)
+{
+    v.x = l[0];
+    v.y = l[1];
+}
+
+static inline void from_lanes(const hnf_lanes &l, Vector3f &v)
+{
+    v.x = l[0];
+    v.y = l[1];
+    v.z = l[2];
+}
+
+template <class T>
+struct HarmonicNotchFilter<T>::packed_notch {
+    // previous two inputs and outputs
+    hnf_lanes x1, x2, y1, y2;
+    float b0, b1, b2, a1, a2;
+    bool initialised;
+    bool need_reset;
+};
+#endif // AP_FILTER_HNF_PACKED_ENABLED
+
 /*
   destroy all of the associated notch filters
  */
 template <class T>
 HarmonicNotchFilter<T>::~HarmonicNotchFilter() {
     delete[] _filters;
+#if AP_FILTER_HNF_PACKED_ENABLED
+    delete[] _packed;
+#endif
     _num_filters = 0;
     _num_enabled_filters = 0;
 }
@@ -223,6 +281,12 @@ void HarmonicNotchFilter<T>::allocate_filters(uint8_t num_notches, uint32_t harm
             GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "Failed to allocate %u bytes for notch filter", (unsigned int)(_num_filters * sizeof(NotchFilter<T>)));
             _num_filters = 0;
         }
+#if AP_FILTER_HNF_PACKED_ENABLED
+        if (_filters != nullptr) {
+            // if this fails we fall back to applying the NotchFilters
+            _packed = NEW_NOTHROW packed_notch[_num_filters];
+        }
+#endif
     }
 }
 
@@ -249,6 +313,21 @@ void HarmonicNotchFilter<T>::expand_filter_count(uint16_t total_notches)
         _alloc_has_failed = true;
         return;
     }
+#if AP_FILTER_HNF_PACKED_ENABLED
+    packed_notch *packed = nullptr;
+    if (_packed != nullptr) {
+        packed = NEW_NOTHROW packed_notch[total_notches];
+        if (packed == nullptr) {
+            delete[] filters;
+            _alloc_has_failed = true;
+            return;
+        }
+        memcpy(packed, _packed, sizeof(packed[0])*_num_filters);
+    }
+    auto _old_packed = _packed;
+    _packed = packed;
+    delete[] _old_packed;
+#endif
     memcpy(filters, _filters, sizeof(filters[0])*_num_filters);
     auto _old_filters = _filters;
     _filters = filters;
@@ -387,8 +466,32 @@ void HarmonicNotchFilter<T>::update(uint8_t num_centers, const float center_freq
             set_center_frequency(_num_enabled_filters++, notch_center, 1.0 + _notch_spread, harmonic_mul);
         }
     }
+
+#if AP_FILTER_HNF_PACKED_ENABLED
+    pack_filters();
+#endif
 }
 
+#if AP_FILTER_HNF_PACKED_ENABLED
+template <class T>
+void HarmonicNotchFilter<T>::pack_filters(void)
+{
+    if (_packed == nullptr) {
+        return;
+    }
+    for (uint16_t i = 0; i < _num_enabled_filters; i++) {
+        const auto &f = _filters[i];
+        auto &p = _packed[i];
+        p.b0 = f.b0;
+        p.b1 = f.b1;
+        p.b2 = f.b2;
+        p.a1 = f.a1;
+        p.a2 = f.a2;
+        p.initialised = f.initialised;
+    }
+}
+#endif
+
 /*
   apply a sample to each of the underlying filters in turn and return the output
  */
@@ -406,6 +509,40 @@ T HarmonicNotchFilter<T>::apply(const T &sample)
     }
 #endif
 
+#if AP_FILTER_HNF_PACKED_ENABLED && !NOTCH_DEBUG_LOGGING
+    if (_packed != nullptr) {
+        /*
+          the same calculation as NotchFilter::apply() on all axes at
+          once, with the operations in the same order so the result
+          is unchanged
+         */
+        hnf_lanes v = to_lanes(sample);
+        for (uint16_t i = 0; i < _num_enabled_filters; i++) {
+            auto &p = _packed[i];
+            if (!p.initialised || p.need_reset) {
+                // pass the sample through and start the filter from it
+                p.x1 = p.x2 = p.y1 = p.y2 = v;
+                if (p.need_reset) {
+                    p.need_reset = false;
+                    // init_with_A_and_Q() doesn't slew limit the
+                    // center frequency until the reset is done
+                    _filters[i].need_reset = false;
+                }
+                continue;
+            }
+            const hnf_lanes out = v*p.b0 + p.x1*p.b1 + p.x2*p.b2 - p.y1*p.a1 - p.y2*p.a2;
+            p.x2 = p.x1;
+            p.x1 = v;
+            p.y2 = p.y1;
+            p.y1 = out;
+            v = out;
+        }
+        T output;
+        from_lanes(v, output);
+        return output;
+    }
+#endif
+
     T output = sample;
     for (uint16_t i = 0; i < _num_enabled_filters; i++) {
 #if NOTCH_DEBUG_LOGGING
@@ -437,6 +574,11 @@ void HarmonicNotchFilter<T>::reset()
 
     for (uint16_t i = 0; i < _num_filters; i++) {
         _filters[i].reset();
+#if AP_FILTER_HNF_PACKED_ENABLED
+        if (_packed != nullptr) {
+            _packed[i].need_reset = true;
+        }
+#endif
     }
 }
 
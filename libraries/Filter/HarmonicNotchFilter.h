@@ -18,6 +18,7 @@
 #include <cmath>
 #include <AP_Param/AP_Param.h>
 #include "NotchFilter.h"
+#include "AP_Filter_config.h"
 
 #define HNF_MAX_HARMONICS 16
 
@@ -62,6 +63,17 @@ public:
 private:
     // underlying bank of notch filters
     NotchFilter<T>*  _filters;
+#if AP_FILTER_HNF_PACKED_ENABLED
+    /*
+      packed copy of the coefficients and state of each filter, so
+      the cascade can be applied without stepping through the
+      NotchFilter objects and with all axes of a sample at once
+     */
+    struct packed_notch;
+    packed_notch *_packed;
+    // copy the coefficients of the enabled filters into _packed
+    void pack_filters(void);
+#endif
     // sample frequency for each filter
     float _sample_freq_hz;
     // base double notch bandwidth for each filter
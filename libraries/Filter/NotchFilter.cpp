@@ -25,6 +25,17 @@ const static float NOTCH_MAX_SLEW       = 0.05f;
 const static float NOTCH_MAX_SLEW_LOWER = 1.0f - NOTCH_MAX_SLEW;
 const static float NOTCH_MAX_SLEW_UPPER = 1.0f / NOTCH_MAX_SLEW_LOWER;
 
+/*
+  largest change in center frequency, in radians per sample, that is
+  applied incrementally to the sin and cos of the center frequency and
+  the number of incremental changes before they are recalculated in
+  full. With the series in update_trig() the truncation error per
+  step is below 1e-7 and the rounding errors over the resync period
+  keep the center frequency within 1e-5 radians per sample
+ */
+const static float NOTCH_TRIG_MAX_DELTA = 0.2f;
+const static uint8_t NOTCH_TRIG_RESYNC = 64;
+
 /*
    calculate the attenuation and quality factors of the filter
  */
@@ -74,15 +85,20 @@ void NotchFilter<T>::init_with_A_and_Q(float sample_freq_hz, float center_freq_h
     }
 
     if (is_positive(new_center_freq) && (new_center_freq < 0.5 * sample_freq_hz) && (Q > 0.0)) {
-        float omega = 2.0 * M_PI * new_center_freq / sample_freq_hz;
-        float alpha = sinf(omega) / (2 * Q);
-        b0 =  1.0 + alpha*sq(A);
-        b1 = -2.0 * cosf(omega);
-        b2 =  1.0 - alpha*sq(A);
+        const float omega = M_2PI * new_center_freq / sample_freq_hz;
+        if (initialised && is_equal(sample_freq_hz, _sample_freq_hz)) {
+            update_trig(omega, M_2PI * (new_center_freq - _center_freq_hz) / sample_freq_hz);
+        } else {
+            update_trig(omega, NOTCH_TRIG_MAX_DELTA*2);
+        }
+        float alpha = _sin_omega / (2 * Q);
+        b0 =  1.0f + alpha*sq(A);
+        b1 = -2.0f * _cos_omega;
+        b2 =  1.0f - alpha*sq(A);
         a1 = b1;
-        a2 =  1.0 - alpha;
+        a2 =  1.0f - alpha;
 
-        const float a0_inv =  1.0/(1.0 + alpha);
+        const float a0_inv =  1.0f/(1.0f + alpha);
 
         // Pre-multiply to save runtime calc
         b0 *= a0_inv;
@@ -101,6 +117,41 @@ void NotchFilter<T>::init_with_A_and_Q(float sample_freq_hz, float center_freq_h
     }
 }
 
+/*
+  update _sin_omega and _cos_omega for a new center frequency of omega
+  radians per sample, which is delta_omega from the previous center
+  frequency. Small changes are applied by rotating through
+  delta_omega, which avoids calling sinf() and cosf() for every notch
+  each time the notch frequencies are updated
+ */
+template <class T>
+void NotchFilter<T>::update_trig(float omega, float delta_omega)
+{
+    if (is_zero(delta_omega) && _trig_updates > 0) {
+        return;
+    }
+    if (fabsf(delta_omega) > NOTCH_TRIG_MAX_DELTA || _trig_updates >= NOTCH_TRIG_RESYNC || _trig_updates == 0) {
+        _sin_omega = sinf(omega);
+        _cos_omega = cosf(omega);
+        _trig_updates = 1;
+        return;
+    }
+
+    // series for sin and cos of delta_omega, accurate to 1e-7 for |delta_omega| <= 0.2
+    const float d2 = sq(delta_omega);
+    const float sin_d = delta_omega * (1.0f - d2 * (1.0f/6.0f) * (1.0f - d2 * (1.0f/20.0f)));
+    const float cos_d = 1.0f - d2 * 0.5f * (1.0f - d2 * (1.0f/12.0f) * (1.0f - d2 * (1.0f/30.0f)));
+
+    const float s = _sin_omega * cos_d + _cos_omega * sin_d;
+    const float c = _cos_omega * cos_d - _sin_omega * sin_d;
+
+    // one newton step to bring the magnitude back to one
+    const float scale = 1.5f - 0.5f * (sq(s) + sq(c));
+    _sin_omega = s * scale;
+    _cos_omega = c * scale;
+    _trig_updates++;
+}
+
 /*
   apply a new input sample, returning new output
  */
@@ -57,6 +57,13 @@ protected:
     float b0, b1, b2, a1, a2;
     float _center_freq_hz, _sample_freq_hz, _A;
     T ntchsig1, ntchsig2, signal2, signal1;
+
+    // sin and cos of the center frequency in radians per sample, updated
+    // incrementally as the center frequency moves
+    float _sin_omega, _cos_omega;
+    // number of incremental updates since sin and cos were last calculated in full
+    uint8_t _trig_updates;
+    void update_trig(float omega, float delta_omega);
 };
 
 /*
@@ -0,0 +1,133 @@
+#include <AP_gbenchmark.h>
+
+#include <Filter/Filter.h>
+#include <Filter/LowPassFilter.h>
+#include <Filter/LowPassFilter2p.h>
+#include <Filter/NotchFilter.h>
+#include <Filter/DerivativeFilter.h>
+#include <Filter/ModeFilter.h>
+#include <Filter/SlewLimiter.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  per-sample cost of the filters used at gyro and loop rate. See
+  benchmark_harmonic_notch.cpp for the harmonic notch
+ */
+
+static const float rate_hz = 8000;
+
+static float test_sample(float, uint32_t i) { return sinf(i * 0.01); }
+static Vector3f test_sample(Vector3f, uint32_t i) { return Vector3f(sinf(i * 0.01), cosf(i * 0.01), 0.5); }
+
+// a set of samples so the filter input changes but we don't time generating it
+template <class T>
+struct test_samples {
+    test_samples() {
+        for (uint16_t i=0; i<ARRAY_SIZE(v); i++) {
+            v[i] = test_sample(T(), i);
+        }
+    }
+    const T &operator[](uint32_t i) const { return v[i & (ARRAY_SIZE(v)-1)]; }
+    T v[256];
+};
+
+template <class T>
+static void BM_LowPassFilter2p(benchmark::State& state)
+{
+    const test_samples<T> samples;
+    LowPassFilter2p<T> filter(rate_hz, 80);
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        T v = filter.apply(samples[i++]);
+        gbenchmark_escape(&v);
+    }
+}
+
+template <class T>
+static void BM_LowPassFilterConstDt(benchmark::State& state)
+{
+    const test_samples<T> samples;
+    LowPassFilterConstDt<T> filter(rate_hz, 20);
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        T v = filter.apply(samples[i++]);
+        gbenchmark_escape(&v);
+    }
+}
+
+template <class T>
+static void BM_LowPassFilter(benchmark::State& state)
+{
+    const test_samples<T> samples;
+    LowPassFilter<T> filter(20);
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        T v = filter.apply(samples[i++], 1.0 / rate_hz);
+        gbenchmark_escape(&v);
+    }
+}
+
+template <class T>
+static void BM_NotchFilter(benchmark::State& state)
+{
+    const test_samples<T> samples;
+    NotchFilter<T> filter {};
+    filter.init(rate_hz, 80, 40, 40);
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        T v = filter.apply(samples[i++]);
+        gbenchmark_escape(&v);
+    }
+}
+
+static void BM_DerivativeFilter(benchmark::State& state)
+{
+    const test_samples<float> samples;
+    DerivativeFilterFloat_Size7 filter;
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        filter.update(samples[i], i * 10);
+        i++;
+        float v = filter.slope();
+        gbenchmark_escape(&v);
+    }
+}
+
+static void BM_ModeFilter(benchmark::State& state)
+{
+    const test_samples<float> samples;
+    ModeFilterFloat_Size5 filter(2);
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        float v = filter.apply(samples[i++]);
+        gbenchmark_escape(&v);
+    }
+}
+
+static void BM_SlewLimiter(benchmark::State& state)
+{
+    const test_samples<float> samples;
+    const float slew_rate_max = 25;
+    const float slew_rate_tau = 1;
+    SlewLimiter limiter(slew_rate_max, slew_rate_tau);
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        float v = limiter.modifier(samples[i++], 1.0 / 400);
+        gbenchmark_escape(&v);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_LowPassFilter2p, float);
+BENCHMARK_TEMPLATE(BM_LowPassFilter2p, Vector3f);
+BENCHMARK_TEMPLATE(BM_LowPassFilterConstDt, float);
+BENCHMARK_TEMPLATE(BM_LowPassFilterConstDt, Vector3f);
+BENCHMARK_TEMPLATE(BM_LowPassFilter, float);
+BENCHMARK_TEMPLATE(BM_LowPassFilter, Vector3f);
+BENCHMARK_TEMPLATE(BM_NotchFilter, float);
+BENCHMARK_TEMPLATE(BM_NotchFilter, Vector3f);
+BENCHMARK(BM_DerivativeFilter);
+BENCHMARK(BM_ModeFilter);
+BENCHMARK(BM_SlewLimiter);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,104 @@
+#include <AP_gbenchmark.h>
+
+#include <Filter/NotchFilter.h>
+#include <Filter/HarmonicNotchFilter.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  per-sample cost of a gyro harmonic notch with triple notches on
+  three harmonics, for state.range(0) frequency sources
+ */
+
+static const float rate_hz = 8000;
+static const uint32_t harmonics = 0x7;
+
+static float test_sample(float) { return 0.1; }
+static Vector3f test_sample(Vector3f) { return Vector3f(0.1, -0.2, 0.3); }
+
+template <class T>
+static void BM_HarmonicNotch(benchmark::State& state)
+{
+    const uint8_t num_sources = state.range(0);
+    HarmonicNotchFilterParams params {};
+    params.set_options(uint16_t(HarmonicNotchFilterParams::Options::TripleNotch));
+    params.set_center_freq_hz(80);
+    params.set_bandwidth_hz(40);
+    params.set_attenuation(40);
+    params.set_freq_min_ratio(1.0);
+
+    HarmonicNotchFilter<T> filter {};
+    filter.allocate_filters(num_sources, harmonics, params.num_composite_notches());
+    filter.init(rate_hz, params);
+    float centers[12];
+    for (uint8_t i=0; i<num_sources; i++) {
+        centers[i] = 90 + 10 * i;
+    }
+    filter.update(num_sources, centers);
+
+    T sample = test_sample(T());
+    while (state.KeepRunning()) {
+        sample = filter.apply(sample);
+        gbenchmark_escape(&sample);
+    }
+}
+
+/*
+  the same notches applied one NotchFilter at a time for comparison
+ */
+static void BM_NotchFilterChainVector3f(benchmark::State& state)
+{
+    const uint8_t num_sources = state.range(0);
+    const uint16_t num_filters = num_sources * 3 * 3;
+    float A, Q;
+    NotchFilter<Vector3f>::calculate_A_and_Q(80, 40/3.0, 40, A, Q);
+    NotchFilter<Vector3f> filters[4*3*3] {};
+    for (uint16_t i=0; i<num_filters; i++) {
+        filters[i].init_with_A_and_Q(rate_hz, 90 + 5 * i, A, Q);
+    }
+
+    Vector3f sample { 0.1, -0.2, 0.3 };
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<num_filters; i++) {
+            sample = filters[i].apply(sample);
+        }
+        gbenchmark_escape(&sample);
+    }
+}
+
+/*
+  cost of moving the notch frequencies, as happens every loop with
+  RPM, ESC telemetry or FFT tracking, for state.range(0) sources
+ */
+static void BM_HarmonicNotchUpdate(benchmark::State& state)
+{
+    const uint8_t num_sources = state.range(0);
+    HarmonicNotchFilterParams params {};
+    params.set_options(uint16_t(HarmonicNotchFilterParams::Options::TripleNotch));
+    params.set_center_freq_hz(80);
+    params.set_bandwidth_hz(40);
+    params.set_attenuation(40);
+    params.set_freq_min_ratio(1.0);
+
+    HarmonicNotchFilter<Vector3f> filter {};
+    filter.allocate_filters(num_sources, harmonics, params.num_composite_notches());
+    filter.init(rate_hz, params);
+
+    float centers[12];
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        // small changes in frequency as the motors change speed
+        for (uint8_t i=0; i<num_sources; i++) {
+            centers[i] = 90 + 10 * i + 0.1 * (n & 0xF);
+        }
+        n++;
+        filter.update(num_sources, centers);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_HarmonicNotch, float)->Arg(1)->Arg(4)->Arg(12);
+BENCHMARK_TEMPLATE(BM_HarmonicNotch, Vector3f)->Arg(1)->Arg(4)->Arg(12);
+BENCHMARK(BM_NotchFilterChainVector3f)->Arg(1)->Arg(4);
+BENCHMARK(BM_HarmonicNotchUpdate)->Arg(1)->Arg(4)->Arg(12);
+
+BENCHMARK_MAIN();
@@ -363,4 +363,109 @@ TEST(NotchFilterTest, HarmonicNotchTest5)
     fclose(f);
 }
 
+/*
+  check a Vector3f harmonic notch gives the same output as applying
+  each of its notches in turn with NotchFilter, including while the
+  center frequency moves and across a reset
+ */
+TEST(NotchFilterTest, HarmonicNotchVector3fTest)
+{
+    const float rate_hz = 2000;
+    const float base_freq = 80;
+    const float bandwidth = 40;
+    const float attenuation_dB = 40;
+    const uint32_t harmonics = 3;
+    const uint8_t composite_notches = 3;
+    const float spread = bandwidth / (32 * base_freq);
+    const float spread_mul[composite_notches] { 1.0, 1.0 - spread, 1.0 + spread };
+
+    HarmonicNotchFilterParams notch_params {};
+    notch_params.set_options(uint16_t(HarmonicNotchFilterParams::Options::TripleNotch));
+    notch_params.set_attenuation(attenuation_dB);
+    notch_params.set_bandwidth_hz(bandwidth);
+    notch_params.set_center_freq_hz(base_freq);
+    notch_params.set_freq_min_ratio(1.0);
+
+    HarmonicNotchFilter<Vector3f> filter {};
+    filter.allocate_filters(1, harmonics, composite_notches);
+    filter.init(rate_hz, notch_params);
+
+    float A, Q;
+    NotchFilter<Vector3f>::calculate_A_and_Q(base_freq, bandwidth / composite_notches, attenuation_dB, A, Q);
+    NotchFilter<Vector3f> reference[2*composite_notches] {};
+
+    for (uint32_t s=0; s<4000; s++) {
+        // sweep the source frequency up and back down, staying above
+        // the minimum frequency where the notch attenuation is reduced
+        const float source_freq = base_freq + 20 * (1 - cosf(s * 0.002));
+        filter.update(source_freq);
+        for (uint8_t h=0; h<2; h++) {
+            for (uint8_t c=0; c<composite_notches; c++) {
+                float center = source_freq * (h+1);
+                center *= spread_mul[c];
+                reference[h*composite_notches+c].init_with_A_and_Q(rate_hz, center, A, Q);
+            }
+        }
+        if (s == 2500) {
+            filter.reset();
+            for (auto &r : reference) {
+                r.reset();
+            }
+        }
+
+        const double t = s / rate_hz;
+        const Vector3f sample { float(sin(t * 2 * M_PI * 90)),
+                                float(0.5 * sin(t * 2 * M_PI * 170) + 0.1),
+                                float(0.3 * sin(t * 2 * M_PI * 45) - 0.2 * sin(t * 2 * M_PI * 250)) };
+        Vector3f expected = sample;
+        for (auto &r : reference) {
+            expected = r.apply(expected);
+        }
+        const Vector3f v = filter.apply(sample);
+        EXPECT_NEAR(v.x, expected.x, 1.0e-5);
+        EXPECT_NEAR(v.y, expected.y, 1.0e-5);
+        EXPECT_NEAR(v.z, expected.z, 1.0e-5);
+    }
+}
+
+/*
+  access to the center frequency used for the coefficients of a notch filter
+ */
+class NotchFilterOmega : public NotchFilter<float> {
+public:
+    // error in the center frequency used for the coefficients in radians per sample
+    double omega_error() const {
+        const double omega = 2 * M_PI * double(_center_freq_hz) / _sample_freq_hz;
+        return fabs(atan2(_sin_omega, _cos_omega) - omega);
+    }
+};
+
+/*
+  check that the notch frequency stays accurate when the center
+  frequency is moved in small steps for a long time, as it is for
+  dynamic harmonic notches
+ */
+TEST(NotchFilterTest, FrequencyUpdateTest)
+{
+    const float rates_hz[] { 1000, 2000, 8000 };
+    for (const float rate_hz : rates_hz) {
+        float A, Q;
+        NotchFilter<float>::calculate_A_and_Q(80, 40, 40, A, Q);
+        NotchFilterOmega filter {};
+        uint32_t seed = 1;
+        float freq = 80;
+        double max_err = 0;
+        for (uint32_t i=0; i<100000; i++) {
+            // random walk between 20Hz and 400Hz in steps of up to 2%
+            seed = seed * 1664525U + 1013904223U;
+            const float step = ((seed >> 8) / float(1U<<24) - 0.5) * 0.04;
+            freq = constrain_float(freq * (1 + step), 20, 400);
+            filter.init_with_A_and_Q(rate_hz, freq, A, Q);
+            max_err = MAX(max_err, filter.omega_error());
+        }
+        ::printf("rate %.0fHz max frequency error %.3gHz\n", rate_hz, max_err * rate_hz / (2 * M_PI));
+        EXPECT_LE(max_err, 1.0e-5);
+    }
+}
+
 AP_GTEST_MAIN()
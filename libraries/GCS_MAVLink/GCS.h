@@ -14,6 +14,7 @@
 #include <AP_Mission/AP_Mission.h>
 #include <stdint.h>
 #include "MAVLink_routing.h"
+#include "GCS_FTP_ReadAhead.h"
 #include <AP_RTC/JitterCorrection.h>
 #include <AP_Common/Bitmask.h>
 #include <AP_LTM_Telem/AP_LTM_Telem.h>
@@ -1029,15 +1030,32 @@ private:
         Write,
     };
 
+    struct ftp_session {
+        int fd = -1;
+        int16_t id = -1;        // session number chosen by the GCS, -1 if unused
+        FTP_FILE_MODE mode;     // work around AP_Filesystem not supporting file modes
+        uint32_t last_send_ms;  // time of last reply in this session
+        // throughput of the open file, logged when the session closes
+        uint32_t open_ms;       // time the file was opened
+        uint32_t bytes_sent;    // file data sent in read replies
+        uint32_t packets_sent;  // replies sent
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+        GCS_FTP_ReadAhead *read_ahead; // null if the file is read directly
+#endif
+    };
+
     struct ftp_state {
         ObjectBuffer<pending_ftp> *requests;
 
-        // session specific info, currently only support a single session over all links
-        int fd = -1;
-        FTP_FILE_MODE mode; // work around AP_Filesystem not supporting file modes
-        int16_t current_session;
+        // sessions over all links, each may have one file open
+        ftp_session sessions[AP_MAVLINK_FTP_MAX_SESSIONS];
         uint32_t last_send_ms;
         uint8_t need_banner_send_mask;
+
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+        // signalled when a session has a block to read ahead
+        HAL_BinarySemaphore *read_ahead_wake;
+#endif
     };
     static struct ftp_state ftp;
 
@@ -1046,11 +1064,20 @@ private:
     static int gen_dir_entry(char *dest, size_t space, const char * path, const struct dirent * entry); // FTP helper for emitting a dir response
     static void ftp_list_dir(struct pending_ftp &request, struct pending_ftp &response);
 
+    static ftp_session *ftp_find_session(uint8_t id);
+    static ftp_session *ftp_free_session(uint32_t now);
+    static void ftp_open_session(ftp_session &session, uint8_t id, int fd, FTP_FILE_MODE mode, bool read_ahead);
+    static void ftp_close_session(ftp_session &session);
+    static int32_t ftp_read(ftp_session &session, uint32_t offset, uint8_t *data, uint32_t len);
+
     bool ftp_init(void);
     void handle_file_transfer_protocol(const mavlink_message_t &msg);
     bool send_ftp_reply(const pending_ftp &reply);
     void ftp_worker(void);
     void ftp_push_replies(pending_ftp &reply);
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+    void ftp_read_ahead_worker(void);
+#endif
 #endif  // AP_MAVLINK_FTP_ENABLED
 
     void send_distance_sensor(const class AP_RangeFinder_Backend *sensor, const uint8_t instance) const;
@@ -26,6 +26,7 @@
 #include <AP_Filesystem/AP_Filesystem.h>
 #include <AP_HAL/utility/sparse-endian.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_Logger/AP_Logger.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -53,6 +54,17 @@ bool GCS_MAVLINK::ftp_init(void) {
         goto failed;
     }
 
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+    // files are read directly if the read ahead thread can't be started
+    ftp.read_ahead_wake = NEW_NOTHROW HAL_BinarySemaphore();
+    if (ftp.read_ahead_wake != nullptr &&
+        !hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&GCS_MAVLINK::ftp_read_ahead_worker, void),
+                                      "FTPR", 2048, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+        delete ftp.read_ahead_wake;
+        ftp.read_ahead_wake = nullptr;
+    }
+#endif
+
     if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&GCS_MAVLINK::ftp_worker, void),
                                       "FTP", 2560, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
         goto failed;
@@ -158,11 +170,23 @@ void GCS_MAVLINK::ftp_error(struct pending_ftp &response, FTP_ERROR error) {
 void GCS_MAVLINK::ftp_push_replies(pending_ftp &reply)
 {
     ftp.last_send_ms = AP_HAL::millis(); // Used to detect active FTP session
+    ftp_session *session = ftp_find_session(reply.session);
+    if (session != nullptr) {
+        session->last_send_ms = ftp.last_send_ms;
+    }
 
     while (!send_ftp_reply(reply)) {
         hal.scheduler->delay(2);
     }
 
+    if (session != nullptr) {
+        session->packets_sent++;
+        if (reply.opcode == FTP_OP::Ack &&
+            (reply.req_opcode == FTP_OP::ReadFile || reply.req_opcode == FTP_OP::BurstReadFile)) {
+            session->bytes_sent += reply.size;
+        }
+    }
+
     if (reply.req_opcode == FTP_OP::TerminateSession) {
         ftp.last_send_ms = 0;
     }
@@ -178,6 +202,140 @@ void GCS_MAVLINK::ftp_push_replies(pending_ftp &reply)
     }
 }
 
+// find the session with the given number, returns nullptr if there is none
+GCS_MAVLINK::ftp_session *GCS_MAVLINK::ftp_find_session(uint8_t id)
+{
+    for (auto &session : ftp.sessions) {
+        if (session.id == id) {
+            return &session;
+        }
+    }
+    return nullptr;
+}
+
+// find a session without an open file, closing sessions which have been idle for longer than the timeout
+// returns nullptr if all sessions are busy
+GCS_MAVLINK::ftp_session *GCS_MAVLINK::ftp_free_session(uint32_t now)
+{
+    for (auto &session : ftp.sessions) {
+        if (session.fd == -1) {
+            return &session;
+        }
+    }
+    for (auto &session : ftp.sessions) {
+        if (now - session.last_send_ms >= FTP_SESSION_TIMEOUT) {
+            // the old session has been idle for more than the timeout, force close it
+            ftp_close_session(session);
+            return &session;
+        }
+    }
+    return nullptr;
+}
+
+// take ownership of an open file for a session
+void GCS_MAVLINK::ftp_open_session(ftp_session &session, uint8_t id, int fd, FTP_FILE_MODE mode, bool read_ahead)
+{
+    session.fd = fd;
+    session.id = id;
+    session.mode = mode;
+    session.last_send_ms = AP_HAL::millis();
+    session.open_ms = session.last_send_ms;
+    session.bytes_sent = 0;
+    session.packets_sent = 0;
+
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+    if (read_ahead && mode == FTP_FILE_MODE::Read && ftp.read_ahead_wake != nullptr) {
+        if (session.read_ahead == nullptr) {
+            session.read_ahead = NEW_NOTHROW GCS_FTP_ReadAhead();
+            if (session.read_ahead != nullptr &&
+                !session.read_ahead->init(AP_MAVLINK_FTP_READ_AHEAD_SIZE, ftp.read_ahead_wake)) {
+                delete session.read_ahead;
+                session.read_ahead = nullptr;
+            }
+        }
+        if (session.read_ahead != nullptr) {
+            session.read_ahead->start(fd);
+        }
+    }
+#endif
+}
+
+// close a session's file and make the session available
+void GCS_MAVLINK::ftp_close_session(ftp_session &session)
+{
+    if (session.fd != -1) {
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+        if (session.read_ahead != nullptr) {
+            session.read_ahead->stop();
+        }
+#endif
+#if HAL_LOGGING_ENABLED
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+        if (session.read_ahead != nullptr) {
+            hits = session.read_ahead->hits();
+            misses = session.read_ahead->misses();
+        }
+#endif
+// @LoggerMessage: MFTP
+// @Description: MAVLink FTP session throughput, written when a session with an open file is closed
+// @Field: TimeUS: Time since system startup
+// @Field: Sess: session ID chosen by the GCS
+// @Field: Time: time the file was open
+// @Field: Bytes: file data sent in read replies
+// @Field: Pkts: replies sent
+// @Field: Hit: reads copied from a block already read ahead
+// @Field: Miss: reads which had to wait for a block to be read
+        AP::logger().Write("MFTP", "TimeUS,Sess,Time,Bytes,Pkts,Hit,Miss",
+                           "s#sb---", "F-C----", "QBIIIII",
+                           AP_HAL::micros64(),
+                           uint8_t(session.id),
+                           AP_HAL::millis() - session.open_ms,
+                           session.bytes_sent,
+                           session.packets_sent,
+                           hits,
+                           misses);
+#endif
+        AP::FS().close(session.fd);
+        session.fd = -1;
+    }
+    session.id = -1;
+}
+
+// read file data for a session, returns number of bytes read, 0 at end of file or -1 on error with errno set
+int32_t GCS_MAVLINK::ftp_read(ftp_session &session, uint32_t offset, uint8_t *data, uint32_t len)
+{
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+    if (session.read_ahead != nullptr && session.read_ahead->active()) {
+        return session.read_ahead->read(offset, data, len);
+    }
+#endif
+    if (AP::FS().lseek(session.fd, offset, SEEK_SET) == -1) {
+        return -1;
+    }
+    return AP::FS().read(session.fd, data, len);
+}
+
+#if AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+// read file data ahead of the FTP worker for all sessions
+void GCS_MAVLINK::ftp_read_ahead_worker(void)
+{
+    while (true) {
+        IGNORE_RETURN(ftp.read_ahead_wake->wait(100000));
+        bool busy = true;
+        while (busy) {
+            busy = false;
+            for (auto &session : ftp.sessions) {
+                if (session.read_ahead != nullptr && session.read_ahead->update()) {
+                    busy = true;
+                }
+            }
+        }
+    }
+}
+#endif
+
 void GCS_MAVLINK::ftp_worker(void) {
     pending_ftp request;
     pending_ftp reply = {};
@@ -215,28 +373,18 @@ void GCS_MAVLINK::ftp_worker(void) {
         }
 
         uint32_t now = AP_HAL::millis();
+        ftp_session *session = ftp_find_session(request.session);
 
         // check for session termination
-        if (request.session != ftp.current_session &&
+        if (session == nullptr &&
             (request.opcode == FTP_OP::TerminateSession || request.opcode == FTP_OP::ResetSessions)) {
             // terminating a different session, just ack
             reply.opcode = FTP_OP::Ack;
-        } else if (ftp.fd != -1 && request.session != ftp.current_session &&
-                   now - ftp.last_send_ms < FTP_SESSION_TIMEOUT) {
-            // if we have an open file and the session isn't right
-            // then reject. This prevents IO on the wrong file
+        } else if (session == nullptr && ftp_free_session(now) == nullptr) {
+            // if all sessions have an open file then reject. This
+            // prevents IO on the wrong file
             ftp_error(reply, FTP_ERROR::InvalidSession);
         } else {
-            if (ftp.fd != -1 &&
-                request.session != ftp.current_session &&
-                now - ftp.last_send_ms >= FTP_SESSION_TIMEOUT) {
-                // if a new session appears and the old session has
-                // been idle for more than the timeout then force
-                // close the old session
-                AP::FS().close(ftp.fd);
-                ftp.fd = -1;
-                ftp.current_session = -1;
-            }
             // dispatch the command as needed
             switch (request.opcode) {
                 case FTP_OP::None:
@@ -245,11 +393,9 @@ void GCS_MAVLINK::ftp_worker(void) {
                 case FTP_OP::TerminateSession:
                 case FTP_OP::ResetSessions:
                     // we already handled this, just listed for completeness
-                    if (ftp.fd != -1) {
-                        AP::FS().close(ftp.fd);
-                        ftp.fd = -1;
+                    if (session != nullptr) {
+                        ftp_close_session(*session);
                     }
-                    ftp.current_session = -1;
                     reply.opcode = FTP_OP::Ack;
                     break;
                 case FTP_OP::ListDirectory:
@@ -258,18 +404,22 @@ void GCS_MAVLINK::ftp_worker(void) {
                 case FTP_OP::OpenFileRO:
                     {
                         // only allow one file to be open per session
-                        if (ftp.fd != -1 && now - ftp.last_send_ms > FTP_SESSION_TIMEOUT) {
+                        if (session != nullptr && now - session->last_send_ms > FTP_SESSION_TIMEOUT) {
                             // no activity for 3s, assume client has
                             // timed out receiving open reply, close
                             // the file
-                            AP::FS().close(ftp.fd);
-                            ftp.fd = -1;
-                            ftp.current_session = -1;
+                            ftp_close_session(*session);
+                            session = nullptr;
                         }
-                        if (ftp.fd != -1) {
+                        if (session != nullptr) {
                             ftp_error(reply, FTP_ERROR::Fail);
                             break;
                         }
+                        session = ftp_free_session(now);
+                        if (session == nullptr) {
+                            ftp_error(reply, FTP_ERROR::NoSessionsAvailable);
+                            break;
+                        }
 
                         // sanity check that our the request looks well formed
                         if (!ftp_check_name_len(request)) {
@@ -288,13 +438,13 @@ void GCS_MAVLINK::ftp_worker(void) {
                         const size_t file_size = st.st_size;
 
                         // actually open the file
-                        ftp.fd = AP::FS().open((char *)request.data, O_RDONLY);
-                        if (ftp.fd == -1) {
+                        const int fd = AP::FS().open((char *)request.data, O_RDONLY);
+                        if (fd == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
                         }
-                        ftp.mode = FTP_FILE_MODE::Read;
-                        ftp.current_session = request.session;
+                        // virtual files starting with @ are generated as they are read so are not read ahead
+                        ftp_open_session(*session, request.session, fd, FTP_FILE_MODE::Read, request.data[0] != '@');
 
                         reply.opcode = FTP_OP::Ack;
                         reply.size = sizeof(uint32_t);
@@ -309,25 +459,19 @@ void GCS_MAVLINK::ftp_worker(void) {
                 case FTP_OP::ReadFile:
                     {
                         // must actually be working on a file
-                        if (ftp.fd == -1) {
+                        if (session == nullptr || session->fd == -1) {
                             ftp_error(reply, FTP_ERROR::FileNotFound);
                             break;
                         }
 
                         // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
+                        if ((session->mode != FTP_FILE_MODE::Read)) {
                             ftp_error(reply, FTP_ERROR::Fail);
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
-                        // fill the buffer
-                        const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data),request.size));
+                        // fill the buffer from the requested offset
+                        const ssize_t read_bytes = ftp_read(*session, request.offset, reply.data, MIN(sizeof(reply.data),request.size));
                         if (read_bytes == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
@@ -351,10 +495,15 @@ void GCS_MAVLINK::ftp_worker(void) {
                 case FTP_OP::CreateFile:
                     {
                         // only allow one file to be open per session
-                        if (ftp.fd != -1) {
+                        if (session != nullptr) {
                             ftp_error(reply, FTP_ERROR::Fail);
                             break;
                         }
+                        session = ftp_free_session(now);
+                        if (session == nullptr) {
+                            ftp_error(reply, FTP_ERROR::NoSessionsAvailable);
+                            break;
+                        }
 
                         // sanity check that our the request looks well formed
                         if (!ftp_check_name_len(request)) {
@@ -365,14 +514,13 @@ void GCS_MAVLINK::ftp_worker(void) {
                         request.data[sizeof(request.data) - 1] = 0; // ensure the path is null terminated
 
                         // actually open the file
-                        ftp.fd = AP::FS().open((char *)request.data,
-                                               (request.opcode == FTP_OP::CreateFile) ? O_WRONLY|O_CREAT|O_TRUNC : O_WRONLY);
-                        if (ftp.fd == -1) {
+                        const int fd = AP::FS().open((char *)request.data,
+                                                     (request.opcode == FTP_OP::CreateFile) ? O_WRONLY|O_CREAT|O_TRUNC : O_WRONLY);
+                        if (fd == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
                         }
-                        ftp.mode = FTP_FILE_MODE::Write;
-                        ftp.current_session = request.session;
+                        ftp_open_session(*session, request.session, fd, FTP_FILE_MODE::Write, false);
 
                         reply.opcode = FTP_OP::Ack;
                         break;
@@ -380,25 +528,25 @@ void GCS_MAVLINK::ftp_worker(void) {
                 case FTP_OP::WriteFile:
                     {
                         // must actually be working on a file
-                        if (ftp.fd == -1) {
+                        if (session == nullptr || session->fd == -1) {
                             ftp_error(reply, FTP_ERROR::FileNotFound);
                             break;
                         }
 
                         // must have the file in write mode
-                        if ((ftp.mode != FTP_FILE_MODE::Write)) {
+                        if ((session->mode != FTP_FILE_MODE::Write)) {
                             ftp_error(reply, FTP_ERROR::Fail);
                             break;
                         }
 
                         // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
+                        if (AP::FS().lseek(session->fd, request.offset, SEEK_SET) == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
                         }
 
                         // fill the buffer
-                        const ssize_t write_bytes = AP::FS().write(ftp.fd, request.data, request.size);
+                        const ssize_t write_bytes = AP::FS().write(session->fd, request.data, request.size);
                         if (write_bytes == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
@@ -474,23 +622,17 @@ void GCS_MAVLINK::ftp_worker(void) {
                     {
                         const uint16_t max_read = (request.size == 0?sizeof(reply.data):request.size);
                         // must actually be working on a file
-                        if (ftp.fd == -1) {
+                        if (session == nullptr || session->fd == -1) {
                             ftp_error(reply, FTP_ERROR::FileNotFound);
                             break;
                         }
 
                         // must have the file in read mode
-                        if ((ftp.mode != FTP_FILE_MODE::Read)) {
+                        if ((session->mode != FTP_FILE_MODE::Read)) {
                             ftp_error(reply, FTP_ERROR::Fail);
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
                         /*
                           calculate a burst delay so that FTP burst
                           transfer doesn't use more than 1/3 of
@@ -513,7 +655,7 @@ void GCS_MAVLINK::ftp_worker(void) {
                         const uint32_t transfer_size = 500;
                         for (uint32_t i = 0; (i < transfer_size); i++) {
                             // fill the buffer
-                            const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data), max_read));
+                            const ssize_t read_bytes = ftp_read(*session, request.offset + i * max_read, reply.data, MIN(sizeof(reply.data), max_read));
                             if (read_bytes == -1) {
                                 ftp_error(reply, FTP_ERROR::FailErrno);
                                 break;
@@ -531,7 +673,10 @@ void GCS_MAVLINK::ftp_worker(void) {
 
                             reply.opcode = FTP_OP::Ack;
                             reply.offset = request.offset + i * max_read;
-                            reply.burst_complete = ((read_bytes < max_read) || (i == (transfer_size - 1)));
+                            // end the burst early if other requests are waiting so
+                            // sessions downloading at the same time are interleaved
+                            reply.burst_complete = ((read_bytes < max_read) || (i == (transfer_size - 1)) ||
+                                                    (AP_MAVLINK_FTP_MAX_SESSIONS > 1 && ftp.requests->available() > 0));
                             reply.size = (uint8_t)read_bytes;
 
                             ftp_push_replies(reply);
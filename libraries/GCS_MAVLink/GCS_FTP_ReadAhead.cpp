@@ -0,0 +1,258 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GCS_FTP_ReadAhead.h"
+
+#if AP_MAVLINK_FTP_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+
+extern const AP_HAL::HAL& hal;
+
+GCS_FTP_ReadAhead::~GCS_FTP_ReadAhead()
+{
+    for (auto &buffer : _buffers) {
+        delete[] buffer.data;
+    }
+}
+
+// allocate two buffers of block_size bytes, returns false on allocation failure
+bool GCS_FTP_ReadAhead::init(uint32_t block_size, AP_HAL::BinarySemaphore *wake)
+{
+    if (_buffers[0].data != nullptr) {
+        return block_size == _block_size;
+    }
+    for (auto &buffer : _buffers) {
+        buffer.data = NEW_NOTHROW uint8_t[block_size];
+    }
+    if ((_buffers[0].data == nullptr) || (_buffers[1].data == nullptr)) {
+        for (auto &buffer : _buffers) {
+            delete[] buffer.data;
+            buffer.data = nullptr;
+        }
+        return false;
+    }
+    _block_size = block_size;
+    _wake = wake;
+    return true;
+}
+
+// start reading ahead from a file opened for reading
+void GCS_FTP_ReadAhead::start(int fd)
+{
+    WITH_SEMAPHORE(_sem);
+    _fd = fd;
+    _prefetch_pending = false;
+    _hits = 0;
+    _misses = 0;
+    for (auto &buffer : _buffers) {
+        buffer.valid = false;
+    }
+}
+
+// stop reading ahead, waits for any block being read by update() to complete
+void GCS_FTP_ReadAhead::stop()
+{
+    while (true) {
+        {
+            WITH_SEMAPHORE(_sem);
+            _fd = -1;
+            _prefetch_pending = false;
+            if (!_buffers[0].loading && !_buffers[1].loading) {
+                _buffers[0].valid = false;
+                _buffers[1].valid = false;
+                return;
+            }
+        }
+        hal.scheduler->delay(1);
+    }
+}
+
+// read the block at offset of file fd into a buffer, called without _sem held
+void GCS_FTP_ReadAhead::fill(Buffer &buffer, int fd, uint32_t offset)
+{
+    int32_t length;
+    int error = 0;
+    {
+        WITH_SEMAPHORE(_fd_sem);
+        if (AP::FS().lseek(fd, offset, SEEK_SET) == -1) {
+            length = -1;
+        } else {
+            length = AP::FS().read(fd, buffer.data, _block_size);
+        }
+        if (length == -1) {
+            error = errno;
+        }
+    }
+
+    WITH_SEMAPHORE(_sem);
+    buffer.length = length;
+    buffer.error = error;
+    buffer.loading = false;
+    buffer.valid = (_fd != -1);
+}
+
+// copy up to len bytes from offset in the file, continuing into the following
+// blocks so only the end of the file gives a short read
+int32_t GCS_FTP_ReadAhead::read(uint32_t offset, uint8_t *data, uint32_t len)
+{
+    uint32_t total = 0;
+    while (total < len) {
+        const int32_t copied = read_block(offset + total, &data[total], len - total);
+        if (copied < 0) {
+            // return what was copied, the error will be seen by the next read
+            return (total > 0) ? (int32_t)total : -1;
+        }
+        total += copied;
+        if ((copied == 0) || (((offset + total) % _block_size) != 0)) {
+            // end of file
+            break;
+        }
+    }
+    return total;
+}
+
+// copy up to len bytes from offset in the file from the block holding offset
+int32_t GCS_FTP_ReadAhead::read_block(uint32_t offset, uint8_t *data, uint32_t len)
+{
+    const uint32_t block = offset - (offset % _block_size);
+    const uint32_t start = offset - block;
+    bool loaded = false;
+    bool waited = false;
+
+    while (true) {
+        int32_t copied = -1;
+        bool signal = false;
+        Buffer *load = nullptr;
+        int fd;
+        {
+            WITH_SEMAPHORE(_sem);
+            fd = _fd;
+            if (fd == -1) {
+                errno = EBADF;
+                return -1;
+            }
+            for (uint8_t i = 0; i < ARRAY_SIZE(_buffers); i++) {
+                Buffer &buffer = _buffers[i];
+                if (!buffer.valid || (buffer.offset != block)) {
+                    continue;
+                }
+                if (buffer.length < 0) {
+                    buffer.valid = false;
+                    errno = buffer.error;
+                    return -1;
+                }
+                if (start >= (uint32_t)buffer.length) {
+                    if (loaded) {
+                        // end of file
+                        return 0;
+                    }
+                    // block was read at the end of the file which may have grown since
+                    buffer.valid = false;
+                    continue;
+                }
+                copied = MIN(len, buffer.length - start);
+                memcpy(data, &buffer.data[start], copied);
+
+                // request the block after this one unless it is already read or this is the end of the file
+                Buffer &other = _buffers[i ^ 1];
+                const uint32_t next = block + _block_size;
+                if (((uint32_t)buffer.length == _block_size) &&
+                    !other.loading &&
+                    !(other.valid && (other.offset == next)) &&
+                    !(_prefetch_pending && (_prefetch_offset == next))) {
+                    other.valid = false;
+                    _prefetch_offset = next;
+                    _prefetch_buffer = i ^ 1;
+                    _prefetch_pending = true;
+                    signal = true;
+                }
+                break;
+            }
+
+            if (copied < 0) {
+                // wait if update() is already reading this block, otherwise read it now
+                bool block_loading = false;
+                for (const auto &buffer : _buffers) {
+                    if (buffer.loading && (buffer.offset == block)) {
+                        block_loading = true;
+                    }
+                }
+                if (!block_loading) {
+                    // use a buffer not being read, preferring one which is empty
+                    const uint8_t i = (_buffers[0].loading || (_buffers[0].valid && !_buffers[1].valid && !_buffers[1].loading)) ? 1 : 0;
+                    if (_prefetch_pending && (_prefetch_buffer == i)) {
+                        _prefetch_pending = false;
+                    }
+                    load = &_buffers[i];
+                    load->loading = true;
+                    load->valid = false;
+                    load->offset = block;
+                }
+            }
+        }
+
+        if (copied >= 0) {
+            if (!waited) {
+                _hits++;
+            }
+            if (signal && (_wake != nullptr)) {
+                _wake->signal();
+            }
+            return copied;
+        }
+
+        if (!waited) {
+            _misses++;
+            waited = true;
+        }
+        if (load != nullptr) {
+            fill(*load, fd, block);
+            loaded = true;
+        } else {
+            hal.scheduler->delay_microseconds(100);
+        }
+    }
+}
+
+// read the requested block ahead, called from the read ahead thread
+bool GCS_FTP_ReadAhead::update()
+{
+    Buffer *buffer;
+    uint32_t offset;
+    int fd;
+    {
+        WITH_SEMAPHORE(_sem);
+        if (!_prefetch_pending || (_fd == -1)) {
+            return false;
+        }
+        _prefetch_pending = false;
+        buffer = &_buffers[_prefetch_buffer];
+        if (buffer->loading) {
+            return false;
+        }
+        offset = _prefetch_offset;
+        fd = _fd;
+        buffer->loading = true;
+        buffer->valid = false;
+        buffer->offset = offset;
+    }
+    fill(*buffer, fd, offset);
+    return true;
+}
+
+#endif  // AP_MAVLINK_FTP_ENABLED
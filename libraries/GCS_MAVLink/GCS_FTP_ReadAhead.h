@@ -0,0 +1,88 @@
+#pragma once
+
+#include "GCS_config.h"
+
+#if AP_MAVLINK_FTP_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_HAL/Semaphores.h>
+
+/*
+  read ahead of MAVFTP file reads
+
+  File data is read in blocks into two buffers. When a read moves into
+  one buffer the block after it is requested for the other buffer, which
+  update() fills from another thread, so file reads overlap with sending
+  the previous block
+ */
+class GCS_FTP_ReadAhead {
+public:
+    GCS_FTP_ReadAhead() {}
+    ~GCS_FTP_ReadAhead();
+
+    CLASS_NO_COPY(GCS_FTP_ReadAhead);  /* Do not allow copies */
+
+    // allocate two buffers of block_size bytes, returns false on allocation failure
+    // wake is signalled when update() has a block to read, it may be null if update() is polled
+    bool init(uint32_t block_size, AP_HAL::BinarySemaphore *wake);
+
+    // start reading ahead from a file opened for reading, fd must stay open until stop()
+    void start(int fd);
+
+    // stop reading ahead, waits for any block being read by update() to complete
+    void stop();
+
+    // true between start() and stop()
+    bool active() const { return _fd != -1; }
+
+    // copy up to len bytes from offset in the file, fewer than len bytes are only
+    // copied at the end of the file
+    // returns number of bytes copied, 0 at end of file or -1 on error with errno set
+    int32_t read(uint32_t offset, uint8_t *data, uint32_t len);
+
+    // read the requested block ahead, called from the read ahead thread
+    // returns true if a block was read
+    bool update();
+
+    // number of reads since start() copied from a block that was already read
+    uint32_t hits() const { return _hits; }
+
+    // number of reads since start() which had to wait for a block to be read
+    uint32_t misses() const { return _misses; }
+
+private:
+
+    struct Buffer {
+        uint8_t *data;
+        uint32_t offset;    // offset in file of first byte
+        int32_t length;     // number of bytes held, -1 if the read failed
+        int error;          // errno of failed read
+        bool valid;         // true if data holds the block at offset
+        bool loading;       // true while the block is being read
+    };
+
+    // copy up to len bytes from offset in the file from the block holding offset
+    // returns number of bytes copied, 0 at end of file or -1 on error with errno set
+    int32_t read_block(uint32_t offset, uint8_t *data, uint32_t len);
+
+    // read the block at offset of file fd into a buffer, called without _sem held
+    void fill(Buffer &buffer, int fd, uint32_t offset);
+
+    Buffer _buffers[2];
+    uint32_t _block_size;
+    int _fd = -1;
+
+    // next block for update() to read and the buffer to read it into
+    uint32_t _prefetch_offset;
+    uint8_t _prefetch_buffer;
+    bool _prefetch_pending;
+
+    AP_HAL::BinarySemaphore *_wake;
+    HAL_Semaphore _sem;     // protects buffer state
+    HAL_Semaphore _fd_sem;  // only one seek and read on the file at a time
+
+    uint32_t _hits;
+    uint32_t _misses;
+};
+
+#endif  // AP_MAVLINK_FTP_ENABLED
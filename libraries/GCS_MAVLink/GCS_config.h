@@ -86,6 +86,24 @@
 #define AP_MAVLINK_FTP_ENABLED HAL_GCS_ENABLED
 #endif
 
+// number of MAVFTP sessions which may have a file open at the same time
+#ifndef AP_MAVLINK_FTP_MAX_SESSIONS
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define AP_MAVLINK_FTP_MAX_SESSIONS 4
+#else
+#define AP_MAVLINK_FTP_MAX_SESSIONS 1
+#endif
+#endif
+
+// size of each of the two blocks MAVFTP reads files ahead into, 0 reads each reply directly from the file
+#ifndef AP_MAVLINK_FTP_READ_AHEAD_SIZE
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define AP_MAVLINK_FTP_READ_AHEAD_SIZE 65536
+#else
+#define AP_MAVLINK_FTP_READ_AHEAD_SIZE 0
+#endif
+#endif
+
 // GCS should be using MISSION_REQUEST_INT instead; this is a waste of
 // flash.  MISSION_REQUEST was deprecated in June 2020.  We started
 // sending warnings to the GCS in Sep 2022 if MISSION_REQUEST was used.
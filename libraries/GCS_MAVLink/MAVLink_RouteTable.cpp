@@ -0,0 +1,203 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file	MAVLink_RouteTable.cpp
+/// @brief	table of MAVLink routes keyed by sysid/compid
+
+#include "MAVLink_RouteTable.h"
+
+#if HAL_GCS_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+
+#define ROUTE_FLAG_COMPONENT    1
+#define ROUTE_FLAG_SYSTEM       2
+
+// initial table size, must be a power of two
+#define ROUTE_TABLE_MIN_SIZE    16
+
+// minimum interval between attempts to remove stale components from a full table
+#define ROUTE_TABLE_EXPIRE_INTERVAL_MS 1000
+
+MAVLink_RouteTable::~MAVLink_RouteTable()
+{
+    delete[] _table;
+}
+
+// slot in table searching for an entry starts from
+uint16_t MAVLink_RouteTable::home(uint8_t sysid, uint8_t compid, uint8_t flags) const
+{
+    const uint32_t key = sysid | (uint32_t(compid) << 8) | (uint32_t(flags) << 16);
+    return ((key * 2654435761U) >> 16) & _mask;
+}
+
+// slot holding the entry or the empty slot ending its search
+uint16_t MAVLink_RouteTable::slot(uint8_t sysid, uint8_t compid, uint8_t flags) const
+{
+    uint16_t i = home(sysid, compid, flags);
+    while ((_table[i].flags != 0) &&
+           ((_table[i].flags != flags) || (_table[i].sysid != sysid) || (_table[i].compid != compid))) {
+        i = (i + 1) & _mask;
+    }
+    return i;
+}
+
+// add channels to a component and its system, the table must have room for both
+MAVLink_RouteTable::Route &MAVLink_RouteTable::insert(uint8_t sysid, uint8_t compid, uint16_t channel_mask, uint32_t now_ms)
+{
+    Route &sys = _table[slot(sysid, 0, ROUTE_FLAG_SYSTEM)];
+    if (sys.flags == 0) {
+        sys.sysid = sysid;
+        sys.flags = ROUTE_FLAG_SYSTEM;
+        _used++;
+    }
+    sys.channel_mask |= channel_mask;
+
+    Route &route = _table[slot(sysid, compid, ROUTE_FLAG_COMPONENT)];
+    if (route.flags == 0) {
+        route.sysid = sysid;
+        route.compid = compid;
+        route.flags = ROUTE_FLAG_COMPONENT;
+        _used++;
+        _count++;
+    }
+    route.channel_mask |= channel_mask;
+    route.last_seen_ms = now_ms;
+
+    _channel_mask |= channel_mask;
+    return route;
+}
+
+// move routes to a table of size entries, dropping components not seen
+// for the timeout if expire is true. Returns false on allocation failure
+bool MAVLink_RouteTable::resize(uint16_t size, uint32_t now_ms, bool expire)
+{
+    Route *table = NEW_NOTHROW Route[size];
+    if (table == nullptr) {
+        return false;
+    }
+    memset(table, 0, size * sizeof(Route));
+
+    Route *old_table = _table;
+    const uint32_t old_size = (old_table == nullptr) ? 0 : _mask + 1U;
+    _table = table;
+    _mask = size - 1;
+    _used = 0;
+    _count = 0;
+    _channel_mask = 0;
+
+    for (uint32_t i = 0; i < old_size; i++) {
+        const Route &old = old_table[i];
+        if (old.flags != ROUTE_FLAG_COMPONENT) {
+            // systems are rebuilt from their components
+            continue;
+        }
+        if (expire && (now_ms - old.last_seen_ms > _timeout_ms)) {
+            continue;
+        }
+        insert(old.sysid, old.compid, old.channel_mask, old.last_seen_ms).mavtype = old.mavtype;
+    }
+    delete[] old_table;
+    return true;
+}
+
+// record sysid/compid as seen on chan, returns nullptr if the table is full
+MAVLink_RouteTable::Route *MAVLink_RouteTable::learn(uint8_t sysid, uint8_t compid, uint8_t chan, uint32_t now_ms)
+{
+    const uint16_t channel_mask = 1U << chan;
+    if (_table != nullptr) {
+        Route &route = _table[slot(sysid, compid, ROUTE_FLAG_COMPONENT)];
+        if (route.flags != 0) {
+            if ((route.channel_mask & channel_mask) == 0) {
+                // known component on a new channel, its system entry already exists
+                return &insert(sysid, compid, channel_mask, now_ms);
+            }
+            route.last_seen_ms = now_ms;
+            return &route;
+        }
+    }
+
+    // new component, make room by removing stale components if the table is full
+    if (_count >= _max_routes) {
+        if (now_ms - _last_expire_ms < ROUTE_TABLE_EXPIRE_INTERVAL_MS) {
+            return nullptr;
+        }
+        _last_expire_ms = now_ms;
+        if (!resize(_mask + 1U, now_ms, true) || (_count >= _max_routes)) {
+            return nullptr;
+        }
+    }
+
+    // keep the table at most three quarters full with room for the component and its system
+    uint32_t size = (_table == nullptr) ? ROUTE_TABLE_MIN_SIZE : _mask + 1U;
+    while ((_used + 2U) * 4U > size * 3U) {
+        size *= 2;
+    }
+    if ((_table == nullptr) || (size != _mask + 1U)) {
+        if ((size > UINT16_MAX) || !resize(size, now_ms, false)) {
+            return nullptr;
+        }
+    }
+
+    return &insert(sysid, compid, channel_mask, now_ms);
+}
+
+// channels a component has been seen on
+uint16_t MAVLink_RouteTable::component_mask(uint8_t sysid, uint8_t compid) const
+{
+    if (_table == nullptr) {
+        return 0;
+    }
+    return _table[slot(sysid, compid, ROUTE_FLAG_COMPONENT)].channel_mask;
+}
+
+// channels any component of a system has been seen on
+uint16_t MAVLink_RouteTable::system_mask(uint8_t sysid) const
+{
+    if (_table == nullptr) {
+        return 0;
+    }
+    return _table[slot(sysid, 0, ROUTE_FLAG_SYSTEM)].channel_mask;
+}
+
+// find a component with given mav_type, returns nullptr if not found
+const MAVLink_RouteTable::Route *MAVLink_RouteTable::find_by_mavtype(uint8_t mavtype) const
+{
+    if (_table == nullptr) {
+        return nullptr;
+    }
+    for (uint32_t i = 0; i <= _mask; i++) {
+        if ((_table[i].flags == ROUTE_FLAG_COMPONENT) && (_table[i].mavtype == mavtype)) {
+            return &_table[i];
+        }
+    }
+    return nullptr;
+}
+
+// find a component with given mav_type and component id, returns nullptr if not found
+const MAVLink_RouteTable::Route *MAVLink_RouteTable::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid) const
+{
+    if (_table == nullptr) {
+        return nullptr;
+    }
+    for (uint32_t i = 0; i <= _mask; i++) {
+        if ((_table[i].flags == ROUTE_FLAG_COMPONENT) && (_table[i].mavtype == mavtype) && (_table[i].compid == compid)) {
+            return &_table[i];
+        }
+    }
+    return nullptr;
+}
+
+#endif  // HAL_GCS_ENABLED
@@ -0,0 +1,90 @@
+/// @file	MAVLink_RouteTable.h
+/// @brief	table of MAVLink routes keyed by sysid/compid
+#pragma once
+
+#include "GCS_config.h"
+
+#if HAL_GCS_ENABLED
+
+#include <AP_Common/AP_Common.h>
+
+/*
+  table of the channels each MAVLink system and component has been
+  seen on.
+
+  Open addressing with linear probing, grown by doubling as routes are
+  learned so lookups stay constant time. Each component has one entry
+  holding a mask of the channels it has been seen on, and each system
+  has an entry holding the mask of channels any of its components have
+  been seen on, so the channels to forward a packet on can be found
+  with a single lookup. When the table holds max_routes components,
+  components not seen for timeout_ms are removed to make room
+ */
+class MAVLink_RouteTable {
+public:
+    MAVLink_RouteTable(uint16_t max_routes, uint32_t timeout_ms) :
+        _max_routes(max_routes),
+        _timeout_ms(timeout_ms) {}
+    ~MAVLink_RouteTable();
+
+    CLASS_NO_COPY(MAVLink_RouteTable);  /* Do not allow copies */
+
+    struct Route {
+        uint8_t sysid;
+        uint8_t compid;
+        uint8_t mavtype;        // MAV_TYPE from heartbeat, zero until one is seen
+        uint8_t flags;          // kind of entry, zero if the slot is empty
+        uint16_t channel_mask;  // channels the component has been seen on
+        uint32_t last_seen_ms;
+    };
+
+    // record sysid/compid as seen on chan, returns nullptr if the table is full
+    Route *learn(uint8_t sysid, uint8_t compid, uint8_t chan, uint32_t now_ms);
+
+    // channels a component has been seen on
+    uint16_t component_mask(uint8_t sysid, uint8_t compid) const;
+
+    // channels any component of a system has been seen on
+    uint16_t system_mask(uint8_t sysid) const;
+
+    // channels any component has been seen on
+    uint16_t channel_mask() const { return _channel_mask; }
+
+    // find a component with given mav_type, returns nullptr if not found
+    const Route *find_by_mavtype(uint8_t mavtype) const;
+
+    // find a component with given mav_type and component id, returns nullptr if not found
+    const Route *find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid) const;
+
+    // first channel in a route's channel mask
+    static uint8_t first_channel(const Route &route) { return __builtin_ctz(route.channel_mask); }
+
+    // number of components learned
+    uint16_t count() const { return _count; }
+
+private:
+
+    // slot in table searching for an entry starts from
+    uint16_t home(uint8_t sysid, uint8_t compid, uint8_t flags) const;
+
+    // slot holding the entry or the empty slot ending its search
+    uint16_t slot(uint8_t sysid, uint8_t compid, uint8_t flags) const;
+
+    // add channels to a component and its system, the table must have room for both
+    Route &insert(uint8_t sysid, uint8_t compid, uint16_t channel_mask, uint32_t now_ms);
+
+    // move routes to a table of size entries, dropping components not seen
+    // for the timeout if expire is true. Returns false on allocation failure
+    bool resize(uint16_t size, uint32_t now_ms, bool expire);
+
+    Route *_table = nullptr;
+    uint16_t _mask;             // table size minus one, table size is a power of two
+    uint16_t _used;             // number of slots holding a component or system
+    uint16_t _count = 0;        // number of components
+    uint16_t _channel_mask = 0; // channels any component has been seen on
+    uint32_t _last_expire_ms = 0; // time stale components were last removed from a full table
+    const uint16_t _max_routes;
+    const uint32_t _timeout_ms;
+};
+
+#endif  // HAL_GCS_ENABLED
@@ -33,7 +33,7 @@ extern const AP_HAL::HAL& hal;
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) {}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -171,45 +171,50 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
         return true;
     }
 
+    // find channels matching the targets
+    uint16_t chan_mask;
+    {
+        WITH_SEMAPHORE(routes_sem);
+        if (broadcast_system) {
+            chan_mask = routes.channel_mask();
+        } else if (broadcast_component || !match_system) {
+            chan_mask = routes.system_mask(target_system);
+        } else {
+            chan_mask = routes.component_mask(target_system, target_component);
+        }
+        // private channels only get packets addressed to a
+        // sysid/compid seen on them
+        chan_mask &= ~GCS_MAVLINK::private_channel_mask();
+        if (!broadcast_system && target_component != -1) {
+            chan_mask |= routes.component_mask(target_system, target_component) & GCS_MAVLINK::private_channel_mask();
+        }
+    }
+    chan_mask &= ~(1U<<(in_link.get_chan()-MAVLINK_COMM_0));
+
     // forward on any channels matching the targets
     bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-
-        // Skip if channel is private and the target system or component IDs do not match
-        GCS_MAVLINK *out_link = gcs().chan(routes[i].channel);
-        if (out_link == nullptr) {
-            // this is bad
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if ((chan_mask & (1U<<i)) == 0) {
             continue;
         }
-        if (out_link->is_private() &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        GCS_MAVLINK *out_link = gcs().chan(channel);
+        if (out_link == nullptr) {
+            // this is bad
             continue;
         }
-
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
-
-            if (&in_link != out_link && !sent_to_chan[routes[i].channel]) {
-                if (out_link->check_payload_size(msg.len)) {
+        if (out_link->check_payload_size(msg.len)) {
 #if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_link.get_chan(),
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
+            ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+                     msg.msgid,
+                     (unsigned)in_link.get_chan(),
+                     (unsigned)channel,
+                     (int)target_system,
+                     (int)target_component);
 #endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
-            }
+            _mavlink_resend_uart(channel, &msg);
         }
+        forwarded = true;
     }
 
     if ((!forwarded && match_system) ||
@@ -236,29 +241,29 @@ void MAVLink_routing::send_to_components(uint32_t msgid, const char *pkt, uint8_
 
 void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entry_t *entry, const uint8_t pkt_len)
 {
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
-
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid != mavlink_system.sysid) {
+    uint16_t chan_mask;
+    {
+        WITH_SEMAPHORE(routes_sem);
+        chan_mask = routes.system_mask(mavlink_system.sysid);
+    }
+
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if ((chan_mask & (1U<<i)) == 0) {
             // our system ID hasn't been seen on this link
             continue;
         }
-        if (sent_to_chan[routes[i].channel]) {
-            // we've already send it on this link
-            continue;
-        }
-        if (comm_get_txspace(routes[i].channel) <
-            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) <
+            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(channel)) {
             // it doesn't fit on this channel
             continue;
         }
 #if ROUTING_DEBUG
-        ::printf("send msg %u on chan %u sysid=%u compid=%u\n",
+        ::printf("send msg %u on chan %u sysid=%u\n",
                  entry->msgid,
-                 (unsigned)routes[i].channel,
-                 (unsigned)routes[i].sysid,
-                 (unsigned)routes[i].compid);
+                 (unsigned)channel,
+                 (unsigned)mavlink_system.sysid);
 #endif
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         if (entry->max_msg_len > pkt_len) {
@@ -266,13 +271,12 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
                           entry->max_msg_len, pkt_len);
         }
 #endif
-        _mav_finalize_message_chan_send(routes[i].channel,
+        _mav_finalize_message_chan_send(channel,
                                         entry->msgid,
                                         pkt,
                                         entry->min_msg_len,
                                         MIN(entry->max_msg_len, pkt_len),
                                         entry->crc_extra);
-        sent_to_chan[routes[i].channel] = true;
     }
 }
 
@@ -282,34 +286,35 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
  */
 bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel)
 {
+    WITH_SEMAPHORE(routes_sem);
+
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].mavtype == mavtype) {
-            sysid = routes[i].sysid;
-            compid = routes[i].compid;
-            channel = routes[i].channel;
-            return true;
-        }
+    const MAVLink_RouteTable::Route *route = routes.find_by_mavtype(mavtype);
+    if (route == nullptr) {
+        // we have not found the component
+        return false;
     }
-
-    // if we've reached we have not found the component
-    return false;
+    sysid = route->sysid;
+    compid = route->compid;
+    channel = (mavlink_channel_t)(MAVLINK_COMM_0 + MAVLink_RouteTable::first_channel(*route));
+    return true;
 }
 
 /*
   search for the first vehicle or component in the routing table with given mav_type and component id and retrieve its sysid and channel
   returns true if a match is found
  */
-bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const
+bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel)
 {
-    for (uint8_t i=0; i<num_routes; i++) {
-        if ((routes[i].mavtype == mavtype) && (routes[i].compid == compid)) {
-            sysid = routes[i].sysid;
-            channel = routes[i].channel;
-            return true;
-        }
+    WITH_SEMAPHORE(routes_sem);
+
+    const MAVLink_RouteTable::Route *route = routes.find_by_mavtype_and_compid(mavtype, compid);
+    if (route == nullptr) {
+        return false;
     }
-    return false;
+    sysid = route->sysid;
+    channel = (mavlink_channel_t)(MAVLINK_COMM_0 + MAVLink_RouteTable::first_channel(*route));
+    return true;
 }
 
 /*
@@ -317,7 +322,6 @@ bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid
 */
 void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0) {
         // don't learn routes to the broadcast system
         return;
@@ -335,31 +339,26 @@ void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t
         return;
     }
     const mavlink_channel_t in_channel = in_link.get_chan();
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-            }
-            break;
-        }
+    WITH_SEMAPHORE(routes_sem);
+#if ROUTING_DEBUG
+    const uint16_t old_count = routes.count();
+#endif
+    MAVLink_RouteTable::Route *route = routes.learn(msg.sysid, msg.compid, in_channel-MAVLINK_COMM_0, AP_HAL::millis());
+    if (route == nullptr) {
+        // routing table is full
+        return;
+    }
+    if (route->mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        route->mavtype = mavlink_msg_heartbeat_get_type(&msg);
     }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-        }
-        num_routes++;
 #if ROUTING_DEBUG
+    if (routes.count() != old_count) {
         ::printf("learned route %u %u via %u\n",
                  (unsigned)msg.sysid,
                  (unsigned)msg.compid,
                  (unsigned)in_channel);
-#endif
     }
+#endif
 }
 
 
@@ -382,10 +381,9 @@ void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
-            mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
-        }
+    {
+        WITH_SEMAPHORE(routes_sem);
+        mask &= ~routes.component_mask(msg.sysid, msg.compid);
     }
 
     if (mask == 0) {
@@ -3,11 +3,23 @@
 #pragma once
 
 #include <AP_Common/AP_Common.h>
+#include <AP_HAL/Semaphores.h>
 #include "GCS_MAVLink.h"
+#include "MAVLink_RouteTable.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+// maximum number of sysid/compid combinations to route to
+#ifndef MAVLINK_MAX_ROUTES
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define MAVLINK_MAX_ROUTES 500
+#else
 #define MAVLINK_MAX_ROUTES 20
+#endif
+#endif
+
+// a full routing table drops routes not seen for this long to make room for new ones
+#ifndef MAVLINK_ROUTE_TIMEOUT_MS
+#define MAVLINK_ROUTE_TIMEOUT_MS 30000
+#endif
 
 /*
   object to handle MAVLink packet routing
@@ -47,19 +59,15 @@ public:
       search for the first vehicle or component in the routing table with given mav_type and component id and retrieve its sysid and channel
       returns true if a match is found
      */
-    bool find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const;
+    bool find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel);
 
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
-    uint8_t num_routes;
-    struct route {
-        uint8_t sysid;
-        uint8_t compid;
-        mavlink_channel_t channel;
-        uint8_t mavtype;
-    } routes[MAVLINK_MAX_ROUTES];
-    
+    // channels each sysid/compid has been seen on
+    MAVLink_RouteTable routes{MAVLINK_MAX_ROUTES, MAVLINK_ROUTE_TIMEOUT_MS};
+
+    // protects routes, which may be searched from other threads
+    HAL_Semaphore routes_sem;
+
     // a channel mask to block routing as required
     uint8_t no_route_mask;
     
@@ -0,0 +1,89 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+#include <GCS_MAVLink/GCS_FTP_ReadAhead.h>
+
+#if AP_MAVLINK_FTP_ENABLED
+
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  file reads for a MAVFTP burst download of a local file, reading one
+  reply payload at a time as GCS_MAVLINK::ftp_worker does. The file size
+  in kilobytes is the benchmark argument
+ */
+
+#define BENCH_FTP_FILE          "bench_ftp_read.bin"
+#define BENCH_FTP_PAYLOAD       239
+#define BENCH_FTP_BLOCK_SIZE    65536
+
+static void create_file(uint32_t size)
+{
+    const int fd = AP::FS().open(BENCH_FTP_FILE, O_WRONLY|O_CREAT|O_TRUNC);
+    if (fd == -1) {
+        AP_HAL::panic("failed to create " BENCH_FTP_FILE);
+    }
+    uint8_t buf[512];
+    for (uint16_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = i;
+    }
+    for (uint32_t ofs = 0; ofs < size; ofs += sizeof(buf)) {
+        AP::FS().write(fd, buf, MIN(sizeof(buf), size - ofs));
+    }
+    AP::FS().close(fd);
+}
+
+static void BM_FTPReadDirect(benchmark::State& state)
+{
+    const uint32_t size = state.range(0) * 1024;
+    create_file(size);
+    const int fd = AP::FS().open(BENCH_FTP_FILE, O_RDONLY);
+    uint8_t data[BENCH_FTP_PAYLOAD];
+
+    while (state.KeepRunning()) {
+        // seek and read for each reply
+        for (uint32_t ofs = 0; ofs < size; ofs += BENCH_FTP_PAYLOAD) {
+            AP::FS().lseek(fd, ofs, SEEK_SET);
+            int32_t n = AP::FS().read(fd, data, sizeof(data));
+            gbenchmark_escape(&n);
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * size);
+    AP::FS().close(fd);
+    AP::FS().unlink(BENCH_FTP_FILE);
+}
+
+static void BM_FTPReadAhead(benchmark::State& state)
+{
+    const uint32_t size = state.range(0) * 1024;
+    create_file(size);
+    const int fd = AP::FS().open(BENCH_FTP_FILE, O_RDONLY);
+    uint8_t data[BENCH_FTP_PAYLOAD];
+    GCS_FTP_ReadAhead *read_ahead = NEW_NOTHROW GCS_FTP_ReadAhead();
+    if ((read_ahead == nullptr) || !read_ahead->init(BENCH_FTP_BLOCK_SIZE, nullptr)) {
+        AP_HAL::panic("out of memory");
+    }
+
+    while (state.KeepRunning()) {
+        read_ahead->start(fd);
+        for (uint32_t ofs = 0; ofs < size; ofs += BENCH_FTP_PAYLOAD) {
+            int32_t n = read_ahead->read(ofs, data, sizeof(data));
+            gbenchmark_escape(&n);
+            // read ahead inline in place of the read ahead thread
+            read_ahead->update();
+        }
+        read_ahead->stop();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * size);
+    delete read_ahead;
+    AP::FS().close(fd);
+    AP::FS().unlink(BENCH_FTP_FILE);
+}
+
+BENCHMARK(BM_FTPReadDirect)->Arg(64)->Arg(1024)->Arg(8192);
+BENCHMARK(BM_FTPReadAhead)->Arg(64)->Arg(1024)->Arg(8192);
+#endif
+
+BENCHMARK_MAIN()
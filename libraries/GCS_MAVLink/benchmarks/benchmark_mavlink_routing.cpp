@@ -0,0 +1,125 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+#include <GCS_MAVLink/MAVLink_RouteTable.h>
+
+#if HAL_GCS_ENABLED
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  route 10000 packets between endpoints spread over 8 channels, learning
+  the route of each sender and finding the channels to forward to as
+  MAVLink_routing::check_and_forward does. The number of sysid/compid
+  endpoints is the benchmark argument
+ */
+
+#define BENCH_PACKETS       10000
+#define BENCH_CHANNELS      8
+#define BENCH_MAX_ROUTES    1000
+
+struct bench_packet {
+    uint8_t sysid;
+    uint8_t compid;
+    uint8_t chan;
+    uint8_t target_sysid;
+    uint8_t target_compid;
+};
+
+static bench_packet *create_packets(uint16_t num_endpoints)
+{
+    bench_packet *packets = NEW_NOTHROW bench_packet[BENCH_PACKETS];
+    if (packets == nullptr) {
+        AP_HAL::panic("out of memory");
+    }
+    uint32_t rand_state = 1;
+    for (uint16_t i = 0; i < BENCH_PACKETS; i++) {
+        rand_state = rand_state * 1664525U + 1013904223U;
+        const uint16_t from = (rand_state >> 8) % num_endpoints;
+        const uint16_t to = (rand_state >> 20) % num_endpoints;
+        // several components per system, each endpoint always on the same channel
+        packets[i].sysid = 1 + from / 4;
+        packets[i].compid = 1 + from % 4;
+        packets[i].chan = from % BENCH_CHANNELS;
+        packets[i].target_sysid = 1 + to / 4;
+        packets[i].target_compid = 1 + to % 4;
+    }
+    return packets;
+}
+
+// the linear routing table used before MAVLink_RouteTable
+struct linear_route {
+    uint8_t sysid;
+    uint8_t compid;
+    uint8_t channel;
+    uint8_t mavtype;
+};
+
+static void BM_RoutingLinear(benchmark::State& state)
+{
+    const uint16_t num_endpoints = state.range(0);
+    bench_packet *packets = create_packets(num_endpoints);
+    linear_route *routes = NEW_NOTHROW linear_route[BENCH_MAX_ROUTES];
+    if (routes == nullptr) {
+        AP_HAL::panic("out of memory");
+    }
+    uint16_t num_routes = 0;
+
+    while (state.KeepRunning()) {
+        for (uint16_t p = 0; p < BENCH_PACKETS; p++) {
+            const bench_packet &pkt = packets[p];
+            // learn_route
+            uint16_t i;
+            for (i = 0; i < num_routes; i++) {
+                if (routes[i].sysid == pkt.sysid &&
+                    routes[i].compid == pkt.compid &&
+                    routes[i].channel == pkt.chan) {
+                    break;
+                }
+            }
+            if (i == num_routes && i < BENCH_MAX_ROUTES) {
+                routes[i].sysid = pkt.sysid;
+                routes[i].compid = pkt.compid;
+                routes[i].channel = pkt.chan;
+                num_routes++;
+            }
+            // forward to the target component
+            uint16_t chan_mask = 0;
+            for (i = 0; i < num_routes; i++) {
+                if (routes[i].sysid == pkt.target_sysid && routes[i].compid == pkt.target_compid) {
+                    chan_mask |= 1U << routes[i].channel;
+                }
+            }
+            gbenchmark_escape(&chan_mask);
+        }
+    }
+    delete[] routes;
+    delete[] packets;
+}
+
+static void BM_RoutingTable(benchmark::State& state)
+{
+    const uint16_t num_endpoints = state.range(0);
+    bench_packet *packets = create_packets(num_endpoints);
+    MAVLink_RouteTable *routes = NEW_NOTHROW MAVLink_RouteTable(BENCH_MAX_ROUTES, 30000);
+    if (routes == nullptr) {
+        AP_HAL::panic("out of memory");
+    }
+
+    while (state.KeepRunning()) {
+        for (uint16_t p = 0; p < BENCH_PACKETS; p++) {
+            const bench_packet &pkt = packets[p];
+            MAVLink_RouteTable::Route *route = routes->learn(pkt.sysid, pkt.compid, pkt.chan, 0);
+            gbenchmark_escape(&route);
+            uint16_t chan_mask = routes->component_mask(pkt.target_sysid, pkt.target_compid);
+            gbenchmark_escape(&chan_mask);
+        }
+    }
+    delete routes;
+    delete[] packets;
+}
+
+BENCHMARK(BM_RoutingLinear)->Arg(20)->Arg(100)->Arg(500);
+BENCHMARK(BM_RoutingTable)->Arg(20)->Arg(100)->Arg(500);
+#endif
+
+BENCHMARK_MAIN()
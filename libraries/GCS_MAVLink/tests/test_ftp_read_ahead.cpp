@@ -0,0 +1,142 @@
+#include <AP_gtest.h>
+
+#include <GCS_MAVLink/GCS_FTP_ReadAhead.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_MAVLINK_FTP_ENABLED && AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+  reads of a file through GCS_FTP_ReadAhead must give the file's bytes
+  when they cross from one read ahead block into the next
+ */
+
+#define TEST_FTP_FILE           "test_ftp_read_ahead.bin"
+#define TEST_FTP_PAYLOAD        239
+#define TEST_FTP_FILE_SIZE      (3 * AP_MAVLINK_FTP_READ_AHEAD_SIZE + 1000)
+
+// file contents which don't repeat at any power of two
+static uint8_t test_byte(uint32_t offset)
+{
+    return offset % 251;
+}
+
+static int create_file(uint32_t size)
+{
+    int fd = AP::FS().open(TEST_FTP_FILE, O_WRONLY|O_CREAT|O_TRUNC);
+    if (fd == -1) {
+        return -1;
+    }
+    uint8_t buf[512];
+    for (uint32_t ofs = 0; ofs < size; ofs += sizeof(buf)) {
+        const uint32_t n = MIN(sizeof(buf), size - ofs);
+        for (uint32_t i = 0; i < n; i++) {
+            buf[i] = test_byte(ofs + i);
+        }
+        if (AP::FS().write(fd, buf, n) != (int32_t)n) {
+            AP::FS().close(fd);
+            return -1;
+        }
+    }
+    AP::FS().close(fd);
+    return AP::FS().open(TEST_FTP_FILE, O_RDONLY);
+}
+
+// read the file a reply payload at a time as a burst read does, with
+// or without the following block having been read ahead
+static void read_file(uint32_t size, bool read_ahead)
+{
+    const int fd = create_file(size);
+    ASSERT_NE(fd, -1);
+    GCS_FTP_ReadAhead *reader = NEW_NOTHROW GCS_FTP_ReadAhead();
+    ASSERT_NE(reader, nullptr);
+    ASSERT_TRUE(reader->init(AP_MAVLINK_FTP_READ_AHEAD_SIZE, nullptr));
+    reader->start(fd);
+
+    uint8_t data[TEST_FTP_PAYLOAD];
+    uint32_t ofs = 0;
+    while (true) {
+        memset(data, 0, sizeof(data));
+        const int32_t n = reader->read(ofs, data, sizeof(data));
+        ASSERT_EQ(n, (int32_t)MIN(sizeof(data), size - ofs)) << "offset " << ofs;
+        if (n == 0) {
+            break;
+        }
+        for (int32_t i = 0; i < n; i++) {
+            ASSERT_EQ(data[i], test_byte(ofs + i)) << "offset " << ofs + i;
+        }
+        ofs += n;
+        if (read_ahead) {
+            // read ahead inline in place of the read ahead thread
+            reader->update();
+        }
+    }
+    EXPECT_EQ(ofs, size);
+
+    // the first block is always waited for
+    EXPECT_GT(reader->misses(), 0U);
+    if (read_ahead) {
+        EXPECT_GT(reader->hits(), 0U);
+    }
+
+    // counts are kept per file
+    reader->stop();
+    reader->start(fd);
+    EXPECT_EQ(reader->hits(), 0U);
+    EXPECT_EQ(reader->misses(), 0U);
+
+    reader->stop();
+    delete reader;
+    AP::FS().close(fd);
+    AP::FS().unlink(TEST_FTP_FILE);
+}
+
+TEST(GCS_FTP_ReadAhead, ReadAcrossBlocks)
+{
+    read_file(TEST_FTP_FILE_SIZE, true);
+}
+
+TEST(GCS_FTP_ReadAhead, ReadAcrossBlocksNotReadAhead)
+{
+    read_file(TEST_FTP_FILE_SIZE, false);
+}
+
+TEST(GCS_FTP_ReadAhead, ReadToEndOfBlock)
+{
+    // file ends at a block boundary
+    read_file(2 * AP_MAVLINK_FTP_READ_AHEAD_SIZE, true);
+}
+
+// a read straddling a block boundary at any offset into the read
+TEST(GCS_FTP_ReadAhead, ReadStraddlingBoundary)
+{
+    const uint32_t size = TEST_FTP_FILE_SIZE;
+    const int fd = create_file(size);
+    ASSERT_NE(fd, -1);
+    GCS_FTP_ReadAhead *reader = NEW_NOTHROW GCS_FTP_ReadAhead();
+    ASSERT_NE(reader, nullptr);
+    ASSERT_TRUE(reader->init(AP_MAVLINK_FTP_READ_AHEAD_SIZE, nullptr));
+    reader->start(fd);
+
+    uint8_t data[TEST_FTP_PAYLOAD];
+    for (uint32_t before = 1; before < sizeof(data); before += 17) {
+        const uint32_t ofs = 2 * AP_MAVLINK_FTP_READ_AHEAD_SIZE - before;
+        const int32_t n = reader->read(ofs, data, sizeof(data));
+        ASSERT_EQ(n, (int32_t)sizeof(data)) << "offset " << ofs;
+        for (uint32_t i = 0; i < sizeof(data); i++) {
+            ASSERT_EQ(data[i], test_byte(ofs + i)) << "offset " << ofs + i;
+        }
+    }
+
+    reader->stop();
+    delete reader;
+    AP::FS().close(fd);
+    AP::FS().unlink(TEST_FTP_FILE);
+}
+
+#endif  // AP_MAVLINK_FTP_ENABLED && AP_MAVLINK_FTP_READ_AHEAD_SIZE > 0
+
+AP_GTEST_MAIN()
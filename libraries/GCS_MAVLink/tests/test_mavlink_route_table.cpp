@@ -0,0 +1,109 @@
+#include <AP_gtest.h>
+
+#include <GCS_MAVLink/MAVLink_RouteTable.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_GCS_ENABLED
+
+TEST(MAVLink_RouteTable, Masks)
+{
+    MAVLink_RouteTable table{20, 30000};
+    EXPECT_EQ(table.channel_mask(), 0);
+    EXPECT_EQ(table.system_mask(1), 0);
+    EXPECT_EQ(table.component_mask(1, 1), 0);
+
+    ASSERT_NE(table.learn(1, 1, 0, 100), nullptr);
+    ASSERT_NE(table.learn(1, 154, 2, 100), nullptr);
+    ASSERT_NE(table.learn(255, 190, 1, 100), nullptr);
+    // same component on a second channel
+    ASSERT_NE(table.learn(1, 1, 3, 100), nullptr);
+    // seen again on a known channel
+    ASSERT_NE(table.learn(1, 1, 0, 200), nullptr);
+    EXPECT_EQ(table.count(), 3);
+
+    EXPECT_EQ(table.component_mask(1, 1), 0b1001);
+    EXPECT_EQ(table.component_mask(1, 154), 0b0100);
+    EXPECT_EQ(table.component_mask(255, 190), 0b0010);
+    EXPECT_EQ(table.component_mask(1, 2), 0);
+    EXPECT_EQ(table.system_mask(1), 0b1101);
+    EXPECT_EQ(table.system_mask(255), 0b0010);
+    EXPECT_EQ(table.system_mask(2), 0);
+    EXPECT_EQ(table.channel_mask(), 0b1111);
+}
+
+TEST(MAVLink_RouteTable, MavType)
+{
+    MAVLink_RouteTable table{20, 30000};
+    EXPECT_EQ(table.find_by_mavtype(26), nullptr);
+
+    MAVLink_RouteTable::Route *route = table.learn(1, 154, 2, 100);
+    ASSERT_NE(route, nullptr);
+    route->mavtype = 26;
+    ASSERT_NE(table.learn(1, 1, 0, 100), nullptr);
+
+    const MAVLink_RouteTable::Route *found = table.find_by_mavtype(26);
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->sysid, 1);
+    EXPECT_EQ(found->compid, 154);
+    EXPECT_EQ(MAVLink_RouteTable::first_channel(*found), 2);
+    EXPECT_NE(table.find_by_mavtype_and_compid(26, 154), nullptr);
+    EXPECT_EQ(table.find_by_mavtype_and_compid(26, 1), nullptr);
+
+    // mav_type is kept as the table grows
+    for (uint8_t i = 2; i < 20; i++) {
+        ASSERT_NE(table.learn(i, 1, 0, 100), nullptr);
+    }
+    found = table.find_by_mavtype(26);
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->compid, 154);
+}
+
+TEST(MAVLink_RouteTable, Grow)
+{
+    MAVLink_RouteTable table{1000, 30000};
+    for (uint16_t i = 0; i < 1000; i++) {
+        ASSERT_NE(table.learn(1 + i % 250, i / 250, i % 16, 100), nullptr);
+    }
+    EXPECT_EQ(table.count(), 1000);
+    for (uint16_t i = 0; i < 1000; i++) {
+        EXPECT_EQ(table.component_mask(1 + i % 250, i / 250), 1U << (i % 16));
+    }
+    EXPECT_EQ(table.component_mask(1, 4), 0);
+    EXPECT_EQ(table.channel_mask(), 0xFFFF);
+}
+
+TEST(MAVLink_RouteTable, Full)
+{
+    MAVLink_RouteTable table{3, 30000};
+    ASSERT_NE(table.learn(1, 1, 0, 2000), nullptr);
+    ASSERT_NE(table.learn(2, 1, 1, 2000), nullptr);
+    ASSERT_NE(table.learn(3, 1, 2, 2000), nullptr);
+
+    // full, known components are still updated
+    EXPECT_EQ(table.learn(4, 1, 3, 2000), nullptr);
+    ASSERT_NE(table.learn(1, 1, 3, 2000), nullptr);
+    EXPECT_EQ(table.component_mask(1, 1), 0b1001);
+
+    // full with no stale components
+    ASSERT_NE(table.learn(1, 1, 0, 20000), nullptr);
+    EXPECT_EQ(table.learn(4, 1, 3, 31000), nullptr);
+
+    // system 2 and 3 are stale, but the last attempt to expire was too recent
+    ASSERT_NE(table.learn(1, 1, 0, 31500), nullptr);
+    EXPECT_EQ(table.learn(4, 1, 3, 31800), nullptr);
+
+    // stale components are replaced
+    ASSERT_NE(table.learn(1, 1, 0, 33000), nullptr);
+    ASSERT_NE(table.learn(4, 1, 3, 33000), nullptr);
+    EXPECT_EQ(table.count(), 2);
+    EXPECT_EQ(table.component_mask(2, 1), 0);
+    EXPECT_EQ(table.system_mask(3), 0);
+    EXPECT_EQ(table.component_mask(1, 1), 0b1001);
+    EXPECT_EQ(table.component_mask(4, 1), 0b1000);
+    EXPECT_EQ(table.channel_mask(), 0b1001);
+}
+
+#endif  // HAL_GCS_ENABLED
+
+AP_GTEST_MAIN()
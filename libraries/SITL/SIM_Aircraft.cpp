@@ -288,10 +288,15 @@ void Aircraft::sync_frame_time(void)
     uint64_t now = get_wall_time_us();
     uint64_t dt_us = now - last_wall_time_us;
 
-    const float target_dt_us = 1.0e6/(rate_hz*target_speedup);
+    if (free_running()) {
+        // simulation time advances as fast as the firmware runs
+        sleep_debt_us = 0;
+    } else {
+        const float target_dt_us = 1.0e6/(rate_hz*target_speedup);
 
-    // accumulate sleep debt if we're running too fast
-    sleep_debt_us += target_dt_us - dt_us;
+        // accumulate sleep debt if we're running too fast
+        sleep_debt_us += target_dt_us - dt_us;
+    }
 
     if (sleep_debt_us < -1.0e5) {
         // don't let a large negative debt build up
@@ -467,7 +472,7 @@ void Aircraft::fill_fdm(struct sitl_fdm &fdm)
         sitl->speedup.set(get_speedup());
     }
     
-    if (!is_equal(last_speedup, float(sitl->speedup)) && sitl->speedup > 0) {
+    if (!is_equal(last_speedup, float(sitl->speedup)) && sitl->speedup >= 0) {
         set_speedup(sitl->speedup);
         last_speedup = sitl->speedup;
     }
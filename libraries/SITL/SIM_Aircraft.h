@@ -59,10 +59,12 @@ public:
     virtual void set_start_location(const Location &start_loc, const float start_yaw);
 
     /*
-      set simulation speedup
+      set simulation speedup, zero runs as fast as possible without
+      pacing against the wall clock
      */
     void set_speedup(float speedup);
     float get_speedup() const { return target_speedup; }
+    bool free_running() const { return !is_positive(target_speedup); }
 
     /*
       set instance number
@@ -314,7 +316,7 @@ protected:
     void adjust_frame_time(float rate);
 
     /* try to synchronise simulation time with wall clock time, taking
-       into account desired speedup */
+       into account desired speedup. Never sleeps when free running */
     void sync_frame_time(void);
 
     /* add noise based on throttle level (from 0..1) */
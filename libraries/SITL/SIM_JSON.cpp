@@ -139,17 +139,201 @@ void JSON::output_servos(const struct sitl_input &input)
 }
 
 
+// skip JSON whitespace
+static const char *skip_space(const char *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+        p++;
+    }
+    return p;
+}
+
+// parse a JSON array of count numbers, returns pointer after the array or nullptr on error
+template <typename T>
+static const char *parse_array(const char *p, T *v, uint8_t count)
+{
+    if (*p != '[') {
+        return nullptr;
+    }
+    p++;
+    for (uint8_t i=0; i<count; i++) {
+        char *end;
+        v[i] = strtod(p, &end);
+        if (end == p) {
+            return nullptr;
+        }
+        p = skip_space(end);
+        if (*p != ((i == count-1) ? ']' : ',')) {
+            return nullptr;
+        }
+        p++;
+    }
+    return p;
+}
+
+// parse the value of a key, returns pointer after the value or nullptr on error
+static const char *parse_value(const char *p, const struct JSON::keytable &key)
+{
+    char *end = const_cast<char *>(p);
+    switch (key.type) {
+        case JSON::DATA_UINT64:
+            *((uint64_t *)key.ptr) = strtoull(p, &end, 10);
+            break;
+
+        case JSON::DATA_FLOAT:
+            *((float *)key.ptr) = strtod(p, &end);
+            break;
+
+        case JSON::DATA_DOUBLE:
+            *((double *)key.ptr) = strtod(p, &end);
+            break;
+
+        case JSON::DATA_VECTOR3F: {
+            float v[3];
+            p = parse_array(p, v, 3);
+            if (p != nullptr) {
+                *((Vector3f *)key.ptr) = Vector3f{v[0], v[1], v[2]};
+            }
+            return p;
+        }
+
+        case JSON::DATA_VECTOR3D: {
+            double v[3];
+            p = parse_array(p, v, 3);
+            if (p != nullptr) {
+                *((Vector3d *)key.ptr) = Vector3d{v[0], v[1], v[2]};
+            }
+            return p;
+        }
+
+        case JSON::QUATERNION: {
+            float v[4];
+            p = parse_array(p, v, 4);
+            if (p != nullptr) {
+                *((Quaternion *)key.ptr) = Quaternion{v[0], v[1], v[2], v[3]};
+            }
+            return p;
+        }
+
+        case JSON::BOOLEAN: {
+            bool *b = (bool *)key.ptr;
+            if (strncasecmp(p, "true", 4) == 0) {
+                *b = true;
+                end += 4;
+            } else if (strncasecmp(p, "false", 5) == 0) {
+                *b = false;
+                end += 5;
+            } else {
+                *b = strtoull(p, &end, 10) != 0;
+            }
+            break;
+        }
+    }
+    // scalars that are not numbers are read as zero, as atof() would
+    return end;
+}
+
 /*
-    very simple JSON parser for sensor data
+    simple single pass JSON parser for sensor data
     called with pointer to one row of sensor data, nul terminated
 
-    This parser does not do any syntax checking, and is not at all
-    general purpose
+    Keys at the top level have an empty section, keys within an object
+    at the top level have the object's name as their section. This
+    parser does very little syntax checking, and is not at all general
+    purpose
 */
-uint32_t JSON::parse_sensors(const char *json)
+uint32_t JSON::parse_keys(const char *json, const struct keytable *keys, uint8_t num_keys)
 {
     uint32_t received_bitmask = 0;
+    const char *section = "";
+    size_t section_len = 0;
+    uint8_t depth = 0;
+
+    const char *p = json;
+    while (*p != 0) {
+        if (*p == '{') {
+            depth++;
+            p++;
+            continue;
+        }
+        if (*p == '}') {
+            if (depth > 0) {
+                depth--;
+            }
+            if (depth <= 1) {
+                section = "";
+                section_len = 0;
+            }
+            p++;
+            continue;
+        }
+        if (*p != '"') {
+            p++;
+            continue;
+        }
 
+        // a string, which is a key if followed by a colon
+        const char *name = ++p;
+        while (*p != 0 && *p != '"') {
+            if (*p == '\\' && p[1] != 0) {
+                p++;
+            }
+            p++;
+        }
+        if (*p == 0) {
+            break;
+        }
+        const size_t name_len = p - name;
+        p = skip_space(p+1);
+        if (*p != ':') {
+            continue;
+        }
+        p = skip_space(p+1);
+
+        if (*p == '{') {
+            if (depth == 1) {
+                // entering a section
+                section = name;
+                section_len = name_len;
+            }
+            continue;
+        }
+        if (depth == 0 || depth > 2) {
+            continue;
+        }
+
+        for (uint8_t i=0; i<num_keys; i++) {
+            const struct keytable &key = keys[i];
+            if (strncmp(key.key, name, name_len) != 0 || key.key[name_len] != 0 ||
+                strncmp(key.section, section, section_len) != 0 || key.section[section_len] != 0) {
+                continue;
+            }
+            p = parse_value(p, key);
+            if (p == nullptr) {
+                printf("Failed to parse %s/%s\n", key.section, key.key);
+                return received_bitmask;
+            }
+            // record the keys that are found
+            received_bitmask |= 1U << i;
+            break;
+        }
+    }
+
+    for (uint8_t i=0; i<num_keys; i++) {
+        if (keys[i].required && (received_bitmask & (1U << i)) == 0) {
+            printf("Failed to find key %s/%s\n", keys[i].section, keys[i].key);
+            return 0;
+        }
+    }
+
+    return received_bitmask;
+}
+
+/*
+    parse one row of JSON sensor data into state
+*/
+uint32_t JSON::parse_sensors(const char *json)
+{
 #if SITL_JSON_DEBUG && AP_FILESYSTEM_FILE_WRITING_ENABLED
     // it is useful in some environments to be able to get a copy of the raw
     // JSON data
@@ -167,96 +351,44 @@ uint32_t JSON::parse_sensors(const char *json)
 #endif
 
     //printf("%s\n", json);
-    for (uint16_t i=0; i<ARRAY_SIZE(keytable); i++) {
-        struct keytable &key = keytable[i];
-
-        /* look for section header */
-        const char *p = strstr(json, key.section);
-        if (!p) {
-            // we don't have this sensor
-            if (key.required) {
-                printf("Failed to find %s\n", key.section);
-                return 0;
-            }
-            continue;
-        }
-        p += strlen(key.section)+1;
-
-        // find key inside section
-        p = strstr(p, key.key);
-        if (!p) {
-            if (key.required) {
-                printf("Failed to find key %s/%s\n", key.section, key.key);
-                return 0;
-            }
-            continue;
-        }
-
-        // record the keys that are found
-        received_bitmask |= 1U << i;
-
-        p += strlen(key.key)+2;
-        switch (key.type) {
-            case DATA_UINT64:
-                *((uint64_t *)key.ptr) = strtoull(p, nullptr, 10);
-                //printf("%s/%s = %lu\n", key.section, key.key, *((uint64_t *)key.ptr));
-                break;
-
-            case DATA_FLOAT:
-                *((float *)key.ptr) = atof(p);
-                //printf("%s/%s = %f\n", key.section, key.key, *((float *)key.ptr));
-                break;
-
-            case DATA_DOUBLE:
-                *((double *)key.ptr) = atof(p);
-                //printf("%s/%s = %f\n", key.section, key.key, *((double *)key.ptr));
-                break;
-
-            case DATA_VECTOR3F: {
-                Vector3f *v = (Vector3f *)key.ptr;
-                if (sscanf(p, "[%f, %f, %f]", &v->x, &v->y, &v->z) != 3) {
-                    printf("Failed to parse Vector3f for %s/%s\n", key.section, key.key);
-                    return received_bitmask;
-                }
-                //printf("%s/%s = %f, %f, %f\n", key.section, key.key, v->x, v->y, v->z);
-                break;
-            }
-
-            case DATA_VECTOR3D: {
-                Vector3d *v = (Vector3d *)key.ptr;
-                if (sscanf(p, "[%lf, %lf, %lf]", &v->x, &v->y, &v->z) != 3) {
-                    printf("Failed to parse Vector3f for %s/%s\n", key.section, key.key);
-                    return received_bitmask;
-                }
-                //printf("%s/%s = %f, %f, %f\n", key.section, key.key, v->x, v->y, v->z);
-                break;
-            }
-
-            case QUATERNION: {
-                Quaternion *v = static_cast<Quaternion*>(key.ptr);
-                if (sscanf(p, "[%f, %f, %f, %f]", &(v->q1), &(v->q2), &(v->q3), &(v->q4)) != 4) {
-                    printf("Failed to parse Vector4f for %s/%s\n", key.section, key.key);
-                    return received_bitmask;
-                }
-                break;
-            }
+    return parse_keys(json, keytable, ARRAY_SIZE(keytable));
+}
 
-            case BOOLEAN: {
-                bool *b = (bool *)key.ptr;
-                if (strncasecmp(p, "true", 4) == 0) {
-                    *b = true;
-                } else if (strncasecmp(p, "false", 5) == 0) {
-                    *b = false;
-                } else {
-                    *b = strtoull(p, nullptr, 10) != 0;
-                }
-                //printf("%s/%s = %i\n", key.section, key.key, *((unit8_t *)key.ptr));
-                break;
-            }
+/*
+    copy a binary sensor packet into state, returns the fields it
+    holds or zero if a required field is missing
+*/
+uint32_t JSON::parse_binary(const struct fdm_packet_binary &pkt)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(keytable); i++) {
+        if (keytable[i].required && (pkt.fields & (1U << i)) == 0) {
+            printf("Failed to find key %s/%s\n", keytable[i].section, keytable[i].key);
+            return 0;
         }
     }
 
-    return received_bitmask;
+    state.timestamp_s = pkt.timestamp_s;
+    state.imu.gyro = Vector3f{pkt.gyro[0], pkt.gyro[1], pkt.gyro[2]};
+    state.imu.accel_body = Vector3f{pkt.accel_body[0], pkt.accel_body[1], pkt.accel_body[2]};
+    state.position = Vector3d{pkt.position[0], pkt.position[1], pkt.position[2]};
+    state.attitude = Vector3f{pkt.attitude[0], pkt.attitude[1], pkt.attitude[2]};
+    state.quaternion = Quaternion{pkt.quaternion[0], pkt.quaternion[1], pkt.quaternion[2], pkt.quaternion[3]};
+    state.velocity = Vector3f{pkt.velocity[0], pkt.velocity[1], pkt.velocity[2]};
+    for (uint8_t i=0; i<ARRAY_SIZE(state.rng); i++) {
+        state.rng[i] = pkt.rng[i];
+    }
+    state.velocity_wind = Vector3f{pkt.velocity_wind[0], pkt.velocity_wind[1], pkt.velocity_wind[2]};
+    state.wind_vane_apparent.direction = pkt.wind_vane_direction;
+    state.wind_vane_apparent.speed = pkt.wind_vane_speed;
+    state.airspeed = pkt.airspeed;
+    state.no_time_sync = pkt.no_time_sync != 0;
+    for (uint8_t i=0; i<ARRAY_SIZE(state.rc); i++) {
+        state.rc[i] = pkt.rc[i];
+    }
+    state.bat_volt = pkt.bat_volt;
+    state.bat_amp = pkt.bat_amp;
+
+    return pkt.fields;
 }
 
 /*
@@ -280,23 +412,41 @@ void JSON::recv_fdm(const struct sitl_input &input)
         }
     }
 
-    // convert '\n' into nul
-    while (uint8_t *p = (uint8_t *)memchr(&sensor_buffer[sensor_buffer_len], '\n', ret)) {
-        *p = 0;
-    }
-    sensor_buffer_len += ret;
+    uint32_t received_bitmask;
+    const uint8_t *p2 = nullptr;
+    const fdm_packet_binary binary_header {};
+    if ((size_t)ret >= sizeof(binary_header.magic) + sizeof(binary_header.version) &&
+        memcmp(&sensor_buffer[sensor_buffer_len], &binary_header.magic, sizeof(binary_header.magic)) == 0) {
+        // binary sensor packet, which is always one datagram
+        fdm_packet_binary pkt;
+        memcpy(&pkt, &sensor_buffer[sensor_buffer_len], MIN(sizeof(pkt), (size_t)ret));
+        if (pkt.version != binary_header.version || (size_t)ret != sizeof(pkt)) {
+            if (binary_version_warned != pkt.version) {
+                binary_version_warned = pkt.version;
+                printf("Unsupported binary sensor packet version %u length %ld\n", (unsigned)pkt.version, (long)ret);
+            }
+            return;
+        }
+        received_bitmask = parse_binary(pkt);
+    } else {
+        // convert '\n' into nul
+        while (uint8_t *p = (uint8_t *)memchr(&sensor_buffer[sensor_buffer_len], '\n', ret)) {
+            *p = 0;
+        }
+        sensor_buffer_len += ret;
 
-    const uint8_t *p2 = (const uint8_t *)memrchr(sensor_buffer, 0, sensor_buffer_len);
-    if (p2 == nullptr || p2 == sensor_buffer) {
-        return;
-    }
+        p2 = (const uint8_t *)memrchr(sensor_buffer, 0, sensor_buffer_len);
+        if (p2 == nullptr || p2 == sensor_buffer) {
+            return;
+        }
 
-    const uint8_t *p1 = (const uint8_t *)memrchr(sensor_buffer, 0, p2 - sensor_buffer);
-    if (p1 == nullptr) {
-        return;
-    }
+        const uint8_t *p1 = (const uint8_t *)memrchr(sensor_buffer, 0, p2 - sensor_buffer);
+        if (p1 == nullptr) {
+            return;
+        }
 
-    const uint32_t received_bitmask = parse_sensors((const char *)(p1+1));
+        received_bitmask = parse_sensors((const char *)(p1+1));
+    }
     if (received_bitmask == 0) {
         // did not receive one of the mandatory fields
         printf("Did not contain all mandatory fields\n");
@@ -327,8 +477,10 @@ void JSON::recv_fdm(const struct sitl_input &input)
     }
     last_received_bitmask = received_bitmask;
 
-    memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
-    sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
+    if (p2 != nullptr) {
+        memmove(sensor_buffer, p2, sensor_buffer_len - (p2 - sensor_buffer));
+        sensor_buffer_len = sensor_buffer_len - (p2 - sensor_buffer);
+    }
 
     accel_body = state.imu.accel_body;
     gyro = state.imu.gyro;
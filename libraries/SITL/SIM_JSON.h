@@ -38,6 +38,60 @@ public:
     /*  Create and set in/out socket for JSON generic simulator */
     void set_interface_ports(const char* address, const int port_in, const int port_out) override;
 
+    enum data_type {
+        DATA_UINT64,
+        DATA_FLOAT,
+        DATA_DOUBLE,
+        DATA_VECTOR3F,
+        DATA_VECTOR3D,
+        QUATERNION,
+        BOOLEAN,
+    };
+
+    // entry in a table of keys to parse from JSON sensor data
+    struct keytable {
+        const char *section;
+        const char *key;
+        void *ptr;
+        enum data_type type;
+        bool required;
+    };
+
+    /*
+      parse one row of JSON sensor data, nul terminated, into the keys
+      of a table of up to 32 keys in a single pass. Returns a bitmask
+      of the keys found, zero if a required key is missing
+    */
+    static uint32_t parse_keys(const char *json, const struct keytable *keys, uint8_t num_keys);
+
+    /*
+      fixed layout alternative to JSON sensor data for physics backends
+      running at high frame rates. Each packet starts with the magic
+      value, which can't be the start of JSON text, and a version. The
+      fields bitmask uses the same bits as the JSON keys
+    */
+    struct PACKED fdm_packet_binary {
+        uint16_t magic = 27028; // constant magic value
+        uint16_t version = 1;
+        uint32_t fields;        // DataKey bitmask of fields set
+        double timestamp_s;
+        float gyro[3];
+        float accel_body[3];
+        double position[3];
+        float attitude[3];
+        float quaternion[4];
+        float velocity[3];
+        float rng[6];
+        float velocity_wind[3];
+        float wind_vane_direction;
+        float wind_vane_speed;
+        float airspeed;
+        float rc[12];
+        float bat_volt;
+        float bat_amp;
+        uint8_t no_time_sync;
+    };
+
 private:
 
     struct servo_packet_16 {
@@ -69,20 +123,14 @@ private:
     void recv_fdm(const struct sitl_input &input);
 
     uint32_t parse_sensors(const char *json);
+    uint32_t parse_binary(const struct fdm_packet_binary &pkt);
 
     // buffer for parsing pose data in JSON format
     uint8_t sensor_buffer[65000];
     uint32_t sensor_buffer_len;
 
-    enum data_type {
-        DATA_UINT64,
-        DATA_FLOAT,
-        DATA_DOUBLE,
-        DATA_VECTOR3F,
-        DATA_VECTOR3D,
-        QUATERNION,
-        BOOLEAN,
-    };
+    // binary packet version we have warned is unsupported
+    uint16_t binary_version_warned;
 
     struct {
         double timestamp_s;
@@ -108,13 +156,7 @@ private:
     } state;
 
     // table to aid parsing of JSON sensor data
-    struct keytable {
-        const char *section;
-        const char *key;
-        void *ptr;
-        enum data_type type;
-        bool required;
-    } keytable[32] {
+    struct keytable keytable[32] {
         { "", "timestamp", &state.timestamp_s, DATA_DOUBLE, true },
         { "imu", "gyro",    &state.imu.gyro, DATA_VECTOR3F, true },
         { "imu", "accel_body", &state.imu.accel_body, DATA_VECTOR3F, true },
@@ -0,0 +1,187 @@
+#include <AP_gbenchmark.h>
+#include <SITL/SIM_JSON.h>
+
+#if AP_SIM_JSON_ENABLED
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+using namespace SITL;
+
+/*
+  decode one frame of sensor data from a physics backend with the keys
+  of SITL::JSON. Frames per second are reported as items per second
+ */
+
+static struct {
+    double timestamp_s;
+    Vector3f gyro;
+    Vector3f accel_body;
+    Vector3d position;
+    Vector3f attitude;
+    Quaternion quaternion;
+    Vector3f velocity;
+    Vector3f velocity_wind;
+    float rng[6];
+    float rc[12];
+    float wind_vane_direction;
+    float wind_vane_speed;
+    float airspeed;
+    float bat_volt;
+    float bat_amp;
+    bool no_time_sync;
+} bench_state;
+
+static const JSON::keytable bench_keys[] {
+    { "", "timestamp", &bench_state.timestamp_s, JSON::DATA_DOUBLE, true },
+    { "imu", "gyro", &bench_state.gyro, JSON::DATA_VECTOR3F, true },
+    { "imu", "accel_body", &bench_state.accel_body, JSON::DATA_VECTOR3F, true },
+    { "", "position", &bench_state.position, JSON::DATA_VECTOR3D, true },
+    { "", "attitude", &bench_state.attitude, JSON::DATA_VECTOR3F, false },
+    { "", "quaternion", &bench_state.quaternion, JSON::QUATERNION, false },
+    { "", "velocity", &bench_state.velocity, JSON::DATA_VECTOR3F, true },
+    { "", "rng_1", &bench_state.rng[0], JSON::DATA_FLOAT, false },
+    { "", "rng_2", &bench_state.rng[1], JSON::DATA_FLOAT, false },
+    { "", "rng_3", &bench_state.rng[2], JSON::DATA_FLOAT, false },
+    { "", "rng_4", &bench_state.rng[3], JSON::DATA_FLOAT, false },
+    { "", "rng_5", &bench_state.rng[4], JSON::DATA_FLOAT, false },
+    { "", "rng_6", &bench_state.rng[5], JSON::DATA_FLOAT, false },
+    { "", "velocity_wind", &bench_state.velocity_wind, JSON::DATA_VECTOR3F, false },
+    { "windvane", "direction", &bench_state.wind_vane_direction, JSON::DATA_FLOAT, false },
+    { "windvane", "speed", &bench_state.wind_vane_speed, JSON::DATA_FLOAT, false },
+    { "", "airspeed", &bench_state.airspeed, JSON::DATA_FLOAT, false },
+    { "", "no_time_sync", &bench_state.no_time_sync, JSON::BOOLEAN, false },
+    { "rc", "rc_1", &bench_state.rc[0], JSON::DATA_FLOAT, false },
+    { "rc", "rc_2", &bench_state.rc[1], JSON::DATA_FLOAT, false },
+    { "rc", "rc_3", &bench_state.rc[2], JSON::DATA_FLOAT, false },
+    { "rc", "rc_4", &bench_state.rc[3], JSON::DATA_FLOAT, false },
+    { "rc", "rc_5", &bench_state.rc[4], JSON::DATA_FLOAT, false },
+    { "rc", "rc_6", &bench_state.rc[5], JSON::DATA_FLOAT, false },
+    { "rc", "rc_7", &bench_state.rc[6], JSON::DATA_FLOAT, false },
+    { "rc", "rc_8", &bench_state.rc[7], JSON::DATA_FLOAT, false },
+    { "rc", "rc_9", &bench_state.rc[8], JSON::DATA_FLOAT, false },
+    { "rc", "rc_10", &bench_state.rc[9], JSON::DATA_FLOAT, false },
+    { "rc", "rc_11", &bench_state.rc[10], JSON::DATA_FLOAT, false },
+    { "rc", "rc_12", &bench_state.rc[11], JSON::DATA_FLOAT, false },
+    { "battery", "voltage", &bench_state.bat_volt, JSON::DATA_FLOAT, false },
+    { "battery", "current", &bench_state.bat_amp, JSON::DATA_FLOAT, false },
+};
+
+// typical frame, without spaces after separators as the strstr parser requires
+static const char bench_json[] =
+    "{\"timestamp\":1234.5675,"
+    "\"imu\":{\"gyro\":[0.0123456789,-0.0234567891,0.0345678912],"
+    "\"accel_body\":[0.123456789,-0.234567891,-9.80665]},"
+    "\"position\":[123.456789012,-234.567890123,-45.6789012345],"
+    "\"quaternion\":[0.999048221581858,0.0130806258460286,-0.0261538461538462,0.0304528463267653],"
+    "\"velocity\":[1.23456789,-2.34567891,0.345678912],"
+    "\"rng_1\":45.678,"
+    "\"battery\":{\"voltage\":16.2,\"current\":12.5}}";
+
+// parser used before JSON::parse_keys, searching the frame for each key
+static uint32_t parse_strstr(const char *json)
+{
+    uint32_t received_bitmask = 0;
+    for (uint16_t i=0; i<ARRAY_SIZE(bench_keys); i++) {
+        const JSON::keytable &key = bench_keys[i];
+        const char *p = strstr(json, key.section);
+        if (!p) {
+            if (key.required) {
+                return 0;
+            }
+            continue;
+        }
+        p += strlen(key.section)+1;
+        p = strstr(p, key.key);
+        if (!p) {
+            if (key.required) {
+                return 0;
+            }
+            continue;
+        }
+        received_bitmask |= 1U << i;
+        p += strlen(key.key)+2;
+        switch (key.type) {
+            case JSON::DATA_UINT64:
+                *((uint64_t *)key.ptr) = strtoull(p, nullptr, 10);
+                break;
+            case JSON::DATA_FLOAT:
+                *((float *)key.ptr) = atof(p);
+                break;
+            case JSON::DATA_DOUBLE:
+                *((double *)key.ptr) = atof(p);
+                break;
+            case JSON::DATA_VECTOR3F: {
+                Vector3f *v = (Vector3f *)key.ptr;
+                if (sscanf(p, "[%f, %f, %f]", &v->x, &v->y, &v->z) != 3) {
+                    return received_bitmask;
+                }
+                break;
+            }
+            case JSON::DATA_VECTOR3D: {
+                Vector3d *v = (Vector3d *)key.ptr;
+                if (sscanf(p, "[%lf, %lf, %lf]", &v->x, &v->y, &v->z) != 3) {
+                    return received_bitmask;
+                }
+                break;
+            }
+            case JSON::QUATERNION: {
+                Quaternion *v = (Quaternion *)key.ptr;
+                if (sscanf(p, "[%f, %f, %f, %f]", &v->q1, &v->q2, &v->q3, &v->q4) != 4) {
+                    return received_bitmask;
+                }
+                break;
+            }
+            case JSON::BOOLEAN:
+                *((bool *)key.ptr) = strtoull(p, nullptr, 10) != 0;
+                break;
+        }
+    }
+    return received_bitmask;
+}
+
+static void BM_SIM_JSONParseStrstr(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        uint32_t mask = parse_strstr(bench_json);
+        gbenchmark_escape(&mask);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_SIM_JSONParseKeys(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        uint32_t mask = JSON::parse_keys(bench_json, bench_keys, ARRAY_SIZE(bench_keys));
+        gbenchmark_escape(&mask);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_SIM_JSONBinary(benchmark::State& state)
+{
+    JSON::fdm_packet_binary pkt {};
+    pkt.fields = 0x0000007F;
+    uint8_t datagram[sizeof(pkt)];
+    memcpy(datagram, &pkt, sizeof(pkt));
+
+    while (state.KeepRunning()) {
+        // same steps as JSON::recv_fdm for a binary packet
+        JSON::fdm_packet_binary rx;
+        memcpy(&rx, datagram, sizeof(rx));
+        bench_state.timestamp_s = rx.timestamp_s;
+        bench_state.gyro = Vector3f{rx.gyro[0], rx.gyro[1], rx.gyro[2]};
+        bench_state.accel_body = Vector3f{rx.accel_body[0], rx.accel_body[1], rx.accel_body[2]};
+        bench_state.position = Vector3d{rx.position[0], rx.position[1], rx.position[2]};
+        bench_state.quaternion = Quaternion{rx.quaternion[0], rx.quaternion[1], rx.quaternion[2], rx.quaternion[3]};
+        bench_state.velocity = Vector3f{rx.velocity[0], rx.velocity[1], rx.velocity[2]};
+        gbenchmark_escape(&bench_state);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SIM_JSONParseStrstr);
+BENCHMARK(BM_SIM_JSONParseKeys);
+BENCHMARK(BM_SIM_JSONBinary);
+#endif
+
+BENCHMARK_MAIN()
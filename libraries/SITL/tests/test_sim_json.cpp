@@ -0,0 +1,88 @@
+#include <AP_gtest.h>
+
+#include <SITL/SIM_JSON.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_SIM_JSON_ENABLED
+
+using namespace SITL;
+
+static struct {
+    double timestamp_s;
+    Vector3f gyro;
+    Vector3f accel_body;
+    Vector3d position;
+    Quaternion quaternion;
+    float rc[2];
+    bool no_time_sync;
+} test_state;
+
+static const JSON::keytable test_keys[] {
+    { "", "timestamp", &test_state.timestamp_s, JSON::DATA_DOUBLE, true },
+    { "imu", "gyro", &test_state.gyro, JSON::DATA_VECTOR3F, true },
+    { "imu", "accel_body", &test_state.accel_body, JSON::DATA_VECTOR3F, true },
+    { "", "position", &test_state.position, JSON::DATA_VECTOR3D, true },
+    { "", "quaternion", &test_state.quaternion, JSON::QUATERNION, false },
+    { "rc", "rc_1", &test_state.rc[0], JSON::DATA_FLOAT, false },
+    { "rc", "rc_2", &test_state.rc[1], JSON::DATA_FLOAT, false },
+    { "", "no_time_sync", &test_state.no_time_sync, JSON::BOOLEAN, false },
+};
+
+TEST(SIM_JSON, ParseKeys)
+{
+    const char *json = "{\"timestamp\": 12.5, \"imu\": {\"gyro\": [0.1, -0.2, 3e-1], \"accel_body\": [0,0,-9.81]},"
+                       " \"position\": [1000.25, -2, 3], \"quaternion\": [1.0, 0.0, 0.0, 0.0],"
+                       " \"rc\": {\"rc_2\": 1500}, \"battery\": {\"voltage\": 12.6}, \"no_time_sync\": True}";
+    const uint32_t mask = JSON::parse_keys(json, test_keys, ARRAY_SIZE(test_keys));
+    EXPECT_EQ(mask, 0b11011111U);
+    EXPECT_DOUBLE_EQ(test_state.timestamp_s, 12.5);
+    EXPECT_FLOAT_EQ(test_state.gyro.x, 0.1);
+    EXPECT_FLOAT_EQ(test_state.gyro.y, -0.2);
+    EXPECT_FLOAT_EQ(test_state.gyro.z, 0.3);
+    EXPECT_FLOAT_EQ(test_state.accel_body.z, -9.81);
+    EXPECT_DOUBLE_EQ(test_state.position.x, 1000.25);
+    EXPECT_FLOAT_EQ(test_state.quaternion.q1, 1.0);
+    EXPECT_FLOAT_EQ(test_state.rc[1], 1500);
+    EXPECT_TRUE(test_state.no_time_sync);
+}
+
+TEST(SIM_JSON, ParseKeysSection)
+{
+    // keys only match in their own section
+    const char *json = "{\"timestamp\": 1, \"gyro\": [9, 9, 9], \"imu\": {\"timestamp\": 2, \"gyro\": [1, 2, 3],"
+                       " \"accel_body\": [4, 5, 6]}, \"position\": [7, 8, 9], \"rc_1\": 1100}";
+    test_state.rc[0] = 0;
+    const uint32_t mask = JSON::parse_keys(json, test_keys, ARRAY_SIZE(test_keys));
+    EXPECT_EQ(mask, 0b1111U);
+    EXPECT_DOUBLE_EQ(test_state.timestamp_s, 1);
+    EXPECT_FLOAT_EQ(test_state.gyro.x, 1);
+    EXPECT_FLOAT_EQ(test_state.rc[0], 0);
+}
+
+TEST(SIM_JSON, ParseKeysErrors)
+{
+    // missing required key
+    EXPECT_EQ(JSON::parse_keys("{\"timestamp\": 1, \"position\": [7, 8, 9]}", test_keys, ARRAY_SIZE(test_keys)), 0U);
+
+    // badly formed vector returns the keys parsed before it
+    EXPECT_EQ(JSON::parse_keys("{\"timestamp\": 1, \"imu\": {\"gyro\": [1, 2]}}", test_keys, ARRAY_SIZE(test_keys)), 1U);
+
+    // unterminated
+    EXPECT_EQ(JSON::parse_keys("{\"timestamp\": 1, \"imu", test_keys, ARRAY_SIZE(test_keys)), 0U);
+}
+
+TEST(SIM_JSON, BinaryPacket)
+{
+    // layout is shared with physics backends, don't change it without changing the version
+    JSON::fdm_packet_binary pkt;
+    EXPECT_EQ(sizeof(pkt), 209U);
+    EXPECT_EQ(pkt.magic, 27028U);
+    EXPECT_EQ(pkt.version, 1U);
+    // the first byte of the magic can't start JSON text
+    EXPECT_GE(((uint8_t *)&pkt.magic)[0], 0x80);
+}
+
+#endif  // AP_SIM_JSON_ENABLED
+
+AP_GTEST_MAIN()